@@ -21,15 +21,23 @@
 #include "config.h"
 
 #include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
 
+#include <glib/gstdio.h>
 #include <gtk/gtk.h>
 #include <libintl.h>
 
 #include <libdesktop-agnostic/fdo.h>
 #include <libawn/libawn.h>
+#include <libawn/awn-startup-trace.h>
 
 #include <dbus/dbus-glib.h>
 #include <dbus/dbus-glib-bindings.h>
@@ -59,12 +67,16 @@ g_execute(const gchar* file,
           gchar**      envp,
           gboolean     search_path);
 
+static gboolean
+zygote_run(const gchar* socket_path, gint* argc, gchar*** argv);
+
 
 /* Commmand line options */
 static gchar*    path = NULL;
 static gchar*    uid  = NULL;
 static gint64    window = 0;
 static gint      panel_id = 1;
+static gchar*    zygote = NULL;
 
 
 static GOptionEntry entries[] = {
@@ -104,33 +116,72 @@ static GOptionEntry entries[] = {
         ""
     },
 
+    {
+        "zygote",
+        'z', 0,
+        G_OPTION_ARG_STRING,
+        &zygote,
+        "Fork applets on requests to this socket (used by awn).",
+        ""
+    },
+
     { NULL }
 };
 
-int main(int argc, char** argv)
+static gboolean
+parse_options(gint* argc, gchar*** argv)
 {
     GError* error = NULL;
     GOptionContext* context;
+
+    context = g_option_context_new(" - Awn Applet Activation Options");
+    g_option_context_add_main_entries(context, entries, NULL);
+    g_option_context_parse(context, argc, argv, &error);
+    g_option_context_free(context);
+
+    if (error) {
+        g_print("%s\n", error->message);
+        g_error_free(error);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+int main(int argc, char** argv)
+{
+    GError* error = NULL;
     DesktopAgnosticVFSFile* desktop_file = NULL;
     DesktopAgnosticFDODesktopEntry* entry = NULL;
     GtkWidget* applet = NULL;
     const gchar* exec;
     const gchar* name;
     const gchar* type;
+    gint64 start;
 
-    /* Load options */
-    context = g_option_context_new(" - Awn Applet Activation Options");
-    g_option_context_add_main_entries(context, entries, NULL);
-    g_option_context_parse(context, &argc, &argv, &error);
+    awn_startup_trace_mark("main");
 
-    if (error) {
-        g_print("%s\n", error->message);
-        g_error_free(error);
+    /* Load options */
+    if (!parse_options(&argc, &argv)) {
         return 1;
     }
 
     g_type_init();
 
+    /* the zygote forks, it must not have started any threads by then */
+    if (zygote) {
+        if (!zygote_run(zygote, &argc, &argv)) {
+            return 0;
+        }
+        /* we're a forked applet now, argv holds the request */
+        awn_startup_trace_clear();
+        awn_startup_trace_mark("forked");
+        g_free(zygote);
+        zygote = NULL;
+        if (!parse_options(&argc, &argv)) {
+            return 1;
+        }
+    }
+
     if (!g_thread_supported()) {
         g_thread_init(NULL);
     }
@@ -142,7 +193,9 @@ int main(int argc, char** argv)
         return EXIT_FAILURE;
     }
 
+    start = awn_startup_trace_now();
     gtk_init(&argc, &argv);
+    awn_startup_trace_span("gtk_init", start);
 
     if (path == NULL || path[0] == '\0') {
         g_warning("You need to provide path to desktop file");
@@ -237,7 +290,10 @@ int main(int argc, char** argv)
                                dot ? dot - canonical_name : strlen(canonical_name));
 
     /* Create a GtkPlug for the applet */
+    awn_startup_trace_set_process_name(canonical_name);
+    start = awn_startup_trace_now();
     applet = _awn_applet_new(canonical_name, exec, uid, panel_id);
+    awn_startup_trace_span("applet module", start);
 
     g_free(canonical_name);
 
@@ -591,3 +647,282 @@ g_execute(const gchar* file,
     // Return the error from the last attempt (probably ENOENT).
     return -1;
 }
+
+/*
+ * Zygote mode: awn starts one "awn-applet --zygote=PATH", which does the
+ * initialization all applets share once, listens on the unix socket PATH and
+ * forks for each request.  The forked applets skip the dynamic linking, type
+ * registration and module loading every freshly spawned awn-applet pays for.
+ *
+ * A request is one line with a shell quoted awn-applet command line, which
+ * may start with NAME=VALUE environment assignments.  The zygote answers with
+ * the pid of the forked applet and, when the applet exits, with its wait
+ * status; then closes the connection.  It exits when its stdin is closed,
+ * ie. when awn is gone.
+ */
+
+#define ZYGOTE_MAX_REQUEST 4096
+
+static gint zygote_sigchld_pipe[2] = { -1, -1 };
+
+static void
+zygote_on_sigchld(int signum)
+{
+    gint saved_errno = errno;
+    ssize_t written = write(zygote_sigchld_pipe[1], "", 1);
+
+    (void)written;
+    errno = saved_errno;
+}
+
+static gboolean
+zygote_send(gint fd, const gchar* line)
+{
+    gsize len = strlen(line);
+
+    while (len > 0) {
+        ssize_t written = write(fd, line, len);
+
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return FALSE;
+        }
+        line += written;
+        len -= written;
+    }
+    return TRUE;
+}
+
+static gchar*
+zygote_read_request(gint fd)
+{
+    GString* request = g_string_new(NULL);
+    gchar c;
+
+    while (request->len < ZYGOTE_MAX_REQUEST) {
+        ssize_t got = read(fd, &c, 1);
+
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            break;
+        }
+        if (c == '\n') {
+            return g_string_free(request, FALSE);
+        }
+        g_string_append_c(request, c);
+    }
+    g_string_free(request, TRUE);
+    return NULL;
+}
+
+/*
+ * Does what doesn't need a display connection (that can't be shared with
+ * the forked applets), threads or the VFS (they don't survive a fork).
+ */
+static void
+zygote_warm_up(void)
+{
+    GError* error = NULL;
+    GtkIconTheme* theme;
+    GType types[] = {
+        AWN_TYPE_APPLET, AWN_TYPE_ICON, AWN_TYPE_THEMED_ICON,
+        AWN_TYPE_EFFECTS, AWN_TYPE_TOOLTIP, AWN_TYPE_DIALOG, GTK_TYPE_PLUG
+    };
+
+    /* loads the config backend module */
+    desktop_agnostic_config_get_type(&error);
+    if (error) {
+        g_warning("Unable to load the config backend: %s", error->message);
+        g_error_free(error);
+    }
+
+    for (guint i = 0; i < G_N_ELEMENTS(types); i++) {
+        g_type_class_unref(g_type_class_ref(types[i]));
+    }
+
+    g_slist_free(gdk_pixbuf_get_formats());
+
+    /* reads the icon theme caches */
+    theme = gtk_icon_theme_new();
+    gtk_icon_theme_has_icon(theme, "image-missing");
+    g_object_unref(theme);
+}
+
+/* Makes the forked applet look like it was started with the request */
+static void
+zygote_apply_request(gchar** request, gint* argc, gchar*** argv)
+{
+    while (*request && (*request)[0] != '-' && strchr(*request, '=')) {
+        gchar** assignment = g_strsplit(*request, "=", 2);
+
+        g_setenv(assignment[0], assignment[1], TRUE);
+        g_strfreev(assignment);
+        request++;
+    }
+    *argv = g_strdupv(request);
+    *argc = g_strv_length(*argv);
+}
+
+/*
+ * Returns TRUE in the forked applets (with argc and argv set to the
+ * request), FALSE in the zygote when it's time to exit.
+ */
+static gboolean
+zygote_run(const gchar* socket_path, gint* argc, gchar*** argv)
+{
+    struct sockaddr_un addr;
+    struct sigaction action;
+    GHashTable* children; /* pid -> connection fd */
+    gint listen_fd;
+    gboolean forked = FALSE;
+
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+        g_warning("Zygote socket path too long: %s", socket_path);
+        return FALSE;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    g_strlcpy(addr.sun_path, socket_path, sizeof(addr.sun_path));
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0 ||
+            bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+            listen(listen_fd, 16) < 0 ||
+            pipe(zygote_sigchld_pipe) < 0) {
+        g_warning("Unable to listen on %s: %s", socket_path, g_strerror(errno));
+        return FALSE;
+    }
+    fcntl(zygote_sigchld_pipe[0], F_SETFL, O_NONBLOCK);
+    fcntl(zygote_sigchld_pipe[1], F_SETFL, O_NONBLOCK);
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = zygote_on_sigchld;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+    sigaction(SIGCHLD, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    children = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+    zygote_warm_up();
+
+    /* tell awn we're ready, from now on applets write where we do */
+    zygote_send(STDOUT_FILENO, "ready\n");
+    dup2(STDERR_FILENO, STDOUT_FILENO);
+
+    while (!forked) {
+        struct pollfd fds[] = {
+            { STDIN_FILENO, POLLIN, 0 },
+            { zygote_sigchld_pipe[0], POLLIN, 0 },
+            { listen_fd, POLLIN, 0 }
+        };
+
+        if (poll(fds, G_N_ELEMENTS(fds), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            g_warning("Zygote poll failed: %s", g_strerror(errno));
+            break;
+        }
+
+        if (fds[0].revents) {
+            /* awn closed our stdin */
+            break;
+        }
+
+        if (fds[1].revents) {
+            gchar buf[64];
+            gint status;
+            pid_t pid;
+
+            while (read(zygote_sigchld_pipe[0], buf, sizeof(buf)) > 0);
+
+            while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+                gpointer conn;
+
+                if (g_hash_table_lookup_extended(children, GINT_TO_POINTER(pid),
+                                                 NULL, &conn)) {
+                    gchar* line = g_strdup_printf("%d\n", status);
+                    zygote_send(GPOINTER_TO_INT(conn), line);
+                    g_free(line);
+                    close(GPOINTER_TO_INT(conn));
+                    g_hash_table_remove(children, GINT_TO_POINTER(pid));
+                }
+            }
+        }
+
+        if (fds[2].revents) {
+            gint conn = accept(listen_fd, NULL, NULL);
+            gchar* request;
+            gchar** request_argv = NULL;
+            pid_t pid;
+
+            if (conn < 0) {
+                continue;
+            }
+            request = zygote_read_request(conn);
+            if (!request || !g_shell_parse_argv(request, NULL, &request_argv, NULL)) {
+                g_warning("Invalid zygote request: %s", request);
+                g_free(request);
+                close(conn);
+                continue;
+            }
+            g_free(request);
+
+            pid = fork();
+            if (pid == 0) {
+                GHashTableIter iter;
+                gpointer other;
+                gint null_fd;
+
+                /* drop everything the zygote had open */
+                g_hash_table_iter_init(&iter, children);
+                while (g_hash_table_iter_next(&iter, NULL, &other)) {
+                    close(GPOINTER_TO_INT(other));
+                }
+                close(conn);
+                close(listen_fd);
+                close(zygote_sigchld_pipe[0]);
+                close(zygote_sigchld_pipe[1]);
+                signal(SIGCHLD, SIG_DFL);
+                signal(SIGPIPE, SIG_DFL);
+
+                null_fd = open("/dev/null", O_RDONLY);
+                if (null_fd >= 0) {
+                    dup2(null_fd, STDIN_FILENO);
+                    close(null_fd);
+                }
+
+                zygote_apply_request(request_argv, argc, argv);
+                forked = TRUE;
+            } else if (pid < 0) {
+                g_warning("Unable to fork an applet: %s", g_strerror(errno));
+                close(conn);
+            } else {
+                gchar* line = g_strdup_printf("%d\n", pid);
+                zygote_send(conn, line);
+                g_free(line);
+                g_hash_table_insert(children, GINT_TO_POINTER(pid),
+                                    GINT_TO_POINTER(conn));
+            }
+            g_strfreev(request_argv);
+        }
+    }
+
+    g_hash_table_destroy(children);
+
+    if (!forked) {
+        gchar* dir = g_path_get_dirname(socket_path);
+
+        close(listen_fd);
+        g_unlink(socket_path);
+        g_rmdir(dir);
+        g_free(dir);
+    }
+
+    return forked;
+}
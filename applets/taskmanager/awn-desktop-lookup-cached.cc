@@ -27,6 +27,10 @@
 #include "awn-desktop-lookup-cached.h"
 #include "libawn/libawn.h"
 #include "util.h"
+#include "trigram-index.h"
+
+#include <sys/stat.h>
+#include <glib/gstdio.h>
 
 #undef G_DISABLE_SINGLE_INCLUDES
 #include <glibtop/procargs.h>
@@ -38,10 +42,23 @@ G_DEFINE_TYPE(AwnDesktopLookupCached, awn_desktop_lookup_cached, AWN_TYPE_DESKTO
 
 typedef struct _AwnDesktopLookupCachedPrivate AwnDesktopLookupCachedPrivate;
 
+/* ms of quiet on the applications dirs before pending changes are applied */
+#define DATA_DIR_CHANGED_DELAY 500
+
 typedef struct {
     gchar* path;
     gchar* exec;
     gchar* name;
+    /*keys into the lookup hashes.  Only valid as hash keys if the hash
+     maps them back to path*/
+    gchar* name_lwr;
+    gchar* desktop_name;
+    gchar* startup_wm;
+    time_t mtime;
+    glong mtime_nsec;
+    off_t size;
+    gboolean collision;     /*lost at least one key to another node*/
+    guint seq;              /*increases with the position in desktop_list*/
 } DesktopNode;
 
 struct _AwnDesktopLookupCachedPrivate {
@@ -49,8 +66,19 @@ struct _AwnDesktopLookupCachedPrivate {
     GHashTable* exec_hash;
     GHashTable* desktops_hash;     /*desktop file names, without paths*/
     GHashTable* startup_wm_hash;
+    GHashTable* path_hash;         /*full path -> DesktopNode*/
 
     GSList* desktop_list;   /*For when the fast lookups don't work*/
+    TrigramIndex* exec_index;   /*substring lookups into desktop_list*/
+    TrigramIndex* path_index;
+    guint next_seq;
+    gboolean no_index;      /*scan desktop_list instead, to compare with*/
+    GSList* shadowed;       /*paths dropped because of an exec collision*/
+
+    GHashTable* pending;    /*paths with monitor events not yet applied*/
+    guint pending_id;
+    gboolean released_keys;
+    gboolean populated;
 };
 
 static void
@@ -76,21 +104,231 @@ awn_desktop_lookup_cached_set_property(GObject* object, guint property_id,
 static void
 awn_desktop_lookup_cached_dispose(GObject* object)
 {
+    AwnDesktopLookupCachedPrivate* priv = GET_PRIVATE(object);
+
+    if (priv->pending_id) {
+        g_source_remove(priv->pending_id);
+        priv->pending_id = 0;
+    }
     G_OBJECT_CLASS(awn_desktop_lookup_cached_parent_class)->dispose(object);
 }
 
+static void desktop_node_free(DesktopNode* node);
+
 static void
 awn_desktop_lookup_cached_finalize(GObject* object)
 {
+    AwnDesktopLookupCachedPrivate* priv = GET_PRIVATE(object);
+
+    g_hash_table_destroy(priv->name_hash);
+    g_hash_table_destroy(priv->exec_hash);
+    g_hash_table_destroy(priv->desktops_hash);
+    g_hash_table_destroy(priv->startup_wm_hash);
+    g_hash_table_destroy(priv->path_hash);
+    g_hash_table_destroy(priv->pending);
+    trigram_index_free(priv->exec_index);
+    trigram_index_free(priv->path_index);
+    g_slist_foreach(priv->desktop_list, (GFunc)desktop_node_free, NULL);
+    g_slist_free(priv->desktop_list);
+    g_slist_foreach(priv->shadowed, (GFunc)g_free, NULL);
+    g_slist_free(priv->shadowed);
+
     G_OBJECT_CLASS(awn_desktop_lookup_cached_parent_class)->finalize(object);
 }
 
+static void
+desktop_node_free(DesktopNode* node)
+{
+    g_free(node->path);
+    g_free(node->exec);
+    g_free(node->name);
+    g_free(node->name_lwr);
+    g_free(node->desktop_name);
+    g_free(node->startup_wm);
+    g_free(node);
+}
+
+/*
+ The lookup hashes borrow their keys and values from the DesktopNode that
+ first claimed them.  A key is only inserted if nobody holds it yet, so the
+ value stored under a key always identifies the owning node's path.
+ */
+static gboolean
+_claim_key(GHashTable* hash, gchar* key, gchar* path)
+{
+    gchar* owner;
+
+    if (!key) {
+        return TRUE;
+    }
+    owner = g_hash_table_lookup(hash, key);
+    if (owner) {
+        return owner == path;
+    }
+    g_hash_table_insert(hash, key, path);
+    return TRUE;
+}
+
+static void
+_release_key(GHashTable* hash, const gchar* key, const gchar* path)
+{
+    if (key && g_hash_table_lookup(hash, key) == path) {
+        g_hash_table_remove(hash, key);
+    }
+}
+
+static void
+awn_desktop_lookup_cached_claim_keys(AwnDesktopLookupCachedPrivate* priv, DesktopNode* node)
+{
+    gboolean collision = FALSE;
+
+    /*Name collisions happen often enough (ex.  "Terminal" ).  Not a big deal,
+     we're relatively conservative in using name for matching purposes*/
+    collision |= !_claim_key(priv->name_hash, node->name_lwr, node->path);
+    collision |= !_claim_key(priv->desktops_hash, node->desktop_name, node->path);
+    if (!_claim_key(priv->startup_wm_hash, node->startup_wm, node->path)) {
+        if (!priv->populated) {
+            /*if we hit this then I'm interested in knowing about it*/
+            g_warning("%s: StartuWM Name (%s) collision between %s and %s", __func__,
+                      node->startup_wm,
+                      (gchar*)g_hash_table_lookup(priv->startup_wm_hash, node->startup_wm),
+                      node->path);
+        }
+        collision = TRUE;
+    }
+    node->collision = collision;
+}
+
+static void
+awn_desktop_lookup_cached_remove_node(AwnDesktopLookupCached* lookup, DesktopNode* node)
+{
+    AwnDesktopLookupCachedPrivate* priv = GET_PRIVATE(lookup);
+
+    _release_key(priv->name_hash, node->name_lwr, node->path);
+    _release_key(priv->exec_hash, node->exec, node->path);
+    _release_key(priv->desktops_hash, node->desktop_name, node->path);
+    _release_key(priv->startup_wm_hash, node->startup_wm, node->path);
+    g_hash_table_remove(priv->path_hash, node->path);
+    trigram_index_remove(priv->exec_index, node->exec, node);
+    trigram_index_remove(priv->path_index, node->path, node);
+    priv->desktop_list = g_slist_remove(priv->desktop_list, node);
+    desktop_node_free(node);
+    priv->released_keys = TRUE;
+}
+
+static void
+awn_desktop_lookup_cached_add_file(AwnDesktopLookupCached* lookup, const gchar* path)
+{
+    AwnDesktopLookupCachedPrivate* priv = GET_PRIVATE(lookup);
+    DesktopAgnosticFDODesktopEntry* entry = NULL;
+    DesktopAgnosticVFSFile* file;
+    DesktopNode* node;
+    struct stat st;
+    gchar* fname;
+
+    if (!g_strstr_len(path, -1, ".desktop")) {
+        return;
+    }
+    node = g_hash_table_lookup(priv->path_hash, path);
+    if (g_stat(path, &st) != 0) {
+        if (node) {
+            awn_desktop_lookup_cached_remove_node(lookup, node);
+        }
+        return;
+    }
+    if (node) {
+        /*a second is too coarse to tell edits apart, compare the size too*/
+        if (node->mtime == st.st_mtime && node->mtime_nsec == st.st_mtim.tv_nsec
+                && node->size == st.st_size) {
+            /*refresh of a directory we already know about*/
+            return;
+        }
+        awn_desktop_lookup_cached_remove_node(lookup, node);
+    }
+
+    file = desktop_agnostic_vfs_file_new_for_path(path, NULL);
+    if (!file) {
+        return;
+    }
+    if (!desktop_agnostic_vfs_file_exists(file)) {
+        goto CLEANUP;
+    }
+    fname = g_path_get_basename(path);
+    entry = desktop_agnostic_fdo_desktop_entry_new_for_file(file, NULL);
+    if (entry && desktop_agnostic_fdo_desktop_entry_key_exists(entry, "NoDisplay")) {
+        if (desktop_agnostic_fdo_desktop_entry_get_boolean(entry, "NoDisplay")) {
+            if (!check_no_display_override(fname)) {
+                g_free(fname);
+                goto CLEANUP;
+            }
+        }
+    }
+    if (entry && desktop_agnostic_fdo_desktop_entry_key_exists(entry, "Name")
+            &&
+            desktop_agnostic_fdo_desktop_entry_key_exists(entry, "Exec")) {
+        gchar* exec = desktop_agnostic_fdo_desktop_entry_get_string(entry, "Exec");
+
+        g_strdelimit(exec, "%", '\0');
+        g_strstrip(exec);
+
+        if (exec && g_hash_table_lookup(priv->exec_hash, exec)) {
+            /* More or less a duplicate of an existing desktop.  Remember it so
+             it can take over if the owner of the exec key goes away.*/
+            if (!g_slist_find_custom(priv->shadowed, path, (GCompareFunc)g_strcmp0)) {
+                priv->shadowed = g_slist_prepend(priv->shadowed, g_strdup(path));
+            }
+            g_free(exec);
+            g_free(fname);
+            goto CLEANUP;
+        }
+
+        node = g_new0(DesktopNode, 1);
+        node->path = g_strdup(path);
+        node->exec = exec;
+        node->name = _desktop_entry_get_localized_name(entry);
+        node->name_lwr = node->name ? g_utf8_strdown(node->name, -1) : NULL;
+        node->desktop_name = fname;
+        node->mtime = st.st_mtime;
+        node->mtime_nsec = st.st_mtim.tv_nsec;
+        node->size = st.st_size;
+        fname = NULL;
+        if (desktop_agnostic_fdo_desktop_entry_key_exists(entry, "StartupWMClass")) {
+            node->startup_wm = desktop_agnostic_fdo_desktop_entry_get_string(entry, "StartupWMClass");
+            if (g_strcmp0(node->startup_wm, "Wine") == 0) {
+                g_free(node->startup_wm);
+                node->startup_wm = NULL;
+            }
+        }
+        _claim_key(priv->exec_hash, node->exec, node->path);
+        awn_desktop_lookup_cached_claim_keys(priv, node);
+        g_hash_table_insert(priv->path_hash, node->path, node);
+        trigram_index_insert(priv->exec_index, node->exec, node);
+        trigram_index_insert(priv->path_index, node->path, node);
+        /*
+         During the initial scan entries are prepended and the list reversed
+         once everything is in.  Later additions go to the back, behind the
+         data dirs that were scanned first.
+         */
+        node->seq = priv->next_seq++;
+        if (priv->populated) {
+            priv->desktop_list = g_slist_append(priv->desktop_list, node);
+        } else {
+            priv->desktop_list = g_slist_prepend(priv->desktop_list, node);
+        }
+    }
+    g_free(fname);
+CLEANUP:
+    if (entry) {
+        g_object_unref(entry);
+    }
+    g_object_unref(file);
+}
+
 static void
 awn_desktop_lookup_cached_add_dir(AwnDesktopLookupCached* lookup, const gchar* applications_dir)
 {
     GDir*         dir = NULL;
     const gchar* fname = NULL;
-    AwnDesktopLookupCachedPrivate* priv = GET_PRIVATE(lookup);
     static int call_depth = 0;
 
     call_depth ++;
@@ -98,107 +336,16 @@ awn_desktop_lookup_cached_add_dir(AwnDesktopLookupCached* lookup, const gchar* a
         g_debug("%s: resursive depth = %d.  bailing at %s", __func__, call_depth, applications_dir);
     }
     dir = g_dir_open(applications_dir, 0, NULL);
+    if (!dir) {
+        call_depth --;
+        return;
+    }
     while ((fname = g_dir_read_name(dir))) {
-        gchar* new_path = g_strdup_printf("%s/%s", applications_dir, fname);
+        gchar* new_path = g_build_filename(applications_dir, fname, NULL);
         if (g_file_test(new_path, G_FILE_TEST_IS_DIR)) {
             awn_desktop_lookup_cached_add_dir(lookup, new_path);
         } else {
-            DesktopAgnosticFDODesktopEntry* entry = NULL;
-            DesktopAgnosticVFSFile* file;
-            file = desktop_agnostic_vfs_file_new_for_path(new_path, NULL);
-            if (file) {
-                if (desktop_agnostic_vfs_file_exists(file) && g_strstr_len(new_path, -1, ".desktop")) {
-                    entry = desktop_agnostic_fdo_desktop_entry_new_for_file(file, NULL);
-                    if (entry && desktop_agnostic_fdo_desktop_entry_key_exists(entry, "NoDisplay")) {
-                        if (desktop_agnostic_fdo_desktop_entry_get_boolean(entry, "NoDisplay")) {
-                            if (!check_no_display_override(fname)) {
-                                goto NO_DISPLAY;
-                            }
-                        }
-                    }
-                    if (entry && desktop_agnostic_fdo_desktop_entry_key_exists(entry, "Name")
-                            &&
-                            desktop_agnostic_fdo_desktop_entry_key_exists(entry, "Exec")) {
-                        /*
-                         Be careful.  Not duplicating these strings for each data structure
-                         */
-                        gchar* name = _desktop_entry_get_localized_name(entry);
-                        gchar* exec = desktop_agnostic_fdo_desktop_entry_get_string(entry, "Exec");
-                        gchar* copy_path = NULL;
-                        gchar* search = NULL;
-                        gchar* name_lwr = g_utf8_strdown(name, -1);
-                        gchar* startup_wm = NULL;
-                        gchar* desktop_name = g_strdup(fname);
-                        DesktopNode* node;
-
-                        g_strdelimit(exec, "%", '\0');
-                        g_strstrip(exec);
-
-                        if (name_lwr && (search = g_hash_table_lookup(priv->name_hash, name_lwr))) {
-//              g_warning ("%s: Name (%s) collision between %s and %s",__func__,name,search,new_path);
-                            g_free(name_lwr);
-                            name_lwr = NULL;
-                        }
-
-                        if (exec && (search = g_hash_table_lookup(priv->exec_hash, exec))) {
-                            /* This gets hit when we refresh the list due to an new installations etc.
-                             If we hit this then it's more or less a duplicate of an existing desktop
-                             or we have a refresh for some reason.  Either way we ignore it.*/
-//              g_warning ("%s: Exec Name (%s) collision between %s and %s",__func__,exec,search,new_path);
-                            g_free(name);
-                            g_free(name_lwr);
-                            g_free(exec);
-                            g_free(desktop_name);
-                            goto NAME_COLLSION;
-                        }
-
-                        if (desktop_name && (search = g_hash_table_lookup(priv->desktops_hash, desktop_name))) {
-                            /*Happens often enough (ex.  "Terminal" ).  Not a big deal, we're
-                             relatively conservative in using name for matching purposes*/
-                            g_free(desktop_name);
-                            desktop_name = NULL;
-                        }
-
-                        if (desktop_agnostic_fdo_desktop_entry_key_exists(entry, "StartupWMClass")) {
-                            startup_wm = desktop_agnostic_fdo_desktop_entry_get_string(entry, "StartupWMClass");
-                            search = g_hash_table_lookup(priv->startup_wm_hash, startup_wm);
-                            if (g_strcmp0(startup_wm, "Wine") == 0) {
-                                g_free(startup_wm);
-                                startup_wm = NULL;
-                            } else if (search) {
-                                /*if we hit this then I'm interested in knowing about it*/
-                                g_warning("%s: StartuWM Name (%s) collision between %s and %s", __func__, startup_wm, search, new_path);
-                                g_free(startup_wm);
-                                startup_wm = NULL;
-                            }
-                        }
-                        copy_path = g_strdup(new_path);
-                        if (name_lwr) {
-                            g_hash_table_insert(priv->name_hash, name_lwr, copy_path);
-                        }
-                        if (exec) {
-                            g_hash_table_insert(priv->exec_hash, exec, copy_path);
-                        }
-                        if (desktop_name) {
-                            g_hash_table_insert(priv->desktops_hash, desktop_name, copy_path);
-                        }
-                        if (startup_wm) {
-                            g_hash_table_insert(priv->startup_wm_hash, startup_wm, copy_path);
-                        }
-                        node = g_malloc(sizeof(DesktopNode));
-                        node->path = copy_path;
-                        node->name = name;
-                        node->exec = exec;
-                        priv->desktop_list = g_slist_prepend(priv->desktop_list, node);
-                    }
-NO_DISPLAY:
-NAME_COLLSION:
-                    if (entry) {
-                        g_object_unref(entry);
-                    }
-                }
-                g_object_unref(file);
-            }
+            awn_desktop_lookup_cached_add_file(lookup, new_path);
         }
         g_free(new_path);
     }
@@ -206,6 +353,79 @@ NAME_COLLSION:
     call_depth --;
 }
 
+/*
+ Drops every node living under a directory that has gone away.
+ */
+static void
+awn_desktop_lookup_cached_remove_dir(AwnDesktopLookupCached* lookup, const gchar* dir_path)
+{
+    AwnDesktopLookupCachedPrivate* priv = GET_PRIVATE(lookup);
+    gchar* prefix = g_str_has_suffix(dir_path, G_DIR_SEPARATOR_S) ?
+                    g_strdup(dir_path) : g_strconcat(dir_path, G_DIR_SEPARATOR_S, NULL);
+    GSList* iter = priv->desktop_list;
+
+    while (iter) {
+        DesktopNode* node = iter->data;
+        iter = iter->next;
+        if (g_str_has_prefix(node->path, prefix)) {
+            awn_desktop_lookup_cached_remove_node(lookup, node);
+        }
+    }
+    g_free(prefix);
+}
+
+static gboolean
+_process_pending(AwnDesktopLookupCached* lookup)
+{
+    AwnDesktopLookupCachedPrivate* priv = GET_PRIVATE(lookup);
+    GHashTableIter iter;
+    gpointer key;
+
+    priv->pending_id = 0;
+    priv->released_keys = FALSE;
+
+    g_hash_table_iter_init(&iter, priv->pending);
+    while (g_hash_table_iter_next(&iter, &key, NULL)) {
+        const gchar* path = key;
+        if (g_file_test(path, G_FILE_TEST_IS_DIR)) {
+            awn_desktop_lookup_cached_add_dir(lookup, path);
+        } else if (g_file_test(path, G_FILE_TEST_EXISTS)) {
+            awn_desktop_lookup_cached_add_file(lookup, path);
+        } else {
+            DesktopNode* node = g_hash_table_lookup(priv->path_hash, path);
+            if (node) {
+                awn_desktop_lookup_cached_remove_node(lookup, node);
+            } else {
+                awn_desktop_lookup_cached_remove_dir(lookup, path);
+            }
+        }
+    }
+    g_hash_table_remove_all(priv->pending);
+
+    if (priv->released_keys) {
+        /*
+         Keys freed up by removed/updated entries go to the first remaining
+         node that wanted them, in list order, same as a full rescan would do.
+         Entries that were dropped outright for an exec collision get parsed
+         again.
+         */
+        GSList* shadowed = priv->shadowed;
+        priv->shadowed = NULL;
+        for (GSList* l = priv->desktop_list; l; l = l->next) {
+            DesktopNode* node = l->data;
+            if (node->collision) {
+                awn_desktop_lookup_cached_claim_keys(priv, node);
+            }
+        }
+        for (GSList* l = shadowed; l; l = l->next) {
+            awn_desktop_lookup_cached_add_file(lookup, l->data);
+        }
+        g_slist_foreach(shadowed, (GFunc)g_free, NULL);
+        g_slist_free(shadowed);
+    }
+    return FALSE;
+}
+
 static void
 _data_dir_changed(DesktopAgnosticVFSFileMonitor* monitor,
                   DesktopAgnosticVFSFile* self,
@@ -214,10 +434,22 @@ _data_dir_changed(DesktopAgnosticVFSFileMonitor* monitor,
                   AwnDesktopLookupCached* lookup
                  )
 {
+    AwnDesktopLookupCachedPrivate* priv = GET_PRIVATE(lookup);
     gchar* path = desktop_agnostic_vfs_file_get_path(self);
-    if (g_file_test(path, G_FILE_TEST_IS_DIR)) {
-        awn_desktop_lookup_cached_add_dir(lookup, path);
+
+    if (!path) {
+        return;
     }
+    /*
+     Package managers tend to write files in bursts.  Collect the paths and
+     only process them once things have been quiet for a moment.
+     */
+    g_hash_table_insert(priv->pending, path, NULL);
+    if (priv->pending_id) {
+        g_source_remove(priv->pending_id);
+    }
+    priv->pending_id = g_timeout_add(DATA_DIR_CHANGED_DELAY,
+                                     (GSourceFunc)_process_pending, lookup);
 }
 
 static void
@@ -271,6 +503,7 @@ awn_desktop_lookup_cached_constructed(GObject* object)
      are looking for
      */
     priv->desktop_list = g_slist_reverse(priv->desktop_list);
+    priv->populated = TRUE;
 }
 
 static void
@@ -292,23 +525,21 @@ awn_desktop_lookup_cached_init(AwnDesktopLookupCached* self)
 {
     AwnDesktopLookupCachedPrivate* priv = GET_PRIVATE(self);
 
-    priv->name_hash = g_hash_table_new_full(g_str_hash,
-                                            g_str_equal,
-                                            g_free,
-                                            NULL);
-    priv->exec_hash = g_hash_table_new_full(g_str_hash,
-                                            g_str_equal,
-                                            g_free,
-                                            NULL);
-    priv->desktops_hash = g_hash_table_new_full(g_str_hash,
-                          g_str_equal,
-                          g_free,
-                          NULL);
-    priv->startup_wm_hash = g_hash_table_new_full(g_str_hash,
-                            g_str_equal,
-                            g_free,
-                            NULL);
+    /*keys and values are owned by the DesktopNodes in desktop_list*/
+    priv->name_hash = g_hash_table_new(g_str_hash, g_str_equal);
+    priv->exec_hash = g_hash_table_new(g_str_hash, g_str_equal);
+    priv->desktops_hash = g_hash_table_new(g_str_hash, g_str_equal);
+    priv->startup_wm_hash = g_hash_table_new(g_str_hash, g_str_equal);
+    priv->path_hash = g_hash_table_new(g_str_hash, g_str_equal);
+    priv->pending = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    priv->exec_index = trigram_index_new();
+    priv->path_index = trigram_index_new();
     priv->desktop_list = NULL;
+    priv->shadowed = NULL;
+    priv->pending_id = 0;
+    priv->populated = FALSE;
+    priv->no_index = g_getenv("AWN_DESKTOP_LOOKUP_NO_INDEX") != NULL;
+    priv->next_seq = 0;
 }
 
 AwnDesktopLookupCached*
@@ -383,11 +614,78 @@ _search_path_base_cmp(DesktopNode* a, gchar* b)
     return result;
 }
 
-const gchar*
+/*
+ Index backed replacement for g_slist_find_custom (priv->desktop_list, ...).
+ Only nodes sharing the trigrams of key can satisfy cmp, and of those the one
+ closest to the head of desktop_list wins, same as the linear search (which
+ is still done with AWN_DESKTOP_LOOKUP_NO_INDEX set).
+ */
+static DesktopNode*
+_index_find_first(AwnDesktopLookupCachedPrivate* priv, TrigramIndex* index,
+                  const gchar* key, gchar* needle, GCompareFunc cmp)
+{
+    const GPtrArray* candidates;
+    DesktopNode* best = NULL;
+
+    if (priv->no_index) {
+        GSList* l = g_slist_find_custom(priv->desktop_list, needle, cmp);
+        return l ? (DesktopNode*)l->data : NULL;
+    }
+    candidates = trigram_index_lookup(index, key);
+    if (!candidates) {
+        return NULL;
+    }
+    for (guint i = 0; i < candidates->len; i++) {
+        DesktopNode* node = g_ptr_array_index(candidates, i);
+        if ((!best || node->seq < best->seq) && cmp(node, needle) == 0) {
+            best = node;
+        }
+    }
+    return best;
+}
+
+/*
+ Returns the path of the desktop file of win, or NULL.  The caller frees
+ it; the node it comes from can go away with the next pending rebuild.
+ */
+gchar*
 awn_desktop_lookup_search_by_wnck_window(AwnDesktopLookupCached* lookup, WnckWindow* win)
 {
-    /*TODO
-     search through the wnck window list for the xid then call ^*/
+    gchar* res_name = NULL;
+    gchar* class_name = NULL;
+    gchar* full_cmd = NULL;
+    gchar* cmd = NULL;
+    gchar* result;
+    glibtop_proc_args buf;
+
+    _wnck_get_wmclass(wnck_window_get_xid(win), &res_name, &class_name);
+    cmd = glibtop_get_proc_args(&buf, wnck_window_get_pid(win), 1024);
+    full_cmd = get_full_cmd_from_pid(wnck_window_get_pid(win));
+    if (full_cmd) {
+        g_strstrip(full_cmd);
+    }
+    result = awn_desktop_lookup_search_by_window_data(lookup, res_name, class_name,
+             cmd, full_cmd,
+             wnck_window_get_name(win));
+    g_free(full_cmd);
+    g_free(cmd);
+    g_free(res_name);
+    g_free(class_name);
+    return result;
+}
+
+/*
+ The lookup behind awn_desktop_lookup_search_by_wnck_window(), given what
+ it read from the window.  Any of the strings can be NULL.
+ */
+gchar*
+awn_desktop_lookup_search_by_window_data(AwnDesktopLookupCached* lookup,
+        const gchar* res_name,
+        const gchar* class_name,
+        const gchar* cmd,
+        const gchar* full_cmd,
+        const gchar* title)
+{
     const gchar* extensions[] = {".exe", ".EXE",
                                  "-bin", "-BIN",
                                  ".bin", ".BIN",
@@ -395,24 +693,15 @@ awn_desktop_lookup_search_by_wnck_window(AwnDesktopLookupCached* lookup, WnckWin
                                 };
     const gchar* result = NULL;
     AwnDesktopLookupCachedPrivate* priv = GET_PRIVATE(lookup);
-    gchar* res_name = NULL;
-    gchar* class_name = NULL;
     gchar* res_name_lwr = NULL;
     gchar* class_name_lwr = NULL;
     gchar* res_name_no_ext = NULL;
     gchar* class_name_no_ext = NULL;
     gchar* res_name_no_ext_lwr = NULL;
-    gchar* full_cmd = NULL;
-    gchar* cmd = NULL;
     gchar* cmd_basename = NULL;
-    glibtop_proc_args buf;
-    gulong xid = wnck_window_get_xid(win);
-    GSList* l = NULL;
-    const gchar* title;
+    DesktopNode* node = NULL;
     gint  hit_method = 0;
 
-    title = wnck_window_get_name(win);
-    _wnck_get_wmclass(xid, &res_name, &class_name);
     if (res_name) {
         res_name_lwr =  g_utf8_strdown(res_name, -1);
     }
@@ -443,30 +732,24 @@ awn_desktop_lookup_search_by_wnck_window(AwnDesktopLookupCached* lookup, WnckWin
     if (class_name) {
         class_name_lwr = g_utf8_strdown(class_name, -1);
     }
-    cmd = glibtop_get_proc_args(&buf, wnck_window_get_pid(win), 1024);
-    full_cmd = get_full_cmd_from_pid(wnck_window_get_pid(win));
-    if (full_cmd) {
-        g_strstrip(full_cmd);
-    }
     if (cmd) {
         cmd_basename = g_path_get_basename(cmd);
     }
     /* Checked the special cased data*/
     if (!result) {
-        GSList* desktops = get_special_desktop_from_window_data(full_cmd,
-                           res_name,
-                           class_name,
-                           title);
+        GSList* desktops = get_special_desktop_from_window_data((gchar*)full_cmd,
+                           (gchar*)res_name,
+                           (gchar*)class_name,
+                           (gchar*)title);
         if (desktops) {
             GSList* iter;
             for (iter = desktops; iter; iter = iter->next) {
                 gchar* build_name = g_strdup_printf("%s.desktop", (gchar*)iter->data);
-                l = g_slist_find_custom(priv->desktop_list,
-                                        build_name,
-                                        (GCompareFunc)_search_path_base_cmp);
+                node = _index_find_first(priv, priv->path_index, build_name, build_name,
+                                         (GCompareFunc)_search_path_base_cmp);
                 g_free(build_name);
-                if (l) {
-                    result = ((DesktopNode*)(l->data))->path;
+                if (node) {
+                    result = node->path;
                     break;
                 }
             }
@@ -476,20 +759,19 @@ awn_desktop_lookup_search_by_wnck_window(AwnDesktopLookupCached* lookup, WnckWin
     }
     result = result ? (g_file_test(result, G_FILE_TEST_EXISTS) ? result : NULL) : NULL;
     if (!result) {
-        GSList* desktops = get_special_desktop_from_window_data(cmd,
-                           res_name,
-                           class_name,
-                           title);
+        GSList* desktops = get_special_desktop_from_window_data((gchar*)cmd,
+                           (gchar*)res_name,
+                           (gchar*)class_name,
+                           (gchar*)title);
         if (desktops) {
             GSList* iter;
             for (iter = desktops; iter; iter = iter->next) {
                 gchar* build_name = g_strdup_printf("%s.desktop", (gchar*)iter->data);
-                l = g_slist_find_custom(priv->desktop_list,
-                                        build_name,
-                                        (GCompareFunc)_search_path_base_cmp);
+                node = _index_find_first(priv, priv->path_index, build_name, build_name,
+                                         (GCompareFunc)_search_path_base_cmp);
                 g_free(build_name);
-                if (l) {
-                    result = ((DesktopNode*)(l->data))->path;
+                if (node) {
+                    result = node->path;
                     break;
                 }
             }
@@ -606,11 +888,14 @@ awn_desktop_lookup_search_by_wnck_window(AwnDesktopLookupCached* lookup, WnckWin
 
     if (!result) {
         if (full_cmd) {
-            l = g_slist_find_custom(priv->desktop_list,
-                                    full_cmd,
-                                    (GCompareFunc)_search_exec);
-            if (l) {
-                result = ((DesktopNode*)(l->data))->path;
+            /*_search_exec matches when one is a prefix of the other, so any
+             hit shares the first three bytes of full_cmd*/
+            gchar* head = g_strndup(full_cmd, 3);
+            node = _index_find_first(priv, priv->exec_index, head, (gchar*)full_cmd,
+                                     (GCompareFunc)_search_exec);
+            g_free(head);
+            if (node) {
+                result = node->path;
             }
         }
         hit_method ++;
@@ -619,16 +904,31 @@ awn_desktop_lookup_search_by_wnck_window(AwnDesktopLookupCached* lookup, WnckWin
 
     if (!result) {
         if (full_cmd) {
-            l = g_slist_find_custom(priv->desktop_list, full_cmd, (GCompareFunc)_search_exec_sub);
-            while (l) {
-                if (g_strstr_len(title, -1, ((DesktopNode*)(l->data))->name)) {
-                    result = ((DesktopNode*)(l->data))->path;
+            /*the last matching node in list order whose name is in the title*/
+            const GPtrArray* candidates = NULL;
+            node = NULL;
+            if (priv->no_index) {
+                for (GSList* l = priv->desktop_list; l; l = l->next) {
+                    DesktopNode* candidate = (DesktopNode*)l->data;
+                    if (_search_exec_sub(candidate, (gchar*)full_cmd) == 0
+                            && title && g_strstr_len(title, -1, candidate->name)) {
+                        node = candidate;
+                    }
                 }
-                l = l->next;
-                if (l) {
-                    l = g_slist_find_custom(l, full_cmd, (GCompareFunc)_search_exec_sub);
+            } else {
+                candidates = trigram_index_lookup(priv->exec_index, full_cmd);
+            }
+            for (guint i = 0; candidates && i < candidates->len; i++) {
+                DesktopNode* candidate = g_ptr_array_index(candidates, i);
+                if ((!node || candidate->seq > node->seq)
+                        && _search_exec_sub(candidate, (gchar*)full_cmd) == 0
+                        && title && g_strstr_len(title, -1, candidate->name)) {
+                    node = candidate;
                 }
             }
+            if (node) {
+                result = node->path;
+            }
         }
         hit_method ++;
     }
@@ -636,11 +936,10 @@ awn_desktop_lookup_search_by_wnck_window(AwnDesktopLookupCached* lookup, WnckWin
 
     if (!result) {
         if (full_cmd) {
-            l = g_slist_find_custom(priv->desktop_list,
-                                    full_cmd,
-                                    (GCompareFunc)_search_exec_sub);
-            if (l) {
-                result = ((DesktopNode*)(l->data))->path;
+            node = _index_find_first(priv, priv->exec_index, full_cmd, (gchar*)full_cmd,
+                                     (GCompareFunc)_search_exec_sub);
+            if (node) {
+                result = node->path;
             }
         }
         hit_method ++;
@@ -650,12 +949,11 @@ awn_desktop_lookup_search_by_wnck_window(AwnDesktopLookupCached* lookup, WnckWin
     if (!result) {
         if (cmd) {
             gchar* d_filename = g_strdup_printf("%s.desktop", cmd);
-            l = g_slist_find_custom(priv->desktop_list,
-                                    d_filename,
-                                    (GCompareFunc)_search_path);
+            node = _index_find_first(priv, priv->path_index, d_filename, d_filename,
+                                     (GCompareFunc)_search_path);
             g_free(d_filename);
-            if (l) {
-                result = ((DesktopNode*)(l->data))->path;
+            if (node) {
+                result = node->path;
             }
         }
         hit_method ++;
@@ -706,15 +1004,11 @@ awn_desktop_lookup_search_by_wnck_window(AwnDesktopLookupCached* lookup, WnckWin
         g_message("%s: Hit method = %d", __func__, hit_method);
     }
 #endif
-    g_free(full_cmd);
-    g_free(cmd);
     g_free(cmd_basename);
-    g_free(res_name);
-    g_free(class_name);
     g_free(res_name_lwr);
     g_free(class_name_lwr);
     g_free(res_name_no_ext);
     g_free(class_name_no_ext);
     g_free(res_name_no_ext_lwr);
-    return result;
+    return g_strdup(result);
 }
@@ -57,7 +57,15 @@ GType awn_desktop_lookup_cached_get_type(void);
 
 AwnDesktopLookupCached* awn_desktop_lookup_cached_new(void);
 
-const gchar* awn_desktop_lookup_search_by_wnck_window(AwnDesktopLookupCached* lookup, WnckWindow* win);
+/* Free the result with g_free() */
+gchar* awn_desktop_lookup_search_by_wnck_window(AwnDesktopLookupCached* lookup, WnckWindow* win);
+
+gchar* awn_desktop_lookup_search_by_window_data(AwnDesktopLookupCached* lookup,
+        const gchar* res_name,
+        const gchar* class_name,
+        const gchar* cmd,
+        const gchar* full_cmd,
+        const gchar* title);
 
 #endif /* _AWN_DESKTOP_LOOKUP_CACHED */
 
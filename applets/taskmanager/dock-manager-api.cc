@@ -37,6 +37,7 @@
 #include <task-item.h>
 #include "dock-manager-api.h"
 #include <libawn/vala-utils.h>
+#include <libawn/awn-pixbuf-cache.h>
 #include <string>
 
 typedef struct _DBusObjectVTable _DBusObjectVTable;
@@ -74,9 +75,26 @@ struct _TaskManagerDispatcherPrivate {
 };
 
 
+/*
+ UpdateDockItem hints are collected per key and applied at most once per
+ frame, so clients flooding progress updates don't redraw the icon for every
+ call.
+ */
+#define UPDATE_DOCK_ITEM_INTERVAL 40
+
 struct _TaskIconDispatcherPrivate {
     TaskIcon* icon;
     gchar* _object_path;
+
+    GHashTable* pending_hints;  /* key -> GValue*, latest value wins */
+    GHashTable* flushed_hints;  /* the last batch applied, see AwnLastFlush */
+    guint update_id;
+
+    /* UpdateDockItem statistics, see AwnUpdateStats */
+    guint hints_received;
+    guint hints_coalesced;
+    guint hints_dropped;
+    guint hints_flushes;
 };
 
 struct _Block1Data {
@@ -165,9 +183,80 @@ const gchar* task_icon_dispatcher_get_object_path(TaskIconDispatcher* self);
 static gchar** task_manager_dispatcher_real_get_capabilities(DockManagerDBusInterface* base, int* result_length1, GError** error);
 static char** task_manager_dispatcher_real_get_items(DockManagerDBusInterface* base, int* result_length1, GError** error);
 TaskManager* task_manager_dispatcher_get_manager(TaskManagerDispatcher* self);
-static char** task_manager_dispatcher_real_get_items_by_name(DockManagerDBusInterface* base, const gchar* name, int* result_length1, GError** error);
-static char** task_manager_dispatcher_real_get_items_by_desktop_file(DockManagerDBusInterface* base, const gchar* desktop_file, int* result_length1, GError** error);
-static char** task_manager_dispatcher_real_get_items_by_pid(DockManagerDBusInterface* base, gint pid, int* result_length1, GError** error);
+/*
+ Object paths of the icons in one of the TaskIconIndex sets, optionally
+ filtered, in panel order.  No intermediate list is built.
+ */
+static char** task_manager_dispatcher_set_to_object_path_array(TaskManager* manager, GHashTable* set, gboolean (*filter)(TaskIcon* icon, gconstpointer data), gconstpointer data, int* result_length1)
+{
+    char** result = g_new0(char*, (set ? g_hash_table_size(set) : 0) + 1);
+    int i = 0;
+
+    if (set) {
+        for (GSList* icon_it = task_manager_get_icons(manager); icon_it != NULL; icon_it = icon_it->next) {
+            TaskIcon* icon = (TaskIcon*) icon_it->data;
+            if (!g_hash_table_lookup(set, icon)) {
+                continue;
+            }
+            if (filter && !filter(icon, data)) {
+                continue;
+            }
+            GObject* tmp = task_icon_get_dbus_dispatcher(icon);
+            TaskIconDispatcher* dispatcher = IS_TASK_ICON_DISPATCHER(tmp) ? ((TaskIconDispatcher*) tmp) : NULL;
+            if (dispatcher == NULL) {
+                continue;
+            }
+            result[i++] = g_strdup(task_icon_dispatcher_get_object_path(dispatcher));
+        }
+    }
+    if (result_length1) {
+        *result_length1 = i;
+    }
+    return result;
+}
+
+
+static char** task_manager_dispatcher_real_get_items_by_name(DockManagerDBusInterface* base, const gchar* name, int* result_length1, GError** error)
+{
+    TaskManagerDispatcher* self = (TaskManagerDispatcher*) base;
+    g_return_val_if_fail(name != NULL, NULL);
+
+    /* task_window_matches_wmclass() never matches Wine */
+    GHashTable* set = g_strcmp0(name, "Wine") == 0 ? NULL :
+                      task_icon_index_lookup_wmclass(task_manager_get_icon_index(self->priv->_manager), name);
+    return task_manager_dispatcher_set_to_object_path_array(self->priv->_manager, set, NULL, NULL, result_length1);
+}
+
+
+static gboolean _launcher_has_suffix(TaskIcon* icon, gconstpointer desktop_file)
+{
+    TaskItem* item = task_icon_get_launcher(icon);
+    TaskLauncher* launcher = TASK_IS_LAUNCHER(item) ? ((TaskLauncher*) item) : NULL;
+
+    return launcher != NULL &&
+           g_str_has_suffix(task_launcher_get_desktop_path(launcher), (const gchar*) desktop_file);
+}
+
+
+static char** task_manager_dispatcher_real_get_items_by_desktop_file(DockManagerDBusInterface* base, const gchar* desktop_file, int* result_length1, GError** error)
+{
+    TaskManagerDispatcher* self = (TaskManagerDispatcher*) base;
+    g_return_val_if_fail(desktop_file != NULL, NULL);
+
+    GHashTable* set = task_icon_index_lookup_desktop(task_manager_get_icon_index(self->priv->_manager), desktop_file);
+    return task_manager_dispatcher_set_to_object_path_array(self->priv->_manager, set, _launcher_has_suffix, desktop_file, result_length1);
+}
+
+
+static char** task_manager_dispatcher_real_get_items_by_pid(DockManagerDBusInterface* base, gint pid, int* result_length1, GError** error)
+{
+    TaskManagerDispatcher* self = (TaskManagerDispatcher*) base;
+
+    GHashTable* set = task_icon_index_lookup_pid(task_manager_get_icon_index(self->priv->_manager), pid);
+    return task_manager_dispatcher_set_to_object_path_array(self->priv->_manager, set, NULL, NULL, result_length1);
+}
+
+
 static char* task_manager_dispatcher_real_get_item_by_xid(DockManagerDBusInterface* base, gint64 xid, GError** error);
 static void task_manager_dispatcher_real_awn_set_visibility(DockManagerDBusInterface* base, const gchar* win_name, gboolean visible, GError** error);
 static void _g_free0_(gpointer var);
@@ -2089,157 +2178,6 @@ static char** task_manager_dispatcher_real_get_items(DockManagerDBusInterface* b
 }
 
 
-static char** task_manager_dispatcher_real_get_items_by_name(DockManagerDBusInterface* base, const gchar* name, int* result_length1, GError** error)
-{
-    TaskManagerDispatcher* self = (TaskManagerDispatcher*) base;
-    GSList* matches = nullptr;
-    g_return_val_if_fail(name != NULL, NULL);
-    GSList* icons = task_manager_get_icons(self->priv->_manager);
-    {
-        GSList* icon_collection;
-        GSList* icon_it;
-        icon_collection = icons;
-        for (icon_it = icon_collection; icon_it != NULL; icon_it = icon_it->next) {
-            TaskIcon* icon;
-            icon = (TaskIcon*) icon_it->data;
-            {
-                GSList* _tmp1_ = NULL;
-                _tmp1_ = task_icon_get_items(icon);
-                {
-                    GSList* item_collection;
-                    GSList* item_it;
-                    item_collection = _tmp1_;
-                    for (item_it = item_collection; item_it != NULL; item_it = item_it->next) {
-                        TaskItem* item;
-                        item = (TaskItem*) item_it->data;
-                        {
-                            TaskItem* _tmp2_;
-                            TaskWindow* window;
-                            _tmp2_ = item;
-                            window = TASK_IS_WINDOW(_tmp2_) ? ((TaskWindow*) _tmp2_) : NULL;
-                            if (window != NULL) {
-                                gboolean _tmp3_;
-                                _tmp3_ = task_window_matches_wmclass(window, name);
-                                if (_tmp3_) {
-                                    matches = g_slist_append(matches, icon);
-                                    break;
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    }
-    int res_len;
-    char** result = task_manager_dispatcher_list_to_object_path_array(matches, &res_len);
-    if (result_length1) {
-        *result_length1 = res_len;
-    }
-    _g_slist_free0(matches);
-    return result;
-}
-
-
-static char** task_manager_dispatcher_real_get_items_by_desktop_file(DockManagerDBusInterface* base, const gchar* desktop_file, int* result_length1, GError** error)
-{
-    TaskManagerDispatcher* self = (TaskManagerDispatcher*) base;
-    char** result = NULL;
-    GSList* _tmp0_ = NULL;
-    GSList* icons;
-    GSList* matches;
-    gint _tmp5_;
-    char** _tmp6_ = NULL;
-    char** _tmp7_;
-    g_return_val_if_fail(desktop_file != NULL, NULL);
-    _tmp0_ = task_manager_get_icons(self->priv->_manager);
-    icons = _tmp0_;
-    matches = NULL;
-    {
-        GSList* icon_collection;
-        GSList* icon_it;
-        icon_collection = icons;
-        for (icon_it = icon_collection; icon_it != NULL; icon_it = icon_it->next) {
-            TaskIcon* icon;
-            icon = (TaskIcon*) icon_it->data;
-            {
-                TaskItem* _tmp1_ = NULL;
-                TaskItem* _tmp2_;
-                TaskLauncher* launcher;
-                _tmp1_ = task_icon_get_launcher(icon);
-                _tmp2_ = _tmp1_;
-                launcher = TASK_IS_LAUNCHER(_tmp2_) ? ((TaskLauncher*) _tmp2_) : NULL;
-                if (launcher != NULL) {
-                    const gchar* _tmp3_ = NULL;
-                    gboolean _tmp4_;
-                    _tmp3_ = task_launcher_get_desktop_path(launcher);
-                    _tmp4_ = g_str_has_suffix(_tmp3_, desktop_file);
-                    if (_tmp4_) {
-                        matches = g_slist_append(matches, icon);
-                    }
-                }
-            }
-        }
-    }
-    _tmp6_ = task_manager_dispatcher_list_to_object_path_array(matches, &_tmp5_);
-    _tmp7_ = _tmp6_;
-    if (result_length1) {
-        *result_length1 = _tmp5_;
-    }
-    result = _tmp7_;
-    _g_slist_free0(matches);
-    return result;
-}
-
-
-static char** task_manager_dispatcher_real_get_items_by_pid(DockManagerDBusInterface* base, gint pid, int* result_length1, GError** error)
-{
-    TaskManagerDispatcher* self = (TaskManagerDispatcher*) base;
-    GSList* matches = nullptr;
-    gint _tmp4_;
-    GSList* icons = task_manager_get_icons(self->priv->_manager);
-    {
-        for (GSList* icon_it = icons; icon_it != NULL; icon_it = icon_it->next) {
-            TaskIcon* icon;
-            icon = (TaskIcon*) icon_it->data;
-            {
-                GSList* _tmp1_ = NULL;
-                _tmp1_ = task_icon_get_items(icon);
-                {
-                    GSList* item_collection;
-                    GSList* item_it;
-                    item_collection = _tmp1_;
-                    for (item_it = item_collection; item_it != NULL; item_it = item_it->next) {
-                        TaskItem* item;
-                        item = (TaskItem*) item_it->data;
-                        {
-                            if (TASK_IS_WINDOW(item)) {
-                                TaskItem* _tmp2_;
-                                TaskWindow* window;
-                                gint _tmp3_;
-                                _tmp2_ = item;
-                                window = TASK_IS_WINDOW(_tmp2_) ? ((TaskWindow*) _tmp2_) : NULL;
-                                _tmp3_ = task_window_get_pid(window);
-                                if (_tmp3_ == pid) {
-                                    matches = g_slist_append(matches, icon);
-                                    break;
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    }
-    char** result = task_manager_dispatcher_list_to_object_path_array(matches, &_tmp4_);
-    if (result_length1) {
-        *result_length1 = _tmp4_;
-    }
-    _g_slist_free0(matches);
-    return result;
-}
-
-
 static char* task_manager_dispatcher_real_get_item_by_xid(DockManagerDBusInterface* base, gint64 xid, GError** error)
 {
     TaskManagerDispatcher* self = (TaskManagerDispatcher*) base;
@@ -2560,13 +2498,25 @@ static void __lambda0__gtk_menu_item_activate(GtkMenuItem* _sender, gpointer sel
 }
 
 
+static void _menu_item_icon_file_loaded(GdkPixbuf* pixbuf, gpointer data)
+{
+    GtkImage* image = (GtkImage*) data;
+
+    if (pixbuf != NULL) {
+        gtk_image_set_from_pixbuf(image, pixbuf);
+    } else {
+        g_warning("dock-manager-api.vala:316: Failed to load menu item icon");
+    }
+    g_object_unref(image);
+}
+
+
 static gint task_icon_dispatcher_real_add_menu_item(DockItemDBusInterface* base, GHashTable* menu_hints, GError** error)
 {
     gint result = 0;
     GtkImageMenuItem* item = nullptr;
     GtkImage* image = nullptr;
     gchar* group = nullptr;
-    GError* _inner_error_ = NULL;
 
     TaskIconDispatcher* self = (TaskIconDispatcher*) base;
     g_return_val_if_fail(menu_hints != NULL, 0);
@@ -2599,14 +2549,17 @@ static gint task_icon_dispatcher_real_add_menu_item(DockItemDBusInterface* base,
                     int w, h;
                     gtk_icon_size_lookup(GTK_ICON_SIZE_MENU, &w, &h);
                     const gchar* _tmp9_ = g_value_get_string(value);
-                    GdkPixbuf* pixbuf = gdk_pixbuf_new_from_file_at_size(_tmp9_, w, h, &_inner_error_);
-                    if (_inner_error_ != NULL) {
-                        g_warning("dock-manager-api.vala:316: %s", _inner_error_->message);
-                        _g_error_free0(_inner_error_);
-                        _inner_error_ = nullptr;
-                    } else {
-                        image = (GtkImage*) gtk_image_new_from_pixbuf(pixbuf);
-                        image = g_object_ref_sink(image);
+                    /* an empty image until the decode finishes */
+                    image = (GtkImage*) gtk_image_new();
+                    image = g_object_ref_sink(image);
+                    gtk_widget_set_size_request((GtkWidget*) image, w, h);
+                    GdkPixbuf* pixbuf = awn_pixbuf_cache_load_file(awn_pixbuf_cache_get_default(),
+                                        _tmp9_, w, h, TRUE,
+                                        _menu_item_icon_file_loaded,
+                                        g_object_ref(image));
+                    if (pixbuf != NULL) {
+                        gtk_image_set_from_pixbuf(image, pixbuf);
+                        g_object_unref(image);
                     }
                     _g_object_unref0(pixbuf);
                 } else {
@@ -2657,36 +2610,101 @@ static void task_icon_dispatcher_real_remove_menu_item(DockItemDBusInterface* ba
 }
 
 
+static GValue* _hint_value_dup(const GValue* value)
+{
+    GValue* copy = g_new0(GValue, 1);
+    g_value_init(copy, G_VALUE_TYPE(value));
+    g_value_copy(value, copy);
+    return copy;
+}
+
+
+static gboolean task_icon_dispatcher_flush_hints(TaskIconDispatcher* self)
+{
+    TaskIconDispatcherPrivate* priv = self->priv;
+    GHashTable* pending = priv->pending_hints;
+    GHashTableIter iter = {0};
+    gpointer key, value;
+
+    priv->update_id = 0;
+    priv->pending_hints = g_hash_table_new_full(g_str_hash, g_str_equal, _g_free0_, __vala_GValue_free0_);
+    priv->hints_flushes++;
+
+    GSList* items = task_icon_get_items(priv->icon);
+    g_hash_table_iter_init(&iter, pending);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+        gboolean changed = FALSE;
+
+        for (GSList* item_it = items; item_it != nullptr; item_it = item_it->next) {
+            TaskItem* item = (TaskItem*) item_it->data;
+            if (TASK_IS_LAUNCHER(item)) {
+                continue;
+            }
+            /* compared with what the overlays show, whoever set them */
+            if (task_item_overlay_has_value(item, key, value)) {
+                continue;
+            }
+            task_item_update_overlay(item, key, value);
+            changed = TRUE;
+        }
+        if (!changed) {
+            priv->hints_dropped++;
+        }
+    }
+    if (priv->flushed_hints) {
+        g_hash_table_destroy(priv->flushed_hints);
+    }
+    priv->flushed_hints = pending;
+
+    return FALSE;
+}
+
+
 static void task_icon_dispatcher_real_update_dock_item(DockItemDBusInterface* base, GHashTable* hints, GError** error)
 {
     TaskIconDispatcher* self = (TaskIconDispatcher*) base;
+    TaskIconDispatcherPrivate* priv = self->priv;
     GHashTableIter iter = {0};
+    gpointer key, value;
 
     g_return_if_fail(hints != NULL);
     g_hash_table_iter_init(&iter, hints);
 
-    while (true) {
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+        priv->hints_received++;
+        if (g_hash_table_lookup(priv->pending_hints, key)) {
+            priv->hints_coalesced++;
+        }
+        g_hash_table_replace(priv->pending_hints, g_strdup((const gchar*) key),
+                             _hint_value_dup((GValue*) value));
+    }
 
-        const gchar* key;
-        GValue* value;
+    if (!priv->update_id && g_hash_table_size(priv->pending_hints)) {
+        priv->update_id = g_timeout_add(UPDATE_DOCK_ITEM_INTERVAL,
+                                        (GSourceFunc) task_icon_dispatcher_flush_hints,
+                                        self);
+    }
+}
 
-        if (!g_hash_table_iter_next(&iter, &key, &value)) {
-            break;
-        }
-        GSList* items = task_icon_get_items(self->priv->icon);
-        {
-            GSList* item_collection = items;
-            for (GSList* item_it = item_collection; item_it != nullptr;
-                item_it = item_it->next) {
-                TaskItem* item = (TaskItem*) item_it->data;
-                {
-                    if (TASK_IS_LAUNCHER(item)) {
-                        continue;
-                    }
-                    task_item_update_overlay(item, key, value);
-                }
-            }
-        }
+
+void task_icon_dispatcher_get_update_stats(TaskIconDispatcher* self,
+                                           guint* received,
+                                           guint* coalesced,
+                                           guint* dropped,
+                                           guint* flushes)
+{
+    g_return_if_fail(self != NULL);
+    if (received) {
+        *received = self->priv->hints_received;
+    }
+    if (coalesced) {
+        *coalesced = self->priv->hints_coalesced;
+    }
+    if (dropped) {
+        *dropped = self->priv->hints_dropped;
+    }
+    if (flushes) {
+        *flushes = self->priv->hints_flushes;
     }
 }
 
@@ -2801,6 +2819,7 @@ static void task_icon_dispatcher_dock_item_dbus_interface_interface_init(DockIte
 static void task_icon_dispatcher_instance_init(TaskIconDispatcher* self)
 {
     self->priv = TASK_ICON_DISPATCHER_GET_PRIVATE(self);
+    self->priv->pending_hints = g_hash_table_new_full(g_str_hash, g_str_equal, _g_free0_, __vala_GValue_free0_);
 }
 
 
@@ -2812,6 +2831,14 @@ static void task_icon_dispatcher_finalize(GObject* obj)
         g_signal_emit_by_name((DockManagerDBusInterface*) proxy, "item-removed",
                               self->priv->_object_path);
     }
+    if (self->priv->update_id) {
+        g_source_remove(self->priv->update_id);
+        self->priv->update_id = 0;
+    }
+    g_hash_table_destroy(self->priv->pending_hints);
+    if (self->priv->flushed_hints) {
+        g_hash_table_destroy(self->priv->flushed_hints);
+    }
     g_free(self->priv->_object_path);
     G_OBJECT_CLASS(task_icon_dispatcher_parent_class)->finalize(obj);
 }
@@ -2847,11 +2874,108 @@ static DBusHandlerResult _dbus_task_icon_dispatcher_introspect(TaskIconDispatche
 }
 
 
+static void _dbus_append_hints(DBusMessageIter* iter, GHashTable* hints)
+{
+    DBusMessageIter array_iter, entry_iter, variant_iter;
+    GHashTableIter hints_iter;
+    gpointer key, value;
+
+    dbus_message_iter_open_container(iter, DBUS_TYPE_ARRAY, "{sv}", &array_iter);
+    if (hints) {
+        g_hash_table_iter_init(&hints_iter, hints);
+    }
+    while (hints && g_hash_table_iter_next(&hints_iter, &key, &value)) {
+        const gchar* name = (const gchar*) key;
+
+        dbus_message_iter_open_container(&array_iter, DBUS_TYPE_DICT_ENTRY, NULL, &entry_iter);
+        dbus_message_iter_append_basic(&entry_iter, DBUS_TYPE_STRING, &name);
+        if (G_VALUE_HOLDS_STRING(value)) {
+            const gchar* string = g_value_get_string(value);
+            if (!string) {
+                string = "";
+            }
+            dbus_message_iter_open_container(&entry_iter, DBUS_TYPE_VARIANT, "s", &variant_iter);
+            dbus_message_iter_append_basic(&variant_iter, DBUS_TYPE_STRING, &string);
+        } else if (G_VALUE_HOLDS_INT(value)) {
+            dbus_int32_t number = g_value_get_int(value);
+            dbus_message_iter_open_container(&entry_iter, DBUS_TYPE_VARIANT, "i", &variant_iter);
+            dbus_message_iter_append_basic(&variant_iter, DBUS_TYPE_INT32, &number);
+        } else {
+            dbus_bool_t flag = G_VALUE_HOLDS_BOOLEAN(value) && g_value_get_boolean(value);
+            dbus_message_iter_open_container(&entry_iter, DBUS_TYPE_VARIANT, "b", &variant_iter);
+            dbus_message_iter_append_basic(&variant_iter, DBUS_TYPE_BOOLEAN, &flag);
+        }
+        dbus_message_iter_close_container(&entry_iter, &variant_iter);
+        dbus_message_iter_close_container(&array_iter, &entry_iter);
+    }
+    dbus_message_iter_close_container(iter, &array_iter);
+}
+
+
+/* Properties.Get("net.launchpad.DockItem", "AwnUpdateStats") -> (uuuu)
+ * Properties.Get("net.launchpad.DockItem", "AwnLastFlush") -> a{sv}, the
+ * hints applied by the last flush */
+static DBusHandlerResult _dbus_task_icon_dispatcher_update_stats(TaskIconDispatcher* self, DBusConnection* connection, DBusMessage* message)
+{
+    DBusMessageIter iter, reply_iter, subiter, structiter;
+    const char* interface_name;
+    const char* property_name;
+    guint stats[4];
+
+    if (strcmp(dbus_message_get_signature(message), "ss")) {
+        return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+    }
+    dbus_message_iter_init(message, &iter);
+    dbus_message_iter_get_basic(&iter, &interface_name);
+    dbus_message_iter_next(&iter);
+    dbus_message_iter_get_basic(&iter, &property_name);
+    if (strcmp(interface_name, "net.launchpad.DockItem") != 0) {
+        return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+    }
+    if (strcmp(property_name, "AwnLastFlush") == 0) {
+        DBusMessage* reply = dbus_message_new_method_return(message);
+        if (!reply) {
+            return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+        }
+        dbus_message_iter_init_append(reply, &reply_iter);
+        dbus_message_iter_open_container(&reply_iter, DBUS_TYPE_VARIANT, "a{sv}", &subiter);
+        _dbus_append_hints(&subiter, self->priv->flushed_hints);
+        dbus_message_iter_close_container(&reply_iter, &subiter);
+        dbus_connection_send(connection, reply, NULL);
+        dbus_message_unref(reply);
+        return DBUS_HANDLER_RESULT_HANDLED;
+    }
+    if (strcmp(property_name, "AwnUpdateStats") != 0) {
+        return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+    }
+
+    task_icon_dispatcher_get_update_stats(self, &stats[0], &stats[1], &stats[2], &stats[3]);
+    DBusMessage* reply = dbus_message_new_method_return(message);
+    if (!reply) {
+        return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+    }
+    dbus_message_iter_init_append(reply, &reply_iter);
+    dbus_message_iter_open_container(&reply_iter, DBUS_TYPE_VARIANT, "(uuuu)", &subiter);
+    dbus_message_iter_open_container(&subiter, DBUS_TYPE_STRUCT, NULL, &structiter);
+    for (int i = 0; i < 4; i++) {
+        dbus_uint32_t value = stats[i];
+        dbus_message_iter_append_basic(&structiter, DBUS_TYPE_UINT32, &value);
+    }
+    dbus_message_iter_close_container(&subiter, &structiter);
+    dbus_message_iter_close_container(&reply_iter, &subiter);
+    dbus_connection_send(connection, reply, NULL);
+    dbus_message_unref(reply);
+    return DBUS_HANDLER_RESULT_HANDLED;
+}
+
+
 DBusHandlerResult task_icon_dispatcher_dbus_message(DBusConnection* connection, DBusMessage* message, void* object)
 {
     DBusHandlerResult result = DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
     if (dbus_message_is_method_call(message, "org.freedesktop.DBus.Introspectable", "Introspect")) {
         result = _dbus_task_icon_dispatcher_introspect(object, connection, message);
+    } else if (dbus_message_is_method_call(message, "org.freedesktop.DBus.Properties", "Get")) {
+        result = _dbus_task_icon_dispatcher_update_stats(object, connection, message);
     }
     if (result == DBUS_HANDLER_RESULT_HANDLED) {
         return result;
@@ -121,6 +121,7 @@ TaskIconDispatcher* task_icon_dispatcher_new(TaskIcon* icon);
 TaskIconDispatcher* task_icon_dispatcher_construct(GType object_type, TaskIcon* icon);
 const gchar* task_icon_dispatcher_get_object_path(TaskIconDispatcher* self);
 void task_icon_dispatcher_set_object_path(TaskIconDispatcher* self, const gchar* value);
+void task_icon_dispatcher_get_update_stats(TaskIconDispatcher* self, guint* received, guint* coalesced, guint* dropped, guint* flushes);
 
 #ifdef __cplusplus
 } // extern "C"
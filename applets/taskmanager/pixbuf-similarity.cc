@@ -0,0 +1,294 @@
+/*
+ * Copyright (C) 2026 Awn-core team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+/* pixbuf-similarity.c */
+
+#include <math.h>
+#include <stdlib.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "pixbuf-similarity.h"
+
+//#define DEBUG 1
+
+/* Images are similar if their PSNR is at least 11dB, ie MSE <= 255^2/10^1.1 */
+#define SIMILAR_PSNR 11
+#define SIMILAR_MSE_LIMIT (255.0 * 255.0 / pow(10.0, SIMILAR_PSNR / 10.0))
+
+/*
+ Bounding the MSE from the cell means (see _mse_lower_bound()).
+
+ For one pixel, with L the composited luminance the cells average and S the
+ sum of squared channel differences the MSE adds up:
+   |dL| <= |d alpha| + |d lum| + 1 <= |d alpha| + 0.6683 * |d rgb| + 2
+ (0.6683 being the norm of the luminance weights, the 1s the roundings), so
+   |dL| <= sqrt(LUMINANCE_BOUND * S) + 2
+ A pixel the MSE skips has an alpha <= 10 in one image and <= 20 in the
+ other, so |dL| <= 20.  Summing over the n pixels of a cell and applying
+ Cauchy-Schwarz, the cell adds at least
+   n * (|d mean| - CELL_MEAN_SLACK)^2 / LUMINANCE_BOUND
+ to the MSE's sum.
+ */
+#define LUMINANCE_BOUND 1.4467
+#define CELL_MEAN_SLACK 20.0
+
+typedef struct {
+    gint width;
+    gint height;
+    gint row_stride;
+    gboolean has_alpha;
+    gdouble means[8][8];
+    guint counts[8][8];
+} PixbufSignature;
+
+static GQuark signature_quark = 0;
+
+static const PixbufSignature*
+_get_signature(GdkPixbuf* pixbuf)
+{
+    PixbufSignature* sig;
+    guint64 sums[8][8] = {{0}};
+    gint n_channels;
+    guchar* pixels;
+
+    if (!signature_quark) {
+        signature_quark = g_quark_from_static_string("awn-taskmanager-pixbuf-signature");
+    }
+    sig = g_object_get_qdata(G_OBJECT(pixbuf), signature_quark);
+    if (sig) {
+        return sig;
+    }
+
+    sig = g_new0(PixbufSignature, 1);
+    sig->width = gdk_pixbuf_get_width(pixbuf);
+    sig->height = gdk_pixbuf_get_height(pixbuf);
+    sig->row_stride = gdk_pixbuf_get_rowstride(pixbuf);
+    sig->has_alpha = gdk_pixbuf_get_has_alpha(pixbuf);
+    n_channels = gdk_pixbuf_get_n_channels(pixbuf);
+    pixels = gdk_pixbuf_get_pixels(pixbuf);
+
+    /* Shrink to 8x8 cells of luminance (composited on black) */
+    for (gint y = 0; y < sig->height; y++) {
+        guchar* it = pixels + y * sig->row_stride;
+        gint cy = y * 8 / sig->height;
+        for (gint x = 0; x < sig->width; x++, it += n_channels) {
+            guint alpha = sig->has_alpha ? it[3] : 255;
+            guint lum = (it[0] * 77 + it[1] * 150 + it[2] * 29) >> 8;
+            gint cx = x * 8 / sig->width;
+
+            sums[cy][cx] += lum * alpha / 255;
+            sig->counts[cy][cx]++;
+        }
+    }
+
+    for (gint r = 0; r < 8; r++) {
+        for (gint c = 0; c < 8; c++) {
+            if (sig->counts[r][c]) {
+                sig->means[r][c] = (gdouble)sums[r][c] / sig->counts[r][c];
+            }
+        }
+    }
+    g_object_set_qdata_full(G_OBJECT(pixbuf), signature_quark, sig, g_free);
+    return sig;
+}
+
+static gdouble
+_mse_lower_bound(const PixbufSignature* s1, const PixbufSignature* s2)
+{
+    gdouble sum = 0.0;
+
+    /* _compute_mse() doesn't compare those either */
+    if (s1->width != s2->width || s1->height != s2->height ||
+        s1->row_stride != s2->row_stride || s1->has_alpha != s2->has_alpha) {
+        return 0.0;
+    }
+    for (gint r = 0; r < 8; r++) {
+        for (gint c = 0; c < 8; c++) {
+            gdouble delta = fabs(s1->means[r][c] - s2->means[r][c]) - CELL_MEAN_SLACK;
+            if (delta > 0.0) {
+                sum += s1->counts[r][c] * delta * delta;
+            }
+        }
+    }
+    /* an RGB pixbuf divides by 3 channels, 4 keeps the bound valid for both */
+    return sum / LUMINANCE_BOUND / ((gdouble)s1->width * s1->height * 4);
+}
+
+gdouble
+pixbuf_similarity_mse_lower_bound(GdkPixbuf* i1, GdkPixbuf* i2)
+{
+    g_return_val_if_fail(GDK_IS_PIXBUF(i1) && GDK_IS_PIXBUF(i2), 0.0);
+
+    return _mse_lower_bound(_get_signature(i1), _get_signature(i2));
+}
+
+/*
+ Sum of squared differences of one RGBA row.  A pixel doesn't count when
+ its alpha is <= 10 in the first image and the alpha difference is <= 10.
+ */
+static guint64
+_row_sse_rgba(const guchar* it1, const guchar* it2, gint width)
+{
+    guint64 result = 0;
+    gint j = 0;
+
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ten = _mm_set1_epi8(10);
+    __m128i acc = zero;
+    guint32 lanes[4];
+
+    for (; j + 4 <= width; j += 4) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(it1 + j * 4));
+        __m128i b = _mm_loadu_si128((const __m128i*)(it2 + j * 4));
+        __m128i delta = _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+        /* bytes <= 10 become 0xff */
+        __m128i small_delta = _mm_cmpeq_epi8(_mm_subs_epu8(delta, ten), zero);
+        __m128i small_a = _mm_cmpeq_epi8(_mm_subs_epu8(a, ten), zero);
+        /* spread the alpha byte's verdict over the whole pixel */
+        __m128i skip = _mm_srai_epi32(_mm_and_si128(small_delta, small_a), 24);
+        __m128i lo, hi;
+
+        delta = _mm_andnot_si128(skip, delta);
+        lo = _mm_unpacklo_epi8(delta, zero);
+        hi = _mm_unpackhi_epi8(delta, zero);
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(lo, lo));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(hi, hi));
+    }
+    _mm_storeu_si128((__m128i*)lanes, acc);
+    result = (guint64)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+
+    for (; j < width; j++) {
+        const guchar* p1 = it1 + j * 4;
+        const guchar* p2 = it2 + j * 4;
+        gint delta_r = p1[0] - p2[0];
+        gint delta_g = p1[1] - p2[1];
+        gint delta_b = p1[2] - p2[2];
+        gint delta_alpha = p1[3] - p2[3];
+
+        if (abs(delta_alpha) <= 10 && p1[3] <= 10) {
+            continue;
+        }
+        result += delta_r * delta_r + delta_g * delta_g + delta_b * delta_b +
+                  delta_alpha * delta_alpha;
+    }
+    return result;
+}
+
+static guint64
+_row_sse_rgb(const guchar* it1, const guchar* it2, gint width)
+{
+    guint64 result = 0;
+
+    for (gint j = 0; j < width * 3; j++) {
+        gint delta = it1[j] - it2[j];
+        result += delta * delta;
+    }
+    return result;
+}
+
+/*
+ Stops summing once the MSE is known to exceed limit, the result is then
+ only guaranteed to be > limit.
+ */
+static gdouble
+_compute_mse(GdkPixbuf* i1, GdkPixbuf* i2, gdouble limit)
+{
+    int width, height, row_stride, has_alpha;
+    guchar* i1_pixels, *i2_pixels;
+    guint64 result = 0;
+    gdouble count;
+
+    g_return_val_if_fail(GDK_IS_PIXBUF(i1) && GDK_IS_PIXBUF(i2), 0.0);
+
+    has_alpha = gdk_pixbuf_get_has_alpha(i1);
+    width = gdk_pixbuf_get_width(i1);
+    height = gdk_pixbuf_get_height(i1);
+    row_stride = gdk_pixbuf_get_rowstride(i1);
+
+    g_return_val_if_fail(
+        has_alpha == gdk_pixbuf_get_has_alpha(i2) &&
+        width == gdk_pixbuf_get_width(i2) &&
+        height == gdk_pixbuf_get_height(i2) &&
+        row_stride == gdk_pixbuf_get_rowstride(i2),
+        0.0
+    );
+
+    i1_pixels = gdk_pixbuf_get_pixels(i1);
+    i2_pixels = gdk_pixbuf_get_pixels(i2);
+    count = (gdouble)width * height * (has_alpha ? 4 : 3);
+
+    for (int i = 0; i < height; i++) {
+        guchar* it1 = i1_pixels + i * row_stride;
+        guchar* it2 = i2_pixels + i * row_stride;
+
+        result += has_alpha ? _row_sse_rgba(it1, it2, width) :
+                  _row_sse_rgb(it1, it2, width);
+        if (result / count > limit) {
+            break;
+        }
+    }
+
+    return result / count;
+}
+
+gdouble
+pixbuf_similarity_mse(GdkPixbuf* i1, GdkPixbuf* i2)
+{
+    return _compute_mse(i1, i2, G_MAXDOUBLE);
+}
+
+static gdouble
+compute_psnr(gdouble MSE, gint max_val)
+{
+    return 10 * log10(max_val * max_val / MSE);
+}
+
+gboolean
+pixbuf_similarity_similar_to(GdkPixbuf* i1, GdkPixbuf* i2)
+{
+    gdouble MSE;
+
+    g_return_val_if_fail(GDK_IS_PIXBUF(i1) && GDK_IS_PIXBUF(i2), TRUE);
+
+    if (_mse_lower_bound(_get_signature(i1), _get_signature(i2)) > SIMILAR_MSE_LIMIT) {
+#ifdef DEBUG
+        g_debug("Different signatures...");
+#endif
+        return FALSE;
+    }
+
+    /* The signatures can only tell them apart, settle it on the pixels */
+    MSE = _compute_mse(i1, i2, SIMILAR_MSE_LIMIT);
+    if (MSE < 0.01) {
+#ifdef DEBUG
+        g_debug("Same images...");
+#endif
+        return TRUE;
+    }
+
+    gdouble PSNR = compute_psnr(MSE, 255);
+#ifdef DEBUG
+    g_debug("PSNR: %g", PSNR);
+#endif
+    return PSNR >= SIMILAR_PSNR;
+}
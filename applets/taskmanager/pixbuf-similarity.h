@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) 2026 Awn-core team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+/* pixbuf-similarity.h */
+
+#ifndef __TASK_MANAGER_PIXBUF_SIMILARITY_H__
+#define __TASK_MANAGER_PIXBUF_SIMILARITY_H__
+
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+/* Mean squared error per channel, as used by utils_gdk_pixbuf_similar_to()
+ before the hash existed.  Nearly transparent pixels that are nearly
+ transparent in both images are not counted.*/
+gdouble pixbuf_similarity_mse(GdkPixbuf* i1, GdkPixbuf* i2);
+
+/* A value the MSE of the two pixbufs is never below, from 8x8 cell means of
+ their luminance composited on black.  The means are computed on first use
+ and kept as object data on the pixbuf, so pixbufs must not be modified
+ after they have been compared.*/
+gdouble pixbuf_similarity_mse_lower_bound(GdkPixbuf* i1, GdkPixbuf* i2);
+
+gboolean pixbuf_similarity_similar_to(GdkPixbuf* i1, GdkPixbuf* i2);
+
+#endif
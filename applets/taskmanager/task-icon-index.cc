@@ -0,0 +1,341 @@
+/*
+ * Copyright (C) 2026 Awn-core team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+/* task-icon-index.c */
+
+#include "task-icon-index.h"
+#include "task-launcher.h"
+#include "task-window.h"
+#include "xutils.h"
+
+/*
+ What an item was indexed under, so it can be unindexed without asking
+ the (possibly dying) item again.
+ */
+typedef struct {
+    TaskIcon* icon;
+    gulong xid;
+    gint pid;
+    gchar* res_name;
+    gchar* class_name;
+    gchar* desktop;
+    gchar** grouping_keys;
+} IndexEntry;
+
+struct _TaskIconIndex {
+    GHashTable* items;          /*TaskItem* -> IndexEntry*/
+    GHashTable* by_xid;         /*xid -> TaskIcon*/
+    GHashTable* by_pid;         /*pid -> icon set*/
+    GHashTable* by_wmclass;     /*lower cased res or class name -> icon set*/
+    GHashTable* by_desktop;     /*desktop file name -> icon set*/
+    GHashTable* by_grouping_key;/*window grouping key -> icon set*/
+};
+
+static void
+_index_entry_free(IndexEntry* entry)
+{
+    g_free(entry->res_name);
+    g_free(entry->class_name);
+    g_free(entry->desktop);
+    g_strfreev(entry->grouping_keys);
+    g_free(entry);
+}
+
+static GHashTable*
+_icon_set_new(void)
+{
+    return g_hash_table_new(g_direct_hash, g_direct_equal);
+}
+
+/*
+ Icon sets count the items of each icon matching the key, the icon leaves
+ the set with its last one.
+ */
+static void
+_icon_set_add(GHashTable* table, gpointer key, gboolean copy_key, TaskIcon* icon)
+{
+    GHashTable* set = g_hash_table_lookup(table, key);
+    guint count;
+
+    if (!set) {
+        set = _icon_set_new();
+        g_hash_table_insert(table, copy_key ? g_strdup(key) : key, set);
+    }
+    count = GPOINTER_TO_UINT(g_hash_table_lookup(set, icon));
+    g_hash_table_insert(set, icon, GUINT_TO_POINTER(count + 1));
+}
+
+static void
+_icon_set_remove(GHashTable* table, gconstpointer key, TaskIcon* icon)
+{
+    GHashTable* set = g_hash_table_lookup(table, key);
+    guint count;
+
+    if (!set) {
+        return;
+    }
+    count = GPOINTER_TO_UINT(g_hash_table_lookup(set, icon));
+    if (count > 1) {
+        g_hash_table_insert(set, icon, GUINT_TO_POINTER(count - 1));
+    } else {
+        g_hash_table_remove(set, icon);
+    }
+    if (!g_hash_table_size(set)) {
+        g_hash_table_remove(table, key);
+    }
+}
+
+/* WM_CLASS names are matched case insensitively */
+static gchar*
+_wmclass_key(const gchar* name)
+{
+    return name ? g_utf8_strdown(name, -1) : NULL;
+}
+
+TaskIconIndex*
+task_icon_index_new(void)
+{
+    TaskIconIndex* index = g_new0(TaskIconIndex, 1);
+
+    index->items = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+                                         (GDestroyNotify)_index_entry_free);
+    index->by_xid = g_hash_table_new(g_direct_hash, g_direct_equal);
+    index->by_pid = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+                                          (GDestroyNotify)g_hash_table_destroy);
+    index->by_wmclass = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                        (GDestroyNotify)g_hash_table_destroy);
+    index->by_desktop = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                        (GDestroyNotify)g_hash_table_destroy);
+    index->by_grouping_key = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                             (GDestroyNotify)g_hash_table_destroy);
+    return index;
+}
+
+void
+task_icon_index_free(TaskIconIndex* index)
+{
+    g_return_if_fail(index);
+
+    g_hash_table_destroy(index->items);
+    g_hash_table_destroy(index->by_xid);
+    g_hash_table_destroy(index->by_pid);
+    g_hash_table_destroy(index->by_wmclass);
+    g_hash_table_destroy(index->by_desktop);
+    g_hash_table_destroy(index->by_grouping_key);
+    g_free(index);
+}
+
+static void
+_unindex_entry(TaskIconIndex* index, IndexEntry* entry)
+{
+    if (entry->xid && g_hash_table_lookup(index->by_xid,
+                                          GUINT_TO_POINTER(entry->xid)) == entry->icon) {
+        g_hash_table_remove(index->by_xid, GUINT_TO_POINTER(entry->xid));
+    }
+    if (entry->pid) {
+        _icon_set_remove(index->by_pid, GINT_TO_POINTER(entry->pid), entry->icon);
+    }
+    if (entry->res_name) {
+        _icon_set_remove(index->by_wmclass, entry->res_name, entry->icon);
+    }
+    if (entry->class_name) {
+        _icon_set_remove(index->by_wmclass, entry->class_name, entry->icon);
+    }
+    if (entry->desktop) {
+        _icon_set_remove(index->by_desktop, entry->desktop, entry->icon);
+    }
+    for (gchar** key = entry->grouping_keys; key && *key; key++) {
+        _icon_set_remove(index->by_grouping_key, *key, entry->icon);
+    }
+}
+
+void
+task_icon_index_add_item(TaskIconIndex* index, TaskIcon* icon, TaskItem* item)
+{
+    IndexEntry* entry;
+
+    g_return_if_fail(index);
+    g_return_if_fail(TASK_IS_ICON(icon));
+    g_return_if_fail(TASK_IS_ITEM(item));
+
+    entry = g_hash_table_lookup(index->items, item);
+    if (entry) {
+        if (entry->icon == icon) {
+            return;
+        }
+        /* regrouped into another icon */
+        task_icon_index_remove_item(index, item);
+    }
+
+    entry = g_new0(IndexEntry, 1);
+    entry->icon = icon;
+    if (TASK_IS_WINDOW(item)) {
+        TaskWindow* window = TASK_WINDOW(item);
+
+        entry->xid = task_window_get_xid(window);
+        entry->pid = task_window_get_pid(window);
+        if (entry->xid) {
+            gchar* res_name = NULL;
+            gchar* class_name = NULL;
+
+            _wnck_get_wmclass(entry->xid, &res_name, &class_name);
+            entry->res_name = _wmclass_key(res_name);
+            entry->class_name = _wmclass_key(class_name);
+            g_free(res_name);
+            g_free(class_name);
+        }
+        if (g_strcmp0(entry->res_name, entry->class_name) == 0) {
+            g_free(entry->class_name);
+            entry->class_name = NULL;
+        }
+        entry->grouping_keys = g_strdupv((gchar**)task_window_get_grouping_keys(window));
+    } else if (TASK_IS_LAUNCHER(item)) {
+        const gchar* path = task_launcher_get_desktop_path(TASK_LAUNCHER(item));
+        if (path) {
+            entry->desktop = g_path_get_basename(path);
+        }
+    }
+
+    if (entry->xid) {
+        g_hash_table_insert(index->by_xid, GUINT_TO_POINTER(entry->xid), icon);
+    }
+    if (entry->pid) {
+        _icon_set_add(index->by_pid, GINT_TO_POINTER(entry->pid), FALSE, icon);
+    }
+    if (entry->res_name) {
+        _icon_set_add(index->by_wmclass, entry->res_name, TRUE, icon);
+    }
+    if (entry->class_name) {
+        _icon_set_add(index->by_wmclass, entry->class_name, TRUE, icon);
+    }
+    if (entry->desktop) {
+        _icon_set_add(index->by_desktop, entry->desktop, TRUE, icon);
+    }
+    for (gchar** key = entry->grouping_keys; key && *key; key++) {
+        _icon_set_add(index->by_grouping_key, *key, TRUE, icon);
+    }
+    g_hash_table_insert(index->items, item, entry);
+}
+
+void
+task_icon_index_remove_item(TaskIconIndex* index, TaskItem* item)
+{
+    IndexEntry* entry;
+
+    g_return_if_fail(index);
+
+    entry = g_hash_table_lookup(index->items, item);
+    if (entry) {
+        _unindex_entry(index, entry);
+        g_hash_table_remove(index->items, item);
+    }
+}
+
+void
+task_icon_index_remove_icon(TaskIconIndex* index, TaskIcon* icon)
+{
+    GHashTableIter iter;
+    gpointer item;
+    IndexEntry* entry;
+
+    g_return_if_fail(index);
+
+    g_hash_table_iter_init(&iter, index->items);
+    while (g_hash_table_iter_next(&iter, &item, (gpointer*)&entry)) {
+        if (entry->icon == icon) {
+            _unindex_entry(index, entry);
+            g_hash_table_iter_remove(&iter);
+        }
+    }
+}
+
+void
+task_icon_index_update_item(TaskIconIndex* index, TaskItem* item)
+{
+    IndexEntry* entry;
+    TaskIcon* icon;
+
+    g_return_if_fail(index);
+    g_return_if_fail(TASK_IS_ITEM(item));
+
+    entry = g_hash_table_lookup(index->items, item);
+    if (!entry) {
+        return;
+    }
+    icon = entry->icon;
+    task_icon_index_remove_item(index, item);
+    task_icon_index_add_item(index, icon, item);
+}
+
+TaskIcon*
+task_icon_index_lookup_xid(TaskIconIndex* index, gulong xid)
+{
+    g_return_val_if_fail(index, NULL);
+
+    return g_hash_table_lookup(index->by_xid, GUINT_TO_POINTER(xid));
+}
+
+GHashTable*
+task_icon_index_lookup_pid(TaskIconIndex* index, gint pid)
+{
+    g_return_val_if_fail(index, NULL);
+
+    return g_hash_table_lookup(index->by_pid, GINT_TO_POINTER(pid));
+}
+
+GHashTable*
+task_icon_index_lookup_wmclass(TaskIconIndex* index, const gchar* name)
+{
+    GHashTable* set;
+    gchar* key;
+
+    g_return_val_if_fail(index, NULL);
+
+    if (!name) {
+        return NULL;
+    }
+    key = _wmclass_key(name);
+    set = g_hash_table_lookup(index->by_wmclass, key);
+    g_free(key);
+    return set;
+}
+
+GHashTable*
+task_icon_index_lookup_desktop(TaskIconIndex* index, const gchar* desktop)
+{
+    GHashTable* set;
+    gchar* name;
+
+    g_return_val_if_fail(index, NULL);
+
+    if (!desktop) {
+        return NULL;
+    }
+    name = g_path_get_basename(desktop);
+    set = g_hash_table_lookup(index->by_desktop, name);
+    g_free(name);
+    return set;
+}
+
+GHashTable*
+task_icon_index_lookup_grouping_key(TaskIconIndex* index, const gchar* key)
+{
+    g_return_val_if_fail(index, NULL);
+
+    return key ? g_hash_table_lookup(index->by_grouping_key, key) : NULL;
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2026 Awn-core team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+/* task-icon-index.h */
+
+#ifndef __TASK_ICON_INDEX_H__
+#define __TASK_ICON_INDEX_H__
+
+#include <glib.h>
+
+#include "task-icon.h"
+
+/*
+ Secondary indexes from window xid, pid, WM_CLASS (res and class name),
+ launcher desktop file name and window grouping key to the TaskIcons holding
+ them.  Kept up to date by TaskManager from the icons' item-added and
+ item-removed signals and the windows' class and pid changes, so the
+ DockManager queries and the grouping don't have to walk every item.
+
+ Lookups return sets (TaskIcon* -> number of matching items) owned by the
+ index, or NULL when nothing matches.
+ */
+typedef struct _TaskIconIndex TaskIconIndex;
+
+TaskIconIndex*    task_icon_index_new(void);
+
+void              task_icon_index_free(TaskIconIndex* index);
+
+void              task_icon_index_add_item(TaskIconIndex* index,
+                                           TaskIcon* icon,
+                                           TaskItem* item);
+
+/* Doesn't touch item, it may already be under destruction */
+void              task_icon_index_remove_item(TaskIconIndex* index,
+                                              TaskItem* item);
+
+/* Reindexes item under its current xid, pid, WM_CLASS and grouping keys,
+ * after they changed */
+void              task_icon_index_update_item(TaskIconIndex* index,
+                                              TaskItem* item);
+
+void              task_icon_index_remove_icon(TaskIconIndex* index,
+                                              TaskIcon* icon);
+
+TaskIcon*         task_icon_index_lookup_xid(TaskIconIndex* index,
+                                             gulong xid);
+
+GHashTable*       task_icon_index_lookup_pid(TaskIconIndex* index,
+                                             gint pid);
+
+/* Matches the res or class name case insensitively */
+GHashTable*       task_icon_index_lookup_wmclass(TaskIconIndex* index,
+                                                 const gchar* name);
+
+/* Matches on the file name of desktop, callers compare full paths */
+GHashTable*       task_icon_index_lookup_desktop(TaskIconIndex* index,
+                                                 const gchar* desktop);
+
+/* See task_window_get_grouping_keys() */
+GHashTable*       task_icon_index_lookup_grouping_key(TaskIconIndex* index,
+                                                      const gchar* key);
+
+#endif /* __TASK_ICON_INDEX_H__ */
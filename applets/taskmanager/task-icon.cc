@@ -94,6 +94,9 @@ enum {
     DEST_DRAG_MOVE,
     DEST_DRAG_LEAVE,
 
+    ITEM_ADDED,
+    ITEM_REMOVED,
+
     LAST_SIGNAL
 };
 static guint32 _icon_signals[LAST_SIGNAL] = { 0 };
@@ -344,8 +347,11 @@ task_icon_dispose(GObject* object)
 {
     TaskIconPrivate* priv = TASK_ICON_GET_PRIVATE(object);
 
-    desktop_agnostic_config_client_unbind_all_for_object(priv->client, object,
-            NULL);
+    if (priv->client) {
+        awn_config_snapshot_unbind_all_for_object(
+            awn_config_snapshot_get(priv->client, DESKTOP_AGNOSTIC_CONFIG_GROUP_DEFAULT),
+            object);
+    }
 
     /*this needs to be done in dispose, not finalize, due to idiosyncracies of
      AwnDialog*/
@@ -434,16 +440,12 @@ task_icon_finalize(GObject* object)
 }
 
 static gboolean
-do_bind_property(DesktopAgnosticConfigClient* client, const gchar* key,
+do_bind_property(AwnConfigSnapshot* snapshot, const gchar* key,
                  GObject* object, const gchar* property)
 {
     GError* error = NULL;
 
-    desktop_agnostic_config_client_bind(client,
-                                        DESKTOP_AGNOSTIC_CONFIG_GROUP_DEFAULT,
-                                        key, object, property, TRUE,
-                                        DESKTOP_AGNOSTIC_CONFIG_BIND_METHOD_FALLBACK,
-                                        &error);
+    awn_config_snapshot_bind(snapshot, key, object, property, &error);
     if (error) {
         g_warning("Could not bind property '%s' to key '%s': %s", property, key,
                   error->message);
@@ -459,6 +461,7 @@ task_icon_constructed(GObject* object)
 {
     TaskIconPrivate* priv = TASK_ICON(object)->priv;
     GtkWidget* widget = GTK_WIDGET(object);
+    AwnConfigSnapshot* snapshot;
     GError* error = NULL;
 
     if (G_OBJECT_CLASS(task_icon_parent_class)->constructed) {
@@ -511,59 +514,63 @@ task_icon_constructed(GObject* object)
         return;
     }
 
-    if (!do_bind_property(priv->client, "max_indicators", object,
+    /* every icon reads the same settings, share one snapshot of them */
+    snapshot = awn_config_snapshot_get(priv->client,
+                                       DESKTOP_AGNOSTIC_CONFIG_GROUP_DEFAULT);
+
+    if (!do_bind_property(snapshot, "max_indicators", object,
                           "max_indicators")) {
         return;
     }
 
-    if (!do_bind_property(priv->client, "txt_indicator_threshold", object,
+    if (!do_bind_property(snapshot, "txt_indicator_threshold", object,
                           "txt_indicator_threshold")) {
         return;
     }
 
-    if (!do_bind_property(priv->client, "enable_long_press", object,
+    if (!do_bind_property(snapshot, "enable_long_press", object,
                           "enable_long_press")) {
         return;
     }
 
-    if (!do_bind_property(priv->client, "icon_change_behavior", object,
+    if (!do_bind_property(snapshot, "icon_change_behavior", object,
                           "icon_change_behavior")) {
         return;
     }
 
-    if (!do_bind_property(priv->client, "drag_and_drop_hover_delay", object,
+    if (!do_bind_property(snapshot, "drag_and_drop_hover_delay", object,
                           "drag_and_drop_hover_delay")) {
         return;
     }
 
-    if (!do_bind_property(priv->client, "desktop_copy", object, "desktop_copy")) {
+    if (!do_bind_property(snapshot, "desktop_copy", object, "desktop_copy")) {
         return;
     }
 
-    if (!do_bind_property(priv->client, "drag_and_drop", object, "draggable")) {
+    if (!do_bind_property(snapshot, "drag_and_drop", object, "draggable")) {
         return;
     }
 
-    if (!do_bind_property(priv->client, "overlay_application_icons", object,
+    if (!do_bind_property(snapshot, "overlay_application_icons", object,
                           "overlay_application_icons")) {
         return;
     }
 
-    if (!do_bind_property(priv->client, "overlay_application_icons_scale", object,
+    if (!do_bind_property(snapshot, "overlay_application_icons_scale", object,
                           "overlay_application_icons_scale")) {
         return;
     }
 
-    if (!do_bind_property(priv->client, "overlay_application_icons_alpha", object,
+    if (!do_bind_property(snapshot, "overlay_application_icons_alpha", object,
                           "overlay_application_icons_alpha")) {
         return;
     }
 
-    if (!do_bind_property(priv->client, "overlay_application_icons_swap", object,
+    if (!do_bind_property(snapshot, "overlay_application_icons_swap", object,
                           "overlay_application_icons_swap")) {
         return;
     }
-    if (!do_bind_property(priv->client, "menu_filename", object, "menu_filename")) {
+    if (!do_bind_property(snapshot, "menu_filename", object, "menu_filename")) {
         return;
     }
     gtk_widget_add_events(GTK_WIDGET(object), GDK_ALL_EVENTS_MASK);
@@ -895,6 +902,28 @@ task_icon_class_init(TaskIconClass* klass)
                      NULL, NULL,
                      g_cclosure_marshal_VOID__VOID,
                      G_TYPE_NONE, 0);
+    /*
+     The item is passed as a pointer, item-removed is also emitted while the
+     item is being destroyed.
+     */
+    _icon_signals[ITEM_ADDED] =
+        g_signal_new("item-added",
+                     G_OBJECT_CLASS_TYPE(obj_class),
+                     G_SIGNAL_RUN_LAST,
+                     G_STRUCT_OFFSET(TaskIconClass, item_added),
+                     NULL, NULL,
+                     g_cclosure_marshal_VOID__POINTER,
+                     G_TYPE_NONE, 1,
+                     G_TYPE_POINTER);
+    _icon_signals[ITEM_REMOVED] =
+        g_signal_new("item-removed",
+                     G_OBJECT_CLASS_TYPE(obj_class),
+                     G_SIGNAL_RUN_LAST,
+                     G_STRUCT_OFFSET(TaskIconClass, item_removed),
+                     NULL, NULL,
+                     g_cclosure_marshal_VOID__POINTER,
+                     G_TYPE_NONE, 1,
+                     G_TYPE_POINTER);
 
     g_type_class_add_private(obj_class, sizeof(TaskIconPrivate));
 }
@@ -1185,6 +1214,7 @@ _destroyed_task_item(TaskIcon* icon, TaskItem* old_item)
     priv = icon->priv;
 
     priv->items = g_slist_remove(priv->items, old_item);
+    g_signal_emit(icon, _icon_signals[ITEM_REMOVED], 0, old_item);
 
     if (old_item == priv->main_item && priv->items) {
         task_icon_search_main_item(icon, NULL);
@@ -1920,6 +1950,7 @@ task_icon_moving_item(TaskIcon* dest, TaskIcon* src, TaskItem* item)
                                          src);
 
     g_object_weak_unref(G_OBJECT(item), (GWeakNotify)_destroyed_task_item, src);
+    g_signal_emit(src, _icon_signals[ITEM_REMOVED], 0, item);
     task_icon_append_item(dest, item);
     g_object_unref(item);
 }
@@ -2003,6 +2034,7 @@ task_icon_append_item(TaskIcon*      icon,
 
     task_item_set_task_icon(item, icon);
     task_icon_refresh_visible(icon);
+    g_signal_emit(icon, _icon_signals[ITEM_ADDED], 0, item);
 
     /* Connect item signals */
     g_signal_connect(item, "visible-changed",
@@ -2657,6 +2689,7 @@ grouping_changed_cb(TaskManager* applet, gboolean grouping, TaskIcon* icon)
                                                          icon);
 
                     g_object_weak_unref(G_OBJECT(item), (GWeakNotify)_destroyed_task_item, icon);
+                    g_signal_emit(icon, _icon_signals[ITEM_REMOVED], 0, item);
                     task_icon_append_item(TASK_ICON(new_icon), TASK_ITEM(item));
                     task_manager_add_icon(TASK_MANAGER(priv->applet), TASK_ICON(new_icon));
                     g_object_unref(item);
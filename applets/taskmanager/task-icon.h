@@ -75,6 +75,8 @@ struct _TaskIconClass {
     void (*source_drag_end)(TaskIcon* icon);
     void (*dest_drag_motion)(TaskIcon* icon);
     void (*dest_drag_leave)(TaskIcon* icon);
+    void (*item_added)(TaskIcon* icon, struct _TaskItem* item);
+    void (*item_removed)(TaskIcon* icon, struct _TaskItem* item);
 };
 
 #ifdef __cplusplus
@@ -130,7 +130,6 @@ task_item_dispose(GObject* object)
 {
     TaskItem* item = TASK_ITEM(object);
     TaskItemPrivate* priv = TASK_ITEM_GET_PRIVATE(object);
-    GError*   err = NULL;
 
     if (priv->icon) {
         g_object_unref(priv->icon);
@@ -148,11 +147,10 @@ task_item_dispose(GObject* object)
     item->icon_overlay = NULL;
 
     if (priv->applet) {
-        desktop_agnostic_config_client_unbind_all_for_object(awn_config_get_default_for_applet(priv->applet, NULL), object, &err);
-        if (err) {
-            g_warning("%s: Failed to unbind_all: %s", __func__, err->message);
-            g_error_free(err);
-        }
+        awn_config_snapshot_unbind_all_for_object(
+            awn_config_snapshot_get(awn_config_get_default_for_applet(priv->applet, NULL),
+                                    DESKTOP_AGNOSTIC_CONFIG_GROUP_DEFAULT),
+            object);
         priv->applet = NULL;
     }
 
@@ -164,14 +162,12 @@ static void
 task_item_finalize(GObject* object)
 {
     TaskItemPrivate* priv = TASK_ITEM_GET_PRIVATE(object);
-    GError*   err = NULL;
 
     if (priv->applet) {
-        desktop_agnostic_config_client_unbind_all_for_object(awn_config_get_default_for_applet(priv->applet, NULL), object, &err);
-        if (err) {
-            g_warning("%s: Failed to unbind_all: %s", __func__, err->message);
-            g_error_free(err);
-        }
+        awn_config_snapshot_unbind_all_for_object(
+            awn_config_snapshot_get(awn_config_get_default_for_applet(priv->applet, NULL),
+                                    DESKTOP_AGNOSTIC_CONFIG_GROUP_DEFAULT),
+            object);
         priv->applet = NULL;
     }
     G_OBJECT_CLASS(task_item_parent_class)->finalize(object);
@@ -194,11 +190,10 @@ task_item_constructed(GObject* object)
 
     g_assert(priv->applet);
     client = awn_config_get_default_for_applet(priv->applet, &error);
-    desktop_agnostic_config_client_bind(client,
-                                        DESKTOP_AGNOSTIC_CONFIG_GROUP_DEFAULT,
-                                        "ignore_wm_client_name", object, "ignore_wm_client_name",
-                                        TRUE, DESKTOP_AGNOSTIC_CONFIG_BIND_METHOD_FALLBACK,
-                                        &error);
+    awn_config_snapshot_bind(awn_config_snapshot_get(client,
+                             DESKTOP_AGNOSTIC_CONFIG_GROUP_DEFAULT),
+                             "ignore_wm_client_name", object,
+                             "ignore_wm_client_name", &error);
     if (error) {
         g_warning("Could not bind property ignore_wm_client_name:%s", error->message);
         g_error_free(error);
@@ -640,6 +635,79 @@ task_item_update_overlay(TaskItem* item, const gchar* key, GValue* value)
     }
 }
 
+/* TRUE if overlay is active and its string property equals text */
+static gboolean
+_overlay_shows_string(AwnOverlay* overlay, const gchar* property,
+                      const gchar* text)
+{
+    gboolean active = FALSE;
+    gchar* current = NULL;
+    gboolean result;
+
+    g_object_get(G_OBJECT(overlay), "active", &active, property, &current, NULL);
+    result = active && g_strcmp0(current, text) == 0;
+    g_free(current);
+    return result;
+}
+
+/*
+ * Whether task_item_update_overlay() with key and value would leave the
+ * overlays as they are, going by their current state (whoever set it).
+ */
+gboolean
+task_item_overlay_has_value(TaskItem* item, const gchar* key,
+                            const GValue* value)
+{
+    g_return_val_if_fail(TASK_IS_ITEM(item), FALSE);
+
+    if (strcmp("icon-file", key) == 0 && G_VALUE_HOLDS_STRING(value)) {
+        const gchar* filename = g_value_get_string(value);
+        gboolean active = FALSE;
+
+        if (item->icon_overlay == NULL) {
+            return FALSE;
+        }
+        if (!filename || filename[0] == '\0') {
+            g_object_get(G_OBJECT(item->icon_overlay), "active", &active, NULL);
+            return !active;
+        }
+        return _overlay_shows_string(AWN_OVERLAY(item->icon_overlay),
+                                     "file-name", filename);
+    } else if (strcmp("progress", key) == 0 && G_VALUE_HOLDS_INT(value)) {
+        gboolean active = FALSE;
+        gdouble percent = 0.0;
+
+        if (item->progress_overlay == NULL) {
+            return FALSE;
+        }
+        g_object_get(G_OBJECT(item->progress_overlay), "active", &active,
+                     "percent-complete", &percent, NULL);
+        if (g_value_get_int(value) == -1) {
+            return !active;
+        }
+        return active && percent == g_value_get_int(value);
+    } else if ((strcmp("message", key) == 0 || strcmp("badge", key) == 0) &&
+               G_VALUE_HOLDS_STRING(value)) {
+        const gchar* text = g_value_get_string(value);
+        GdkGravity gravity = GDK_GRAVITY_CENTER;
+        gboolean active = FALSE;
+
+        if (item->text_overlay == NULL) {
+            return FALSE;
+        }
+        /* badges and messages share the overlay, told apart by gravity */
+        g_object_get(G_OBJECT(item->text_overlay), "active", &active,
+                     "gravity", &gravity, NULL);
+        if (!text || text[0] == '\0') {
+            return !active;
+        }
+        return (gravity == GDK_GRAVITY_NORTH_EAST) == (strcmp("badge", key) == 0) &&
+               _overlay_shows_string(AWN_OVERLAY(item->text_overlay),
+                                     "text", text);
+    }
+    return FALSE;
+}
+
 TaskIcon*
 task_item_get_task_icon(TaskItem* item)
 {
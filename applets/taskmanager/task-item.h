@@ -112,6 +112,10 @@ void          task_item_update_overlay(TaskItem* item,
                                        const gchar* key,
                                        GValue* value);
 
+gboolean      task_item_overlay_has_value(TaskItem* item,
+                                          const gchar* key,
+                                          const GValue* value);
+
 GtkWidget*    task_item_get_image_widget(TaskItem* item);
 
 //TODO: 2nd round: implement
@@ -210,12 +210,10 @@ task_launcher_constructed(GObject* object)
     priv->client = awn_config_get_default_for_applet(AWN_APPLET(applet), NULL);
 
     /* Connect up the important bits */
-    desktop_agnostic_config_client_bind(priv->client,
-                                        DESKTOP_AGNOSTIC_CONFIG_GROUP_DEFAULT,
-                                        "monitor_desktops",
-                                        object, "monitor-desktops", TRUE,
-                                        DESKTOP_AGNOSTIC_CONFIG_BIND_METHOD_FALLBACK,
-                                        NULL);
+    awn_config_snapshot_bind(awn_config_snapshot_get(priv->client,
+                             DESKTOP_AGNOSTIC_CONFIG_GROUP_DEFAULT),
+                             "monitor_desktops", object, "monitor-desktops",
+                             NULL);
 }
 
 
@@ -56,6 +56,7 @@ extern "C" {
 
 #include "task-drag-indicator.h"
 #include "task-icon.h"
+#include "task-icon-index.h"
 #include "task-settings.h"
 #include "xutils.h"
 #include "util.h"
@@ -85,6 +86,12 @@ static const GtkTargetEntry drop_types[] = {
 static const gint n_drop_types = G_N_ELEMENTS(drop_types);
 
 
+/* ms between intellihide evaluations while windows are moving */
+#define INTELLIHIDE_CHECK_INTERVAL 40
+
+/* first event code of the SHAPE extension, -1 if not queried yet */
+static int shape_event_base = -1;
+
 typedef struct {
     DesktopAgnosticConfigClient* panel_instance_client;
     GdkWindow* foreign_window;
@@ -92,6 +99,11 @@ typedef struct {
     TaskManagerPanelConnector* connector;
     gint        intellihide_mode;
     guint       autohide_cookie;
+    TaskManager* manager;
+    /*WnckWindows whose geometry meets foreign_region*/
+    GHashTable* overlapping;
+    /*panel moved or reshaped since foreign_region was fetched*/
+    gboolean    region_dirty;
 } TaskManagerAwnPanelInfo;
 
 struct _TaskManagerPrivate {
@@ -117,12 +129,14 @@ struct _TaskManagerPrivate {
 
     GHashTable* win_table;
     GHashTable* desktops_table;
+    /*xid, pid, wmclass and desktop -> icons, for the DockManager queries*/
+    TaskIconIndex* icon_index;
     GHashTable* intellihide_panel_instances;
+    /*windows that moved since the last intellihide evaluation*/
+    GHashTable* intellihide_dirty_windows;
+    guint       intellihide_check_id;
+    guint       panel_xid_wait_id;
 
-    /*
-     Used during grouping configuration changes for optimization purposes
-     */
-    GList* grouping_list;
     /* Properties */
     GValueArray* launcher_paths;
 
@@ -232,6 +246,8 @@ static void task_manager_active_workspace_changed_cb(WnckScreen*    screen,
 static void task_manager_check_for_intersection(TaskManager* manager,
         WnckWorkspace* space,
         WnckApplication* app);
+static void task_manager_queue_intersection_check(TaskManager* manager,
+        WnckWindow* moved);
 
 static void task_manager_win_geom_changed_cb(WnckWindow* window,
         TaskManager* manager);
@@ -412,12 +428,22 @@ task_manager_set_property(GObject*      object,
     }
 }
 
+static GdkFilterReturn _panel_window_filter(GdkXEvent* xevent, GdkEvent* event,
+        TaskManagerAwnPanelInfo* panel_info);
+
 static void
 _delete_panel_info_cb(TaskManagerAwnPanelInfo* panel_info)
 {
     g_object_unref(panel_info->connector);
-    g_object_unref(panel_info->foreign_window);
-    gdk_region_destroy(panel_info->foreign_region);
+    if (panel_info->foreign_window) {
+        gdk_window_remove_filter(panel_info->foreign_window,
+                                 (GdkFilterFunc)_panel_window_filter, panel_info);
+        g_object_unref(panel_info->foreign_window);
+    }
+    if (panel_info->foreign_region) {
+        gdk_region_destroy(panel_info->foreign_region);
+    }
+    g_hash_table_destroy(panel_info->overlapping);
     g_free(panel_info);
 }
 
@@ -432,6 +458,9 @@ _on_panel_added(DBusGProxy* proxy, guint panel_id, TaskManager* applet)
     g_assert(!g_hash_table_lookup(priv->intellihide_panel_instances, GINT_TO_POINTER(panel_id)));
     panel_info = g_malloc0(sizeof(TaskManagerAwnPanelInfo));
     panel_info->connector = task_manager_panel_connector_new(panel_id);
+    panel_info->manager = TASK_MANAGER(applet);
+    panel_info->overlapping = g_hash_table_new(g_direct_hash, g_direct_equal);
+    panel_info->region_dirty = TRUE;
     g_free(uid);
     panel_info->panel_instance_client = awn_config_get_default(panel_id, NULL);
     panel_info->intellihide_mode = desktop_agnostic_config_client_get_int(
@@ -521,6 +550,8 @@ task_manager_constructed(GObject* object)
     priv->intellihide_panel_instances = g_hash_table_new_full(g_direct_hash, g_direct_equal,
                                         NULL,
                                         (GDestroyNotify)_delete_panel_info_cb);
+    priv->intellihide_dirty_windows = g_hash_table_new(g_direct_hash, g_direct_equal);
+    priv->icon_index = task_icon_index_new();
 
     priv->client = awn_config_get_default_for_applet(AWN_APPLET(object), NULL);
 
@@ -900,6 +931,22 @@ task_manager_dispose(GObject* object)
     desktop_agnostic_config_client_unbind_all_for_object(priv->client,
             object,
             NULL);
+    if (priv->intellihide_check_id) {
+        g_source_remove(priv->intellihide_check_id);
+        priv->intellihide_check_id = 0;
+    }
+    if (priv->intellihide_dirty_windows) {
+        g_hash_table_destroy(priv->intellihide_dirty_windows);
+        priv->intellihide_dirty_windows = NULL;
+    }
+    if (priv->panel_xid_wait_id) {
+        g_source_remove(priv->panel_xid_wait_id);
+        priv->panel_xid_wait_id = 0;
+    }
+    if (priv->icon_index) {
+        task_icon_index_free(priv->icon_index);
+        priv->icon_index = NULL;
+    }
     if (priv->connection) {
         if (priv->proxy) {
             g_object_unref(priv->proxy);
@@ -1095,6 +1142,9 @@ on_active_window_changed(WnckScreen*    screen,
  * When the property 'show_all_windows' is False,
  * workspace switches are monitored. Whenever one happens
  * all TaskWindows are notified.
+ * The icons shown and hidden meanwhile only queue resizes, GTK negotiates
+ * the size once for all of them (bench-awn's workspace-switch counts the
+ * icon box allocations).
  */
 static void
 on_workspace_changed(TaskManager* manager)  /*... has more arguments*/
@@ -1241,6 +1291,9 @@ window_closed(TaskManager* manager, GObject* old_item)
     g_return_if_fail(TASK_IS_MANAGER(manager));
     priv = manager->priv;
     priv->windows = g_slist_remove(priv->windows, old_item);
+    if (priv->icon_index) {
+        task_icon_index_remove_item(priv->icon_index, TASK_ITEM(old_item));
+    }
 }
 
 /*
@@ -1258,6 +1311,78 @@ icon_closed(TaskManager* manager, GObject* old_icon)
 
     priv = manager->priv;
     priv->icons = g_slist_remove(priv->icons, old_icon);
+    if (priv->icon_index) {
+        task_icon_index_remove_icon(priv->icon_index, TASK_ICON(old_icon));
+    }
+}
+
+static void
+on_icon_item_added(TaskManager* manager, TaskItem* item, TaskIcon* icon)
+{
+    TaskManagerPrivate* priv = manager->priv;
+
+    if (priv->icon_index) {
+        task_icon_index_add_item(priv->icon_index, icon, item);
+    }
+}
+
+static void
+on_icon_item_removed(TaskManager* manager, TaskItem* item, TaskIcon* icon)
+{
+    TaskManagerPrivate* priv = manager->priv;
+
+    if (priv->icon_index) {
+        task_icon_index_remove_item(priv->icon_index, item);
+    }
+}
+
+static void
+on_window_class_changed(WnckWindow* window, TaskManager* manager)
+{
+    TaskManagerPrivate* priv = manager->priv;
+    TaskWindow* item = g_object_get_qdata(G_OBJECT(window), win_quark);
+
+    if (priv->icon_index && item) {
+        task_icon_index_update_item(priv->icon_index, TASK_ITEM(item));
+    }
+}
+
+static void
+on_window_grouping_keys_changed(TaskWindow* item, TaskManager* manager)
+{
+    TaskManagerPrivate* priv = manager->priv;
+
+    if (priv->icon_index) {
+        task_icon_index_update_item(priv->icon_index, TASK_ITEM(item));
+    }
+}
+
+static void
+on_window_pid_changed(TaskWindow* item, TaskManager* manager)
+{
+    TaskManagerPrivate* priv = manager->priv;
+
+    if (priv->icon_index) {
+        task_icon_index_update_item(priv->icon_index, TASK_ITEM(item));
+    }
+}
+
+/*
+ Starts following the items of an icon that joined priv->icons, indexing
+ the ones it already has.
+ */
+static void
+task_manager_index_icon(TaskManager* manager, TaskIcon* icon)
+{
+    TaskManagerPrivate* priv = manager->priv;
+
+    for (GSList* i = task_icon_get_items(icon); i; i = i->next) {
+        task_icon_index_add_item(priv->icon_index, icon, i->data);
+    }
+    g_signal_connect_swapped(icon, "item-added",
+                             G_CALLBACK(on_icon_item_added), manager);
+    g_signal_connect_swapped(icon, "item-removed",
+                             G_CALLBACK(on_icon_item_removed), manager);
 }
 
 
@@ -1315,6 +1440,7 @@ task_manager_add_icon(TaskManager* manager, TaskIcon* icon)
     }
 
     g_object_weak_ref(G_OBJECT(icon), (GWeakNotify)icon_closed, manager);
+    task_manager_index_icon(manager, icon);
     g_signal_connect_swapped(icon,
                              "visible-changed",
                              G_CALLBACK(on_icon_visible_changed),
@@ -1400,7 +1526,8 @@ task_manager_find_window(TaskManager* manager, WnckWindow* window)
 }
 
 
-static const gchar*
+/* Returns the desktop file of item's window, free it with g_free() */
+static gchar*
 search_for_desktop(TaskIcon* icon, TaskItem* item, gboolean thorough)
 {
     /* grab the class name.
@@ -1409,7 +1536,7 @@ search_for_desktop(TaskIcon* icon, TaskItem* item, gboolean thorough)
      launcher into the the dialog.
     */
     gchar* id = NULL;
-    const gchar* found_desktop = NULL;
+    gchar* found_desktop = NULL;
     TaskManager* manager;
     TaskManagerPrivate* priv;
     WnckWindow* win;
@@ -1448,7 +1575,7 @@ search_for_desktop(TaskIcon* icon, TaskItem* item, gboolean thorough)
 static void
 window_name_changed_cb(TaskWindow* item, const gchar* name, TaskIcon* icon)
 {
-    const gchar* found_desktop = NULL;
+    gchar* found_desktop = NULL;
 
     g_return_if_fail(TASK_IS_WINDOW(item));
     g_return_if_fail(TASK_IS_ICON(icon));
@@ -1465,6 +1592,46 @@ window_name_changed_cb(TaskWindow* item, const gchar* name, TaskIcon* icon)
             }
         }
     }
+    g_free(found_desktop);
+}
+
+/*
+ The icons a new window can match: those sharing a grouping key bucket with
+ it, and the launcher icons, whose desktop file matching isn't keyed.  In
+ panel order, so ties go to the same icon as scoring every icon would.
+ */
+static GSList*
+_grouping_candidates(TaskManager* manager, TaskItem* item)
+{
+    TaskManagerPrivate* priv = manager->priv;
+    GHashTable* keyed = g_hash_table_new(g_direct_hash, g_direct_equal);
+    GSList* candidates = NULL;
+
+    if (TASK_IS_WINDOW(item)) {
+        const gchar* const* keys = task_window_get_grouping_keys(TASK_WINDOW(item));
+
+        for (; keys && *keys; keys++) {
+            GHashTable* set = task_icon_index_lookup_grouping_key(priv->icon_index, *keys);
+            GHashTableIter iter;
+            gpointer icon;
+
+            if (!set) {
+                continue;
+            }
+            g_hash_table_iter_init(&iter, set);
+            while (g_hash_table_iter_next(&iter, &icon, NULL)) {
+                g_hash_table_insert(keyed, icon, icon);
+            }
+        }
+    }
+    for (GSList* i = priv->icons; i; i = i->next) {
+        if (g_hash_table_lookup(keyed, i->data) || task_icon_contains_launcher(i->data)) {
+            candidates = g_slist_prepend(candidates, i->data);
+        }
+    }
+    g_hash_table_destroy(keyed);
+
+    return g_slist_reverse(candidates);
 }
 
 static void
@@ -1479,10 +1646,11 @@ process_window_opened(WnckWindow*    window,
     TaskItem*           item;
     WnckWindowType      type;
     GSList*             w;
+    GSList*             candidates;
     TaskIcon* match      = NULL;
     gint match_score     = 0;
     gint max_match_score = 0;
-    const gchar*         found_desktop = NULL;
+    gchar*               found_desktop = NULL;
     TaskIcon*            containing_icon = NULL;
 
     g_return_if_fail(TASK_IS_MANAGER(manager));
@@ -1510,6 +1678,7 @@ process_window_opened(WnckWindow*    window,
                      G_CALLBACK(task_manager_win_geom_changed_cb), manager);
     g_signal_connect(window, "state-changed",
                      G_CALLBACK(task_manager_win_state_changed_cb), manager);
+    task_manager_queue_intersection_check(manager, window);
     switch (type) {
     case WNCK_WINDOW_DESKTOP:
     case WNCK_WINDOW_DOCK:
@@ -1543,12 +1712,19 @@ process_window_opened(WnckWindow*    window,
     /* create a new TaskWindow containing the WnckWindow*/
     item = task_window_new(AWN_APPLET(manager), NULL, window);
     g_object_set_qdata(G_OBJECT(window), win_quark, TASK_WINDOW(item));
+    g_signal_connect(window, "class-changed",
+                     G_CALLBACK(on_window_class_changed), manager);
+    g_signal_connect(item, "grouping-keys-changed",
+                     G_CALLBACK(on_window_grouping_keys_changed), manager);
+    g_signal_connect(item, "pid-changed",
+                     G_CALLBACK(on_window_pid_changed), manager);
 
     priv->windows = g_slist_append(priv->windows, item);
     g_object_weak_ref(G_OBJECT(item), (GWeakNotify)window_closed, manager);
 
     /* see if there is a icon that matches*/
-    for (w = priv->icons; w; w = w->next) {
+    candidates = _grouping_candidates(manager, item);
+    for (w = candidates; w; w = w->next) {
         TaskIcon* taskicon = w->data;
 
 #ifdef DEBUG
@@ -1574,6 +1750,7 @@ process_window_opened(WnckWindow*    window,
             match = taskicon;
         }
     }
+    g_slist_free(candidates);
 #ifdef DEBUG
     g_debug("Matching score: %i, must be bigger then:%i, groups: %i", max_match_score, 99 - priv->match_strength, max_match_score > 99 - priv->match_strength);
 #endif
@@ -1632,6 +1809,7 @@ process_window_opened(WnckWindow*    window,
         if (!found_desktop) {
             g_signal_connect(item, "name-changed", G_CALLBACK(window_name_changed_cb), icon);
         }
+        g_free(found_desktop);
         task_manager_add_icon(manager, TASK_ICON(icon));
     }
 }
@@ -1685,6 +1863,10 @@ on_window_opened(WnckScreen*    screen,
         return;
     }
 
+    /* wnck announces a batch of new windows one by one, the first of them
+     requests the properties of all */
+    xutils_prefetch_window_properties(wnck_screen_get_windows(manager->priv->screen));
+
     _wnck_get_wmclass(wnck_window_get_xid(window),
                       &res_name, &class_name);
     if (g_strcmp0(res_name, "awn-applet") != 0) {
@@ -1802,6 +1984,13 @@ task_manager_remove_task_icon(TaskManager*  manager, GtkWidget* icon)
     priv = manager->priv;
 
     priv->icons = g_slist_remove(priv->icons, icon);
+    g_signal_handlers_disconnect_by_func(icon, (gpointer)on_icon_item_added,
+                                         manager);
+    g_signal_handlers_disconnect_by_func(icon, (gpointer)on_icon_item_removed,
+                                         manager);
+    if (priv->icon_index) {
+        task_icon_index_remove_icon(priv->icon_index, TASK_ICON(icon));
+    }
 }
 
 void
@@ -1937,6 +2126,7 @@ task_manager_refresh_launcher_paths(TaskManager* manager, GValueArray* list)
                     priv->icons = g_slist_insert(priv->icons, icon, idx);
 
                     g_object_weak_ref(G_OBJECT(icon), (GWeakNotify)icon_closed, manager);
+                    task_manager_index_icon(manager, TASK_ICON(icon));
                     g_signal_connect_swapped(icon,
                                              "visible-changed",
                                              G_CALLBACK(on_icon_visible_changed),
@@ -2036,179 +2226,193 @@ task_manager_set_drag_and_drop(TaskManager* manager,
     }
 }
 
+/*
+ Moves the window items of src into dest, src's launcher stays behind.
+ */
 static void
-task_manager_regroup_launcher_icon(TaskManager* manager, TaskIcon* grouping_icon)
+task_manager_merge_icon(TaskIcon* dest, TaskIcon* src)
 {
-    g_assert(TASK_IS_ICON(grouping_icon));
-    g_assert(TASK_IS_MANAGER(manager));
+    GSList* items = g_slist_copy(task_icon_get_items(src));
 
-    GSList* i;
-    GSList* j;
-    TaskManagerPrivate* priv = manager->priv;
-    GtkWidget* grouping_launcher = GTK_WIDGET(task_icon_get_launcher(grouping_icon));
-
-    g_assert(grouping_launcher);
-    for (i = task_icon_get_items(grouping_icon); i; i = i->next) {
-        TaskItem* item = i->data;
-        if (TASK_IS_LAUNCHER(item)) {
-            continue;
-        }
-        if (g_list_find(priv->grouping_list, item)) {
-            continue;
+    for (GSList* i = items; i; i = i->next) {
+        if (!TASK_IS_LAUNCHER(i->data)) {
+            task_icon_moving_item(dest, src, i->data);
         }
-        priv->grouping_list = g_list_prepend(priv->grouping_list, item);
     }
-    for (i = priv->icons; i; i = i->next) {
-        GtkWidget* launcher;
-        TaskIcon*   icon;
-        icon = i->data;
-        if (icon == grouping_icon) {
+    g_slist_free(items);
+}
+
+/*
+ Launcher icons are bucketed by desktop file.  The window items of the
+ ephemeral ones go to the first permanent launcher of their bucket, or to
+ the first ephemeral one when there is none.
+ */
+static void
+task_manager_regroup_launcher_icons(TaskManager* manager)
+{
+    TaskManagerPrivate* priv = manager->priv;
+    GHashTable* buckets = g_hash_table_new(g_str_hash, g_str_equal);
+    GSList* ephemeral = NULL;
+
+    for (GSList* i = priv->icons; i; i = i->next) {
+        TaskIcon* icon = i->data;
+        const TaskItem* launcher = task_icon_get_launcher(icon);
+        const gchar* path;
+        TaskIcon* target;
+
+        if (!launcher) {
             continue;
         }
-        launcher = GTK_WIDGET(task_icon_get_launcher(icon));
-        if (!launcher) { /* no launcher...  need to do matches on these eventually TODO */
+        path = task_launcher_get_desktop_path(TASK_LAUNCHER(launcher));
+        if (!path) {
             continue;
         }
-        /* Is i an existing permanent launcher... if so then ignore.*/
-        else if (!task_icon_is_ephemeral(icon)) {
-            continue;
+        target = g_hash_table_lookup(buckets, path);
+        if (task_icon_is_ephemeral(icon)) {
+            ephemeral = g_slist_prepend(ephemeral, icon);
+            if (!target) {
+                g_hash_table_insert(buckets, (gpointer)path, icon);
+            }
+        } else if (!target || task_icon_is_ephemeral(target)) {
+            g_hash_table_insert(buckets, (gpointer)path, icon);
         }
-        /*ok... non-permanent launcher check if the desktop file paths match.*/
-        if (g_strcmp0(task_launcher_get_desktop_path(TASK_LAUNCHER(grouping_launcher)),
-                      task_launcher_get_desktop_path(TASK_LAUNCHER(launcher))) == 0) {
-            for (j = task_icon_get_items(icon); j; j ? j = j->next : j) {
+    }
 
-                TaskItem* item = j->data;
-                if (TASK_IS_LAUNCHER(item)) {
-                    continue;
-                }
-                if (g_list_find(priv->grouping_list, item)) {
-                    continue;
-                }
-                task_icon_moving_item(grouping_icon, icon, item);
-                priv->grouping_list = g_list_prepend(priv->grouping_list, item);
-                j = task_icon_get_items(icon);
-            }
+    ephemeral = g_slist_reverse(ephemeral);
+    for (GSList* i = ephemeral; i; i = i->next) {
+        TaskIcon* icon = i->data;
+        const TaskItem* launcher = task_icon_get_launcher(icon);
+        TaskIcon* target;
+
+        target = g_hash_table_lookup(buckets,
+                                     task_launcher_get_desktop_path(TASK_LAUNCHER(launcher)));
+        if (target && target != icon) {
+            task_manager_merge_icon(target, icon);
         }
     }
+    g_slist_free(ephemeral);
+    g_hash_table_destroy(buckets);
 }
 
-static void
-task_manager_regroup_nonlauncher_icon(TaskManager* manager, TaskIcon* grouping_icon)
+/*
+ The icon without a launcher scoring highest on item, the first in panel
+ order on ties, like scoring every icon would give.
+ */
+static TaskIcon*
+_best_nonlauncher_match(TaskManager* manager, TaskItem* item, guint* max_score)
 {
-    g_assert(TASK_IS_ICON(grouping_icon));
-    g_assert(TASK_IS_MANAGER(manager));
+    GSList* candidates = _grouping_candidates(manager, item);
+    TaskIcon* match = NULL;
 
-    GSList* i;
-    GSList* j;
-    GSList* w;
-    GSList* k;
-    TaskManagerPrivate* priv = manager->priv;
-    for (i = task_icon_get_items(grouping_icon); i; i = i->next) {
-        TaskItem* item = i->data;
-        if (g_list_find(priv->grouping_list, item)) {
+    *max_score = 0;
+    for (GSList* c = candidates; c; c = c->next) {
+        guint score;
+
+        if (task_icon_contains_launcher(c->data)) {
             continue;
         }
-        priv->grouping_list = g_list_prepend(priv->grouping_list, item);
+        score = task_icon_match_item(c->data, item);
+        if (score > *max_score) {
+            *max_score = score;
+            match = c->data;
+        }
     }
+    g_slist_free(candidates);
 
-    for (i = priv->icons; i; i = i->next) {
-        TaskIcon*   icon;
-        icon = i->data;
-        if (icon == grouping_icon) {
+    return match;
+}
+
+/*
+ Merges the icons without a launcher that hold matching windows.  Only the
+ icons sharing a grouping key bucket with a window can match it, so each
+ window is scored against those instead of against every icon.  Icons are
+ taken in panel order and absorb the later ones holding a window they are
+ the best match for, windows they gain are matched in turn.
+ */
+static void
+task_manager_regroup_nonlauncher_icons(TaskManager* manager)
+{
+    TaskManagerPrivate* priv = manager->priv;
+    GHashTable* merged = g_hash_table_new(g_direct_hash, g_direct_equal);
+    GQueue pending = G_QUEUE_INIT;
+
+    for (GSList* i = priv->icons; i; i = i->next) {
+        TaskIcon* grouping_icon = i->data;
+
+        if (g_hash_table_lookup(merged, grouping_icon) ||
+                task_icon_contains_launcher(grouping_icon)) {
             continue;
         }
-        if (task_icon_contains_launcher(icon)) {
-            continue;
+        g_hash_table_insert(merged, grouping_icon, grouping_icon);
+
+        for (GSList* j = task_icon_get_items(grouping_icon); j; j = j->next) {
+            g_queue_push_tail(&pending, j->data);
         }
-        for (j = task_icon_get_items(icon); j; j ? j = j->next : j) {
-            gint match_score = 0;
-            gint max_match_score = 0;
-            TaskIcon* match = NULL;
-            TaskItem* item = j->data;
-            if (g_list_find(priv->grouping_list, item)) {
+        while (!g_queue_is_empty(&pending)) {
+            TaskItem* item = g_queue_pop_head(&pending);
+            const gchar* const* keys;
+            GSList* candidates = NULL;
+
+            if (!TASK_IS_WINDOW(item)) {
                 continue;
             }
-            for (w = priv->icons; w; w = w->next) {
-                TaskIcon* taskicon = w->data;
-                /*optimization....  if the icon we're checking against has a launcher
-                 then the item would have been grouped with it on open if it could have
-                 been*/
-                if (task_icon_contains_launcher(taskicon)) {
+            /* the buckets change under us as items move, take a copy */
+            for (keys = task_window_get_grouping_keys(TASK_WINDOW(item)); *keys; keys++) {
+                GHashTable* set = task_icon_index_lookup_grouping_key(priv->icon_index, *keys);
+                GHashTableIter iter;
+                gpointer icon;
+
+                if (!set) {
                     continue;
                 }
-                match_score = task_icon_match_item(taskicon, item);
-                if (match_score > max_match_score) {
-                    max_match_score = match_score;
-                    match = taskicon;
+                g_hash_table_iter_init(&iter, set);
+                while (g_hash_table_iter_next(&iter, &icon, NULL)) {
+                    if (!g_hash_table_lookup(merged, icon) &&
+                            !g_slist_find(candidates, icon)) {
+                        candidates = g_slist_prepend(candidates, icon);
+                    }
                 }
             }
-            if (
-                match && (match == grouping_icon)
-                &&
-                (priv->grouping || ((task_icon_count_items(match) == 1) && (task_icon_contains_launcher(match))))
-                &&
-                (max_match_score > 99 - priv->match_strength)) {
-                /*we have one match in this icon.  dump all the other items in also and
-                 get the hell out of the inner loop.  3 nested loops nasty... short
-                 circuiting as much as possible*/
-                task_icon_moving_item(grouping_icon, icon, item);
-                priv->grouping_list = g_list_prepend(priv->grouping_list, item);
-                for (k = task_icon_get_items(icon); k; k = k->next) {
-                    if (g_list_find(priv->grouping_list, k->data)) {
-                        continue;
+
+            for (GSList* c = candidates; c; c = c->next) {
+                TaskIcon* icon = c->data;
+
+                if (g_hash_table_lookup(merged, icon) ||
+                        task_icon_contains_launcher(icon)) {
+                    continue;
+                }
+                for (GSList* k = task_icon_get_items(icon); k; k = k->next) {
+                    guint max_score;
+
+                    if (_best_nonlauncher_match(manager, k->data, &max_score) == grouping_icon &&
+                            max_score > (guint)(99 - priv->match_strength)) {
+                        GSList* moved = g_slist_copy(task_icon_get_items(icon));
+
+                        g_hash_table_insert(merged, icon, icon);
+                        task_manager_merge_icon(grouping_icon, icon);
+                        for (GSList* m = moved; m; m = m->next) {
+                            g_queue_push_tail(&pending, m->data);
+                        }
+                        g_slist_free(moved);
+                        break;
                     }
-                    task_icon_moving_item(grouping_icon, icon, k->data);
-                    priv->grouping_list = g_list_prepend(priv->grouping_list, k->data);
                 }
-                j = NULL;
             }
+            g_slist_free(candidates);
         }
     }
+    g_hash_table_destroy(merged);
 }
 
+/*
+ Regrouping only runs when grouping gets switched on, launchers first so
+ windows end up with their desktop file where possible.
+ */
 static void
 task_manager_regroup(TaskManager* manager)
 {
-    GSList* i;
-
-    TaskManagerPrivate* priv = manager->priv;
-    /*
-     find the permanent Launchers and regroup them*/
-    for (i = priv->icons; i; i = i->next) {
-        GtkWidget* launcher;
-        TaskIcon*   icon;
-        icon = i->data;
-        launcher = GTK_WIDGET(task_icon_get_launcher(icon));
-
-        if (launcher) {
-            task_manager_regroup_launcher_icon(manager, icon);
-        }
-    }
-
-    /* Find the ephemeral launchers and regroup them */
-    for (i = priv->icons; i; i = i->next) {
-        GtkWidget* launcher;
-        TaskIcon*   icon;
-        icon = i->data;
-        launcher = GTK_WIDGET(task_icon_get_launcher(icon));
-        if (launcher) {
-            task_manager_regroup_launcher_icon(manager, icon);
-        }
-    }
-    /* Find the icons that do not have a launcher. */
-    for (i = priv->icons; i; i = i->next) {
-        TaskIcon*   icon;
-        icon = i->data;
-        if (!task_icon_contains_launcher(icon)) {
-            GSList* items = task_icon_get_items(icon);
-            if (items) {
-                task_manager_regroup_nonlauncher_icon(manager, icon);
-            }
-        }
-    }
-    g_list_free(priv->grouping_list);
-    priv->grouping_list = NULL;
+    task_manager_regroup_launcher_icons(manager);
+    task_manager_regroup_nonlauncher_icons(manager);
 }
 
 static void
@@ -2238,6 +2442,33 @@ task_manager_get_icons(TaskManager* manager)
     return priv->icons;
 }
 
+TaskIconIndex*
+task_manager_get_icon_index(TaskManager* manager)
+{
+    g_return_val_if_fail(TASK_IS_MANAGER(manager), NULL);
+
+    return manager->priv->icon_index;
+}
+
+/*
+ The icons of priv->icons that are in set, in panel order.
+ */
+static GSList*
+_icons_in_set(TaskManager* manager, GHashTable* set)
+{
+    GSList* l = NULL;
+
+    if (!set) {
+        return NULL;
+    }
+    for (GSList* i = manager->priv->icons; i; i = i->next) {
+        if (g_hash_table_lookup(set, i->data)) {
+            l = g_slist_prepend(l, i->data);
+        }
+    }
+    return g_slist_reverse(l);
+}
+
 /*
  Returns a list of TaskIcons that have a matching resource or class name.
  The caller owns the list and should free it with g_slist_free ().  The caller
@@ -2249,33 +2480,8 @@ task_manager_get_icons_by_wmclass(TaskManager* manager, const gchar* name)
 {
     g_return_val_if_fail(TASK_IS_MANAGER(manager), NULL);
 
-    GSList* l = NULL;
-    GSList* i;
-    GSList* j;
-    TaskManagerPrivate* priv = manager->priv;
-
-    for (i = priv->icons; i ; i = i->next) {
-        GSList* items = task_icon_get_items(i->data);
-        for (j = items; j ; j = j->next) {
-            WnckWindow* win;
-            gchar* res_name = NULL;
-            gchar* class_name = NULL;
-            if (!TASK_IS_WINDOW(j->data)) {
-                continue;
-            }
-            win = task_window_get_window(j->data);
-            _wnck_get_wmclass(wnck_window_get_xid(win), &res_name, &class_name);
-            if ((g_strcmp0(res_name, name) == 0) || (g_strcmp0(class_name, name) == 0)) {
-                l = g_slist_append(l, i->data);
-                g_free(res_name);
-                g_free(class_name);
-                break;
-            }
-            g_free(res_name);
-            g_free(class_name);
-        }
-    }
-    return l;
+    return _icons_in_set(manager,
+                         task_icon_index_lookup_wmclass(manager->priv->icon_index, name));
 }
 
 /*
@@ -2289,17 +2495,18 @@ task_manager_get_icons_by_desktop(TaskManager* manager, const gchar* desktop)
 {
     g_return_val_if_fail(TASK_IS_MANAGER(manager), NULL);
 
-    TaskManagerPrivate* priv;
-    priv = manager->priv;
-    GSList* l = NULL;
+    GSList* l = _icons_in_set(manager,
+                              task_icon_index_lookup_desktop(manager->priv->icon_index, desktop));
 
-    for (GSList* i = priv->icons; i ; i = i->next) {
+    /* the index only knows file names */
+    for (GSList* i = l; i;) {
+        GSList* next = i->next;
         const TaskItem* launcher = task_icon_get_launcher(i->data);
-        if (launcher) {
-            if (g_strcmp0(desktop, task_launcher_get_desktop_path(TASK_LAUNCHER(launcher))) == 0) {
-                l = g_slist_append(l, i->data);
-            }
+        if (!launcher ||
+                g_strcmp0(desktop, task_launcher_get_desktop_path(TASK_LAUNCHER(launcher))) != 0) {
+            l = g_slist_delete_link(l, i);
         }
+        i = next;
     }
     return l;
 }
@@ -2316,26 +2523,8 @@ task_manager_get_icons_by_pid(TaskManager* manager, int pid)
     g_return_val_if_fail(TASK_IS_MANAGER(manager), NULL);
     g_return_val_if_fail(pid, NULL);
 
-    TaskManagerPrivate* priv;
-    priv = manager->priv;
-    GSList* l = NULL;
-
-    for (GSList* i = priv->icons; i ; i = i->next) {
-        GSList* items = task_icon_get_items(i->data);
-        for (GSList* j = items; j ; j = j->next) {
-            /*
-             Look through all the items in the TaskIcon.  In most cases it's going
-             to be a shared PID but not all so we need to check all the windows*/
-            if (!TASK_IS_WINDOW(j->data)) {
-                continue;
-            }
-            if (task_window_get_pid(j->data) == pid) {
-                l = g_slist_append(l, i->data);
-                break;
-            }
-        }
-    }
-    return l;
+    return _icons_in_set(manager,
+                         task_icon_index_lookup_pid(manager->priv->icon_index, pid));
 }
 /*
  Returns the TaskIcon that contains a TaskWindow with a matching xid.
@@ -2346,24 +2535,7 @@ task_manager_get_icon_by_xid(TaskManager* manager, gint64 xid)
     g_return_val_if_fail(TASK_IS_MANAGER(manager), NULL);
     g_return_val_if_fail(xid, NULL);
 
-    TaskManagerPrivate* priv;
-    priv = manager->priv;
-
-    for (GSList* i = priv->icons; i ; i = i->next) {
-        GSList* items = task_icon_get_items(i->data);
-        for (GSList* j = items; j ; j = j->next) {
-            /*
-             Look through all the items in the TaskIcon for our XID.  There should
-             only be one instance*/
-            if (!TASK_IS_WINDOW(j->data)) {
-                continue;
-            }
-            if ((gint64)task_window_get_xid(j->data) == xid) {
-                return i->data;
-            }
-        }
-    }
-    return NULL;
+    return task_icon_index_lookup_xid(manager->priv->icon_index, (gulong)xid);
 }
 /**
  * D-BUS functionality
@@ -2496,24 +2668,51 @@ xutils_get_input_shape(GdkWindow* window)
     return region;
 }
 
+static gboolean
+_window_overlaps_panel(TaskManagerAwnPanelInfo* panel_info, WnckWindow* window)
+{
+    GdkRectangle win_rect;
+
+    if (!panel_info->foreign_region) {
+        return FALSE;
+    }
+    /*
+     It may be a good idea to go the same route as we go with the
+     panel to get the GdkRectangle.  But in practice it's _probably_
+     not necessary
+     */
+    wnck_window_get_geometry(window, &win_rect.x,
+                             &win_rect.y, &win_rect.width,
+                             &win_rect.height);
+    return gdk_region_rect_in(panel_info->foreign_region, &win_rect) !=
+           GDK_OVERLAP_RECTANGLE_OUT;
+}
+
 static void
-task_manager_check_for_panel_instance_intersection(TaskManager* manager,
-        TaskManagerAwnPanelInfo* panel_info,
-        WnckWorkspace* space,
-        WnckApplication* app)
+task_manager_panel_instance_update_window(TaskManagerAwnPanelInfo* panel_info,
+        WnckWindow* window)
 {
-    TaskManagerPrivate*  priv;
-    GList* windows;
-    GList* iter;
-    gboolean  intersect = FALSE;
+    if (_window_overlaps_panel(panel_info, window)) {
+        g_hash_table_insert(panel_info->overlapping, window, window);
+    } else {
+        g_hash_table_remove(panel_info->overlapping, window);
+    }
+}
+
+/*
+ Refetches the panel position and input shape and redoes the geometry test
+ for every window.  Only needed when the panel told us its shape or
+ position changed (see _panel_window_filter).
+ */
+static void
+task_manager_panel_instance_update_region(TaskManager* manager,
+        TaskManagerAwnPanelInfo* panel_info)
+{
+    TaskManagerPrivate*  priv = manager->priv;
     GdkRectangle awn_rect;
     GdkRegion* updated_region;
-    g_return_if_fail(TASK_IS_MANAGER(manager));
-    priv = manager->priv;
 
     gdk_error_trap_push();
-
-    gdk_window_get_position(panel_info->foreign_window, &awn_rect.x, &awn_rect.y);
     gdk_drawable_get_size(panel_info->foreign_window, &awn_rect.width, &awn_rect.height);
     /*
      gdk_window_get_geometry gives us an x,y or 0,0
@@ -2526,6 +2725,7 @@ task_manager_check_for_panel_instance_intersection(TaskManager* manager,
      region.
      */
     updated_region = xutils_get_input_shape(panel_info->foreign_window);
+    gdk_error_trap_pop();
     g_return_if_fail(updated_region);
     if (gdk_region_empty(updated_region)) {
         gdk_region_destroy(updated_region);
@@ -2536,64 +2736,119 @@ task_manager_check_for_panel_instance_intersection(TaskManager* manager,
         panel_info->foreign_region = updated_region;
         gdk_region_offset(panel_info->foreign_region, awn_rect.x, awn_rect.y);
     }
+    panel_info->region_dirty = FALSE;
 
-    /*
-     Get the list of windows to check for intersection
-     */
-    switch (panel_info->intellihide_mode) {
-    case INTELLIHIDE_WORKSPACE:
-        windows = wnck_screen_get_windows(priv->screen);
-        break;
-    case INTELLIHIDE_GROUP:  /*TODO... Implement this for now same as app*/
-    case INTELLIHIDE_APP:
-    default:
-        if (app) {
-            windows = wnck_application_get_windows(app);
-        } else {
-            windows = wnck_screen_get_windows(priv->screen);
+    g_hash_table_remove_all(panel_info->overlapping);
+    for (GList* iter = wnck_screen_get_windows(priv->screen); iter; iter = iter->next) {
+        task_manager_panel_instance_update_window(panel_info, iter->data);
+    }
+}
+
+static GdkFilterReturn
+_panel_window_filter(GdkXEvent* xevent, GdkEvent* event,
+                     TaskManagerAwnPanelInfo* panel_info)
+{
+    XEvent* xev = (XEvent*)xevent;
+
+    if (xev->type == ConfigureNotify ||
+            (shape_event_base >= 0 && xev->type == shape_event_base + ShapeNotify)) {
+        panel_info->region_dirty = TRUE;
+        task_manager_queue_intersection_check(panel_info->manager, NULL);
+    }
+    return GDK_FILTER_CONTINUE;
+}
+
+/*
+ Ask the X server to tell us when the panel moves or changes its input
+ shape, so we don't have to go fetch it every time a window moves.
+ */
+static void
+task_manager_panel_instance_watch(TaskManagerAwnPanelInfo* panel_info)
+{
+    GdkWindow* window = panel_info->foreign_window;
+    int error_base;
+
+    g_return_if_fail(window);
+
+    if (shape_event_base == -1) {
+        if (!XShapeQueryExtension(GDK_WINDOW_XDISPLAY(window), &shape_event_base, &error_base)) {
+            shape_event_base = -2;
+        }
+    }
+    gdk_error_trap_push();
+    if (shape_event_base >= 0) {
+        XShapeSelectInput(GDK_WINDOW_XDISPLAY(window), GDK_WINDOW_XID(window),
+                          ShapeNotifyMask);
+    }
+    gdk_window_set_events(window, (GdkEventMask)(gdk_window_get_events(window) | GDK_STRUCTURE_MASK));
+    gdk_error_trap_pop();
+    gdk_window_add_filter(window, (GdkFilterFunc)_panel_window_filter, panel_info);
+    panel_info->region_dirty = TRUE;
+}
+
+static void
+task_manager_check_for_panel_instance_intersection(TaskManager* manager,
+        TaskManagerAwnPanelInfo* panel_info,
+        WnckWorkspace* space,
+        WnckApplication* app)
+{
+    TaskManagerPrivate*  priv;
+    GHashTableIter iter;
+    gpointer key;
+    gboolean  intersect = FALSE;
+    g_return_if_fail(TASK_IS_MANAGER(manager));
+    priv = manager->priv;
+
+    if (panel_info->region_dirty) {
+        task_manager_panel_instance_update_region(manager, panel_info);
+    } else {
+        g_hash_table_iter_init(&iter, priv->intellihide_dirty_windows);
+        while (g_hash_table_iter_next(&iter, &key, NULL)) {
+            task_manager_panel_instance_update_window(panel_info, key);
         }
-        break;
     }
 
     /*
-     Check window list for intersection... ignoring skip tasklist and those on
-     non-active workspaces
+     Check the windows overlapping the panel... ignoring skip tasklist and
+     those on non-active workspaces or (depending on the mode) belonging to
+     other applications
      */
-    for (iter = windows; iter; iter = iter->next) {
-        GdkRectangle win_rect;
+    g_hash_table_iter_init(&iter, panel_info->overlapping);
+    while (g_hash_table_iter_next(&iter, &key, NULL)) {
+        WnckWindow* window = key;
 
-        if (!wnck_window_is_visible_on_workspace(iter->data, space)) {
+        if (!wnck_window_is_visible_on_workspace(window, space)) {
             continue;
         }
-        if (wnck_window_is_minimized(iter->data)) {
+        if (wnck_window_is_minimized(window)) {
             continue;
         }
-        if (wnck_window_get_window_type(iter->data) == WNCK_WINDOW_DESKTOP) {
+        if (wnck_window_get_window_type(window) == WNCK_WINDOW_DESKTOP) {
             continue;
         }
-        if (wnck_window_get_window_type(iter->data) == WNCK_WINDOW_DOCK) {
+        if (wnck_window_get_window_type(window) == WNCK_WINDOW_DOCK) {
             continue;
         }
-        /*
-         It may be a good idea to go the same route as we go with the
-         panel to get the GdkRectangle.  But in practice it's _probably_
-         not necessary
-         */
-        wnck_window_get_geometry(iter->data, &win_rect.x,
-                                 &win_rect.y, &win_rect.width,
-                                 &win_rect.height);
-
-        if (gdk_region_rect_in(panel_info->foreign_region, &win_rect) !=
-                GDK_OVERLAP_RECTANGLE_OUT) {
-#ifdef DEBUG
-            g_debug("Intersect with %s, %d", wnck_window_get_name(iter->data),
-                    wnck_window_get_pid(iter->data));
-#endif
-            intersect = TRUE;
+        switch (panel_info->intellihide_mode) {
+        case INTELLIHIDE_WORKSPACE:
+            break;
+        case INTELLIHIDE_GROUP:  /*TODO... Implement this for now same as app*/
+        case INTELLIHIDE_APP:
+        default:
+            if (app && wnck_window_get_application(window) != app) {
+                continue;
+            }
             break;
         }
+#ifdef DEBUG
+        g_debug("Intersect with %s, %d", wnck_window_get_name(window),
+                wnck_window_get_pid(window));
+#endif
+        intersect = TRUE;
+        break;
     }
 
+    gdk_error_trap_push();
     /*
      Allow panel to hide (if necessary)
      */
@@ -2622,14 +2877,10 @@ task_manager_check_for_panel_instance_intersection(TaskManager* manager,
 static gboolean
 _waiting_for_panel_dbus(TaskManager* manager)
 {
-    TaskManagerPrivate*  priv;
-
     g_return_val_if_fail(TASK_IS_MANAGER(manager), FALSE);
-    priv = manager->priv;
 
-    task_manager_check_for_intersection(manager,
-                                        wnck_screen_get_active_workspace(priv->screen),
-                                        wnck_application_get(wnck_window_get_xid(wnck_screen_get_active_window(priv->screen))));
+    manager->priv->panel_xid_wait_id = 0;
+    task_manager_queue_intersection_check(manager, NULL);
     return FALSE;
 }
 /*
@@ -2656,25 +2907,83 @@ task_manager_check_for_intersection(TaskManager* manager,
         TaskManagerAwnPanelInfo* panel_info = value;
         g_object_get(panel_info->connector, "panel-xid", &xid, NULL);
         if (!xid) {
-            g_timeout_add(1000, (GSourceFunc)_waiting_for_panel_dbus, manager);
+            if (!priv->panel_xid_wait_id) {
+                priv->panel_xid_wait_id = g_timeout_add(1000, (GSourceFunc)_waiting_for_panel_dbus, manager);
+            }
         } else {
             if (!panel_info->foreign_window) {
                 panel_info->foreign_window = gdk_window_foreign_new(xid);
+                if (!panel_info->foreign_window) {
+                    continue;
+                }
+                task_manager_panel_instance_watch(panel_info);
             }
             if (panel_info->intellihide_mode) {
                 task_manager_check_for_panel_instance_intersection(manager,
                         panel_info,
                         space,
                         app);
-            } else if (!panel_info->intellihide_mode && panel_info->autohide_cookie) {
-                task_manager_panel_connector_uninhibit_autohide(panel_info->connector, panel_info->autohide_cookie);
-                panel_info->autohide_cookie = 0;
+            } else {
+                /*window geometry updates are skipped while off*/
+                panel_info->region_dirty = TRUE;
+                if (panel_info->autohide_cookie) {
+                    task_manager_panel_connector_uninhibit_autohide(panel_info->connector, panel_info->autohide_cookie);
+                    panel_info->autohide_cookie = 0;
+                }
             }
         }
     }
+    g_hash_table_remove_all(priv->intellihide_dirty_windows);
     return;
 }
 
+static gboolean
+_intellihide_check_timeout(TaskManager* manager)
+{
+    TaskManagerPrivate*  priv;
+    WnckWindow*          win;
+
+    g_return_val_if_fail(TASK_IS_MANAGER(manager), FALSE);
+    priv = manager->priv;
+
+    priv->intellihide_check_id = 0;
+    /*
+     No active window tends to happen when the last window on workspace is
+     moved to a different workspace or minimized.  In which case we have a
+     problem if we had intersection and the panel was hidden, it will
+     continue hide.  Checking against all windows inhibits the autohide.
+     */
+    win = wnck_screen_get_active_window(priv->screen);
+    task_manager_check_for_intersection(manager,
+                                        wnck_screen_get_active_workspace(priv->screen),
+                                        win ? wnck_window_get_application(win) : NULL);
+    return FALSE;
+}
+
+/*
+ Window moves, state changes and panel reshapes all end up here.  Work is
+ coalesced so that each panel is evaluated at most once per
+ INTELLIHIDE_CHECK_INTERVAL, and only windows that moved since the last
+ evaluation get their geometry retested.
+ */
+static void
+task_manager_queue_intersection_check(TaskManager* manager, WnckWindow* moved)
+{
+    TaskManagerPrivate*  priv = manager->priv;
+
+    if (!priv->intellihide_dirty_windows) {
+        return;  /* disposed */
+    }
+    if (moved) {
+        g_hash_table_insert(priv->intellihide_dirty_windows, moved, moved);
+    }
+    if (!priv->intellihide_check_id) {
+        priv->intellihide_check_id = g_timeout_add(INTELLIHIDE_CHECK_INTERVAL,
+                                     (GSourceFunc)_intellihide_check_timeout,
+                                     manager);
+    }
+}
+
 /*
   Active window has changed.  If intellhide is active we need to check for
  window instersections
@@ -2684,38 +2993,9 @@ task_manager_active_window_changed_cb(WnckScreen* screen,
                                       WnckWindow* previous_window,
                                       TaskManager* manager)
 {
-    //TaskManagerPrivate*  priv;
-    WnckWindow*          win;
-    WnckApplication*     app;
-    WnckWorkspace*       space;
-
     g_return_if_fail(TASK_IS_MANAGER(manager));
-    //priv = manager->priv;
 
-    win = wnck_screen_get_active_window(screen);
-    if (!win) {
-        /*
-         This tends to happen when the last window on workspace is moved to a
-         different workspace or minimized.  In which case we have a problem if
-         we had intersection and the panel was hidden, it will continue hide.
-         So inhibit the autohide if there is no active window.
-         */
-        task_manager_check_for_intersection(manager,
-                                            wnck_screen_get_active_workspace(screen),
-                                            NULL);
-        /*
-            if (!priv->autohide_cookie)
-            {
-              priv->autohide_cookie = awn_applet_inhibit_autohide (AWN_APPLET(manager), "Intellihide");
-        #ifdef DEBUG
-              g_debug ("%s: cookie is %u",__func__,priv->autohide_cookie);
-        #endif
-            }*/
-        return;
-    }
-    app = wnck_window_get_application(win);
-    space = wnck_screen_get_active_workspace(screen);
-    task_manager_check_for_intersection(manager, space, app);
+    task_manager_queue_intersection_check(manager, NULL);
 }
 /*
  Workspace changed... check window intersections for new workspace if Intellidide
@@ -2726,44 +3006,32 @@ task_manager_active_workspace_changed_cb(WnckScreen*    screen,
         WnckWorkspace* previous_space,
         TaskManager* manager)
 {
-    TaskManagerPrivate* priv;
-    WnckApplication*     app;
-    WnckWorkspace*       space;
-    WnckWindow*          win;
-
     g_return_if_fail(TASK_IS_MANAGER(manager));
-    priv = manager->priv;
 
-    win = wnck_screen_get_active_window(screen);
-    if (!win) {
-        task_manager_check_for_intersection(manager,
-                                            wnck_screen_get_active_workspace(screen),
-                                            NULL);
-        return;
-    }
-
-    app = wnck_window_get_application(win);
-    space = wnck_screen_get_active_workspace(screen);
-    task_manager_check_for_intersection(manager, space, app);
+    task_manager_queue_intersection_check(manager, NULL);
 }
 
 static void
 task_manager_win_closed_cb(WnckScreen* screen, WnckWindow* window, TaskManager* manager)
 {
     TaskManagerPrivate*  priv;
-    WnckWindow*          win;
-    WnckApplication*     app;
-    WnckWorkspace*       space;
+    GHashTableIter iter;
+    gpointer value;
 
     g_return_if_fail(TASK_IS_MANAGER(manager));
     priv = manager->priv;
-    win = wnck_screen_get_active_window(priv->screen);
-    if (!win) {
-        return;
+
+    /*The window is going away, don't keep it in any of the indexes*/
+    xutils_forget_window_properties(window);
+    if (priv->intellihide_dirty_windows) {
+        g_hash_table_remove(priv->intellihide_dirty_windows, window);
     }
-    app = wnck_window_get_application(win);
-    space = wnck_screen_get_active_workspace(priv->screen);
-    task_manager_check_for_intersection(manager, space, app);
+    g_hash_table_iter_init(&iter, priv->intellihide_panel_instances);
+    while (g_hash_table_iter_next(&iter, NULL, &value)) {
+        TaskManagerAwnPanelInfo* panel_info = value;
+        g_hash_table_remove(panel_info->overlapping, window);
+    }
+    task_manager_queue_intersection_check(manager, NULL);
 }
 /*
  A window's geometry has channged.  If Intellihide is active then check for
@@ -2772,22 +3040,9 @@ task_manager_win_closed_cb(WnckScreen* screen, WnckWindow* window, TaskManager*
 static void
 task_manager_win_geom_changed_cb(WnckWindow* window, TaskManager* manager)
 {
-    /*
-       TODO... only check for intersect if window is in the active application.
-       practically speaking it should be in most cases */
-    TaskManagerPrivate*  priv;
-    WnckWindow*          win;
-    WnckApplication*     app;
-    WnckWorkspace*       space;
     g_return_if_fail(TASK_IS_MANAGER(manager));
-    priv = manager->priv;
-    win = wnck_screen_get_active_window(priv->screen);
-    if (!win) {
-        return;
-    }
-    app = wnck_window_get_application(win);
-    space = wnck_screen_get_active_workspace(priv->screen);
-    task_manager_check_for_intersection(manager, space, app);
+
+    task_manager_queue_intersection_check(manager, window);
 }
 
 static void task_manager_win_state_changed_cb(WnckWindow* window,
@@ -2795,21 +3050,9 @@ static void task_manager_win_state_changed_cb(WnckWindow* window,
         WnckWindowState new_state,
         TaskManager* manager)
 {
-    TaskManagerPrivate*  priv;
-    WnckWindow*          win;
-    WnckApplication*     app;
-    WnckWorkspace*       space;
     g_return_if_fail(TASK_IS_MANAGER(manager));
-    priv = manager->priv;
-
-    win = wnck_screen_get_active_window(priv->screen);
-    if (!win) {
-        return;
-    }
-    app = wnck_window_get_application(win);
-    space = wnck_screen_get_active_workspace(priv->screen);
-    task_manager_check_for_intersection(manager, space, app);
 
+    task_manager_queue_intersection_check(manager, NULL);
 }
 
 static GQuark
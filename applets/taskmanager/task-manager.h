@@ -26,6 +26,7 @@
 #include <gtk/gtk.h>
 #include <libawn/libawn.h>
 #include "task-icon.h"
+#include "task-icon-index.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -103,6 +104,7 @@ const GSList* task_manager_get_icons(TaskManager* manager);
 GSList* task_manager_get_icons_by_wmclass(TaskManager* manager, const gchar* name);
 GSList* task_manager_get_icons_by_desktop(TaskManager* manager, const gchar* desktop);
 GSList* task_manager_get_icons_by_pid(TaskManager* manager, int pid);
+TaskIconIndex* task_manager_get_icon_index(TaskManager* manager);
 
 gboolean task_manager_get_show_all_windows(TaskManager* manager);
 const TaskIcon* task_manager_get_icon_by_xid(TaskManager* manager, gint64 xid);
@@ -85,6 +85,11 @@ struct _TaskWindowPrivate {
     GtkWidget*         menu;
 
     gchar* special_id;  /*Thank you OpenOffice*/
+    /*command line of the owning process, read from /proc once per pid*/
+    gchar* full_cmd;
+    gint   full_cmd_pid;
+    /*see task_window_get_grouping_keys(), computed on first use*/
+    gchar** grouping_keys;
 
     GtkWidget* box;
     GtkWidget* name;    /*name label*/
@@ -111,6 +116,8 @@ enum {
     MESSAGE_CHANGED,
     PROGRESS_CHANGED,
     HIDDEN_CHANGED,
+    GROUPING_KEYS_CHANGED,
+    PID_CHANGED,
 
     LAST_SIGNAL
 };
@@ -134,7 +141,7 @@ static GtkWidget*    _get_image_widget(TaskItem* item);
 
 static void   task_window_set_window(TaskWindow* window,
                                      WnckWindow* wnckwin);
-static void   task_window_check_for_special_case(TaskWindow* window);
+static gboolean task_window_check_for_special_case(TaskWindow* window);
 
 static void   _active_window_changed(WnckScreen* screen,
                                      WnckWindow* previously_active_window,
@@ -211,11 +218,9 @@ do_bind_property(DesktopAgnosticConfigClient* client, const gchar* key,
 {
     GError* error = NULL;
 
-    desktop_agnostic_config_client_bind(client,
-                                        DESKTOP_AGNOSTIC_CONFIG_GROUP_DEFAULT,
-                                        key, object, property, TRUE,
-                                        DESKTOP_AGNOSTIC_CONFIG_BIND_METHOD_FALLBACK,
-                                        &error);
+    awn_config_snapshot_bind(awn_config_snapshot_get(client,
+                             DESKTOP_AGNOSTIC_CONFIG_GROUP_DEFAULT),
+                             key, object, property, &error);
     if (error) {
         g_warning("Could not bind property '%s' to key '%s': %s", property, key,
                   error->message);
@@ -258,14 +263,12 @@ static void
 task_window_dispose(GObject* object)
 {
     TaskWindowPrivate* priv = TASK_WINDOW(object)->priv;
-    GError*   err = NULL;
     /*TaskItem will also do this, so it shouldn't be necessary in TaskWindow.*/
     if (priv->applet) {
-        desktop_agnostic_config_client_unbind_all_for_object(awn_config_get_default_for_applet(priv->applet, NULL), object, &err);
-        if (err) {
-            g_warning("%s: Failed to unbind_all: %s", __func__, err->message);
-            g_error_free(err);
-        }
+        awn_config_snapshot_unbind_all_for_object(
+            awn_config_snapshot_get(awn_config_get_default_for_applet(priv->applet, NULL),
+                                    DESKTOP_AGNOSTIC_CONFIG_GROUP_DEFAULT),
+            object);
         priv->applet = NULL;
     }
     if (priv->menu) {
@@ -290,6 +293,8 @@ task_window_finalize(GObject* object)
                                          object);
     g_free(priv->client_name);
     g_free(priv->special_id);
+    g_free(priv->full_cmd);
+    g_strfreev(priv->grouping_keys);
     g_free(priv->message);
     g_signal_handlers_disconnect_by_func(G_OBJECT(gtk_icon_theme_get_default()),
                                          G_CALLBACK(theme_changed_cb), object);
@@ -382,6 +387,24 @@ task_window_class_init(TaskWindowClass* klass)
                      G_TYPE_NONE,
                      1, G_TYPE_BOOLEAN);
 
+    _window_signals[GROUPING_KEYS_CHANGED] =
+        g_signal_new("grouping-keys-changed",
+                     G_OBJECT_CLASS_TYPE(obj_class),
+                     G_SIGNAL_RUN_LAST,
+                     G_STRUCT_OFFSET(TaskWindowClass, grouping_keys_changed),
+                     NULL, NULL,
+                     g_cclosure_marshal_VOID__VOID,
+                     G_TYPE_NONE, 0);
+
+    _window_signals[PID_CHANGED] =
+        g_signal_new("pid-changed",
+                     G_OBJECT_CLASS_TYPE(obj_class),
+                     G_SIGNAL_RUN_LAST,
+                     G_STRUCT_OFFSET(TaskWindowClass, pid_changed),
+                     NULL, NULL,
+                     g_cclosure_marshal_VOID__VOID,
+                     G_TYPE_NONE, 0);
+
     /* Install properties */
     pspec = g_param_spec_object("taskwindow",
                                 "Window",
@@ -479,23 +502,64 @@ task_window_new(AwnApplet* applet, GObject* proxy, WnckWindow* window)
 }
 
 
-static void
+/*
+ Recomputes the special id and the grouping keys, the title and WM_CLASS
+ they depend on can change after the window is mapped.  Returns TRUE if the
+ keys changed.
+ */
+static gboolean
 task_window_check_for_special_case(TaskWindow* window)
 {
-    gchar* full_cmd;
     gchar*   res_name = NULL;
     gchar*   class_name = NULL;
     TaskWindowPrivate* priv = window->priv;
-
-    full_cmd = get_full_cmd_from_pid(task_window_get_pid(window));
+    gint pid = task_window_get_pid(window);
+    gchar** old_keys = priv->grouping_keys;
+    gboolean changed;
+
+    if (!priv->full_cmd || pid != priv->full_cmd_pid) {
+        g_free(priv->full_cmd);
+        priv->full_cmd = pid ? get_full_cmd_from_pid(pid) : NULL;
+        priv->full_cmd_pid = pid;
+    }
     task_window_get_wm_class(window, &res_name, &class_name);
-    priv->special_id = get_special_id_from_window_data(full_cmd,
+    g_free(priv->special_id);
+    priv->special_id = get_special_id_from_window_data(priv->full_cmd,
                        res_name,
                        class_name,
                        task_window_get_name(window));
-    g_free(full_cmd);
     g_free(res_name);
     g_free(class_name);
+
+    priv->grouping_keys = NULL;
+    if (!old_keys) {
+        return FALSE;
+    }
+    task_window_get_grouping_keys(window);
+    changed = g_strv_length(old_keys) != g_strv_length(priv->grouping_keys);
+    for (guint i = 0; !changed && old_keys[i]; i++) {
+        changed = g_strcmp0(old_keys[i], priv->grouping_keys[i]) != 0;
+    }
+    g_strfreev(old_keys);
+
+    return changed;
+}
+
+/*
+ libwnck has no signal for _NET_WM_PID, a pid set late is picked up here
+ along with the command line.
+ */
+static void
+task_window_update_grouping_keys(TaskWindow* window)
+{
+    gint old_pid = window->priv->full_cmd_pid;
+
+    if (task_window_check_for_special_case(window)) {
+        g_signal_emit(window, _window_signals[GROUPING_KEYS_CHANGED], 0);
+    }
+    if (window->priv->full_cmd_pid != old_pid) {
+        g_signal_emit(window, _window_signals[PID_CHANGED], 0);
+    }
 }
 /*
  * Handling of the main WnckWindow
@@ -526,6 +590,15 @@ on_window_name_changed(WnckWindow* wnckwin, TaskWindow* window)
     gtk_label_set_markup(GTK_LABEL(priv->name), markup);
     g_free(markup);
     task_item_emit_name_changed(TASK_ITEM(window), name);
+    task_window_update_grouping_keys(window);
+}
+
+static void
+on_window_class_changed(WnckWindow* wnckwin, TaskWindow* window)
+{
+    g_return_if_fail(TASK_IS_WINDOW(window));
+
+    task_window_update_grouping_keys(window);
 }
 
 static void
@@ -666,6 +739,8 @@ task_window_set_window(TaskWindow* window, WnckWindow* wnckwin)
 
     g_signal_connect(wnckwin, "name-changed",
                      G_CALLBACK(on_window_name_changed), window);
+    g_signal_connect(wnckwin, "class-changed",
+                     G_CALLBACK(on_window_class_changed), window);
     g_signal_connect(wnckwin, "icon-changed",
                      G_CALLBACK(on_window_icon_changed), window);
     g_signal_connect(wnckwin, "workspace-changed",
@@ -756,6 +831,57 @@ task_window_get_client_name(TaskWindow* window)
     return priv->client_name;
 }
 
+/*
+ The keys _match() can score a pair of windows on: the special id, or else
+ the command line, the pid and the lower cased resource name.  Two windows
+ with no key in common never match, so TaskManager buckets the grouping
+ candidates by them.  The client name isn't part of the keys, _match()
+ still checks it.
+ */
+const gchar* const*
+task_window_get_grouping_keys(TaskWindow* window)
+{
+    TaskWindowPrivate* priv;
+    GPtrArray* keys;
+    gchar* res_name = NULL;
+    gchar* class_name = NULL;
+
+    g_return_val_if_fail(TASK_IS_WINDOW(window), NULL);
+    priv = window->priv;
+
+    if (priv->grouping_keys) {
+        return (const gchar * const*)priv->grouping_keys;
+    }
+
+    keys = g_ptr_array_new();
+    if (priv->special_id) {
+        g_ptr_array_add(keys, g_strconcat("special:", priv->special_id, NULL));
+    } else {
+        gint pid = task_window_get_pid(window);
+
+        if (priv->full_cmd) {
+            g_ptr_array_add(keys, g_strconcat("cmd:", priv->full_cmd, NULL));
+        }
+        if (pid) {
+            g_ptr_array_add(keys, g_strdup_printf("pid:%d", pid));
+        }
+        task_window_get_wm_class(window, &res_name, &class_name);
+        if (res_name && *res_name) {
+            gchar* lower = g_utf8_strdown(res_name, -1);
+            if (g_strcmp0(lower, "wine") != 0) {
+                g_ptr_array_add(keys, g_strconcat("res:", lower, NULL));
+            }
+            g_free(lower);
+        }
+        g_free(res_name);
+        g_free(class_name);
+    }
+    g_ptr_array_add(keys, NULL);
+    priv->grouping_keys = (gchar**)g_ptr_array_free(keys, FALSE);
+
+    return (const gchar * const*)priv->grouping_keys;
+}
+
 
 /*
  return the total number of icon changes
@@ -1295,9 +1421,7 @@ _match(TaskItem* item,
     gchar*   temp;
     gint      pid;
     gint      pid_to_match;
-    gchar*   full_cmd_to_match;
-    gchar*   full_cmd = NULL;
-    gchar*   id;
+    const gchar* id;
     gboolean ignore_wm_client_name;
 
     g_return_val_if_fail(TASK_IS_WINDOW(item), 0);
@@ -1355,11 +1479,7 @@ _match(TaskItem* item,
 
 //#define DEBUG 1
     /* special case? */
-    full_cmd_to_match = get_full_cmd_from_pid(pid_to_match);
-    task_window_get_wm_class(window_to_match, &res_name_to_match, &class_name_to_match);
-    id = get_special_id_from_window_data(full_cmd_to_match, res_name_to_match,
-                                         class_name_to_match,
-                                         task_window_get_name(window_to_match));
+    id = window_to_match->priv->special_id;
     /* the open office clause follows */
 #ifdef DEBUG
     g_debug("%s, compare %s,%s------------------------", __func__, priv->special_id, id);
@@ -1367,50 +1487,29 @@ _match(TaskItem* item,
 
     if (priv->special_id && id) {
         if (g_strcmp0(priv->special_id, id) == 0) {
-            g_free(res_name_to_match);
-            g_free(class_name_to_match);
-            g_free(full_cmd_to_match);
-            g_free(id);
             return 99;
         }
     }
     if (priv->special_id || id) {
-        g_free(res_name_to_match);
-        g_free(class_name_to_match);
-        g_free(full_cmd_to_match);
-        g_free(id);
         return 0;
     }
 
-    if (pid) {
-        full_cmd = get_full_cmd_from_pid(pid);
-    }
-    if (full_cmd && g_strcmp0(full_cmd, full_cmd_to_match) == 0) {
-        g_free(res_name_to_match);
-        g_free(class_name_to_match);
-        g_free(full_cmd_to_match);
-        g_free(full_cmd);
-        g_free(id);
+    if (priv->full_cmd && g_strcmp0(priv->full_cmd, window_to_match->priv->full_cmd) == 0) {
         return 95;
     }
 
-    g_free(full_cmd_to_match);
-    g_free(id);
-
     /* Try simple pid-match next */
 
 #ifdef DEBUG
     g_debug("%s:  Pid to match = %d,  pid = %d", __func__, pid_to_match, pid);
 #endif
     if (pid && (pid_to_match == pid)) {
-        g_free(full_cmd);
-        g_free(res_name_to_match);
-        g_free(class_name_to_match);
         return 94;
     }
 
     /* Now try resource name, which should (hopefully) be 99% of the cases */
     task_window_get_wm_class(window, &res_name, &class_name);
+    task_window_get_wm_class(window_to_match, &res_name_to_match, &class_name_to_match);
 
     if (res_name && res_name_to_match) {
         temp = res_name;
@@ -1431,13 +1530,11 @@ _match(TaskItem* item,
                     g_free(class_name);
                     g_free(res_name_to_match);
                     g_free(class_name_to_match);
-                    g_free(full_cmd);
                     return 65;
                 }
             }
         }
     }
-    g_free(full_cmd);
     g_free(res_name);
     g_free(class_name);
     g_free(res_name_to_match);
@@ -72,6 +72,8 @@ struct _TaskWindowClass {
     void (*progress_changed)(TaskWindow* window, gfloat         progress);
     void (*hidden_changed)(TaskWindow* window, gboolean       hidden);
     void (*running_changed)(TaskWindow* window, gboolean       is_running);
+    void (*grouping_keys_changed)(TaskWindow* window);
+    void (*pid_changed)(TaskWindow* window);
 };
 
 GType           task_window_get_type(void) G_GNUC_CONST;
@@ -151,6 +153,8 @@ void            task_window_set_highlighted(TaskWindow* window, gboolean highlig
 
 const gchar*    task_window_get_client_name(TaskWindow* window);
 
+const gchar* const* task_window_get_grouping_keys(TaskWindow* window);
+
 gboolean        task_window_get_icon_is_fallback(TaskWindow* window);
 
 #ifdef __cplusplus
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2026 Awn-core team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+/* trigram-index.c */
+
+#include <string.h>
+
+#include "trigram-index.h"
+
+struct _TrigramIndex {
+    GHashTable* postings;   /*packed trigram -> GPtrArray of data*/
+};
+
+#define TRIGRAM_AT(s) \
+  GUINT_TO_POINTER (((guint32)(guchar)(s)[0] << 16) | \
+                    ((guint32)(guchar)(s)[1] << 8) | \
+                    (guint32)(guchar)(s)[2])
+
+static void
+_free_posting(GPtrArray* posting)
+{
+    g_ptr_array_free(posting, TRUE);
+}
+
+TrigramIndex*
+trigram_index_new(void)
+{
+    TrigramIndex* index = g_new0(TrigramIndex, 1);
+
+    index->postings = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+                                            NULL, (GDestroyNotify)_free_posting);
+    return index;
+}
+
+void
+trigram_index_free(TrigramIndex* index)
+{
+    g_return_if_fail(index);
+
+    g_hash_table_destroy(index->postings);
+    g_free(index);
+}
+
+/*
+ Calls func once for every distinct trigram in text.
+ */
+static void
+_foreach_trigram(const gchar* text, void (*func)(TrigramIndex*, gpointer, gpointer),
+                 TrigramIndex* index, gpointer data)
+{
+    GHashTable* seen;
+    gsize len;
+
+    if (!text) {
+        return;
+    }
+    len = strlen(text);
+    if (len < 3) {
+        return;
+    }
+    seen = g_hash_table_new(g_direct_hash, g_direct_equal);
+    for (gsize i = 0; i + 3 <= len; i++) {
+        gpointer key = TRIGRAM_AT(text + i);
+        if (!g_hash_table_lookup_extended(seen, key, NULL, NULL)) {
+            g_hash_table_insert(seen, key, NULL);
+            func(index, key, data);
+        }
+    }
+    g_hash_table_destroy(seen);
+}
+
+static void
+_add_posting(TrigramIndex* index, gpointer key, gpointer data)
+{
+    GPtrArray* posting = g_hash_table_lookup(index->postings, key);
+
+    if (!posting) {
+        posting = g_ptr_array_new();
+        g_hash_table_insert(index->postings, key, posting);
+    }
+    g_ptr_array_add(posting, data);
+}
+
+static void
+_remove_posting(TrigramIndex* index, gpointer key, gpointer data)
+{
+    GPtrArray* posting = g_hash_table_lookup(index->postings, key);
+
+    if (posting) {
+        g_ptr_array_remove_fast(posting, data);
+        if (!posting->len) {
+            g_hash_table_remove(index->postings, key);
+        }
+    }
+}
+
+void
+trigram_index_insert(TrigramIndex* index, const gchar* text, gpointer data)
+{
+    g_return_if_fail(index);
+    _foreach_trigram(text, _add_posting, index, data);
+}
+
+void
+trigram_index_remove(TrigramIndex* index, const gchar* text, gpointer data)
+{
+    g_return_if_fail(index);
+    _foreach_trigram(text, _remove_posting, index, data);
+}
+
+const GPtrArray*
+trigram_index_lookup(TrigramIndex* index, const gchar* needle)
+{
+    GPtrArray* best = NULL;
+    gsize len;
+
+    g_return_val_if_fail(index, NULL);
+
+    if (!needle) {
+        return NULL;
+    }
+    len = strlen(needle);
+    if (len < 3) {
+        return NULL;
+    }
+    for (gsize i = 0; i + 3 <= len; i++) {
+        GPtrArray* posting = g_hash_table_lookup(index->postings, TRIGRAM_AT(needle + i));
+        if (!posting) {
+            /*some trigram of the needle occurs nowhere*/
+            return NULL;
+        }
+        if (!best || posting->len < best->len) {
+            best = posting;
+        }
+    }
+    return best;
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2026 Awn-core team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+/* trigram-index.h */
+
+#ifndef __TASK_MANAGER_TRIGRAM_INDEX_H__
+#define __TASK_MANAGER_TRIGRAM_INDEX_H__
+
+#include <glib.h>
+
+/*
+ Maps every 3 byte sequence of the indexed strings to the data items whose
+ string contains it.  A lookup hands back the shortest posting list among
+ the needle's trigrams; callers still need to verify each candidate (with
+ strstr() or similar) as sharing all trigrams does not imply a substring
+ match.
+ */
+typedef struct _TrigramIndex TrigramIndex;
+
+TrigramIndex* trigram_index_new(void);
+
+void trigram_index_free(TrigramIndex* index);
+
+void trigram_index_insert(TrigramIndex* index, const gchar* text, gpointer data);
+
+void trigram_index_remove(TrigramIndex* index, const gchar* text, gpointer data);
+
+/* Returns NULL if needle is shorter than 3 bytes or nothing can match.
+ The array is owned by the index and valid until the next insert/remove.*/
+const GPtrArray* trigram_index_lookup(TrigramIndex* index, const gchar* needle);
+
+#endif
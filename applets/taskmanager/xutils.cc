@@ -23,19 +23,51 @@
 
 #include <config.h>
 
+#include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
 #include <X11/Xatom.h>
+#include <X11/Xutil.h>
 #include <gdk/gdkx.h>
 #include <gtk/gtk.h>
 
+#ifdef HAVE_XCB
+#include <X11/Xlib-xcb.h>
+#include <xcb/xcb.h>
+#endif
+
 #include <unistd.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include "xutils.h"
 
 typedef struct _WnckIconCache WnckIconCache;
 
+/*
+ Last icon we built from _NET_WM_ICON for a WnckWindow, kept as object
+ data on it.  Apps like browsers set their icon over and over again without
+ changing it.
+ */
+typedef struct {
+    guint32 hash;
+    int width;
+    int height;
+    int ideal_width;
+    int ideal_height;
+    GdkPixbuf* icon;
+} NetWmIconCache;
+
+#define NET_WM_ICON_CACHE_KEY "awn-net-wm-icon-cache"
+
+/* longs fetched by the first read of _NET_WM_ICON.  Properties that fit
+ (most of them) are read in one go, larger ones are walked header by
+ header */
+#define NET_WM_ICON_PROBE_LONGS 4096
+
 static Display*
 _wnck_get_default_display(void)
 {
@@ -72,6 +104,234 @@ latin1_to_utf8(const char* latin1)
     return g_string_free(str, FALSE);
 }
 
+static Atom _wnck_atom_get(const char* atom_name);
+
+/*
+ * PROPERTY PREFETCHING
+ *
+ * When a batch of windows gets mapped (session restore, the applet starting
+ * up) every one of them is asked for its WM_CLASS, WM_CLIENT_MACHINE and
+ * icon properties, each a synchronous round trip through Xlib.  With XCB the
+ * requests for the whole batch are sent at once instead, the replies are
+ * collected from an idle and the accessors below answer from them.
+ *
+ * The WM_CLASS reply is kept until libwnck reports a class change or the
+ * window is forgotten.  The other replies are only good for the first read
+ * (TaskWindow keeps the client name itself), and the icon ones only until
+ * the icon changes.
+ */
+#ifdef HAVE_XCB
+typedef enum {
+    PREFETCH_WM_CLASS,
+    PREFETCH_WM_CLIENT_MACHINE,
+    PREFETCH_NET_WM_ICON,
+    PREFETCH_WM_HINTS,
+    PREFETCH_KWM_WIN_ICON,
+    N_PREFETCH
+} PrefetchProp;
+
+typedef struct {
+    gboolean pending;
+    gboolean have_reply;
+    xcb_get_property_cookie_t cookie;
+    xcb_get_property_reply_t* reply;    /*NULL when the request failed*/
+} PrefetchSlot;
+
+typedef struct {
+    PrefetchSlot slots[N_PREFETCH];
+} PrefetchedProps;
+
+static GHashTable* prefetched = NULL;   /*xid -> PrefetchedProps*/
+static guint prefetch_collect_id = 0;
+
+static xcb_connection_t*
+_prefetch_connection(void)
+{
+    return XGetXCBConnection(_wnck_get_default_display());
+}
+
+static void
+_prefetch_slot_clear(PrefetchSlot* slot)
+{
+    if (slot->pending) {
+        xcb_discard_reply(_prefetch_connection(), slot->cookie.sequence);
+    }
+    free(slot->reply);
+    memset(slot, 0, sizeof(PrefetchSlot));
+}
+
+static void
+_prefetched_props_free(PrefetchedProps* props)
+{
+    for (guint i = 0; i < N_PREFETCH; i++) {
+        _prefetch_slot_clear(&props->slots[i]);
+    }
+    g_free(props);
+}
+
+static void
+_prefetch_slot_wait(PrefetchSlot* slot)
+{
+    xcb_generic_error_t* error = NULL;
+
+    if (!slot->pending) {
+        return;
+    }
+    slot->pending = FALSE;
+    slot->have_reply = TRUE;
+    slot->reply = xcb_get_property_reply(_prefetch_connection(), slot->cookie, &error);
+    free(error);
+}
+
+static gboolean
+_prefetch_collect(gpointer data)
+{
+    GHashTableIter iter;
+    gpointer value;
+
+    prefetch_collect_id = 0;
+    g_hash_table_iter_init(&iter, prefetched);
+    while (g_hash_table_iter_next(&iter, NULL, &value)) {
+        PrefetchedProps* props = value;
+
+        for (guint i = 0; i < N_PREFETCH; i++) {
+            _prefetch_slot_wait(&props->slots[i]);
+        }
+    }
+    return FALSE;
+}
+
+/*
+ Returns TRUE if prop of xwindow was prefetched, *reply is then its reply or
+ NULL if the window doesn't have it.  With take the reply goes to the caller,
+ who free()s it.
+ */
+static gboolean
+_prefetch_lookup(Window xwindow, PrefetchProp prop, gboolean take,
+                 xcb_get_property_reply_t** reply)
+{
+    PrefetchedProps* props;
+    PrefetchSlot* slot;
+
+    *reply = NULL;
+    if (!prefetched) {
+        return FALSE;
+    }
+    props = g_hash_table_lookup(prefetched, GUINT_TO_POINTER(xwindow));
+    if (!props) {
+        return FALSE;
+    }
+    slot = &props->slots[prop];
+    _prefetch_slot_wait(slot);
+    if (!slot->have_reply) {
+        return FALSE;
+    }
+    *reply = slot->reply;
+    if (take) {
+        slot->reply = NULL;
+        slot->have_reply = FALSE;
+    }
+    return TRUE;
+}
+
+static void
+_prefetch_request(xcb_connection_t* conn, PrefetchSlot* slot, Window xwindow,
+                  Atom property, Atom type, guint32 length)
+{
+    slot->cookie = xcb_get_property(conn, FALSE, xwindow, property, type, 0, length);
+    slot->pending = TRUE;
+}
+
+static void
+_prefetch_class_changed(WnckWindow* window)
+{
+    PrefetchedProps* props;
+
+    props = g_hash_table_lookup(prefetched, GUINT_TO_POINTER(wnck_window_get_xid(window)));
+    if (props) {
+        _prefetch_slot_clear(&props->slots[PREFETCH_WM_CLASS]);
+    }
+}
+
+static void
+_prefetch_icon_changed(WnckWindow* window)
+{
+    PrefetchedProps* props;
+
+    props = g_hash_table_lookup(prefetched, GUINT_TO_POINTER(wnck_window_get_xid(window)));
+    if (props) {
+        _prefetch_slot_clear(&props->slots[PREFETCH_NET_WM_ICON]);
+        _prefetch_slot_clear(&props->slots[PREFETCH_WM_HINTS]);
+        _prefetch_slot_clear(&props->slots[PREFETCH_KWM_WIN_ICON]);
+    }
+}
+#endif
+
+/*
+ Sends the property requests for all the windows not seen before in one
+ batch.  A no-op without XCB, the accessors then do their own round trips.
+ */
+void
+xutils_prefetch_window_properties(GList* windows)
+{
+#ifdef HAVE_XCB
+    xcb_connection_t* conn = _prefetch_connection();
+    guint sent = 0;
+
+    if (!prefetched) {
+        prefetched = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+                                           (GDestroyNotify)_prefetched_props_free);
+    }
+
+    for (GList* w = windows; w; w = w->next) {
+        WnckWindow* window = w->data;
+        Window xwindow = wnck_window_get_xid(window);
+        PrefetchedProps* props;
+
+        if (g_hash_table_lookup(prefetched, GUINT_TO_POINTER(xwindow))) {
+            continue;
+        }
+        props = g_new0(PrefetchedProps, 1);
+        _prefetch_request(conn, &props->slots[PREFETCH_WM_CLASS], xwindow,
+                          XA_WM_CLASS, XA_STRING, 2048);
+        _prefetch_request(conn, &props->slots[PREFETCH_WM_CLIENT_MACHINE], xwindow,
+                          XA_WM_CLIENT_MACHINE, XCB_GET_PROPERTY_TYPE_ANY, 256);
+        _prefetch_request(conn, &props->slots[PREFETCH_NET_WM_ICON], xwindow,
+                          _wnck_atom_get("_NET_WM_ICON"), XA_CARDINAL,
+                          NET_WM_ICON_PROBE_LONGS);
+        _prefetch_request(conn, &props->slots[PREFETCH_WM_HINTS], xwindow,
+                          XA_WM_HINTS, XA_WM_HINTS, 9);     /*sizeof(XWMHints) on the wire*/
+        _prefetch_request(conn, &props->slots[PREFETCH_KWM_WIN_ICON], xwindow,
+                          _wnck_atom_get("KWM_WIN_ICON"), _wnck_atom_get("KWM_WIN_ICON"), 2);
+        g_hash_table_insert(prefetched, GUINT_TO_POINTER(xwindow), props);
+        g_signal_connect(window, "class-changed",
+                         G_CALLBACK(_prefetch_class_changed), NULL);
+        g_signal_connect(window, "icon-changed",
+                         G_CALLBACK(_prefetch_icon_changed), NULL);
+        sent++;
+    }
+
+    if (sent) {
+        xcb_flush(conn);
+        if (!prefetch_collect_id) {
+            prefetch_collect_id = g_idle_add(_prefetch_collect, NULL);
+        }
+    }
+#endif
+}
+
+void
+xutils_forget_window_properties(WnckWindow* window)
+{
+#ifdef HAVE_XCB
+    if (prefetched &&
+            g_hash_table_remove(prefetched, GUINT_TO_POINTER(wnck_window_get_xid(window)))) {
+        g_signal_handlers_disconnect_by_func(window, (gpointer)_prefetch_class_changed, NULL);
+        g_signal_handlers_disconnect_by_func(window, (gpointer)_prefetch_icon_changed, NULL);
+    }
+#endif
+}
+
 void
 _wnck_get_wmclass(Window xwindow,
                   char** res_class,
@@ -79,6 +339,34 @@ _wnck_get_wmclass(Window xwindow,
 {
     XClassHint ch;
 
+#ifdef HAVE_XCB
+    xcb_get_property_reply_t* reply;
+
+    if (_prefetch_lookup(xwindow, PREFETCH_WM_CLASS, FALSE, &reply)) {
+        if (res_class) {
+            *res_class = NULL;
+        }
+        if (res_name) {
+            *res_name = NULL;
+        }
+        /* "name\0class\0", what XGetClassHint() accepts */
+        if (reply && reply->type == XA_STRING && reply->format == 8) {
+            gint len = xcb_get_property_value_length(reply);
+            gchar* value = g_strndup((const gchar*)xcb_get_property_value(reply), len);
+            gint name_len = strlen(value);
+
+            if (res_name) {
+                *res_name = latin1_to_utf8(value);
+            }
+            if (res_class) {
+                *res_class = latin1_to_utf8(name_len < len ? value + name_len + 1 : "");
+            }
+            g_free(value);
+        }
+        return;
+    }
+#endif
+
     _wnck_error_trap_push();
 
     ch.res_name = NULL;
@@ -121,6 +409,22 @@ _wnck_get_client_name(Window xwindow, char** client_name)
     XTextProperty text_prop;
     Status status;
 
+#ifdef HAVE_XCB
+    xcb_get_property_reply_t* reply;
+
+    if (_prefetch_lookup(xwindow, PREFETCH_WM_CLIENT_MACHINE, TRUE, &reply)) {
+        *client_name = NULL;
+        if (reply && reply->type != XCB_NONE && reply->format == 8) {
+            gchar* value = g_strndup((const gchar*)xcb_get_property_value(reply),
+                                     xcb_get_property_value_length(reply));
+            *client_name = latin1_to_utf8(value);
+            g_free(value);
+        }
+        free(reply);
+        return;
+    }
+#endif
+
     _wnck_error_trap_push();
 
     status = XGetWMClientMachine(_wnck_get_default_display(), xwindow, &text_prop);
@@ -179,54 +483,39 @@ _wnck_atom_get(const char* atom_name)
 /* The icon-reading code is copied
  * from metacity, please sync bugfixes
  */
-static gboolean
-find_largest_sizes(gulong* data, gulong nitems, int* width, int* height)
-{
-    *width = 0;
-    *height = 0;
-
-    while (nitems > 0) {
-
-        if (nitems < 3) {
-            return FALSE;    /* no space for w, h */
-        }
-
-        int w = data[0];
-        int h = data[1];
-
-        if (nitems < ((w * h) + 2)) {
-            return FALSE;    /* not enough data */
-        }
-
-        *width = MAX(w, *width);
-        *height = MAX(h, *height);
-
-        data += (w * h) + 2;
-        nitems -= (w * h) + 2;
-    }
-
-    return TRUE;
-}
+/*
+ _NET_WM_ICON is a list of (width, height, width * height ARGB cardinals)
+ blocks.  IconBlock remembers where the pixels of one of them start, in
+ 32 bit units from the start of the property.
+ */
+typedef struct {
+    int w;
+    int h;
+    gulong offset;
+} IconBlock;
 
 static gboolean
-find_best_size(gulong* data,
-               gulong nitems,
+find_best_size(IconBlock* blocks,
+               guint n_blocks,
                int ideal_width,
-               int ideal_height, int* width, int* height, gulong** start)
+               int ideal_height, IconBlock** best)
 {
     int best_w;
     int best_h;
-    gulong* best_start;
-    int max_width, max_height;
+    IconBlock* best_block;
+    int max_width = 0, max_height = 0;
 
-    *width = 0;
-    *height = 0;
-    *start = NULL;
+    *best = NULL;
 
-    if (!find_largest_sizes(data, nitems, &max_width, &max_height)) {
+    if (!n_blocks) {
         return FALSE;
     }
 
+    for (guint i = 0; i < n_blocks; i++) {
+        max_width = MAX(blocks[i].w, max_width);
+        max_height = MAX(blocks[i].h, max_height);
+    }
+
     if (ideal_width < 0) {
         ideal_width = max_width;
     }
@@ -236,26 +525,16 @@ find_best_size(gulong* data,
 
     best_w = 0;
     best_h = 0;
-    best_start = NULL;
+    best_block = NULL;
 
-    while (nitems > 0) {
-        int w, h;
+    for (guint i = 0; i < n_blocks; i++) {
+        int w = blocks[i].w;
+        int h = blocks[i].h;
         gboolean replace;
 
         replace = FALSE;
 
-        if (nitems < 3) {
-            return FALSE;    /* no space for w, h */
-        }
-
-        w = data[0];
-        h = data[1];
-
-        if (nitems < ((w * h) + 2)) {
-            break;    /* not enough data */
-        }
-
-        if (best_start == NULL) {
+        if (best_block == NULL) {
             replace = TRUE;
         } else {
             /* work with averages */
@@ -281,87 +560,98 @@ find_best_size(gulong* data,
         }
 
         if (replace) {
-            best_start = data + 2;
+            best_block = &blocks[i];
             best_w = w;
             best_h = h;
         }
-
-        data += (w * h) + 2;
-        nitems -= (w * h) + 2;
     }
 
-    if (best_start) {
-        *start = best_start;
-        *width = best_w;
-        *height = best_h;
-        return TRUE;
-    } else {
-        return FALSE;
-    }
+    *best = best_block;
+    return TRUE;
 }
 
+/*
+ Converts the chosen block to the RGBA byte order GdkPixbuf wants.  On
+ 64 bit the property arrives as longs, only the low 32 bits carry data.
+ */
 static void
 argbdata_to_pixdata(gulong* argb_data, int len, guchar** pixdata)
 {
-    guchar* p;
+    guint32* p;
     int i;
 
     *pixdata = g_new(guchar, len * 4);
-    p = *pixdata;
+    p = (guint32*) * pixdata;
 
-    /* One could speed this up a lot. */
     i = 0;
-    while (i < len) {
-        guint argb;
-        guint rgba;
-
-        argb = argb_data[i];
-        rgba = (argb << 8) | (argb >> 24);
+#if defined(__SSE2__) && GLIB_SIZEOF_LONG == 8 && G_BYTE_ORDER == G_LITTLE_ENDIAN
+    {
+        const __m128i mask_ag = _mm_set1_epi32(0xff00ff00);
+        const __m128i mask_b = _mm_set1_epi32(0x000000ff);
+
+        for (; i + 4 <= len; i += 4) {
+            __m128i lo = _mm_loadu_si128((const __m128i*)(argb_data + i));
+            __m128i hi = _mm_loadu_si128((const __m128i*)(argb_data + i + 2));
+            __m128i argb;
+            __m128i rgba;
+
+            /* gather the low halves of the four longs */
+            lo = _mm_shuffle_epi32(lo, _MM_SHUFFLE(3, 1, 2, 0));
+            hi = _mm_shuffle_epi32(hi, _MM_SHUFFLE(3, 1, 2, 0));
+            argb = _mm_unpacklo_epi64(lo, hi);
+
+            /* 0xAARRGGBB -> 0xAABBGGRR, ie bytes R G B A in memory */
+            rgba = _mm_or_si128(_mm_and_si128(argb, mask_ag),
+                                _mm_or_si128(_mm_and_si128(_mm_srli_epi32(argb, 16), mask_b),
+                                             _mm_slli_epi32(_mm_and_si128(argb, mask_b), 16)));
+            _mm_storeu_si128((__m128i*)(p + i), rgba);
+        }
+    }
+#endif
+    for (; i < len; i++) {
+        guint32 argb = argb_data[i];
+        guchar* px = (guchar*)(p + i);
+
+        px[0] = (argb >> 16) & 0xff;
+        px[1] = (argb >> 8) & 0xff;
+        px[2] = argb & 0xff;
+        px[3] = argb >> 24;
+    }
+}
 
-        *p = rgba >> 24;
-        ++p;
-        *p = (rgba >> 16) & 0xff;
-        ++p;
-        *p = (rgba >> 8) & 0xff;
-        ++p;
-        *p = rgba & 0xff;
-        ++p;
+/* FNV-1a over the pixels, enough to tell an icon changed */
+static guint32
+argbdata_hash(gulong* argb_data, int len)
+{
+    guint32 hash = 2166136261U;
 
-        ++i;
+    for (int i = 0; i < len; i++) {
+        hash = (hash ^ (guint32)argb_data[i]) * 16777619U;
     }
+    return hash;
 }
 
 static gboolean
-read_rgb_icon(Window xwindow,
-              int ideal_width,
-              int ideal_height,
-              int ideal_mini_width,
-              int ideal_mini_height,
-              int* width,
-              int* height,
-              guchar** pixdata,
-              int* mini_width, int* mini_height, guchar** mini_pixdata)
+get_net_wm_icon_chunk(Window xwindow,
+                      glong offset,
+                      glong length,
+                      gulong** data,
+                      gulong* nitems,
+                      gulong* bytes_after)
 {
     Atom type;
     int format;
-    gulong nitems;
-    gulong bytes_after;
     int result, err;
-    gulong* data;
-    gulong* best;
-    int w, h;
-    gulong* best_mini;
-    int mini_w, mini_h;
 
     _wnck_error_trap_push();
     type = None;
-    data = NULL;
+    *data = NULL;
     result = XGetWindowProperty(_wnck_get_default_display(),
                                 xwindow,
                                 _wnck_atom_get("_NET_WM_ICON"),
-                                0, G_MAXLONG,
-                                False, XA_CARDINAL, &type, &format, &nitems,
-                                &bytes_after, (void*) &data);
+                                offset, length,
+                                False, XA_CARDINAL, &type, &format, nitems,
+                                bytes_after, (guchar**) data);
 
     err = _wnck_error_trap_pop();
 
@@ -370,33 +660,163 @@ read_rgb_icon(Window xwindow,
     }
 
     if (type != XA_CARDINAL) {
-        XFree(data);
+        if (*data) {
+            XFree(*data);
+        }
+        *data = NULL;
         return FALSE;
     }
+    return TRUE;
+}
 
-    if (!find_best_size(data, nitems,
-                        ideal_width, ideal_height, &w, &h, &best)) {
-        XFree(data);
-        return FALSE;
+static void
+xfree_chunk(gpointer data)
+{
+    XFree(data);
+}
+
+/*
+ The first NET_WM_ICON_PROBE_LONGS of _NET_WM_ICON, from the prefetched
+ reply when there is one.  *free_data frees *data.
+ */
+static gboolean
+get_net_wm_icon_probe(Window xwindow,
+                      gulong** data,
+                      gulong* nitems,
+                      gulong* bytes_after,
+                      GDestroyNotify* free_data)
+{
+#ifdef HAVE_XCB
+    xcb_get_property_reply_t* reply;
+
+    if (_prefetch_lookup(xwindow, PREFETCH_NET_WM_ICON, TRUE, &reply)) {
+        const guint32* values;
+
+        *data = NULL;
+        if (!reply || reply->type != XA_CARDINAL || reply->format != 32) {
+            free(reply);
+            return FALSE;
+        }
+        /* Xlib hands out format 32 properties as longs, so does this */
+        values = (const guint32*)xcb_get_property_value(reply);
+        *nitems = reply->value_len;
+        *bytes_after = reply->bytes_after;
+        *data = g_new(gulong, MAX(*nitems, 1));
+        for (gulong i = 0; i < *nitems; i++) {
+            (*data)[i] = values[i];
+        }
+        *free_data = g_free;
+        free(reply);
+        return TRUE;
     }
+#endif
+    *free_data = xfree_chunk;
+    return get_net_wm_icon_chunk(xwindow, 0, NET_WM_ICON_PROBE_LONGS,
+                                 data, nitems, bytes_after);
+}
 
-    if (!find_best_size(data, nitems,
-                        ideal_mini_width, ideal_mini_height,
-                        &mini_w, &mini_h, &best_mini)) {
-        XFree(data);
+/*
+ Finds the block of _NET_WM_ICON closest to the ideal size and fetches only
+ that one.  *argb_data points into *x_data, which the caller frees with
+ *free_x_data.
+ */
+static gboolean
+read_rgb_icon(Window xwindow,
+              int ideal_width,
+              int ideal_height,
+              int* width,
+              int* height,
+              gulong** argb_data,
+              gulong** x_data,
+              GDestroyNotify* free_x_data)
+{
+    gulong nitems;
+    gulong bytes_after;
+    gulong total;
+    gulong pos;
+    gulong* data;
+    GDestroyNotify free_data;
+    GArray* blocks;
+    IconBlock* best;
+
+    if (!get_net_wm_icon_probe(xwindow, &data, &nitems, &bytes_after, &free_data)) {
         return FALSE;
     }
+    total = nitems + bytes_after / 4;
+
+    blocks = g_array_new(FALSE, FALSE, sizeof(IconBlock));
+    pos = 0;
+    while (total - pos >= 3) {
+        IconBlock block;
+        gulong w, h;
+
+        if (pos + 2 <= nitems) {
+            w = data[pos];
+            h = data[pos + 1];
+        } else {
+            gulong* header;
+            gulong header_items, header_after;
 
-    *width = w;
-    *height = h;
+            if (!get_net_wm_icon_chunk(xwindow, pos, 2, &header,
+                                       &header_items, &header_after)) {
+                break;
+            }
+            if (header_items < 2) {
+                XFree(header);
+                break;
+            }
+            w = header[0];
+            h = header[1];
+            XFree(header);
+        }
 
-    *mini_width = mini_w;
-    *mini_height = mini_h;
+        if (!w || !h || w > G_MAXSHORT || h > G_MAXSHORT ||
+                total - pos - 2 < w * h) {
+            break;    /* not enough data */
+        }
 
-    argbdata_to_pixdata(best, w * h, pixdata);
-    argbdata_to_pixdata(best_mini, mini_w * mini_h, mini_pixdata);
+        block.w = w;
+        block.h = h;
+        block.offset = pos + 2;
+        g_array_append_val(blocks, block);
 
-    XFree(data);
+        pos += (w * h) + 2;
+    }
+
+    if (!find_best_size((IconBlock*)blocks->data, blocks->len,
+                        ideal_width, ideal_height, &best)) {
+        g_array_free(blocks, TRUE);
+        free_data(data);
+        return FALSE;
+    }
+
+    *width = best->w;
+    *height = best->h;
+
+    if (best->offset + best->w * best->h <= nitems) {
+        *x_data = data;
+        *free_x_data = free_data;
+        *argb_data = data + best->offset;
+    } else {
+        gulong* pixels;
+        gulong pixel_items, pixel_after;
+
+        free_data(data);
+        if (!get_net_wm_icon_chunk(xwindow, best->offset, best->w * best->h,
+                                   &pixels, &pixel_items, &pixel_after)) {
+            g_array_free(blocks, TRUE);
+            return FALSE;
+        }
+        if (pixel_items < (gulong)(best->w * best->h)) {
+            g_array_free(blocks, TRUE);
+            XFree(pixels);
+            return FALSE;
+        }
+        *x_data = pixels;
+        *free_x_data = xfree_chunk;
+        *argb_data = pixels;
+    }
+    g_array_free(blocks, TRUE);
 
     return TRUE;
 }
@@ -577,9 +997,7 @@ try_pixmap_and_mask(Pixmap src_pixmap,
                     Pixmap src_mask,
                     GdkPixbuf** iconp,
                     int ideal_width,
-                    int ideal_height,
-                    GdkPixbuf** mini_iconp,
-                    int ideal_mini_width, int ideal_mini_height)
+                    int ideal_height)
 {
     GdkPixbuf* unscaled = NULL;
     GdkPixbuf* mask = NULL;
@@ -623,13 +1041,6 @@ try_pixmap_and_mask(Pixmap src_pixmap,
                                     ideal_height > 0 ? ideal_height :
                                     gdk_pixbuf_get_height(unscaled),
                                     GDK_INTERP_BILINEAR);
-        *mini_iconp =
-            gdk_pixbuf_scale_simple(unscaled,
-                                    ideal_mini_width > 0 ? ideal_mini_width :
-                                    gdk_pixbuf_get_width(unscaled),
-                                    ideal_mini_height > 0 ? ideal_mini_height :
-                                    gdk_pixbuf_get_height(unscaled),
-                                    GDK_INTERP_BILINEAR);
 
         g_object_unref(G_OBJECT(unscaled));
         return TRUE;
@@ -651,6 +1062,21 @@ get_kwm_win_icon(Window xwindow, Pixmap* pixmap, Pixmap* mask)
     *pixmap = None;
     *mask = None;
 
+#ifdef HAVE_XCB
+    xcb_get_property_reply_t* reply;
+
+    if (_prefetch_lookup(xwindow, PREFETCH_KWM_WIN_ICON, TRUE, &reply)) {
+        if (reply && reply->type == _wnck_atom_get("KWM_WIN_ICON") &&
+                reply->format == 32 && reply->value_len >= 2) {
+            const guint32* values = (const guint32*)xcb_get_property_value(reply);
+            *pixmap = values[0];
+            *mask = values[1];
+        }
+        free(reply);
+        return;
+    }
+#endif
+
     _wnck_error_trap_push();
     icons = NULL;
     result = XGetWindowProperty(_wnck_get_default_display(), xwindow,
@@ -679,6 +1105,49 @@ get_kwm_win_icon(Window xwindow, Pixmap* pixmap, Pixmap* mask)
     return;
 }
 
+static XWMHints*
+get_wm_hints(Window xwindow)
+{
+    XWMHints* hints;
+
+    _wnck_error_trap_push();
+    hints = XGetWMHints(_wnck_get_default_display(), xwindow);
+    _wnck_error_trap_pop();
+
+    return hints;
+}
+
+/*
+ Icon pixmap and mask from the prefetched WM_HINTS, FALSE when there is no
+ prefetched reply and XGetWMHints() has to be asked.
+ */
+static gboolean
+get_wm_hints_icon(Window xwindow, Pixmap* pixmap, Pixmap* mask)
+{
+#ifdef HAVE_XCB
+    xcb_get_property_reply_t* reply;
+
+    if (_prefetch_lookup(xwindow, PREFETCH_WM_HINTS, TRUE, &reply)) {
+        /* flags, input, initial_state, icon_pixmap, icon_window, icon_x,
+         icon_y, icon_mask, window_group */
+        if (reply && reply->type == XA_WM_HINTS && reply->format == 32 &&
+                reply->value_len >= 8) {
+            const guint32* values = (const guint32*)xcb_get_property_value(reply);
+
+            if (values[0] & IconPixmapHint) {
+                *pixmap = values[3];
+            }
+            if (values[0] & IconMaskHint) {
+                *mask = values[7];
+            }
+        }
+        free(reply);
+        return TRUE;
+    }
+#endif
+    return FALSE;
+}
+
 typedef enum {
     /* These MUST be in ascending order of preference;
      * i.e. if we get _NET_WM_ICON and already have
@@ -754,68 +1223,92 @@ scaled_from_pixdata(guchar* pixdata, int w, int h, int new_w, int new_h)
     return dest;
 }
 
+static void
+net_wm_icon_cache_free(NetWmIconCache* cache)
+{
+    if (cache->icon) {
+        g_object_unref(cache->icon);
+    }
+    g_free(cache);
+}
+
 static gboolean
 _wnck_read_icons_(Window xwindow,
-                  GtkWidget* icon_cache,
+                  NetWmIconCache* icon_cache,
                   GdkPixbuf** iconp,
                   int ideal_width,
-                  int ideal_height,
-                  GdkPixbuf** mini_iconp,
-                  int ideal_mini_width, int ideal_mini_height)
+                  int ideal_height)
 {
     guchar* pixdata;
+    gulong* argb_data;
+    gulong* x_data;
+    GDestroyNotify free_x_data;
     int w, h;
-    guchar* mini_pixdata;
-    int mini_w, mini_h;
     Pixmap pixmap;
     Pixmap mask;
     XWMHints* hints;
 
     *iconp = NULL;
-    *mini_iconp = NULL;
     pixdata = NULL;
     if (read_rgb_icon(xwindow,
                       ideal_width, ideal_height,
-                      ideal_mini_width, ideal_mini_height,
-                      &w, &h, &pixdata, &mini_w, &mini_h, &mini_pixdata)) {
-        *iconp = scaled_from_pixdata(pixdata, w, h, ideal_width, ideal_height);
-
-        *mini_iconp = scaled_from_pixdata(mini_pixdata, mini_w, mini_h,
-                                          ideal_mini_width, ideal_mini_height);
+                      &w, &h, &argb_data, &x_data, &free_x_data)) {
+        guint32 hash = argbdata_hash(argb_data, w * h);
+
+        if (icon_cache && icon_cache->icon &&
+                icon_cache->hash == hash &&
+                icon_cache->width == w && icon_cache->height == h &&
+                icon_cache->ideal_width == ideal_width &&
+                icon_cache->ideal_height == ideal_height) {
+            *iconp = g_object_ref(icon_cache->icon);
+        } else {
+            argbdata_to_pixdata(argb_data, w * h, &pixdata);
+            *iconp = scaled_from_pixdata(pixdata, w, h, ideal_width, ideal_height);
+            if (icon_cache && *iconp) {
+                if (icon_cache->icon) {
+                    g_object_unref(icon_cache->icon);
+                }
+                icon_cache->icon = g_object_ref(*iconp);
+                icon_cache->hash = hash;
+                icon_cache->width = w;
+                icon_cache->height = h;
+                icon_cache->ideal_width = ideal_width;
+                icon_cache->ideal_height = ideal_height;
+            }
+        }
+        free_x_data(x_data);
 
         return TRUE;
     }
 
 
-    _wnck_error_trap_push();
-    hints = XGetWMHints(_wnck_get_default_display(), xwindow);
-    _wnck_error_trap_pop();
     pixmap = None;
     mask = None;
-    if (hints) {
-        if (hints->flags & IconPixmapHint) {
-            pixmap = hints->icon_pixmap;
-        }
-        if (hints->flags & IconMaskHint) {
-            mask = hints->icon_mask;
-        }
+    if (!get_wm_hints_icon(xwindow, &pixmap, &mask)) {
+        hints = get_wm_hints(xwindow);
+        if (hints) {
+            if (hints->flags & IconPixmapHint) {
+                pixmap = hints->icon_pixmap;
+            }
+            if (hints->flags & IconMaskHint) {
+                mask = hints->icon_mask;
+            }
 
-        XFree(hints);
-        hints = NULL;
+            XFree(hints);
+            hints = NULL;
+        }
     }
 
 
     if (try_pixmap_and_mask(pixmap, mask,
-                            iconp, ideal_width, ideal_height,
-                            mini_iconp, ideal_mini_width, ideal_mini_height)) {
+                            iconp, ideal_width, ideal_height)) {
         return TRUE;
     }
 
     get_kwm_win_icon(xwindow, &pixmap, &mask);
 
     if (try_pixmap_and_mask(pixmap, mask,
-                            iconp, ideal_width, ideal_height,
-                            mini_iconp, ideal_mini_width, ideal_mini_height)) {
+                            iconp, ideal_width, ideal_height)) {
         return TRUE;
     }
     return FALSE;
@@ -827,23 +1320,25 @@ _wnck_get_icon_at_size(WnckWindow* window,
                        gint        width,
                        gint        height)
 {
-    GdkPixbuf* icon, *icon_scaled, *mini_icon;
+    GdkPixbuf* icon, *icon_scaled;
+    NetWmIconCache* icon_cache;
     gboolean res;
 
     icon = NULL;
     icon_scaled = NULL;
-    mini_icon = NULL;
+
+    icon_cache = g_object_get_data(G_OBJECT(window), NET_WM_ICON_CACHE_KEY);
+    if (!icon_cache) {
+        icon_cache = g_new0(NetWmIconCache, 1);
+        g_object_set_data_full(G_OBJECT(window), NET_WM_ICON_CACHE_KEY, icon_cache,
+                               (GDestroyNotify)net_wm_icon_cache_free);
+    }
 
     res = _wnck_read_icons_(wnck_window_get_xid(window),
-                            NULL,
-                            &icon, width, width,
-                            &mini_icon, 24, 24);
+                            icon_cache,
+                            &icon, width, width);
 
     if (res) {
-        if (mini_icon) {
-            g_object_unref(mini_icon);
-        }
-
         if (icon) {
             return icon;
         }
@@ -30,6 +30,14 @@
 #include <gdk-pixbuf/gdk-pixbuf.h>
 #include <libwnck/libwnck.h>
 
+/* windows is a list of WnckWindows */
+void
+xutils_prefetch_window_properties(GList* windows);
+
+/* Drops what was prefetched for window, which is going away */
+void
+xutils_forget_window_properties(WnckWindow* window);
+
 void
 _wnck_get_wmclass(Window xwindow,
                   char** res_class,
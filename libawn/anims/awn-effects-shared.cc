@@ -21,8 +21,7 @@ gboolean
 awn_effect_force_timeout(AwnEffectsAnimation* anim,
                          const gint timeout, GSourceFunc func)
 {
-    AwnEffectsPrivate* priv = anim->effects->priv;
-    priv->timer_id = g_timeout_add(timeout, func, anim);
+    awn_effects_set_timer(anim->effects, timeout, func, anim);
     return FALSE;
 }
 
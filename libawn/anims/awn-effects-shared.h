@@ -20,6 +20,7 @@
 #define __AWN_EFFECT_SHARED_H__
 
 #include "../awn-effects.h"
+#include "../awn-effects-replay.h"
 
 typedef enum {
     AWN_ARROW_TYPE_CUSTOM = 0,
@@ -86,8 +87,49 @@ struct _AwnEffectsPrivate {
 
     guint timer_id;
     gboolean already_exposed;
+
+    /* icon painted by awn_effects_cairo_create_clipped()'s caller, see
+     * awn_effects_set_icon_source()
+     */
+    cairo_surface_t* icon_source;
+    cairo_surface_t* icon_source_large;
+    gboolean icon_source_large_requested; /* ::large-source-needed emitted */
+    gint icon_source_width, icon_source_height;
+    GArray* icon_levels; /* AwnEffectsIconLevel, halvings made on demand */
+
+    /* the animation timer, see awn_effects_set_timer() */
+    GSourceFunc timer_func;
+    gpointer timer_data;
+    guint timer_interval;
+    guint frame; /* animation frames run so far */
+    guint timer_skip; /* frames run per tick by the current timer */
+    gboolean suspended; /* timer stopped while paused or not viewable */
+
+    /* frame rate governor, see awn_effects_govern() */
+    gboolean adaptive;
+    gint min_frame_rate;
+    gboolean paused;
+    gint quality_level;
+    gint frame_skip;
+    gdouble load;
+    gdouble last_tick;
+    gdouble render_start;
+    gdouble render_time;
+    guint calm_ticks;
+    guint settle_ticks;
+
+    /* see awn-effects-replay.h */
+    AwnEffectsRecording* recording;
+    gboolean virtual_clock;
+    gint64 virtual_time;
+    gint64 timer_due; /* on the virtual clock, -1 if there's no timer */
 };
 
+typedef struct {
+    cairo_surface_t* surface;
+    gint width, height;
+} AwnEffectsIconLevel;
+
 typedef enum {
     AWN_EFFECT_DIR_NONE,
     AWN_EFFECT_DIR_STOP,
@@ -135,6 +177,19 @@ gboolean awn_effect_force_timeout(AwnEffectsAnimation* anim,
                                   const gint timeout,
                                   GSourceFunc func);
 
+/* Runs func(anim) every interval ms until it returns FALSE, replacing the
+ * current animation timer */
+void awn_effects_set_timer(AwnEffects* fx, guint interval,
+                           GSourceFunc func, gpointer anim);
+
+void awn_effects_remove_timer(AwnEffects* fx);
+
+/* Makes the animation timer run only on awn_effects_step_virtual_clock() */
+void awn_effects_set_virtual_clock(AwnEffects* fx, gboolean virtual_clock);
+
+/* Moves the virtual clock to the timer and runs it, FALSE if there's none */
+gboolean awn_effects_step_virtual_clock(AwnEffects* fx);
+
 void awn_effect_emit_anim_start(AwnEffectsAnimation* anim);
 void awn_effect_emit_anim_end(AwnEffectsAnimation* anim);
 
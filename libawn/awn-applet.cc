@@ -33,8 +33,10 @@
 
 #include "awn-defines.h"
 #include "awn-applet.h"
+#include "awn-effects.h"
 #include "awn-utils.h"
 #include "awn-enum-types.h"
+#include "awn-startup-trace.h"
 #include "gseal-transition.h"
 #include "libawn-marshal.h"
 
@@ -64,6 +66,7 @@ struct _AwnAppletPrivate {
 
     gboolean show_all_on_embed;
     gboolean quit_on_delete;
+    gboolean panel_hidden;
 
     gint origin_x, origin_y;
     gint pos_x, pos_y;
@@ -91,6 +94,7 @@ enum {
 
     PROP_SHOW_ALL_ON_EMBED,
     PROP_QUIT_ON_DELETE,
+    PROP_PANEL_HIDDEN,
 };
 
 enum {
@@ -164,11 +168,35 @@ awn_applet_plug_embedded(AwnApplet* applet)
 
     AwnAppletPrivate* priv = applet->priv;
 
+    awn_startup_trace_mark("embedded");
+
     if (priv->show_all_on_embed) {
         gtk_widget_show_all(GTK_WIDGET(applet));
     }
 }
 
+static gboolean
+on_first_expose(GtkWidget* widget, GdkEventExpose* event)
+{
+    awn_startup_trace_mark("first expose");
+    g_signal_handlers_disconnect_by_func(widget, (gpointer)on_first_expose, NULL);
+
+    return FALSE;
+}
+
+static void
+report_startup_phase(const AwnStartupTraceEvent* event, AwnApplet* applet)
+{
+    dbus_g_proxy_call_no_reply(applet->priv->proxy, "ReportStartupPhase",
+                               G_TYPE_STRING, event->process ?
+                               event->process : awn_startup_trace_get_process_name(),
+                               G_TYPE_INT, event->pid,
+                               G_TYPE_STRING, event->name,
+                               G_TYPE_INT64, event->timestamp,
+                               G_TYPE_INT64, event->duration,
+                               G_TYPE_INVALID);
+}
+
 static gboolean
 on_plug_deleted(GObject* object)
 {
@@ -312,6 +340,11 @@ awn_applet_set_property(GObject*      object,
     case PROP_QUIT_ON_DELETE:
         applet->priv->quit_on_delete = g_value_get_boolean(value);
         break;
+    case PROP_PANEL_HIDDEN:
+        applet->priv->panel_hidden = g_value_get_boolean(value);
+        awn_effects_set_paused_for_toplevel(GTK_WIDGET(applet),
+                                            applet->priv->panel_hidden);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -382,6 +415,10 @@ awn_applet_get_property(GObject*    object,
         g_value_set_boolean(value, priv->quit_on_delete);
         break;
 
+    case PROP_PANEL_HIDDEN:
+        g_value_set_boolean(value, priv->panel_hidden);
+        break;
+
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -447,6 +484,15 @@ awn_applet_constructed(GObject* obj)
         g_signal_connect(priv->proxy, "destroy",
                          G_CALLBACK(on_proxy_destroyed), applet);
 
+        /* the panel collects the startup trace, hand it our events */
+        if (awn_startup_trace_enabled()) {
+            awn_startup_trace_set_process_name(priv->canonical_name);
+            awn_startup_trace_set_sink((AwnStartupTraceSink)report_startup_phase,
+                                       applet);
+            g_signal_connect_after(applet, "expose-event",
+                                   G_CALLBACK(on_first_expose), NULL);
+        }
+
         // get prop values from Panel
         DBusGProxy* prop_proxy = dbus_g_proxy_new_from_proxy(
                                      priv->proxy, "org.freedesktop.DBus.Properties", NULL
@@ -627,6 +673,10 @@ awn_applet_finalize(GObject* obj)
 {
     AwnAppletPrivate* priv = AWN_APPLET_GET_PRIVATE(obj);
 
+    if (priv->proxy && awn_startup_trace_enabled()) {
+        awn_startup_trace_set_sink(NULL, NULL);
+    }
+
     if (priv->connection) {
         if (priv->proxy) {
             g_object_unref(priv->proxy);
@@ -869,6 +919,20 @@ awn_applet_class_init(AwnAppletClass* klass)
                                             "Quit the applet when it's socket is destroyed",
                                             TRUE,
                                             G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+    /**
+    * AwnApplet:panel-hidden:
+    *
+    * Whether the panel is hidden by autohide, the panel sets it.  The
+    * animations of the applet are paused meanwhile.
+    */
+
+    g_object_class_install_property(g_object_class,
+                                    PROP_PANEL_HIDDEN,
+                                    g_param_spec_boolean("panel-hidden",
+                                            "Panel hidden",
+                                            "Whether the panel is hidden by autohide",
+                                            FALSE,
+                                            G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
     /* Class signals */
     _applet_signals[POS_CHANGED] =
@@ -22,6 +22,7 @@
 #endif
 
 #include "awn-config.h"
+#include "awn-startup-trace.h"
 
 /**
  * SECTION: awn-config
@@ -75,6 +76,7 @@ awn_config_get_default(gint panel_id, GError** error)
              instance_id);
     if (client == NULL) {
         char* schema_filename;
+        gint64 start = awn_startup_trace_now();
 
         schema_filename = g_build_filename(SCHEMADIR, "avant-window-navigator.schema-ini", NULL);
         if (panel_id != 0) {
@@ -95,6 +97,7 @@ awn_config_get_default(gint panel_id, GError** error)
         }
         g_datalist_set_data_full(&awn_config_clients, instance_id, client,
                                  on_config_destroy);
+        awn_startup_trace_span("config", start);
     }
     g_free(instance_id);
     return client;
@@ -195,6 +198,7 @@ awn_config_get_default_for_applet_by_info(const gchar*  name,
         gchar* schema_basename;
         gchar* schema_filename;
         DesktopAgnosticConfigSchema* schema;
+        gint64 start = awn_startup_trace_now();
 
         schema_basename = g_strdup_printf("awn-applet-%s.schema-ini", name);
 
@@ -229,7 +233,411 @@ awn_config_get_default_for_applet_by_info(const gchar*  name,
         }
         g_datalist_set_data_full(&awn_config_clients, instance_id, client,
                                  on_config_destroy);
+        awn_startup_trace_span("applet config", start);
     }
     g_free(instance_id);
     return client;
 }
+
+
+/*
+ * Config snapshots
+ */
+
+/* awn animates at 25 fps, changes arriving within one frame are applied
+ * together */
+#define SNAPSHOT_FLUSH_INTERVAL (1000 / 25)
+
+struct _AwnConfigSnapshot {
+    DesktopAgnosticConfigClient* client;
+    gchar* group;
+
+    GHashTable* values;   /* key -> GValue*, replaced but never modified */
+    GHashTable* pending;  /* key -> GValue* changed since the last flush */
+    GHashTable* bindings; /* key -> GPtrArray of SnapshotBinding* */
+    GHashTable* objects;  /* bound GObject* -> number of its bindings */
+    guint flush_id;
+};
+
+typedef struct {
+    GObject* object;
+    gchar* property;
+} SnapshotBinding;
+
+static GValue*
+snapshot_value_dup(const GValue* value)
+{
+    GValue* copy = g_new0(GValue, 1);
+
+    g_value_init(copy, G_VALUE_TYPE(value));
+    g_value_copy(value, copy);
+    return copy;
+}
+
+static void
+snapshot_value_free(GValue* value)
+{
+    g_value_unset(value);
+    g_free(value);
+}
+
+static void
+snapshot_bindings_free(GPtrArray* bindings)
+{
+    for (guint i = 0; i < bindings->len; i++) {
+        SnapshotBinding* binding = (SnapshotBinding*)g_ptr_array_index(bindings, i);
+        g_free(binding->property);
+        g_free(binding);
+    }
+    g_ptr_array_free(bindings, TRUE);
+}
+
+static void
+snapshot_set_property(GObject* object, const gchar* property,
+                      const GValue* value)
+{
+    GParamSpec* pspec;
+    GValue converted = {0};
+
+    pspec = g_object_class_find_property(G_OBJECT_GET_CLASS(object), property);
+    if (G_VALUE_TYPE(value) == pspec->value_type) {
+        g_object_set_property(object, property, value);
+        return;
+    }
+
+    g_value_init(&converted, pspec->value_type);
+    if (g_value_transform(value, &converted)) {
+        g_object_set_property(object, property, &converted);
+    } else {
+        g_warning("Cannot convert a %s config value to the %s property '%s'",
+                  G_VALUE_TYPE_NAME(value), g_type_name(pspec->value_type),
+                  property);
+    }
+    g_value_unset(&converted);
+}
+
+static void
+snapshot_remove_object(AwnConfigSnapshot* snapshot, GObject* object)
+{
+    GHashTableIter iter;
+    gpointer bindings;
+
+    g_hash_table_iter_init(&iter, snapshot->bindings);
+    while (g_hash_table_iter_next(&iter, NULL, &bindings)) {
+        GPtrArray* array = (GPtrArray*)bindings;
+
+        for (gint i = array->len - 1; i >= 0; i--) {
+            SnapshotBinding* binding = (SnapshotBinding*)g_ptr_array_index(array, i);
+            if (binding->object == object) {
+                g_ptr_array_remove_index(array, i);
+                g_free(binding->property);
+                g_free(binding);
+            }
+        }
+    }
+    g_hash_table_remove(snapshot->objects, object);
+}
+
+static void
+on_bound_object_finalized(AwnConfigSnapshot* snapshot, GObject* object)
+{
+    snapshot_remove_object(snapshot, object);
+}
+
+static gboolean
+snapshot_flush(AwnConfigSnapshot* snapshot)
+{
+    GHashTable* pending = snapshot->pending;
+    GHashTableIter iter;
+    gpointer key, value;
+
+    snapshot->flush_id = 0;
+    snapshot->pending = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                        (GDestroyNotify)snapshot_value_free);
+
+    /* update every value first, so bound objects see a consistent snapshot */
+    g_hash_table_iter_init(&iter, pending);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+        g_hash_table_replace(snapshot->values, g_strdup((gchar*)key),
+                             snapshot_value_dup((GValue*)value));
+    }
+
+    g_hash_table_iter_init(&iter, pending);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+        GPtrArray* bindings = (GPtrArray*)g_hash_table_lookup(snapshot->bindings,
+                              key);
+        GArray* targets;
+
+        if (!bindings) {
+            continue;
+        }
+
+        /* property handlers can bind and unbind, so walk a copy holding a
+         * reference to every object and skip the ones unbound meanwhile */
+        targets = g_array_sized_new(FALSE, FALSE, sizeof(SnapshotBinding),
+                                    bindings->len);
+        for (guint i = 0; i < bindings->len; i++) {
+            SnapshotBinding* binding = (SnapshotBinding*)g_ptr_array_index(bindings, i);
+            SnapshotBinding target;
+
+            target.object = G_OBJECT(g_object_ref(binding->object));
+            target.property = g_strdup(binding->property);
+            g_array_append_val(targets, target);
+        }
+
+        for (guint i = 0; i < targets->len; i++) {
+            SnapshotBinding* target = &g_array_index(targets, SnapshotBinding, i);
+
+            if (g_hash_table_lookup(snapshot->objects, target->object)) {
+                snapshot_set_property(target->object, target->property,
+                                      (GValue*)value);
+            }
+        }
+
+        for (guint i = 0; i < targets->len; i++) {
+            SnapshotBinding* target = &g_array_index(targets, SnapshotBinding, i);
+
+            g_object_unref(target->object);
+            g_free(target->property);
+        }
+        g_array_free(targets, TRUE);
+    }
+
+    g_hash_table_destroy(pending);
+    return FALSE;
+}
+
+static void
+on_snapshot_key_changed(const gchar* group, const gchar* key, GValue* value,
+                        AwnConfigSnapshot* snapshot)
+{
+    g_hash_table_replace(snapshot->pending, g_strdup(key),
+                         snapshot_value_dup(value));
+    if (!snapshot->flush_id) {
+        snapshot->flush_id = g_timeout_add(SNAPSHOT_FLUSH_INTERVAL,
+                                           (GSourceFunc)snapshot_flush,
+                                           snapshot);
+    }
+}
+
+/* Reads the key and starts watching it the first time it's asked for */
+static const GValue*
+snapshot_ensure_key(AwnConfigSnapshot* snapshot, const gchar* key,
+                    GError** error)
+{
+    GValue* value;
+    GError* local_error = NULL;
+
+    value = (GValue*)g_hash_table_lookup(snapshot->values, key);
+    if (value) {
+        return value;
+    }
+
+    value = g_new0(GValue, 1);
+    desktop_agnostic_config_client_get_value(snapshot->client, snapshot->group,
+            key, value, &local_error);
+    if (!local_error) {
+        desktop_agnostic_config_client_notify_add(snapshot->client,
+                snapshot->group, key,
+                (DesktopAgnosticConfigNotifyFunc)on_snapshot_key_changed,
+                snapshot, &local_error);
+    }
+    if (local_error) {
+        if (G_IS_VALUE(value)) {
+            g_value_unset(value);
+        }
+        g_free(value);
+        g_propagate_error(error, local_error);
+        return NULL;
+    }
+
+    g_hash_table_insert(snapshot->values, g_strdup(key), value);
+    return value;
+}
+
+static gchar*
+snapshot_data_key(const gchar* group)
+{
+    return g_strdup_printf("awn-config-snapshot-%s", group);
+}
+
+/* Runs when the client is disposed, while it can still remove notifies */
+static void
+snapshot_free(AwnConfigSnapshot* snapshot, GObject* client)
+{
+    GHashTableIter iter;
+    gpointer key, object;
+    gchar* data_key;
+
+    if (snapshot->flush_id) {
+        g_source_remove(snapshot->flush_id);
+    }
+
+    /* every key in values has its notify, see snapshot_ensure_key() */
+    g_hash_table_iter_init(&iter, snapshot->values);
+    while (g_hash_table_iter_next(&iter, &key, NULL)) {
+        desktop_agnostic_config_client_notify_remove(snapshot->client,
+                snapshot->group, (gchar*)key,
+                (DesktopAgnosticConfigNotifyFunc)on_snapshot_key_changed,
+                snapshot, NULL);
+    }
+
+    g_hash_table_iter_init(&iter, snapshot->objects);
+    while (g_hash_table_iter_next(&iter, &object, NULL)) {
+        g_object_weak_unref(G_OBJECT(object),
+                            (GWeakNotify)on_bound_object_finalized, snapshot);
+    }
+
+    data_key = snapshot_data_key(snapshot->group);
+    g_object_set_data(client, data_key, NULL);
+    g_free(data_key);
+
+    g_hash_table_destroy(snapshot->objects);
+    g_hash_table_destroy(snapshot->bindings);
+    g_hash_table_destroy(snapshot->pending);
+    g_hash_table_destroy(snapshot->values);
+    g_free(snapshot->group);
+    g_free(snapshot);
+}
+
+/**
+ * awn_config_snapshot_get:
+ * @client: The configuration client.
+ * @group: The configuration group.
+ *
+ * Looks up or creates the snapshot of @group's values in @client.  Any
+ * number of objects can read from and bind to the snapshot, it watches each
+ * key once for all of them and applies bursts of changes once per frame.
+ *
+ * Returns: A snapshot owned by @client.
+ */
+AwnConfigSnapshot*
+awn_config_snapshot_get(DesktopAgnosticConfigClient* client,
+                        const gchar* group)
+{
+    AwnConfigSnapshot* snapshot;
+    gchar* data_key;
+
+    g_return_val_if_fail(DESKTOP_AGNOSTIC_CONFIG_IS_CLIENT(client), NULL);
+    g_return_val_if_fail(group != NULL, NULL);
+
+    data_key = snapshot_data_key(group);
+    snapshot = (AwnConfigSnapshot*)g_object_get_data(G_OBJECT(client), data_key);
+    if (!snapshot) {
+        snapshot = g_new0(AwnConfigSnapshot, 1);
+        snapshot->client = client;
+        snapshot->group = g_strdup(group);
+        snapshot->values = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                           (GDestroyNotify)snapshot_value_free);
+        snapshot->pending = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                            (GDestroyNotify)snapshot_value_free);
+        snapshot->bindings = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                             (GDestroyNotify)snapshot_bindings_free);
+        snapshot->objects = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+        g_object_set_data(G_OBJECT(client), data_key, snapshot);
+        g_object_weak_ref(G_OBJECT(client), (GWeakNotify)snapshot_free,
+                          snapshot);
+    }
+    g_free(data_key);
+
+    return snapshot;
+}
+
+/**
+ * awn_config_snapshot_get_value:
+ * @snapshot: The snapshot.
+ * @key: The configuration key.
+ * @error: The address of the #GError object, if an error occurs.
+ *
+ * Reads @key from the snapshot, loading it from the configuration backend
+ * only the first time.
+ *
+ * Returns: The value, valid until the next change to @key is applied.
+ */
+const GValue*
+awn_config_snapshot_get_value(AwnConfigSnapshot* snapshot, const gchar* key,
+                              GError** error)
+{
+    g_return_val_if_fail(snapshot != NULL, NULL);
+    g_return_val_if_fail(key != NULL, NULL);
+
+    return snapshot_ensure_key(snapshot, key, error);
+}
+
+/**
+ * awn_config_snapshot_bind:
+ * @snapshot: The snapshot.
+ * @key: The configuration key.
+ * @object: The object to update.
+ * @property: The name of the property of @object to update.
+ * @error: The address of the #GError object, if an error occurs.
+ *
+ * Sets @property to the value of @key now and whenever it changes.  Unlike
+ * desktop_agnostic_config_client_bind() this is a one-way binding that
+ * doesn't add another notification to the client.  It is removed when
+ * @object is finalized.
+ *
+ * Returns: %TRUE if the binding was added.
+ */
+gboolean
+awn_config_snapshot_bind(AwnConfigSnapshot* snapshot, const gchar* key,
+                         GObject* object, const gchar* property,
+                         GError** error)
+{
+    const GValue* value;
+    GPtrArray* bindings;
+    SnapshotBinding* binding;
+    guint count;
+
+    g_return_val_if_fail(snapshot != NULL, FALSE);
+    g_return_val_if_fail(key != NULL, FALSE);
+    g_return_val_if_fail(G_IS_OBJECT(object), FALSE);
+    g_return_val_if_fail(g_object_class_find_property(G_OBJECT_GET_CLASS(object),
+                         property) != NULL, FALSE);
+
+    value = snapshot_ensure_key(snapshot, key, error);
+    if (!value) {
+        return FALSE;
+    }
+    snapshot_set_property(object, property, value);
+
+    bindings = (GPtrArray*)g_hash_table_lookup(snapshot->bindings, key);
+    if (!bindings) {
+        bindings = g_ptr_array_new();
+        g_hash_table_insert(snapshot->bindings, g_strdup(key), bindings);
+    }
+    binding = g_new(SnapshotBinding, 1);
+    binding->object = object;
+    binding->property = g_strdup(property);
+    g_ptr_array_add(bindings, binding);
+
+    count = GPOINTER_TO_UINT(g_hash_table_lookup(snapshot->objects, object));
+    if (!count) {
+        g_object_weak_ref(object, (GWeakNotify)on_bound_object_finalized,
+                          snapshot);
+    }
+    g_hash_table_insert(snapshot->objects, object, GUINT_TO_POINTER(count + 1));
+
+    return TRUE;
+}
+
+/**
+ * awn_config_snapshot_unbind_all_for_object:
+ * @snapshot: The snapshot.
+ * @object: The bound object.
+ *
+ * Removes all the bindings of @object added with awn_config_snapshot_bind().
+ */
+void
+awn_config_snapshot_unbind_all_for_object(AwnConfigSnapshot* snapshot,
+        GObject* object)
+{
+    g_return_if_fail(snapshot != NULL);
+
+    if (g_hash_table_lookup(snapshot->objects, object)) {
+        g_object_weak_unref(object, (GWeakNotify)on_bound_object_finalized,
+                            snapshot);
+        snapshot_remove_object(snapshot, object);
+    }
+}
@@ -33,6 +33,13 @@ DesktopAgnosticConfigClient* awn_config_get_default_for_applet(AwnApplet* applet
 DesktopAgnosticConfigClient* awn_config_get_default_for_applet_by_info(const gchar* name, const gchar* uid, GError** error);
 void                         awn_config_free(void);
 
+typedef struct _AwnConfigSnapshot AwnConfigSnapshot;
+
+AwnConfigSnapshot* awn_config_snapshot_get(DesktopAgnosticConfigClient* client, const gchar* group);
+const GValue*      awn_config_snapshot_get_value(AwnConfigSnapshot* snapshot, const gchar* key, GError** error);
+gboolean           awn_config_snapshot_bind(AwnConfigSnapshot* snapshot, const gchar* key, GObject* object, const gchar* property, GError** error);
+void               awn_config_snapshot_unbind_all_for_object(AwnConfigSnapshot* snapshot, GObject* object);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -0,0 +1,482 @@
+/*
+ * Copyright (C) 2026 Awn-core team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* awn-effects-replay.c */
+
+#include <string.h>
+#include <stdlib.h>
+
+#include "awn-effects-replay.h"
+#include "anims/awn-effects-shared.h"
+
+#define RECORDING_HEADER "# awn effects recording"
+
+typedef enum {
+    EVENT_START,
+    EVENT_STOP,
+    EVENT_EFFECTS
+} EventType;
+
+typedef struct {
+    EventType type;
+    guint frame;
+    gint value; /* the effect, or the effects for EVENT_EFFECTS */
+    gint max_loops;
+    gboolean signal_start;
+    gboolean signal_end;
+} Event;
+
+/* what the ops draw from, the rest of AwnEffectsPrivate is bookkeeping */
+typedef struct {
+    gint current_effect;
+    gint count;
+    gint direction;
+    gdouble side_offset;
+    gdouble top_offset;
+    gdouble curve_offset;
+    gfloat width_mod;
+    gfloat height_mod;
+    gdouble rotate_degrees;
+    gfloat alpha;
+    gfloat spotlight_alpha;
+    gfloat saturation;
+    gfloat glow_amount;
+    gint icon_depth;
+    gint icon_depth_direction;
+    GtkAllocation clip_region;
+    gboolean clip;
+    gboolean flip;
+    gboolean spotlight;
+    gboolean simple_rect;
+} FrameState;
+
+struct _AwnEffectsRecording {
+    gint effects;
+    gint position;
+    gint icon_width;
+    gint icon_height;
+
+    GArray* events; /* Event */
+    GArray* frames; /* FrameState */
+};
+
+AwnEffectsRecording*
+awn_effects_recording_new(void)
+{
+    AwnEffectsRecording* recording = g_new0(AwnEffectsRecording, 1);
+
+    recording->position = GTK_POS_BOTTOM;
+    recording->icon_width = 48;
+    recording->icon_height = 48;
+    recording->events = g_array_new(FALSE, FALSE, sizeof(Event));
+    recording->frames = g_array_new(FALSE, FALSE, sizeof(FrameState));
+    return recording;
+}
+
+void
+awn_effects_recording_free(AwnEffectsRecording* recording)
+{
+    g_return_if_fail(recording);
+
+    g_array_free(recording->events, TRUE);
+    g_array_free(recording->frames, TRUE);
+    g_free(recording);
+}
+
+guint
+awn_effects_recording_get_n_frames(AwnEffectsRecording* recording)
+{
+    g_return_val_if_fail(recording, 0);
+
+    return recording->frames->len;
+}
+
+static void
+add_event(AwnEffectsRecording* recording, EventType type, guint frame,
+          gint value, gint max_loops, gboolean signal_start, gboolean signal_end)
+{
+    Event event;
+
+    event.type = type;
+    event.frame = frame;
+    event.value = value;
+    event.max_loops = max_loops;
+    event.signal_start = signal_start;
+    event.signal_end = signal_end;
+    g_array_append_val(recording->events, event);
+}
+
+void
+awn_effects_recording_add_start(AwnEffectsRecording* recording, guint frame,
+                                AwnEffect effect, gint max_loops,
+                                gboolean signal_start, gboolean signal_end)
+{
+    add_event(recording, EVENT_START, frame, effect, max_loops,
+              signal_start, signal_end);
+}
+
+void
+awn_effects_recording_add_stop(AwnEffectsRecording* recording, guint frame,
+                               AwnEffect effect)
+{
+    add_event(recording, EVENT_STOP, frame, effect, 0, FALSE, FALSE);
+}
+
+void
+awn_effects_recording_add_effects(AwnEffectsRecording* recording, guint frame,
+                                  gint effects)
+{
+    add_event(recording, EVENT_EFFECTS, frame, effects, 0, FALSE, FALSE);
+}
+
+static void
+get_frame_state(AwnEffects* fx, FrameState* state)
+{
+    AwnEffectsPrivate* priv = fx->priv;
+
+    memset(state, 0, sizeof(FrameState));
+    state->current_effect = priv->current_effect;
+    state->count = priv->count;
+    state->direction = priv->direction;
+    state->side_offset = priv->side_offset;
+    state->top_offset = priv->top_offset;
+    state->curve_offset = priv->curve_offset;
+    state->width_mod = priv->width_mod;
+    state->height_mod = priv->height_mod;
+    state->rotate_degrees = priv->rotate_degrees;
+    state->alpha = priv->alpha;
+    state->spotlight_alpha = priv->spotlight_alpha;
+    state->saturation = priv->saturation;
+    state->glow_amount = priv->glow_amount;
+    state->icon_depth = priv->icon_depth;
+    state->icon_depth_direction = priv->icon_depth_direction;
+    state->clip_region = priv->clip_region;
+    state->clip = priv->clip;
+    state->flip = priv->flip;
+    state->spotlight = priv->spotlight;
+    state->simple_rect = priv->simple_rect;
+}
+
+void
+awn_effects_recording_add_frame(AwnEffectsRecording* recording, AwnEffects* fx)
+{
+    FrameState state;
+
+    get_frame_state(fx, &state);
+    g_array_append_val(recording->frames, state);
+}
+
+/* The state was zeroed before it was filled, so the padding compares too */
+static gboolean
+frame_state_equal(const FrameState* a, const FrameState* b)
+{
+    return memcmp(a, b, sizeof(FrameState)) == 0;
+}
+
+void
+awn_effects_record(AwnEffects* fx, AwnEffectsRecording* recording)
+{
+    g_return_if_fail(AWN_IS_EFFECTS(fx));
+
+    fx->priv->recording = recording;
+    if (recording) {
+        /* like the replay, don't run a frame when an effect starts */
+        fx->priv->already_exposed = TRUE;
+        fx->priv->frame = 0;
+        recording->effects = fx->set_effects;
+        recording->position = fx->position;
+        recording->icon_width = fx->priv->icon_width;
+        recording->icon_height = fx->priv->icon_height;
+    }
+}
+
+static void
+apply_event(AwnEffects* fx, const Event* event)
+{
+    switch (event->type) {
+    case EVENT_START:
+        awn_effects_start_ex(fx, (AwnEffect)event->value, event->max_loops,
+                             event->signal_start, event->signal_end);
+        break;
+    case EVENT_STOP:
+        awn_effects_stop(fx, (AwnEffect)event->value);
+        break;
+    case EVENT_EFFECTS:
+        g_object_set(fx, "effects", event->value, NULL);
+        break;
+    }
+}
+
+guint
+awn_effects_replay(AwnEffects* fx, AwnEffectsRecording* recording,
+                   AwnEffectsReplayFunc func, gpointer user_data)
+{
+    AwnEffectsPrivate* priv;
+    guint next = 0;
+    guint mismatches = 0;
+
+    g_return_val_if_fail(AWN_IS_EFFECTS(fx), 0);
+    g_return_val_if_fail(recording, 0);
+    priv = fx->priv;
+
+    g_object_set(fx, "effects", recording->effects,
+                 "position", recording->position, NULL);
+    awn_effects_set_icon_size(fx, recording->icon_width,
+                              recording->icon_height, FALSE);
+    /* no frame is run right away when an effect starts */
+    priv->already_exposed = TRUE;
+
+    awn_effects_set_virtual_clock(fx, TRUE);
+    priv->virtual_time = 0;
+    priv->frame = 0;
+
+    while (TRUE) {
+        FrameState state;
+
+        while (next < recording->events->len &&
+                g_array_index(recording->events, Event, next).frame <= priv->frame) {
+            apply_event(fx, &g_array_index(recording->events, Event, next++));
+        }
+
+        if (priv->frame >= recording->frames->len &&
+                next >= recording->events->len) {
+            /* recorded until here, even if the animation goes on */
+            break;
+        }
+
+        if (!awn_effects_step_virtual_clock(fx)) {
+            if (next >= recording->events->len) {
+                break;
+            }
+            /* the recording had frames we don't, carry on with its calls */
+            apply_event(fx, &g_array_index(recording->events, Event, next++));
+            continue;
+        }
+
+        get_frame_state(fx, &state);
+        if (priv->frame > recording->frames->len ||
+                !frame_state_equal(&state, &g_array_index(recording->frames,
+                                   FrameState, priv->frame - 1))) {
+            mismatches++;
+        }
+
+        if (func) {
+            func(fx, priv->frame, priv->virtual_time, user_data);
+        }
+    }
+
+    if (priv->frame < recording->frames->len) {
+        mismatches += recording->frames->len - priv->frame;
+    }
+
+    awn_effects_set_virtual_clock(fx, FALSE);
+    return mismatches;
+}
+
+/*
+ The file is plain text, one line per call or frame, in the order they
+ happened.  Floating point values are written with all their digits, so that
+ they load back exactly.
+ */
+static void
+append_double(GString* line, gdouble value)
+{
+    gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+    g_string_append_c(line, ' ');
+    g_string_append(line, g_ascii_formatd(buf, sizeof(buf), "%.17g", value));
+}
+
+static void
+append_event(GString* contents, const Event* event)
+{
+    switch (event->type) {
+    case EVENT_START:
+        g_string_append_printf(contents, "start %u %d %d %d %d\n",
+                               event->frame, event->value, event->max_loops,
+                               event->signal_start, event->signal_end);
+        break;
+    case EVENT_STOP:
+        g_string_append_printf(contents, "stop %u %d\n",
+                               event->frame, event->value);
+        break;
+    case EVENT_EFFECTS:
+        g_string_append_printf(contents, "effects %u %d\n",
+                               event->frame, event->value);
+        break;
+    }
+}
+
+static void
+append_frame(GString* contents, guint frame, const FrameState* state)
+{
+    g_string_append_printf(contents, "frame %u %d %d %d", frame,
+                           state->current_effect, state->count, state->direction);
+    append_double(contents, state->side_offset);
+    append_double(contents, state->top_offset);
+    append_double(contents, state->curve_offset);
+    append_double(contents, state->width_mod);
+    append_double(contents, state->height_mod);
+    append_double(contents, state->rotate_degrees);
+    append_double(contents, state->alpha);
+    append_double(contents, state->spotlight_alpha);
+    append_double(contents, state->saturation);
+    append_double(contents, state->glow_amount);
+    g_string_append_printf(contents, " %d %d %d %d %d %d %d %d %d %d\n",
+                           state->icon_depth, state->icon_depth_direction,
+                           state->clip_region.x, state->clip_region.y,
+                           state->clip_region.width, state->clip_region.height,
+                           state->clip, state->flip, state->spotlight,
+                           state->simple_rect);
+}
+
+gboolean
+awn_effects_recording_save(AwnEffectsRecording* recording,
+                           const gchar* filename, GError** error)
+{
+    GString* contents;
+    guint next = 0;
+    gboolean result;
+
+    g_return_val_if_fail(recording && filename, FALSE);
+
+    contents = g_string_new(RECORDING_HEADER "\n");
+    g_string_append_printf(contents, "setup %d %d %d %d\n", recording->effects,
+                           recording->position, recording->icon_width,
+                           recording->icon_height);
+
+    for (guint i = 0; i <= recording->frames->len; i++) {
+        while (next < recording->events->len &&
+                g_array_index(recording->events, Event, next).frame <= i) {
+            append_event(contents, &g_array_index(recording->events, Event, next++));
+        }
+        if (i < recording->frames->len) {
+            append_frame(contents, i + 1,
+                         &g_array_index(recording->frames, FrameState, i));
+        }
+    }
+    while (next < recording->events->len) {
+        append_event(contents, &g_array_index(recording->events, Event, next++));
+    }
+
+    result = g_file_set_contents(filename, contents->str, contents->len, error);
+    g_string_free(contents, TRUE);
+    return result;
+}
+
+static gboolean
+parse_line(AwnEffectsRecording* recording, gchar** tokens)
+{
+    guint n = g_strv_length(tokens);
+    const gchar* type = tokens[0];
+
+#define INT(i) ((gint)g_ascii_strtoll(tokens[i], NULL, 10))
+#define DOUBLE(i) (g_ascii_strtod(tokens[i], NULL))
+
+    if (strcmp(type, "setup") == 0 && n == 5) {
+        recording->effects = INT(1);
+        recording->position = INT(2);
+        recording->icon_width = INT(3);
+        recording->icon_height = INT(4);
+    } else if (strcmp(type, "start") == 0 && n == 6) {
+        add_event(recording, EVENT_START, INT(1), INT(2), INT(3), INT(4), INT(5));
+    } else if (strcmp(type, "stop") == 0 && n == 3) {
+        add_event(recording, EVENT_STOP, INT(1), INT(2), 0, FALSE, FALSE);
+    } else if (strcmp(type, "effects") == 0 && n == 3) {
+        add_event(recording, EVENT_EFFECTS, INT(1), INT(2), 0, FALSE, FALSE);
+    } else if (strcmp(type, "frame") == 0 && n == 25) {
+        FrameState state;
+
+        memset(&state, 0, sizeof(FrameState));
+        state.current_effect = INT(2);
+        state.count = INT(3);
+        state.direction = INT(4);
+        state.side_offset = DOUBLE(5);
+        state.top_offset = DOUBLE(6);
+        state.curve_offset = DOUBLE(7);
+        state.width_mod = DOUBLE(8);
+        state.height_mod = DOUBLE(9);
+        state.rotate_degrees = DOUBLE(10);
+        state.alpha = DOUBLE(11);
+        state.spotlight_alpha = DOUBLE(12);
+        state.saturation = DOUBLE(13);
+        state.glow_amount = DOUBLE(14);
+        state.icon_depth = INT(15);
+        state.icon_depth_direction = INT(16);
+        state.clip_region.x = INT(17);
+        state.clip_region.y = INT(18);
+        state.clip_region.width = INT(19);
+        state.clip_region.height = INT(20);
+        state.clip = INT(21);
+        state.flip = INT(22);
+        state.spotlight = INT(23);
+        state.simple_rect = INT(24);
+        g_array_append_val(recording->frames, state);
+    } else {
+        return FALSE;
+    }
+
+#undef INT
+#undef DOUBLE
+
+    return TRUE;
+}
+
+AwnEffectsRecording*
+awn_effects_recording_load(const gchar* filename, GError** error)
+{
+    AwnEffectsRecording* recording;
+    gchar* contents;
+    gchar** lines;
+
+    g_return_val_if_fail(filename, NULL);
+
+    if (!g_file_get_contents(filename, &contents, NULL, error)) {
+        return NULL;
+    }
+    if (!g_str_has_prefix(contents, RECORDING_HEADER)) {
+        g_set_error(error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+                    "%s is not an effects recording", filename);
+        g_free(contents);
+        return NULL;
+    }
+
+    recording = awn_effects_recording_new();
+    lines = g_strsplit(contents, "\n", -1);
+    for (guint i = 1; lines[i]; i++) {
+        gchar** tokens;
+
+        if (lines[i][0] == '\0' || lines[i][0] == '#') {
+            continue;
+        }
+        tokens = g_strsplit(lines[i], " ", -1);
+        if (!parse_line(recording, tokens)) {
+            g_set_error(error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+                        "%s:%u: invalid line", filename, i + 1);
+            g_strfreev(tokens);
+            g_strfreev(lines);
+            g_free(contents);
+            awn_effects_recording_free(recording);
+            return NULL;
+        }
+        g_strfreev(tokens);
+    }
+
+    g_strfreev(lines);
+    g_free(contents);
+    return recording;
+}
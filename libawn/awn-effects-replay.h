@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2026 Awn-core team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* awn-effects-replay.h */
+
+#ifndef _AWN_EFFECTS_REPLAY_H
+#define _AWN_EFFECTS_REPLAY_H
+
+#include "awn-effects.h"
+
+/*
+ Records what an AwnEffects is asked to do (awn_effects_start_ex(),
+ awn_effects_stop() and changes of the effects property) together with the
+ animation state after every frame, and replays it on a virtual clock.
+
+ The animations advance per frame, never by the time passed, so a replay
+ goes through exactly the recorded frames, as fast as the caller can render
+ them.  Calls are keyed by the number of frames run before them.
+ */
+
+typedef struct _AwnEffectsRecording AwnEffectsRecording;
+
+/* Called after every replayed frame, time is the virtual clock in ms */
+typedef void (*AwnEffectsReplayFunc)(AwnEffects* fx, guint frame,
+                                     gint64 time, gpointer user_data);
+
+AwnEffectsRecording* awn_effects_recording_new(void);
+
+void     awn_effects_recording_free(AwnEffectsRecording* recording);
+
+gboolean awn_effects_recording_save(AwnEffectsRecording* recording,
+                                    const gchar* filename, GError** error);
+
+AwnEffectsRecording* awn_effects_recording_load(const gchar* filename,
+                                                GError** error);
+
+guint    awn_effects_recording_get_n_frames(AwnEffectsRecording* recording);
+
+/* Records fx into recording (until called with NULL), starting with its
+ * current effects, position and icon size */
+void     awn_effects_record(AwnEffects* fx, AwnEffectsRecording* recording);
+
+/* Replays recording on fx, which shouldn't be animating, calling func after
+ * every frame.  Returns the number of frames that didn't end in the
+ * recorded state. */
+guint    awn_effects_replay(AwnEffects* fx, AwnEffectsRecording* recording,
+                            AwnEffectsReplayFunc func, gpointer user_data);
+
+/* Used by AwnEffects while recording */
+void     awn_effects_recording_add_start(AwnEffectsRecording* recording,
+                                         guint frame, AwnEffect effect,
+                                         gint max_loops, gboolean signal_start,
+                                         gboolean signal_end);
+
+void     awn_effects_recording_add_stop(AwnEffectsRecording* recording,
+                                        guint frame, AwnEffect effect);
+
+void     awn_effects_recording_add_effects(AwnEffectsRecording* recording,
+                                           guint frame, gint effects);
+
+void     awn_effects_recording_add_frame(AwnEffectsRecording* recording,
+                                         AwnEffects* fx);
+
+#endif
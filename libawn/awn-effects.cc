@@ -29,6 +29,7 @@
 #include <math.h>
 #include <string.h>
 #include <stdlib.h>
+#include <time.h>
 #include <cairo/cairo-xlib.h>
 
 #include "gseal-transition.h"
@@ -58,8 +59,19 @@ extern "C" {
  * property (and use it in the animations) but don't change fps
  */
 #define AWN_FRAMES_PER_SECOND(fx) (25)
+#define AWN_FRAME_INTERVAL(fx) (1000 / AWN_FRAMES_PER_SECOND(fx))
 #define AWN_ANIMATIONS_PER_BUNDLE 5
 
+/* the frame rate governor: the load is the part of the frame interval spent
+ * animating, rendering and waiting for the main loop, averaged over the last
+ * few ticks
+ */
+#define AWN_GOVERNOR_OVERLOAD 0.8
+#define AWN_GOVERNOR_HEADROOM 0.4
+#define AWN_GOVERNOR_SMOOTHING 0.25
+#define AWN_GOVERNOR_SETTLE_TICKS 5
+#define AWN_GOVERNOR_RESTORE_TICKS 25
+
 #define AWN_INTERNAL_ICON "__awn_internal_"
 
 #define AWN_INTERNAL_SPOTLIGHT  AWN_INTERNAL_ICON "spotlight"
@@ -71,6 +83,7 @@ typedef gboolean(*_AwnAnimation)(AwnEffectsAnimation*);
 enum {
     ANIMATION_START,
     ANIMATION_END,
+    LARGE_SOURCE_NEEDED,
 
     LAST_SIGNAL
 };
@@ -99,11 +112,23 @@ enum {
     PROP_DOT_COLOR,
     PROP_ARROW_ICON,
     PROP_ARROWS_COUNT,
-    PROP_CUSTOM_ACTIVE_ICON
+    PROP_CUSTOM_ACTIVE_ICON,
+    PROP_ADAPTIVE_FRAME_RATE,
+    PROP_MIN_FRAME_RATE,
+    PROP_FRAME_RATE,
+    PROP_REDUCED_EFFECTS,
+    PROP_PAUSED
 };
 
 /* FORWARDS */
 static void awn_effects_prop_changed(GObject* object, GParamSpec* pspec);
+static gboolean awn_effects_widget_exposed(AwnEffects* fx);
+static void awn_effects_widget_hidden(AwnEffects* fx);
+static void awn_effects_set_quality_level(AwnEffects* fx, gint level);
+static void awn_effects_resume_timer(AwnEffects* fx);
+
+/* every instance, see awn_effects_set_paused_for_toplevel() */
+static GList* effects_instances = NULL;
 
 static void
 awn_effects_dispose(GObject* object)
@@ -111,12 +136,14 @@ awn_effects_dispose(GObject* object)
     AwnEffects* fx = AWN_EFFECTS(object);
 
     /* destroy animation timer */
-    if (fx->priv->timer_id) {
-        g_source_remove(fx->priv->timer_id);
-        fx->priv->timer_id = 0;
-    }
+    awn_effects_remove_timer(fx);
+    fx->priv->recording = NULL;
 
     if (fx->widget) {
+        g_signal_handlers_disconnect_by_func(fx->widget,
+                                             (gpointer)awn_effects_widget_hidden, fx);
+        g_signal_handlers_disconnect_by_func(fx->widget,
+                                             (gpointer)awn_effects_widget_exposed, fx);
         g_object_remove_weak_pointer((GObject*)fx->widget, (gpointer*)&fx->widget);
         fx->widget = NULL;
     }
@@ -134,6 +161,8 @@ awn_effects_dispose(GObject* object)
         fx->priv->overlays = NULL;
     }
 
+    awn_effects_set_icon_source(fx, NULL);
+
     G_OBJECT_CLASS(awn_effects_parent_class)->dispose(object);
 }
 
@@ -156,6 +185,7 @@ awn_effects_finalize(GObject* object)
     }
 
     fx->widget = NULL;
+    effects_instances = g_list_remove(effects_instances, fx);
 
     /* free effect queue and associated AwnEffectsPriv */
     if (fx->priv->effect_queue) {
@@ -265,6 +295,15 @@ awn_effects_widget_hidden(AwnEffects* fx)
     priv->already_exposed = FALSE;
 }
 
+static gboolean
+awn_effects_widget_exposed(AwnEffects* fx)
+{
+    /* the timer was suspended if the widget couldn't be seen */
+    awn_effects_resume_timer(fx);
+
+    return FALSE;
+}
+
 static void
 awn_effects_get_property(GObject*      object,
                          guint         prop_id,
@@ -340,6 +379,22 @@ awn_effects_get_property(GObject*      object,
     case PROP_DOT_COLOR:
         g_value_set_object(value, fx->priv->dot_color);
         break;
+    case PROP_ADAPTIVE_FRAME_RATE:
+        g_value_set_boolean(value, fx->priv->adaptive);
+        break;
+    case PROP_MIN_FRAME_RATE:
+        g_value_set_int(value, fx->priv->min_frame_rate);
+        break;
+    case PROP_FRAME_RATE:
+        g_value_set_double(value, (gdouble)AWN_FRAMES_PER_SECOND(fx) /
+                           fx->priv->frame_skip);
+        break;
+    case PROP_REDUCED_EFFECTS:
+        g_value_set_boolean(value, fx->priv->quality_level > 0);
+        break;
+    case PROP_PAUSED:
+        g_value_set_boolean(value, fx->priv->paused);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -365,6 +420,8 @@ awn_effects_set_property(GObject*      object,
         g_object_add_weak_pointer((GObject*)fx->widget, (gpointer*)&fx->widget);
         g_signal_connect_swapped((GObject*)fx->widget, "hide",
                                  G_CALLBACK(awn_effects_widget_hidden), fx);
+        g_signal_connect_swapped((GObject*)fx->widget, "expose-event",
+                                 G_CALLBACK(awn_effects_widget_exposed), fx);
         break;
     case PROP_NO_CLEAR:
         fx->no_clear = g_value_get_boolean(value);
@@ -377,6 +434,10 @@ awn_effects_set_property(GObject*      object,
         break;
     case PROP_CURRENT_EFFECTS:
         fx->set_effects = (uint)g_value_get_int(value);
+        if (fx->priv->recording) {
+            awn_effects_recording_add_effects(fx->priv->recording,
+                                              fx->priv->frame, fx->set_effects);
+        }
         break;
     case PROP_ICON_OFFSET:
         fx->icon_offset = g_value_get_int(value);
@@ -446,6 +507,23 @@ awn_effects_set_property(GObject*      object,
         }
         priv->dot_color = g_value_dup_object(value);
         break;
+    case PROP_ADAPTIVE_FRAME_RATE:
+        priv->adaptive = g_value_get_boolean(value);
+        if (!priv->adaptive) {
+            awn_effects_set_quality_level(fx, 0);
+        }
+        break;
+    case PROP_MIN_FRAME_RATE:
+        priv->min_frame_rate = g_value_get_int(value);
+        /* clamps the frame skip to the new minimum */
+        awn_effects_set_quality_level(fx, priv->quality_level);
+        break;
+    case PROP_PAUSED:
+        priv->paused = g_value_get_boolean(value);
+        if (!priv->paused) {
+            awn_effects_resume_timer(fx);
+        }
+        break;
 
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
@@ -599,6 +677,23 @@ awn_effects_class_init(AwnEffectsClass* klass)
                      NULL, NULL,
                      g_cclosure_marshal_VOID__ENUM,
                      G_TYPE_NONE, 1, AWN_TYPE_EFFECT);
+    /**
+     * AwnEffects::large-source-needed:
+     *
+     * @fx: The #AwnEffects instance which received the signal.
+     *
+     * Emitted the first time an effect draws the icon source (see
+     * #awn_effects_set_icon_source) larger than its size.  Handlers can call
+     * #awn_effects_set_icon_source_large, so a larger rendering is only made
+     * for icons that actually get zoomed.  Emitted once for each icon source.
+     */
+    _effects_signals[LARGE_SOURCE_NEEDED] =
+        g_signal_new("large-source-needed", G_OBJECT_CLASS_TYPE(obj_class),
+                     G_SIGNAL_RUN_LAST,
+                     0,
+                     NULL, NULL,
+                     g_cclosure_marshal_VOID__VOID,
+                     G_TYPE_NONE, 0);
 
     g_type_class_add_private(obj_class, sizeof(AwnEffectsPrivate));
 
@@ -955,6 +1050,79 @@ awn_effects_class_init(AwnEffectsClass* klass)
                             NULL,
                             G_PARAM_CONSTRUCT | G_PARAM_READWRITE |
                             G_PARAM_STATIC_STRINGS));
+    /**
+     * AwnEffects:adaptive-frame-rate:
+     *
+     * Determines whether the animations should measure how long their frames
+     * take and, when they don't fit in the frame interval, leave out the
+     * shadow, reflection and 3D depth and then lower the frame rate (down to
+     * #AwnEffects:min-frame-rate). Everything is restored once there's
+     * enough headroom again.
+     */
+    g_object_class_install_property(
+        obj_class, PROP_ADAPTIVE_FRAME_RATE,
+        g_param_spec_boolean("adaptive-frame-rate",
+                             "Adaptive frame rate",
+                             "Reduce the effects and the frame rate when "
+                             "the frames take too long",
+                             TRUE,
+                             G_PARAM_CONSTRUCT | G_PARAM_READWRITE |
+                             G_PARAM_STATIC_STRINGS));
+    /**
+     * AwnEffects:min-frame-rate:
+     *
+     * The frame rate #AwnEffects:adaptive-frame-rate won't go below.
+     */
+    g_object_class_install_property(
+        obj_class, PROP_MIN_FRAME_RATE,
+        g_param_spec_int("min-frame-rate",
+                         "Minimum frame rate",
+                         "Lowest number of frames per second the animations "
+                         "can be reduced to",
+                         1, AWN_FRAMES_PER_SECOND(NULL), 8,
+                         G_PARAM_CONSTRUCT | G_PARAM_READWRITE |
+                         G_PARAM_STATIC_STRINGS));
+    /**
+     * AwnEffects:frame-rate:
+     *
+     * Number of frames per second the animations are currently drawn at.
+     * The animations always advance at the same speed, at lower frame rates
+     * some of their frames aren't drawn.
+     */
+    g_object_class_install_property(
+        obj_class, PROP_FRAME_RATE,
+        g_param_spec_double("frame-rate",
+                            "Frame rate",
+                            "Number of frames per second currently drawn",
+                            0.0, G_MAXDOUBLE, AWN_FRAMES_PER_SECOND(NULL),
+                            G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+    /**
+     * AwnEffects:reduced-effects:
+     *
+     * Set when #AwnEffects:adaptive-frame-rate left out some of the effects
+     * or lowered the frame rate.
+     */
+    g_object_class_install_property(
+        obj_class, PROP_REDUCED_EFFECTS,
+        g_param_spec_boolean("reduced-effects",
+                             "Reduced effects",
+                             "Whether the animations are currently reduced",
+                             FALSE,
+                             G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+    /**
+     * AwnEffects:paused:
+     *
+     * Stops the animations where they are until it's unset again. They're
+     * also stopped while the managed widget isn't visible on the screen.
+     */
+    g_object_class_install_property(
+        obj_class, PROP_PAUSED,
+        g_param_spec_boolean("paused",
+                             "Paused",
+                             "Determines whether the animations are stopped",
+                             FALSE,
+                             G_PARAM_CONSTRUCT | G_PARAM_READWRITE |
+                             G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -973,6 +1141,11 @@ awn_effects_init(AwnEffects* fx)
     fx->priv->height_mod = 1.0;
     fx->priv->alpha = 1.0;
     fx->priv->saturation = 1.0;
+    fx->priv->timer_due = -1;
+    fx->priv->timer_skip = 1;
+    fx->priv->frame_skip = 1;
+
+    effects_instances = g_list_prepend(effects_instances, fx);
 }
 
 /**
@@ -1079,6 +1252,12 @@ awn_effects_start_ex(AwnEffects* fx, const AwnEffect effect, gint max_loops,
         return;
     }
 
+    if (fx->priv->recording) {
+        awn_effects_recording_add_start(fx->priv->recording, fx->priv->frame,
+                                        effect, max_loops,
+                                        signal_start, signal_end);
+    }
+
     AwnEffectsAnimation* queue_item;
 
     GList* queue = fx->priv->effect_queue;
@@ -1124,6 +1303,11 @@ awn_effects_stop(AwnEffects* fx, const AwnEffect effect)
         return;
     }
 
+    if (fx->priv->recording) {
+        awn_effects_recording_add_stop(fx->priv->recording, fx->priv->frame,
+                                       effect);
+    }
+
     AwnEffectsAnimation* queue_item;
 
     GList* queue = fx->priv->effect_queue;
@@ -1151,8 +1335,8 @@ awn_effects_stop(AwnEffects* fx, const AwnEffect effect)
             g_free(queue_item);
         } else if (fx->priv->sleeping_func) {
             /* wake up sleeping effect */
-            fx->priv->timer_id = g_timeout_add(1000 / AWN_FRAMES_PER_SECOND(fx),
-                                               fx->priv->sleeping_func, queue_item);
+            awn_effects_set_timer(fx, AWN_FRAME_INTERVAL(fx),
+                                  fx->priv->sleeping_func, queue_item);
             fx->priv->sleeping_func = NULL;
         }
     }
@@ -1178,6 +1362,277 @@ static gpointer get_animation(AwnEffectsAnimation* topEffect, guint fxNum)
     return g_ptr_array_index(anims, fxNum * AWN_ANIMATIONS_PER_BUNDLE + increment);
 }
 
+/* Monotonic time in ms, for measuring the frames */
+static gdouble
+awn_effects_now(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+}
+
+/*
+ * Quality levels of the frame rate governor:
+ *  0 - everything
+ *  1 - no shadow
+ *  2 - no shadow, reflection and 3D depth
+ *  3+ - also only every (level - 1)th frame drawn
+ */
+static gint
+awn_effects_max_quality_level(AwnEffects* fx)
+{
+    gint max_skip = AWN_FRAMES_PER_SECOND(fx) / fx->priv->min_frame_rate;
+
+    return 1 + MAX(max_skip, 1);
+}
+
+static void
+awn_effects_set_quality_level(AwnEffects* fx, gint level)
+{
+    AwnEffectsPrivate* priv = fx->priv;
+    gint old_level = priv->quality_level;
+    gint old_skip = priv->frame_skip;
+
+    if (priv->min_frame_rate > 0) {
+        level = MIN(level, awn_effects_max_quality_level(fx));
+    }
+    priv->quality_level = MAX(level, 0);
+    priv->frame_skip = MAX(priv->quality_level - 1, 1);
+    priv->settle_ticks = AWN_GOVERNOR_SETTLE_TICKS;
+    priv->calm_ticks = 0;
+
+    if (priv->frame_skip != old_skip) {
+        g_object_notify(G_OBJECT(fx), "frame-rate");
+    }
+    if ((priv->quality_level > 0) != (old_level > 0)) {
+        g_object_notify(G_OBJECT(fx), "reduced-effects");
+    }
+}
+
+/*
+ * Adds the last tick to the load and moves the quality level when the
+ * frames don't fit in the interval or when they've had enough headroom
+ * for a while.
+ */
+static void
+awn_effects_govern(AwnEffects* fx, gdouble tick_start, gdouble tick_time)
+{
+    AwnEffectsPrivate* priv = fx->priv;
+    gdouble interval = priv->timer_interval * priv->timer_skip;
+    gdouble late = MAX(tick_start - priv->last_tick - interval, 0.0);
+    gdouble load = (tick_time + priv->render_time + late) / interval;
+
+    priv->last_tick = tick_start;
+    priv->render_time = 0.0;
+    priv->load += (load - priv->load) * AWN_GOVERNOR_SMOOTHING;
+
+    if (priv->settle_ticks > 0) {
+        priv->settle_ticks--;
+        return;
+    }
+
+    if (priv->load > AWN_GOVERNOR_OVERLOAD) {
+        if (priv->quality_level < awn_effects_max_quality_level(fx)) {
+            awn_effects_set_quality_level(fx, priv->quality_level + 1);
+        }
+    } else if (priv->load < AWN_GOVERNOR_HEADROOM && priv->quality_level > 0) {
+        if (++priv->calm_ticks >= AWN_GOVERNOR_RESTORE_TICKS) {
+            awn_effects_set_quality_level(fx, priv->quality_level - 1);
+        }
+    } else {
+        priv->calm_ticks = 0;
+    }
+}
+
+/* TRUE if the widget is realized, but not on the screen, or its toplevel
+ * is paused (for the effects created since) */
+static gboolean
+awn_effects_is_hidden(AwnEffects* fx)
+{
+    GdkWindow* window = fx->widget ? gtk_widget_get_window(fx->widget) : NULL;
+
+    return (window && !gdk_window_is_viewable(window)) ||
+           (fx->widget && g_object_get_data(G_OBJECT(gtk_widget_get_toplevel(fx->widget)),
+                   "awn-effects-paused"));
+}
+
+/*
+ * Runs the animation frames for the timer, recording them if asked to.
+ * When the frame rate is lowered the tick runs several frames, so the
+ * animations keep their speed.
+ */
+static gboolean
+awn_effects_timer_cb(AwnEffectsAnimation* anim)
+{
+    AwnEffects* fx = anim->effects;
+    AwnEffectsPrivate* priv = fx->priv;
+    GSourceFunc func = priv->timer_func;
+    AwnEffectsRecording* recording = priv->recording;
+    gboolean repeat = TRUE;
+    gdouble start;
+
+    if (!priv->virtual_clock && (priv->paused || awn_effects_is_hidden(fx))) {
+        /* nobody would see the frames (the panel can be hidden by autohide),
+         * awn_effects_resume_timer() continues when that changes
+         */
+        priv->timer_id = 0;
+        priv->suspended = TRUE;
+        return FALSE;
+    }
+
+    /* the animation can drop the last reference to the widget */
+    g_object_ref(fx);
+
+    start = awn_effects_now();
+    for (guint i = 0; i < priv->timer_skip && repeat; i++) {
+        /* the animations stop themselves, a replay will do that too */
+        priv->recording = NULL;
+        repeat = func(anim);
+        priv->recording = recording;
+
+        priv->frame++;
+        if (recording) {
+            awn_effects_recording_add_frame(recording, fx);
+        }
+
+        if (priv->timer_func != func || priv->timer_data != anim) {
+            /* replaced by another timer */
+            break;
+        }
+    }
+
+    if (repeat && !priv->virtual_clock &&
+            priv->timer_interval == AWN_FRAME_INTERVAL(fx)) {
+        if (priv->adaptive) {
+            awn_effects_govern(fx, start, awn_effects_now() - start);
+        }
+        if (priv->frame_skip != priv->timer_skip) {
+            awn_effects_set_timer(fx, priv->timer_interval, func, anim);
+            repeat = FALSE;
+        }
+    }
+
+    g_object_unref(fx);
+    return repeat;
+}
+
+void
+awn_effects_set_timer(AwnEffects* fx, guint interval,
+                      GSourceFunc func, gpointer anim)
+{
+    AwnEffectsPrivate* priv = fx->priv;
+
+    priv->timer_func = func;
+    priv->timer_data = anim;
+    priv->timer_interval = interval;
+    priv->suspended = FALSE;
+
+    /* only the frame timers are slowed down, not the animations' delays */
+    priv->timer_skip = interval == AWN_FRAME_INTERVAL(fx) && !priv->virtual_clock ?
+                       priv->frame_skip : 1;
+    priv->last_tick = awn_effects_now();
+    priv->render_time = 0.0;
+
+    if (priv->virtual_clock) {
+        priv->timer_id = 0;
+        priv->timer_due = priv->virtual_time + interval;
+    } else {
+        priv->timer_id = g_timeout_add(interval * priv->timer_skip,
+                                       (GSourceFunc)awn_effects_timer_cb, anim);
+    }
+}
+
+void
+awn_effects_remove_timer(AwnEffects* fx)
+{
+    if (fx->priv->timer_id) {
+        g_source_remove(fx->priv->timer_id);
+        fx->priv->timer_id = 0;
+    }
+    fx->priv->timer_due = -1;
+    fx->priv->suspended = FALSE;
+}
+
+static void
+awn_effects_resume_timer(AwnEffects* fx)
+{
+    AwnEffectsPrivate* priv = fx->priv;
+
+    if (priv->suspended && !priv->paused) {
+        awn_effects_set_timer(fx, priv->timer_interval,
+                              priv->timer_func, priv->timer_data);
+    }
+}
+
+/**
+ * awn_effects_set_paused_for_toplevel:
+ * @toplevel: A toplevel widget.
+ * @paused: Whether to pause the animations.
+ *
+ * Sets #AwnEffects:paused on all the effects managing widgets inside
+ * @toplevel.  While it's paused the effects created for its widgets don't
+ * animate either.  #AwnApplet and the panel use this while the panel is
+ * hidden by autohide.
+ */
+void
+awn_effects_set_paused_for_toplevel(GtkWidget* toplevel, gboolean paused)
+{
+    g_return_if_fail(GTK_IS_WIDGET(toplevel));
+
+    g_object_set_data(G_OBJECT(toplevel), "awn-effects-paused",
+                      GINT_TO_POINTER(paused));
+
+    for (GList* iter = effects_instances; iter; iter = iter->next) {
+        AwnEffects* fx = AWN_EFFECTS(iter->data);
+
+        if (fx->widget && gtk_widget_get_toplevel(fx->widget) == toplevel) {
+            g_object_set(fx, "paused", paused, NULL);
+        }
+    }
+}
+
+void
+awn_effects_set_virtual_clock(AwnEffects* fx, gboolean virtual_clock)
+{
+    AwnEffectsPrivate* priv = fx->priv;
+    gboolean running = priv->timer_id || priv->timer_due >= 0 ||
+                       priv->suspended;
+
+    if (priv->virtual_clock == virtual_clock) {
+        return;
+    }
+
+    awn_effects_remove_timer(fx);
+    priv->virtual_clock = virtual_clock;
+    if (running) {
+        awn_effects_set_timer(fx, priv->timer_interval,
+                              priv->timer_func, priv->timer_data);
+    }
+}
+
+gboolean
+awn_effects_step_virtual_clock(AwnEffects* fx)
+{
+    AwnEffectsPrivate* priv = fx->priv;
+    gpointer anim = priv->timer_data;
+
+    g_return_val_if_fail(priv->virtual_clock, FALSE);
+
+    if (priv->timer_due < 0) {
+        return FALSE;
+    }
+
+    priv->virtual_time = priv->timer_due;
+    priv->timer_due = -1;
+
+    /* keeps running unless the animation replaced the timer */
+    if (awn_effects_timer_cb((AwnEffectsAnimation*)anim) && priv->timer_due < 0) {
+        priv->timer_due = priv->virtual_time + priv->timer_interval;
+    }
+    return TRUE;
+}
+
 void
 awn_effects_main_effect_loop(AwnEffects* fx)
 {
@@ -1206,8 +1661,8 @@ awn_effects_main_effect_loop(AwnEffects* fx)
 
             g_return_if_fail(queue_item);
 
-            fx->priv->timer_id = g_timeout_add(1000 / AWN_FRAMES_PER_SECOND(fx),
-                                               fx->priv->sleeping_func, queue_item);
+            awn_effects_set_timer(fx, AWN_FRAME_INTERVAL(fx),
+                                  fx->priv->sleeping_func, queue_item);
             fx->priv->sleeping_func = NULL;
         }
         return;
@@ -1229,9 +1684,9 @@ awn_effects_main_effect_loop(AwnEffects* fx)
     GSourceFunc animation = (GSourceFunc) get_animation(topEffect, effect);
 
     if (animation) {
-        // FIXME: if we're not mapped wait with starting the timer for the map-event
-        fx->priv->timer_id = g_timeout_add(1000 / AWN_FRAMES_PER_SECOND(fx),
-                                           animation, topEffect);
+        /* if we're not viewable the first tick suspends the timer */
+        awn_effects_set_timer(fx, AWN_FRAME_INTERVAL(fx),
+                              animation, topEffect);
         fx->priv->current_effect = topEffect->this_effect;
         fx->priv->effect_lock = FALSE;
 
@@ -1239,7 +1694,7 @@ awn_effects_main_effect_loop(AwnEffects* fx)
         //  immediately
         if (fx->priv->already_exposed == FALSE) {
             guint timer_backup = fx->priv->timer_id;
-            if (animation(topEffect) == FALSE) {
+            if (awn_effects_timer_cb(topEffect) == FALSE) {
                 // if the animation is one-frame, we need to kill the timer ourselves,
                 //  but effect cleanup set the timer_id to 0 meanwhile
                 g_source_remove(timer_backup);
@@ -1331,31 +1786,209 @@ awn_effects_set_icon_size(AwnEffects* fx, gint width, gint height,
     }
 }
 
+static void
+awn_effects_clear_icon_levels(AwnEffects* fx)
+{
+    GArray* levels = fx->priv->icon_levels;
+
+    if (!levels) {
+        return;
+    }
+    for (guint i = 0; i < levels->len; i++) {
+        cairo_surface_destroy(g_array_index(levels, AwnEffectsIconLevel, i).surface);
+    }
+    g_array_free(levels, TRUE);
+    fx->priv->icon_levels = NULL;
+}
+
+/*
+ * Returns the level of the icon source closest to (but not below) scale,
+ * halving the previous level to make it if it isn't there yet.  Level 0 is
+ * the icon source itself.
+ */
+static AwnEffectsIconLevel*
+awn_effects_get_icon_level(AwnEffects* fx, gdouble scale)
+{
+    AwnEffectsPrivate* priv = fx->priv;
+    gint wanted = 0;
+
+    if (!priv->icon_levels) {
+        AwnEffectsIconLevel level;
+
+        priv->icon_levels = g_array_new(FALSE, FALSE, sizeof(AwnEffectsIconLevel));
+        level.surface = cairo_surface_reference(priv->icon_source);
+        level.width = priv->icon_source_width;
+        level.height = priv->icon_source_height;
+        g_array_append_val(priv->icon_levels, level);
+    }
+
+    while (scale <= 0.5 && scale > 0.0) {
+        scale *= 2;
+        wanted++;
+    }
+
+    while ((gint)priv->icon_levels->len <= wanted) {
+        AwnEffectsIconLevel* prev = &g_array_index(priv->icon_levels,
+                                    AwnEffectsIconLevel,
+                                    priv->icon_levels->len - 1);
+        AwnEffectsIconLevel level;
+        cairo_t* cr;
+
+        if (prev->width == 1 && prev->height == 1) {
+            break;
+        }
+        level.width = MAX(prev->width / 2, 1);
+        level.height = MAX(prev->height / 2, 1);
+        level.surface = cairo_surface_create_similar(prev->surface,
+                        CAIRO_CONTENT_COLOR_ALPHA,
+                        level.width, level.height);
+        cr = cairo_create(level.surface);
+        cairo_scale(cr, level.width / (gdouble)prev->width,
+                    level.height / (gdouble)prev->height);
+        cairo_set_source_surface(cr, prev->surface, 0, 0);
+        cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_GOOD);
+        cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+        cairo_paint(cr);
+        cairo_destroy(cr);
+
+        g_array_append_val(priv->icon_levels, level);
+    }
+
+    return &g_array_index(priv->icon_levels, AwnEffectsIconLevel,
+                          MIN(wanted, (gint)priv->icon_levels->len - 1));
+}
+
+/*
+ * Sets the icon source as cr's source, in the resolution closest to the one
+ * it will be painted at after the scaling pre-op, so cairo doesn't have to
+ * resample the full icon at every intermediate scale of an animation.
+ */
+static void
+awn_effects_set_icon_source_pattern(AwnEffects* fx, cairo_t* cr)
+{
+    AwnEffectsPrivate* priv = fx->priv;
+    cairo_surface_t* surface;
+    gdouble scale_x, scale_y;
+    gint width, height;
+    cairo_matrix_t matrix;
+
+    switch (fx->position) {
+    case GTK_POS_RIGHT:
+    case GTK_POS_LEFT:
+        scale_x = priv->height_mod;
+        scale_y = priv->width_mod;
+        break;
+    default:
+        scale_x = priv->width_mod;
+        scale_y = priv->height_mod;
+        break;
+    }
+
+    if (MAX(scale_x, scale_y) > 1.0 && !priv->icon_source_large &&
+            !priv->icon_source_large_requested) {
+        priv->icon_source_large_requested = TRUE;
+        g_signal_emit(fx, _effects_signals[LARGE_SOURCE_NEEDED], 0);
+    }
+    if (MAX(scale_x, scale_y) > 1.0 && priv->icon_source_large) {
+        surface = priv->icon_source_large;
+        width = cairo_image_surface_get_width(surface);
+        height = cairo_image_surface_get_height(surface);
+    } else {
+        AwnEffectsIconLevel* level = awn_effects_get_icon_level(fx,
+                                     MAX(scale_x, scale_y));
+        surface = level->surface;
+        width = level->width;
+        height = level->height;
+    }
+
+    cairo_set_source_surface(cr, surface, 0, 0);
+    cairo_matrix_init_scale(&matrix,
+                            width / (gdouble)priv->icon_source_width,
+                            height / (gdouble)priv->icon_source_height);
+    cairo_pattern_set_matrix(cairo_get_source(cr), &matrix);
+}
+
 /**
- * awn_effects_cairo_create:
+ * awn_effects_set_icon_source:
  * @fx: Pointer to #AwnEffects instance.
+ * @surface: The icon painted on the contexts from
+ * awn_effects_cairo_create_clipped(), or %NULL.
  *
- * <note>
- *  Make sure you call awn_effects_cairo_destroy() on the cairo context
- *  returned by this call.
- * </note>
+ * Tells the effects what the icon looks like, so that
+ * awn_effects_cairo_create_clipped() can set it as the source of the context
+ * it returns, prescaled to the size the effects draw it at.  Painting the
+ * icon is then just a cairo_paint().
  *
- * Returns: cairo context where an icon can be drawn. (the icon should have
- * dimensions specified by a previous call to #awn_effects_set_icon_size)
+ * The prescaled copies are made once for each icon source, so @surface must
+ * not change while it is set.  Also unsets the source set by
+ * awn_effects_set_icon_source_large().
  */
-cairo_t* awn_effects_cairo_create(AwnEffects* fx)
+void
+awn_effects_set_icon_source(AwnEffects* fx, cairo_surface_t* surface)
 {
-    return awn_effects_cairo_create_clipped(fx, NULL);
+    AwnEffectsPrivate* priv;
+
+    g_return_if_fail(AWN_IS_EFFECTS(fx));
+    priv = fx->priv;
+
+    awn_effects_clear_icon_levels(fx);
+    if (priv->icon_source) {
+        cairo_surface_destroy(priv->icon_source);
+        priv->icon_source = NULL;
+    }
+    awn_effects_set_icon_source_large(fx, NULL);
+    priv->icon_source_large_requested = FALSE;
+
+    if (!surface) {
+        return;
+    }
+    switch (cairo_surface_get_type(surface)) {
+    case CAIRO_SURFACE_TYPE_XLIB:
+        priv->icon_source_width = cairo_xlib_surface_get_width(surface);
+        priv->icon_source_height = cairo_xlib_surface_get_height(surface);
+        break;
+    case CAIRO_SURFACE_TYPE_IMAGE:
+        priv->icon_source_width = cairo_image_surface_get_width(surface);
+        priv->icon_source_height = cairo_image_surface_get_height(surface);
+        break;
+    default:
+        g_warning("Invalid surface type: Surfaces must be either xlib or image");
+        return;
+    }
+    priv->icon_source = cairo_surface_reference(surface);
 }
 
 /**
- * awn_effects_cairo_create_clipped:
+ * awn_effects_set_icon_source_large:
  * @fx: Pointer to #AwnEffects instance.
- * @event: #GdkEventExpose received by the widget.
+ * @surface: An image surface with a larger rendering of the icon source,
+ * or %NULL.
  *
- * Creates a Cairo context for drawing to #AwnEffects:widget. The drawing
- * region will be clipped to @event's region member, and translated to its
- * area member, so you can always paint the icon at coordinates [0, 0].
+ * Used instead of the icon source whenever an effect (like hover zoom) draws
+ * the icon larger than its size, rather than upscaling it.  Best set from a
+ * #AwnEffects::large-source-needed handler.
+ */
+void
+awn_effects_set_icon_source_large(AwnEffects* fx, cairo_surface_t* surface)
+{
+    AwnEffectsPrivate* priv;
+
+    g_return_if_fail(AWN_IS_EFFECTS(fx));
+    priv = fx->priv;
+
+    if (priv->icon_source_large) {
+        cairo_surface_destroy(priv->icon_source_large);
+        priv->icon_source_large = NULL;
+    }
+    if (surface && priv->icon_source) {
+        g_return_if_fail(cairo_surface_get_type(surface) == CAIRO_SURFACE_TYPE_IMAGE);
+        priv->icon_source_large = cairo_surface_reference(surface);
+    }
+}
+
+/**
+ * awn_effects_cairo_create:
+ * @fx: Pointer to #AwnEffects instance.
  *
  * <note>
  *  Make sure you call awn_effects_cairo_destroy() on the cairo context
@@ -1364,43 +1997,29 @@ cairo_t* awn_effects_cairo_create(AwnEffects* fx)
  *
  * Returns: cairo context where an icon can be drawn. (the icon should have
  * dimensions specified by a previous call to #awn_effects_set_icon_size)
- *
  */
-cairo_t* awn_effects_cairo_create_clipped(AwnEffects* fx,
-        GdkEventExpose* event)
+cairo_t* awn_effects_cairo_create(AwnEffects* fx)
 {
-    g_return_val_if_fail(AWN_IS_EFFECTS(fx) && fx->widget, NULL);
+    return awn_effects_cairo_create_clipped(fx, NULL);
+}
 
+/*
+ * Takes over window_ctx (a width x height area at its origin) for drawing
+ * the icon: clears it, sets up the indirect surface if asked to and runs
+ * the pre-ops.  Returns the context the icon is painted on, which is
+ * finished by awn_effects_cairo_destroy().
+ */
+static cairo_t*
+awn_effects_cairo_begin(AwnEffects* fx, cairo_t* window_ctx,
+                        gint width, gint height, gboolean indirect)
+{
     AwnEffectsPrivate* priv = fx->priv;
-    cairo_t* cr;
-    GtkAllocation alloc;
-
-    cr = gdk_cairo_create(gtk_widget_get_window(fx->widget));
-    g_return_val_if_fail(cairo_status(cr) == CAIRO_STATUS_SUCCESS, NULL);
-    fx->window_ctx = cr;
-
-    /*
-     * Oh right, first we used cairo_xlib_surface_get_width/height, but we
-     * discovered that is causes artifacts, so now we use simple allocation
-     * which seems to work just fine.
-     */
-    gtk_widget_get_allocation(fx->widget, &alloc);
-    priv->window_width = alloc.width;
-    priv->window_height = alloc.height;
-
-    if (event) {
-        /* clip the region */
-        gdk_cairo_region(cr, event->region);
-        cairo_clip(cr);
+    cairo_t* cr = window_ctx;
 
-        /* this part of the code is also very sensitive, using different condition
-         * (ie "if (event->area.x > 0)" results in artifacts similar to the ones
-         * mentioned above if using cairo_xlib_surface_get_width/height)
-         */
-        if (!gtk_widget_get_has_window(fx->widget)) {
-            cairo_translate(cr, (double)(alloc.x), (double)(alloc.y));
-        }
-    }
+    fx->window_ctx = window_ctx;
+    priv->window_width = width;
+    priv->window_height = height;
+    priv->render_start = awn_effects_now();
 
     if (fx->priv->already_exposed == FALSE) {
         fx->priv->already_exposed = TRUE;
@@ -1414,12 +2033,9 @@ cairo_t* awn_effects_cairo_create_clipped(AwnEffects* fx,
     g_debug("Icon size: %dx%d, Surface size: %dx%d",
             priv->icon_width, priv->icon_height,
             priv->window_width, priv->window_height);
-    g_debug("Allocation size: (%d,%d) (%dx%d)",
-            alloc.x, alloc.y,
-            alloc.width, alloc.height);
 #endif
 
-    if (fx->indirect_paint) {
+    if (indirect) {
         cairo_surface_t* targetSurface = cairo_get_target(cr);
         /* we'll give to user virtual context and later paint everything on real one */
         targetSurface = cairo_surface_create_similar(targetSurface,
@@ -1453,9 +2069,129 @@ cairo_t* awn_effects_cairo_create_clipped(AwnEffects* fx,
     awn_effects_pre_op_rotate(fx, cr, &ds, NULL);
     awn_effects_pre_op_flip(fx, cr, &ds, NULL);
 
+    if (priv->icon_source) {
+        awn_effects_set_icon_source_pattern(fx, cr);
+    }
+
     return cr;
 }
 
+/**
+ * awn_effects_cairo_create_clipped:
+ * @fx: Pointer to #AwnEffects instance.
+ * @event: #GdkEventExpose received by the widget.
+ *
+ * Creates a Cairo context for drawing to #AwnEffects:widget. The drawing
+ * region will be clipped to @event's region member, and translated to its
+ * area member, so you can always paint the icon at coordinates [0, 0].
+ * If an icon source is set (see awn_effects_set_icon_source()) it is the
+ * context's source.
+ *
+ * <note>
+ *  Make sure you call awn_effects_cairo_destroy() on the cairo context
+ *  returned by this call.
+ * </note>
+ *
+ * Returns: cairo context where an icon can be drawn. (the icon should have
+ * dimensions specified by a previous call to #awn_effects_set_icon_size)
+ *
+ */
+cairo_t* awn_effects_cairo_create_clipped(AwnEffects* fx,
+        GdkEventExpose* event)
+{
+    g_return_val_if_fail(AWN_IS_EFFECTS(fx) && fx->widget, NULL);
+
+    cairo_t* cr;
+    GtkAllocation alloc;
+
+    cr = gdk_cairo_create(gtk_widget_get_window(fx->widget));
+    g_return_val_if_fail(cairo_status(cr) == CAIRO_STATUS_SUCCESS, NULL);
+
+    /*
+     * Oh right, first we used cairo_xlib_surface_get_width/height, but we
+     * discovered that is causes artifacts, so now we use simple allocation
+     * which seems to work just fine.
+     */
+    gtk_widget_get_allocation(fx->widget, &alloc);
+
+    if (event) {
+        /* clip the region */
+        gdk_cairo_region(cr, event->region);
+        cairo_clip(cr);
+
+        /* this part of the code is also very sensitive, using different condition
+         * (ie "if (event->area.x > 0)" results in artifacts similar to the ones
+         * mentioned above if using cairo_xlib_surface_get_width/height)
+         */
+        if (!gtk_widget_get_has_window(fx->widget)) {
+            cairo_translate(cr, (double)(alloc.x), (double)(alloc.y));
+        }
+    }
+
+    return awn_effects_cairo_begin(fx, cr, alloc.width, alloc.height,
+                                   fx->indirect_paint);
+}
+
+/**
+ * AwnEffectsPaintFunc:
+ * @fx: #AwnEffects instance.
+ * @cr: Cairo context to paint the icon on, at coordinates [0, 0].
+ * @user_data: User data passed to awn_effects_render_to_surface().
+ *
+ * Paints the icon for awn_effects_render_to_surface().
+ */
+
+/**
+ * awn_effects_render_to_surface:
+ * @fx: Pointer to #AwnEffects instance.
+ * @target: Surface to render to.
+ * @x: X coordinate of the area on @target.
+ * @y: Y coordinate of the area on @target.
+ * @width: Width of the area, the equivalent of the widget's allocation.
+ * @height: Height of the area.
+ * @paint: Function painting the icon, or %NULL to paint the icon source
+ * (see awn_effects_set_icon_source()).
+ * @user_data: Data passed to @paint.
+ *
+ * Renders the icon with all the current effects, overlays and post-ops to
+ * the given area of @target, exactly like an expose of #AwnEffects:widget
+ * would. The widget doesn't need to be realized, so this can be used to
+ * draw icons offscreen.
+ */
+void
+awn_effects_render_to_surface(AwnEffects* fx, cairo_surface_t* target,
+                              gint x, gint y, gint width, gint height,
+                              AwnEffectsPaintFunc paint, gpointer user_data)
+{
+    cairo_t* cr;
+
+    g_return_if_fail(AWN_IS_EFFECTS(fx));
+    g_return_if_fail(target != NULL);
+
+    cr = cairo_create(target);
+    cairo_rectangle(cr, x, y, width, height);
+    cairo_clip(cr);
+    cairo_translate(cr, x, y);
+
+    /* the post-ops reset the matrix, so we can't paint in place unless the
+     * area is at the origin */
+    cr = awn_effects_cairo_begin(fx, cr, width, height,
+                                 fx->indirect_paint || x != 0 || y != 0);
+    if (!cr) {
+        cairo_destroy(fx->window_ctx);
+        fx->window_ctx = NULL;
+        return;
+    }
+
+    if (paint) {
+        paint(fx, cr, user_data);
+    } else if (fx->priv->icon_source) {
+        cairo_paint(cr);
+    }
+
+    awn_effects_cairo_destroy(fx);
+}
+
 /**
  * awn_effects_cairo_destroy:
  * @fx: Pointer to #AwnEffects instance.
@@ -1464,7 +2200,12 @@ cairo_t* awn_effects_cairo_create_clipped(AwnEffects* fx,
  */
 void awn_effects_cairo_destroy(AwnEffects* fx)
 {
+    AwnEffectsPrivate* priv = fx->priv;
     cairo_t* cr = fx->virtual_ctx;
+    /* the governor leaves out the expensive ops only during the animations,
+     * the frame they end on is complete again
+     */
+    gint level = priv->timer_id ? priv->quality_level : 0;
 
     /* FIXME: divide overlays into two lists - those where effects should be
      *  applied and where they shouldn't
@@ -1498,12 +2239,18 @@ void awn_effects_cairo_destroy(AwnEffects* fx)
      * FIXME: put the functions in some kind of list/array
      */
     awn_effects_post_op_clip(fx, cr, NULL, NULL);
-    awn_effects_post_op_depth(fx, cr, NULL, NULL);
-    awn_effects_post_op_shadow(fx, cr, NULL, NULL);
+    if (level < 2) {
+        awn_effects_post_op_depth(fx, cr, NULL, NULL);
+    }
+    if (level < 1) {
+        awn_effects_post_op_shadow(fx, cr, NULL, NULL);
+    }
     awn_effects_post_op_saturate(fx, cr, NULL, NULL);
     awn_effects_post_op_glow(fx, cr, NULL, NULL);
     awn_effects_post_op_alpha(fx, cr, NULL, NULL);
-    awn_effects_post_op_reflection(fx, cr, NULL, NULL);
+    if (level < 2) {
+        awn_effects_post_op_reflection(fx, cr, NULL, NULL);
+    }
     awn_effects_post_op_active(fx, cr, NULL, NULL);
     awn_effects_post_op_spotlight(fx, cr, NULL, NULL);
     awn_effects_post_op_arrow(fx, cr, NULL, NULL);
@@ -1523,7 +2270,7 @@ void awn_effects_cairo_destroy(AwnEffects* fx)
         }
     }
 
-    if (fx->indirect_paint) {
+    if (fx->virtual_ctx != fx->window_ctx) {
         cairo_set_operator(fx->window_ctx, CAIRO_OPERATOR_OVER);
         cairo_set_source_surface(fx->window_ctx, cairo_get_target(cr), 0, 0);
         cairo_paint(fx->window_ctx);
@@ -1538,6 +2285,8 @@ void awn_effects_cairo_destroy(AwnEffects* fx)
 
     fx->window_ctx = NULL;
     fx->virtual_ctx = NULL;
+
+    priv->render_time += awn_effects_now() - priv->render_start;
 }
 
 /**
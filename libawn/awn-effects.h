@@ -147,6 +147,19 @@ cairo_t* awn_effects_cairo_create_clipped(AwnEffects* fx,
 
 void awn_effects_cairo_destroy(AwnEffects* fx);
 
+typedef void (*AwnEffectsPaintFunc)(AwnEffects* fx, cairo_t* cr,
+                                    gpointer user_data);
+
+void awn_effects_render_to_surface(AwnEffects* fx, cairo_surface_t* target,
+                                   gint x, gint y, gint width, gint height,
+                                   AwnEffectsPaintFunc paint,
+                                   gpointer user_data);
+
+void awn_effects_set_icon_source(AwnEffects* fx, cairo_surface_t* surface);
+
+void awn_effects_set_icon_source_large(AwnEffects* fx,
+                                       cairo_surface_t* surface);
+
 void awn_effects_add_overlay(AwnEffects* fx, AwnOverlay* overlay);
 
 void awn_effects_remove_overlay(AwnEffects* fx, AwnOverlay* overlay);
@@ -155,6 +168,8 @@ GList* awn_effects_get_overlays(AwnEffects* fx);
 
 void awn_effects_redraw(AwnEffects* fx);
 
+void awn_effects_set_paused_for_toplevel(GtkWidget* toplevel, gboolean paused);
+
 /* Move this somewhere else eventually, these are used only internally */
 void awn_effects_main_effect_loop(AwnEffects* fx);
 void awn_effects_emit_anim_start(AwnEffects* fx, AwnEffect effect);
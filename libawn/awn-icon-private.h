@@ -0,0 +1,29 @@
+/*
+ * Copyright (C) 2026 Awn-core team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* awn-icon-private.h */
+
+#ifndef _AWN_ICON_PRIVATE_H
+#define _AWN_ICON_PRIVATE_H
+
+/*
+ AwnIcon requests this much room along the panel for an icon of size x,
+ the hover zoom draws the icon up to that size.
+ */
+#define APPLY_SIZE_MULTIPLIER(x)    (x)*6/5
+
+#endif
@@ -25,10 +25,9 @@
 #include "awn-utils.h"
 #include "awn-overlayable.h"
 
+#include "awn-icon-private.h"
 #include "gseal-transition.h"
 
-#define APPLY_SIZE_MULTIPLIER(x)    (x)*6/5
-
 static void awn_icon_overlayable_init(AwnOverlayableIface* iface);
 
 static AwnEffects* awn_icon_get_effects(AwnOverlayable* icon);
@@ -66,6 +65,8 @@ struct _AwnIconPrivate {
 
     /* Info relating to the current icon */
     cairo_surface_t* icon_srfc;
+    /* icon_srfc is the effects' icon source (it's ours and never changes) */
+    gboolean icon_srfc_is_source;
 };
 
 enum {
@@ -177,7 +178,9 @@ awn_icon_expose_event(GtkWidget* widget, GdkEventExpose* event)
      */
 
     cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
-    cairo_set_source_surface(cr, priv->icon_srfc, 0, 0);
+    if (!priv->icon_srfc_is_source) {
+        cairo_set_source_surface(cr, priv->icon_srfc, 0, 0);
+    }
     cairo_paint(cr);
 
     /* let effects know we're finished */
@@ -883,6 +886,10 @@ free_existing_icon(AwnIcon* icon)
         return;
     }
 
+    if (priv->icon_srfc_is_source) {
+        awn_effects_set_icon_source(priv->effects, NULL);
+        priv->icon_srfc_is_source = FALSE;
+    }
     cairo_surface_destroy(priv->icon_srfc);
     priv->icon_srfc = NULL;
 }
@@ -920,6 +927,10 @@ awn_icon_set_from_pixbuf(AwnIcon* icon, GdkPixbuf* pixbuf)
 
     cairo_destroy(temp_cr);
 
+    /* nobody else can touch the surface, so the effects can prescale it */
+    awn_effects_set_icon_source(priv->effects, priv->icon_srfc);
+    priv->icon_srfc_is_source = TRUE;
+
     /* Queue a redraw */
     update_widget_size(icon);
     gtk_widget_queue_draw(GTK_WIDGET(icon));
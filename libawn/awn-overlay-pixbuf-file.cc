@@ -48,6 +48,7 @@
 #include <math.h>
 
 #include "awn-overlay-pixbuf-file.h"
+#include "awn-pixbuf-cache.h"
 
 extern "C" {
     G_DEFINE_TYPE(AwnOverlayPixbufFile, awn_overlay_pixbuf_file, AWN_TYPE_OVERLAY_PIXBUF)
@@ -66,6 +67,8 @@ struct _AwnOverlayPixbufFilePrivate {
     gint  icon_height;
     /*Used to keep missing file from spamming the console messages*/
     gboolean  emitted_warning;
+    /*file name and size of the decode we're waiting for, if any*/
+    gchar*    loading_key;
 };
 
 enum {
@@ -134,6 +137,7 @@ awn_overlay_pixbuf_file_finalize(GObject* object)
     AwnOverlayPixbufFilePrivate* priv = AWN_OVERLAY_PIXBUF_FILE_GET_PRIVATE(object);
 
     g_free(priv->file_name);
+    g_free(priv->loading_key);
     g_hash_table_destroy(priv->pixbufs);
 
     G_OBJECT_CLASS(awn_overlay_pixbuf_file_parent_class)->finalize(object);
@@ -268,6 +272,34 @@ _awn_overlay_pixbuf_file_render(AwnOverlay* _overlay,
     }
 }
 
+typedef struct {
+    AwnOverlayPixbufFile* overlay;
+    gchar* key;
+} LoadRequest;
+
+static void
+awn_overlay_pixbuf_file_loaded(GdkPixbuf* pixbuf, LoadRequest* request)
+{
+    AwnOverlayPixbufFilePrivate* priv = AWN_OVERLAY_PIXBUF_FILE_GET_PRIVATE(request->overlay);
+
+    /*only if nothing else was asked for in the meantime*/
+    if (g_strcmp0(request->key, priv->loading_key) == 0) {
+        g_free(priv->loading_key);
+        priv->loading_key = NULL;
+        if (pixbuf) {
+            g_object_set(request->overlay,
+                         "pixbuf", pixbuf,
+                         NULL);
+        } else if (!priv->emitted_warning) {
+            g_warning("%s: Failed to load pixbuf (%s)", __func__, priv->file_name);
+            priv->emitted_warning = TRUE;
+        }
+    }
+    g_object_unref(request->overlay);
+    g_free(request->key);
+    g_free(request);
+}
+
 static gboolean
 awn_overlay_pixbuf_file_load(AwnOverlayPixbufFile* overlay,
                              gchar* file_name)
@@ -295,22 +327,42 @@ awn_overlay_pixbuf_file_load(AwnOverlayPixbufFile* overlay,
                            scaled_width /
                            priv->icon_width);
 
-    pixbuf = gdk_pixbuf_new_from_file_at_scale(file_name,
-             scaled_width,
-             scaled_height,
-             TRUE, NULL);
-    if (pixbuf) {
-        g_object_set(overlay,
-                     "pixbuf", pixbuf,
-                     NULL);
-        g_object_unref(pixbuf);
-    } else {
-        if (!priv->emitted_warning) {
-            g_warning("%s: Failed to load pixbuf (%s)", __func__, file_name);
-            priv->emitted_warning = TRUE;
-        }
+    /*
+     Decoded on a worker thread unless the cache already has it.  Until then
+     there is nothing to draw, the pixbuf notify redraws us when it's done.
+     */
+    gchar* key = g_strdup_printf("%s::%dx%d", file_name, scaled_width, scaled_height);
+    if (g_strcmp0(key, priv->loading_key) == 0) {
+        g_free(key);
         return FALSE;
     }
+    LoadRequest* request = g_new0(LoadRequest, 1);
+    request->overlay = g_object_ref(overlay);
+    request->key = g_strdup(key);
+    g_free(priv->loading_key);
+    priv->loading_key = key;
+
+    pixbuf = awn_pixbuf_cache_load_file(awn_pixbuf_cache_get_default(),
+                                        file_name,
+                                        scaled_width,
+                                        scaled_height,
+                                        TRUE,
+                                        (AwnPixbufCacheFileFunc)awn_overlay_pixbuf_file_loaded,
+                                        request);
+    if (!pixbuf) {
+        /*the callback takes it from here*/
+        return FALSE;
+    }
+    g_object_unref(request->overlay);
+    g_free(request->key);
+    g_free(request);
+    g_free(priv->loading_key);
+    priv->loading_key = NULL;
+
+    g_object_set(overlay,
+                 "pixbuf", pixbuf,
+                 NULL);
+    g_object_unref(pixbuf);
     return TRUE;
 }
 
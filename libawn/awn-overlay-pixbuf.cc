@@ -46,6 +46,7 @@
 #include <math.h>
 
 #include "awn-overlay-pixbuf.h"
+#include "awn-pixbuf-scale.h"
 
 enum {
     PROP_0,
@@ -65,7 +66,7 @@ typedef struct _AwnOverlayPixbufPrivate AwnOverlayPixbufPrivate;
 
 struct _AwnOverlayPixbufPrivate {
     GdkPixbuf* pixbuf;
-    GdkPixbuf* scaled_pixbuf;
+    cairo_surface_t* scaled_surface;
     gdouble scale;
     gdouble alpha;
 };
@@ -109,9 +110,9 @@ awn_overlay_pixbuf_set_property(GObject* object, guint property_id,
             g_object_unref(priv->pixbuf);
         }
         priv->pixbuf = g_value_dup_object(value);
-        if (priv->scaled_pixbuf) {
-            g_object_unref(priv->scaled_pixbuf);
-            priv->scaled_pixbuf = NULL;
+        if (priv->scaled_surface) {
+            cairo_surface_destroy(priv->scaled_surface);
+            priv->scaled_surface = NULL;
         }
         break;
     case PROP_SCALE:
@@ -138,8 +139,8 @@ awn_overlay_pixbuf_finalize(GObject* object)
     if (priv->pixbuf) {
         g_object_unref(priv->pixbuf);
     }
-    if (priv->scaled_pixbuf) {
-        g_object_unref(priv->scaled_pixbuf);
+    if (priv->scaled_surface) {
+        cairo_surface_destroy(priv->scaled_surface);
     }
     G_OBJECT_CLASS(awn_overlay_pixbuf_parent_class)->finalize(object);
 }
@@ -210,7 +211,7 @@ awn_overlay_pixbuf_init(AwnOverlayPixbuf* self)
 {
     AwnOverlayPixbufPrivate* priv = AWN_OVERLAY_PIXBUF_GET_PRIVATE(self);
 
-    priv->scaled_pixbuf = NULL;
+    priv->scaled_surface = NULL;
 }
 
 /**
@@ -271,23 +272,18 @@ _awn_overlay_pixbuf_render(AwnOverlay* _overlay,
         scaled_width = lround(pixbuf_width * (scaled_height / (gdouble) pixbuf_height));
     }
 
-    /* Why do we do this?  Well the gdk pixbuf scaling gives a better result than
-     the cairo scaling when dealing with a source pixbuf */
-    if (!priv->scaled_pixbuf || (scaled_width != gdk_pixbuf_get_width(priv->scaled_pixbuf)) ||
-            (scaled_height != gdk_pixbuf_get_height(priv->scaled_pixbuf))) {
-        if (priv->scaled_pixbuf) {
-            g_object_unref(priv->scaled_pixbuf);
-            priv->scaled_pixbuf = NULL;
-        }
-        if ((scaled_width == pixbuf_width) && (scaled_height == pixbuf_height)) {
-            g_object_ref(priv->pixbuf);
-            priv->scaled_pixbuf = priv->pixbuf;
-        } else {
-            priv->scaled_pixbuf = gdk_pixbuf_scale_simple(priv->pixbuf,
-                                  scaled_width,
-                                  scaled_height,
-                                  GDK_INTERP_BILINEAR);
+    /* Why do we do this?  Well prescaling gives a better result than the cairo
+     scaling when dealing with a source pixbuf, and keeping the result as a
+     surface saves converting the pixbuf on every render */
+    if (!priv->scaled_surface ||
+            (scaled_width != cairo_image_surface_get_width(priv->scaled_surface)) ||
+            (scaled_height != cairo_image_surface_get_height(priv->scaled_surface))) {
+        if (priv->scaled_surface) {
+            cairo_surface_destroy(priv->scaled_surface);
         }
+        priv->scaled_surface = awn_pixbuf_scale_to_surface(priv->pixbuf,
+                               MAX(scaled_width, 1),
+                               MAX(scaled_height, 1));
     }
 
     awn_overlay_move_to(AWN_OVERLAY(overlay), cr,
@@ -304,7 +300,7 @@ _awn_overlay_pixbuf_render(AwnOverlay* _overlay,
         cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
     }
 
-    gdk_cairo_set_source_pixbuf(cr, priv->scaled_pixbuf, coord.x, coord.y);
+    cairo_set_source_surface(cr, priv->scaled_surface, coord.x, coord.y);
     cairo_paint_with_alpha(cr, priv->alpha);
     cairo_restore(cr);
 }
@@ -34,9 +34,13 @@
 #define MAX_PRUNE_FREQ 60
 
 #include "glib.h"
+#include <glib/gstdio.h>
 
 #include "awn-pixbuf-cache.h"
 
+/* worker threads decoding image files for awn_pixbuf_cache_load_file() */
+#define MAX_DECODE_THREADS 2
+
 extern "C" {
     G_DEFINE_TYPE(AwnPixbufCache, awn_pixbuf_cache, G_TYPE_OBJECT)
 }
@@ -59,8 +63,35 @@ struct _AwnPixbufCachePrivate {
     guint               num_pixbufs;
     guint               max_cache_size;
     GTimeVal        last_prune;
+
+    GThreadPool*  decode_pool;
+    /* file key -> FileDecodeJob, decodes in flight */
+    GHashTable*   decoding;
+    /* finished jobs, handed to the main loop in batches */
+    GAsyncQueue*  finished;
+    volatile gint delivery_queued;
 };
 
+typedef struct {
+    AwnPixbufCacheFileFunc callback;
+    gpointer user_data;
+} FileWaiter;
+
+typedef struct {
+    AwnPixbufCache* cache;
+    gchar* key;
+    gchar* filename;
+    gint width;
+    gint height;
+    gboolean preserve_aspect_ratio;
+    GdkPixbuf* pixbuf;
+    /* FileWaiters, only touched from the main loop */
+    GSList* waiters;
+    /* number of waiters, the worker skips jobs nobody waits for anymore */
+    volatile gint wanted;
+    gboolean skipped;
+} FileDecodeJob;
+
 static void
 awn_pixbuf_cache_get_property(GObject* object, guint property_id,
                               GValue* value, GParamSpec* pspec)
@@ -102,6 +133,19 @@ awn_pixbuf_cache_dispose(GObject* object)
         g_list_free(priv->accessed);
         priv->accessed = NULL;
     }
+    /* jobs hold a reference on us, the pool is idle by now */
+    if (priv->decode_pool) {
+        g_thread_pool_free(priv->decode_pool, TRUE, TRUE);
+        priv->decode_pool = NULL;
+    }
+    if (priv->decoding) {
+        g_hash_table_destroy(priv->decoding);
+        priv->decoding = NULL;
+    }
+    if (priv->finished) {
+        g_async_queue_unref(priv->finished);
+        priv->finished = NULL;
+    }
     G_OBJECT_CLASS(awn_pixbuf_cache_parent_class)->dispose(object);
 }
 
@@ -160,6 +204,8 @@ awn_pixbuf_cache_init(AwnPixbufCache* self)
     priv->accessed = NULL;
     priv->num_pixbufs = 0;
     g_get_current_time(&priv->last_prune);
+    priv->decoding = g_hash_table_new(g_str_hash, g_str_equal);
+    priv->finished = g_async_queue_new();
 }
 
 /**
@@ -453,3 +499,239 @@ awn_pixbuf_cache_invalidate(AwnPixbufCache* pixbuf_cache)
     g_get_current_time(&priv->last_prune);
 }
 
+static gchar*
+awn_pixbuf_cache_file_key(const gchar* filename, gint width, gint height,
+                          gboolean preserve_aspect_ratio)
+{
+    struct stat st;
+
+    if (g_stat(filename, &st) != 0) {
+        return NULL;
+    }
+    return g_strdup_printf("__FILE__::%s::%ld::%dx%d%s", filename,
+                           (glong)st.st_mtime, width, height,
+                           preserve_aspect_ratio ? "" : "::stretch");
+}
+
+/*
+ Back in the main loop: cache the result and hand it to everyone who asked
+ while the decode was running.
+ */
+static void
+awn_pixbuf_cache_decode_done(FileDecodeJob* job)
+{
+    AwnPixbufCachePrivate* priv = GET_PRIVATE(job->cache);
+
+    if (job->skipped && job->waiters) {
+        /* somebody asked again after the worker dropped it */
+        job->skipped = FALSE;
+        g_thread_pool_push(priv->decode_pool, job, NULL);
+        return;
+    }
+
+    if (priv->decoding) {
+        g_hash_table_remove(priv->decoding, job->key);
+    }
+    if (job->pixbuf && priv->pixbufs) {
+        awn_pixbuf_cache_insert_pixbuf_simple_key(job->cache, job->pixbuf, job->key);
+        awn_pixbuf_cache_check(job->cache, job->pixbuf);
+    }
+
+    job->waiters = g_slist_reverse(job->waiters);
+    for (GSList* iter = job->waiters; iter; iter = iter->next) {
+        FileWaiter* waiter = iter->data;
+        waiter->callback(job->pixbuf, waiter->user_data);
+        g_free(waiter);
+    }
+    g_slist_free(job->waiters);
+
+    if (job->pixbuf) {
+        g_object_unref(job->pixbuf);
+    }
+    g_object_unref(job->cache);
+    g_free(job->filename);
+    g_free(job->key);
+    g_free(job);
+}
+
+/*
+ Delivers everything the workers finished since the last time, so a burst
+ of decodes costs one main loop dispatch instead of one per file.
+ */
+static gboolean
+awn_pixbuf_cache_deliver(AwnPixbufCache* pixbuf_cache)
+{
+    AwnPixbufCachePrivate* priv = GET_PRIVATE(pixbuf_cache);
+    FileDecodeJob* job;
+
+    g_atomic_int_set(&priv->delivery_queued, 0);
+    while ((job = g_async_queue_try_pop(priv->finished))) {
+        awn_pixbuf_cache_decode_done(job);
+    }
+    g_object_unref(pixbuf_cache);
+    return FALSE;
+}
+
+static void
+awn_pixbuf_cache_decode_thread(FileDecodeJob* job, gpointer data)
+{
+    AwnPixbufCachePrivate* priv = GET_PRIVATE(job->cache);
+
+    if (g_atomic_int_get(&job->wanted) > 0) {
+        job->pixbuf = gdk_pixbuf_new_from_file_at_scale(job->filename,
+                      job->width, job->height,
+                      job->preserve_aspect_ratio,
+                      NULL);
+    } else {
+        job->skipped = TRUE;
+    }
+    g_async_queue_push(priv->finished, job);
+    if (g_atomic_int_compare_and_exchange(&priv->delivery_queued, 0, 1)) {
+        g_idle_add((GSourceFunc)awn_pixbuf_cache_deliver, g_object_ref(job->cache));
+    }
+}
+
+/**
+ * awn_pixbuf_cache_load_file:
+ * @pixbuf_cache: A pointer to an #AwnPixbufCache object.
+ * @filename: The image file to load.
+ * @width: Width to scale the image to, or -1.
+ * @height: Height to scale the image to, or -1.
+ * @preserve_aspect_ratio: As for gdk_pixbuf_new_from_file_at_scale().
+ * @callback: Called from the main loop once the file has been decoded, or NULL
+ * to decode synchronously.
+ * @user_data: Data passed to @callback.
+ *
+ * Loads an image file through the cache, keyed by file name, modification
+ * time and size, so the same file is only decoded once.  With a @callback
+ * cache misses are decoded on a worker thread; @callback then receives the
+ * #GdkPixbuf (or NULL if the file couldn't be loaded) and must keep a
+ * reference to it if it wants it.  The caller is responsible for keeping
+ * @user_data alive until then.
+ *
+ * Returns: a new reference to the cached #GdkPixbuf or the one loaded
+ * synchronously.  When a @callback was given and NULL is returned, @callback
+ * is called exactly once, possibly before this function returns.
+ */
+
+GdkPixbuf*
+awn_pixbuf_cache_load_file(AwnPixbufCache* pixbuf_cache,
+                           const gchar* filename,
+                           gint width,
+                           gint height,
+                           gboolean preserve_aspect_ratio,
+                           AwnPixbufCacheFileFunc callback,
+                           gpointer user_data)
+{
+    AwnPixbufCachePrivate* priv;
+    GdkPixbuf* pixbuf;
+    FileDecodeJob* job;
+    FileWaiter* waiter;
+    gchar* key;
+
+    g_return_val_if_fail(AWN_IS_PIXBUF_CACHE(pixbuf_cache), NULL);
+    g_return_val_if_fail(filename, NULL);
+
+    priv = GET_PRIVATE(pixbuf_cache);
+    key = awn_pixbuf_cache_file_key(filename, width, height, preserve_aspect_ratio);
+    if (!key) {
+        if (callback) {
+            callback(NULL, user_data);
+        }
+        return NULL;
+    }
+
+    pixbuf = awn_pixbuf_cache_lookup_simple_key(pixbuf_cache, key, width, height);
+    if (pixbuf) {
+        awn_pixbuf_cache_check(pixbuf_cache, pixbuf);
+        g_free(key);
+        return pixbuf;
+    }
+
+    if (!priv->decode_pool && callback && g_thread_supported()) {
+        priv->decode_pool = g_thread_pool_new((GFunc)awn_pixbuf_cache_decode_thread,
+                                              NULL, MAX_DECODE_THREADS, FALSE, NULL);
+    }
+    if (!callback || !priv->decode_pool) {
+        pixbuf = gdk_pixbuf_new_from_file_at_scale(filename, width, height,
+                 preserve_aspect_ratio, NULL);
+        if (pixbuf) {
+            awn_pixbuf_cache_insert_pixbuf_simple_key(pixbuf_cache, pixbuf, key);
+            awn_pixbuf_cache_check(pixbuf_cache, pixbuf);
+        } else if (callback) {
+            callback(NULL, user_data);
+        }
+        g_free(key);
+        return pixbuf;
+    }
+
+    waiter = g_new0(FileWaiter, 1);
+    waiter->callback = callback;
+    waiter->user_data = user_data;
+
+    /* already being decoded, just wait for it */
+    job = g_hash_table_lookup(priv->decoding, key);
+    if (job) {
+        job->waiters = g_slist_prepend(job->waiters, waiter);
+        g_atomic_int_inc(&job->wanted);
+        g_free(key);
+        return NULL;
+    }
+
+    job = g_new0(FileDecodeJob, 1);
+    job->cache = g_object_ref(pixbuf_cache);
+    job->key = key;
+    job->filename = g_strdup(filename);
+    job->width = width;
+    job->height = height;
+    job->preserve_aspect_ratio = preserve_aspect_ratio;
+    job->waiters = g_slist_prepend(NULL, waiter);
+    job->wanted = 1;
+    g_hash_table_insert(priv->decoding, job->key, job);
+    g_thread_pool_push(priv->decode_pool, job, NULL);
+    return NULL;
+}
+
+/**
+ * awn_pixbuf_cache_cancel_load_file:
+ * @pixbuf_cache: A pointer to an #AwnPixbufCache object.
+ * @callback: The callback given to awn_pixbuf_cache_load_file().
+ * @user_data: The user data given to awn_pixbuf_cache_load_file().
+ *
+ * Withdraws the pending loads that would call @callback with @user_data,
+ * @callback won't be called for them.  Files nobody waits for anymore are
+ * not decoded if a worker hasn't started on them yet.
+ */
+
+void
+awn_pixbuf_cache_cancel_load_file(AwnPixbufCache* pixbuf_cache,
+                                  AwnPixbufCacheFileFunc callback,
+                                  gpointer user_data)
+{
+    AwnPixbufCachePrivate* priv;
+    GHashTableIter iter;
+    gpointer value;
+
+    g_return_if_fail(AWN_IS_PIXBUF_CACHE(pixbuf_cache));
+
+    priv = GET_PRIVATE(pixbuf_cache);
+    if (!priv->decoding) {
+        return;
+    }
+    g_hash_table_iter_init(&iter, priv->decoding);
+    while (g_hash_table_iter_next(&iter, NULL, &value)) {
+        FileDecodeJob* job = value;
+
+        for (GSList* w = job->waiters; w;) {
+            FileWaiter* waiter = w->data;
+            GSList* next = w->next;
+
+            if (waiter->callback == callback && waiter->user_data == user_data) {
+                job->waiters = g_slist_delete_link(job->waiters, w);
+                g_atomic_int_add(&job->wanted, -1);
+                g_free(waiter);
+            }
+            w = next;
+        }
+    }
+}
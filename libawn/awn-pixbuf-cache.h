@@ -56,6 +56,8 @@ typedef struct {
     GObjectClass parent_class;
 } AwnPixbufCacheClass;
 
+typedef void (*AwnPixbufCacheFileFunc)(GdkPixbuf* pixbuf, gpointer user_data);
+
 void awn_pixbuf_cache_insert_pixbuf(AwnPixbufCache* pixbuf_cache,
                                     GdkPixbuf* pbuf,
                                     const gchar* scope,
@@ -86,6 +88,18 @@ void awn_pixbuf_cache_insert_pixbuf_simple_key(AwnPixbufCache* pixbuf_cache,
         GdkPixbuf* pbuf,
         const gchar* simple_key);
 
+GdkPixbuf* awn_pixbuf_cache_load_file(AwnPixbufCache* pixbuf_cache,
+                                      const gchar* filename,
+                                      gint width,
+                                      gint height,
+                                      gboolean preserve_aspect_ratio,
+                                      AwnPixbufCacheFileFunc callback,
+                                      gpointer user_data);
+
+void awn_pixbuf_cache_cancel_load_file(AwnPixbufCache* pixbuf_cache,
+                                       AwnPixbufCacheFileFunc callback,
+                                       gpointer user_data);
+
 
 GType awn_pixbuf_cache_get_type(void);
 
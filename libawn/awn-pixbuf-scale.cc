@@ -0,0 +1,449 @@
+/*
+ * Copyright (C) 2026 Awn-core team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* awn-pixbuf-scale.c */
+
+#include <math.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "awn-pixbuf-scale.h"
+
+/*
+ Intermediate pixels are premultiplied RGBA floats in the 0 - 255 range,
+ one SSE register each where available.
+ */
+#ifdef __SSE2__
+typedef __m128 Pixel;
+
+static inline Pixel
+pixel_zero(void)
+{
+    return _mm_setzero_ps();
+}
+
+static inline Pixel
+pixel_load(const gfloat* p)
+{
+    return _mm_loadu_ps(p);
+}
+
+static inline void
+pixel_store(gfloat* p, Pixel v)
+{
+    _mm_storeu_ps(p, v);
+}
+
+static inline Pixel
+pixel_add(Pixel a, Pixel b)
+{
+    return _mm_add_ps(a, b);
+}
+
+static inline Pixel
+pixel_mul(Pixel v, gfloat w)
+{
+    return _mm_mul_ps(v, _mm_set1_ps(w));
+}
+
+static inline Pixel
+pixel_madd(Pixel acc, Pixel v, gfloat w)
+{
+    return _mm_add_ps(acc, _mm_mul_ps(v, _mm_set1_ps(w)));
+}
+
+static inline Pixel
+pixel_premultiply(const guchar* p, gboolean has_alpha)
+{
+    if (has_alpha) {
+        const __m128i zero = _mm_setzero_si128();
+        gint32 bytes;
+        __m128i wide;
+        __m128 v, f;
+
+        memcpy(&bytes, p, sizeof(bytes));
+        wide = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero),
+                                  zero);
+        v = _mm_cvtepi32_ps(wide);
+        /* (a, a, a) / 255 for the colours, 1 for alpha itself */
+        f = _mm_mul_ps(_mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)),
+                       _mm_set1_ps(1.0f / 255.0f));
+        f = _mm_or_ps(_mm_and_ps(f, _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1))),
+                      _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f));
+        return _mm_mul_ps(v, f);
+    }
+    return _mm_set_ps(255.0f, p[2], p[1], p[0]);
+}
+#else
+typedef struct {
+    gfloat v[4];
+} Pixel;
+
+static inline Pixel
+pixel_zero(void)
+{
+    Pixel r = {{ 0.0f, 0.0f, 0.0f, 0.0f }};
+    return r;
+}
+
+static inline Pixel
+pixel_load(const gfloat* p)
+{
+    Pixel r = {{ p[0], p[1], p[2], p[3] }};
+    return r;
+}
+
+static inline void
+pixel_store(gfloat* p, Pixel v)
+{
+    memcpy(p, v.v, sizeof(v.v));
+}
+
+static inline Pixel
+pixel_add(Pixel a, Pixel b)
+{
+    for (gint i = 0; i < 4; i++) {
+        a.v[i] += b.v[i];
+    }
+    return a;
+}
+
+static inline Pixel
+pixel_mul(Pixel v, gfloat w)
+{
+    for (gint i = 0; i < 4; i++) {
+        v.v[i] *= w;
+    }
+    return v;
+}
+
+static inline Pixel
+pixel_madd(Pixel acc, Pixel v, gfloat w)
+{
+    for (gint i = 0; i < 4; i++) {
+        acc.v[i] += v.v[i] * w;
+    }
+    return acc;
+}
+
+static inline Pixel
+pixel_premultiply(const guchar* p, gboolean has_alpha)
+{
+    gfloat a = has_alpha ? p[3] : 255.0f;
+    gfloat f = a / 255.0f;
+    Pixel r = {{ p[0] * f, p[1] * f, p[2] * f, a }};
+    return r;
+}
+#endif
+
+/* Mitchell-Netravali with B = C = 1/3 */
+static gdouble
+mitchell(gdouble x)
+{
+    x = fabs(x);
+    if (x < 1.0) {
+        return (7.0 * x * x * x - 12.0 * x * x + 16.0 / 3.0) / 6.0;
+    }
+    if (x < 2.0) {
+        return (-7.0 / 3.0 * x * x * x + 12.0 * x * x - 20.0 * x + 32.0 / 3.0) / 6.0;
+    }
+    return 0.0;
+}
+
+/*
+ Weights of one axis: destination pixel i is the sum of n_taps source pixels
+ from first[i], weighted by weights[i * n_taps ...].  Taps past the edges
+ are folded onto the edge pixels.
+ */
+typedef struct {
+    gint    n_taps;
+    gint*   first;
+    gfloat* weights;
+} ScaleFilter;
+
+static void
+scale_filter_init(ScaleFilter* filter, gint src_size, gint dst_size)
+{
+    gdouble scale = (gdouble)src_size / dst_size;
+    gdouble stretch = MAX(scale, 1.0);
+    gdouble support = 2.0 * stretch;
+
+    if (src_size == dst_size) {
+        filter->n_taps = 1;
+    } else {
+        filter->n_taps = MIN((gint)ceil(support * 2.0) + 1, src_size);
+    }
+    filter->first = g_new(gint, dst_size);
+    filter->weights = g_new0(gfloat, dst_size * filter->n_taps);
+
+    for (gint i = 0; i < dst_size; i++) {
+        gfloat* weights = filter->weights + i * filter->n_taps;
+        gdouble center;
+        gdouble total = 0.0;
+        gint raw_first;
+
+        if (src_size == dst_size) {
+            filter->first[i] = i;
+            weights[0] = 1.0f;
+            continue;
+        }
+
+        center = (i + 0.5) * scale - 0.5;
+        raw_first = (gint)floor(center - support) + 1;
+        filter->first[i] = CLAMP(raw_first, 0, src_size - filter->n_taps);
+
+        for (gint j = raw_first; j < raw_first + filter->n_taps; j++) {
+            gdouble w = mitchell((j - center) / stretch);
+            gint src = CLAMP(j, 0, src_size - 1);
+
+            weights[src - filter->first[i]] += w;
+            total += w;
+        }
+        if (total != 0.0) {
+            for (gint k = 0; k < filter->n_taps; k++) {
+                weights[k] /= total;
+            }
+        }
+    }
+}
+
+static void
+scale_filter_clear(ScaleFilter* filter)
+{
+    g_free(filter->first);
+    g_free(filter->weights);
+}
+
+/*
+ Premultiplies pixbuf into a width x height float image, averaging boxes of
+ source pixels when that is smaller than the pixbuf.
+ */
+static gfloat*
+premultiply_and_box(GdkPixbuf* pixbuf, gint width, gint height)
+{
+    gint src_width = gdk_pixbuf_get_width(pixbuf);
+    gint src_height = gdk_pixbuf_get_height(pixbuf);
+    gint rowstride = gdk_pixbuf_get_rowstride(pixbuf);
+    gint n_channels = gdk_pixbuf_get_n_channels(pixbuf);
+    gboolean has_alpha = gdk_pixbuf_get_has_alpha(pixbuf);
+    const guchar* pixels = gdk_pixbuf_get_pixels(pixbuf);
+    gfloat* out = g_new(gfloat, width * height * 4);
+    gfloat* row = g_new(gfloat, width * 4);
+
+    for (gint y = 0; y < height; y++) {
+        gint y0 = y * src_height / height;
+        gint y1 = (y + 1) * src_height / height;
+
+        memset(row, 0, width * 4 * sizeof(gfloat));
+        for (gint sy = y0; sy < y1; sy++) {
+            const guchar* p = pixels + sy * rowstride;
+
+            for (gint x = 0; x < width; x++) {
+                gint x1 = (x + 1) * src_width / width;
+                Pixel acc = pixel_load(row + x * 4);
+
+                for (gint sx = x * src_width / width; sx < x1; sx++) {
+                    acc = pixel_add(acc, pixel_premultiply(p + sx * n_channels,
+                                                           has_alpha));
+                }
+                pixel_store(row + x * 4, acc);
+            }
+        }
+        for (gint x = 0; x < width; x++) {
+            gint n = ((x + 1) * src_width / width - x * src_width / width) * (y1 - y0);
+
+            pixel_store(out + (y * width + x) * 4, pixel_mul(pixel_load(row + x * 4), 1.0f / n));
+        }
+    }
+    g_free(row);
+    return out;
+}
+
+/*
+ Scales pixbuf to width x height, handing each finished row of premultiplied
+ floats to emit.
+ */
+typedef void (*ScaleRowFunc)(const gfloat* row, gint width, gint y,
+                             gpointer user_data);
+
+static void
+scale_premultiplied(GdkPixbuf* pixbuf, gint width, gint height,
+                    ScaleRowFunc emit, gpointer user_data)
+{
+    gint src_width = gdk_pixbuf_get_width(pixbuf);
+    gint src_height = gdk_pixbuf_get_height(pixbuf);
+    gint box_width = src_width;
+    gint box_height = src_height;
+    ScaleFilter hfilter, vfilter;
+    gfloat* boxed;
+    gfloat* hscaled;
+    gfloat* row;
+
+    /* leave the last factor of two or so to the filter */
+    if (src_width >= width * 4) {
+        box_width = src_width / (src_width / (width * 2));
+    }
+    if (src_height >= height * 4) {
+        box_height = src_height / (src_height / (height * 2));
+    }
+    boxed = premultiply_and_box(pixbuf, box_width, box_height);
+
+    scale_filter_init(&hfilter, box_width, width);
+    scale_filter_init(&vfilter, box_height, height);
+
+    hscaled = g_new(gfloat, width * box_height * 4);
+    for (gint y = 0; y < box_height; y++) {
+        const gfloat* src = boxed + y * box_width * 4;
+        gfloat* dst = hscaled + y * width * 4;
+
+        for (gint x = 0; x < width; x++) {
+            const gfloat* weights = hfilter.weights + x * hfilter.n_taps;
+            const gfloat* s = src + hfilter.first[x] * 4;
+            Pixel acc = pixel_zero();
+
+            for (gint k = 0; k < hfilter.n_taps; k++) {
+                acc = pixel_madd(acc, pixel_load(s + k * 4), weights[k]);
+            }
+            pixel_store(dst + x * 4, acc);
+        }
+    }
+    g_free(boxed);
+
+    /* vertically a row at a time, so the inner loop walks memory in order */
+    row = g_new(gfloat, width * 4);
+    for (gint y = 0; y < height; y++) {
+        const gfloat* weights = vfilter.weights + y * vfilter.n_taps;
+
+        memset(row, 0, width * 4 * sizeof(gfloat));
+        for (gint k = 0; k < vfilter.n_taps; k++) {
+            const gfloat* src = hscaled + (vfilter.first[y] + k) * width * 4;
+
+            for (gint x = 0; x < width; x++) {
+                pixel_store(row + x * 4, pixel_madd(pixel_load(row + x * 4),
+                                                    pixel_load(src + x * 4),
+                                                    weights[k]));
+            }
+        }
+        emit(row, width, y, user_data);
+    }
+    g_free(row);
+    g_free(hscaled);
+
+    scale_filter_clear(&hfilter);
+    scale_filter_clear(&vfilter);
+}
+
+/*
+ The filter's negative lobes can take a channel out of range or above alpha,
+ neither of which is a valid premultiplied pixel.
+ */
+static inline void
+clamp_premultiplied(const gfloat* p, guint* r, guint* g, guint* b, guint* a)
+{
+    gfloat alpha = CLAMP(p[3], 0.0f, 255.0f);
+
+    *a = (guint)(alpha + 0.5f);
+    *r = (guint)(CLAMP(p[0], 0.0f, alpha) + 0.5f);
+    *g = (guint)(CLAMP(p[1], 0.0f, alpha) + 0.5f);
+    *b = (guint)(CLAMP(p[2], 0.0f, alpha) + 0.5f);
+}
+
+typedef struct {
+    guchar* data;
+    gint    stride;
+} ScaleTarget;
+
+static void
+emit_surface_row(const gfloat* row, gint width, gint y, ScaleTarget* target)
+{
+    guint32* dst = (guint32*)(target->data + y * target->stride);
+
+    for (gint x = 0; x < width; x++) {
+        guint r, g, b, a;
+
+        clamp_premultiplied(row + x * 4, &r, &g, &b, &a);
+        dst[x] = (a << 24) | (r << 16) | (g << 8) | b;
+    }
+}
+
+static void
+emit_pixbuf_row(const gfloat* row, gint width, gint y, ScaleTarget* target)
+{
+    guchar* dst = target->data + y * target->stride;
+
+    for (gint x = 0; x < width; x++) {
+        guint r, g, b, a;
+
+        clamp_premultiplied(row + x * 4, &r, &g, &b, &a);
+        if (a) {
+            dst[0] = (r * 255 + a / 2) / a;
+            dst[1] = (g * 255 + a / 2) / a;
+            dst[2] = (b * 255 + a / 2) / a;
+        } else {
+            dst[0] = dst[1] = dst[2] = 0;
+        }
+        dst[3] = a;
+        dst += 4;
+    }
+}
+
+cairo_surface_t*
+awn_pixbuf_scale_to_surface(GdkPixbuf* pixbuf, gint width, gint height)
+{
+    cairo_surface_t* surface;
+    ScaleTarget target;
+
+    g_return_val_if_fail(GDK_IS_PIXBUF(pixbuf), NULL);
+    g_return_val_if_fail(width > 0 && height > 0, NULL);
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+    if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
+        return surface;
+    }
+    cairo_surface_flush(surface);
+    target.data = cairo_image_surface_get_data(surface);
+    target.stride = cairo_image_surface_get_stride(surface);
+    scale_premultiplied(pixbuf, width, height,
+                        (ScaleRowFunc)emit_surface_row, &target);
+    cairo_surface_mark_dirty(surface);
+
+    return surface;
+}
+
+GdkPixbuf*
+awn_pixbuf_scale(GdkPixbuf* pixbuf, gint width, gint height)
+{
+    GdkPixbuf* scaled;
+    ScaleTarget target;
+
+    g_return_val_if_fail(GDK_IS_PIXBUF(pixbuf), NULL);
+    g_return_val_if_fail(width > 0 && height > 0, NULL);
+
+    scaled = gdk_pixbuf_new(GDK_COLORSPACE_RGB, TRUE, 8, width, height);
+    if (!scaled) {
+        return NULL;
+    }
+    target.data = gdk_pixbuf_get_pixels(scaled);
+    target.stride = gdk_pixbuf_get_rowstride(scaled);
+    scale_premultiplied(pixbuf, width, height,
+                        (ScaleRowFunc)emit_pixbuf_row, &target);
+
+    return scaled;
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2026 Awn-core team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* awn-pixbuf-scale.h */
+
+#ifndef _AWN_PIXBUF_SCALE_H
+#define _AWN_PIXBUF_SCALE_H
+
+#include <cairo.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+/*
+ Icon scaling for the sizes themes ship (256 - 512 px) down to dock sizes,
+ a good deal faster than GDK_INTERP_HYPER at comparable quality.
+
+ Works on premultiplied pixels: large reductions are first box filtered to
+ about twice the target size, the rest is done with a separable Mitchell
+ filter.  Axes that keep their size are copied, so scaling to the source
+ size is a plain conversion.
+ */
+
+/* Returns a new CAIRO_FORMAT_ARGB32 image surface */
+cairo_surface_t*
+awn_pixbuf_scale_to_surface(GdkPixbuf* pixbuf, gint width, gint height);
+
+/* Returns a new pixbuf with an alpha channel */
+GdkPixbuf*
+awn_pixbuf_scale(GdkPixbuf* pixbuf, gint width, gint height);
+
+#endif
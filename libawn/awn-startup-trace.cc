@@ -0,0 +1,264 @@
+/*
+ * Copyright (C) 2026 Awn-core team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* awn-startup-trace.c */
+
+#include <time.h>
+#include <unistd.h>
+
+#include "awn-startup-trace.h"
+
+/* Only ever touched from the main thread */
+static gint trace_enabled = -1;
+static gchar* process_name = NULL;
+static GQueue* events = NULL;
+static AwnStartupTraceSink trace_sink = NULL;
+static gpointer trace_sink_data = NULL;
+static guint write_delay = 0;
+static guint write_id = 0;
+
+gboolean
+awn_startup_trace_enabled(void)
+{
+    if (trace_enabled < 0) {
+        const gchar* filename = g_getenv("AWN_STARTUP_TRACE");
+        trace_enabled = filename && filename[0] != '\0';
+    }
+    return trace_enabled;
+}
+
+gint64
+awn_startup_trace_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (gint64)ts.tv_sec * G_USEC_PER_SEC + ts.tv_nsec / 1000;
+}
+
+void
+awn_startup_trace_set_process_name(const gchar* name)
+{
+    g_free(process_name);
+    process_name = g_strdup(name);
+}
+
+const gchar*
+awn_startup_trace_get_process_name(void)
+{
+    if (process_name) {
+        return process_name;
+    }
+    return g_get_prgname() ? g_get_prgname() : "awn";
+}
+
+static void
+event_free(AwnStartupTraceEvent* event)
+{
+    g_free(event->process);
+    g_free(event->name);
+    g_free(event);
+}
+
+static gboolean
+on_write_timeout(gpointer data)
+{
+    GError* error = NULL;
+
+    write_id = 0;
+    if (!awn_startup_trace_write(&error)) {
+        g_warning("Unable to write the startup trace: %s", error->message);
+        g_error_free(error);
+    }
+    return FALSE;
+}
+
+static void
+record(AwnStartupTraceEvent* event)
+{
+    if (trace_sink) {
+        trace_sink(event, trace_sink_data);
+        event_free(event);
+        return;
+    }
+    if (!events) {
+        events = g_queue_new();
+    }
+    g_queue_push_tail(events, event);
+
+    if (write_delay && !write_id) {
+        write_id = g_timeout_add(write_delay, on_write_timeout, NULL);
+    }
+}
+
+void
+awn_startup_trace_add(const gchar* process, gint pid, const gchar* name,
+                      gint64 timestamp, gint64 duration)
+{
+    AwnStartupTraceEvent* event;
+
+    if (!awn_startup_trace_enabled()) {
+        return;
+    }
+    event = g_new0(AwnStartupTraceEvent, 1);
+    event->process = g_strdup(process);
+    event->pid = pid;
+    event->name = g_strdup(name);
+    event->timestamp = timestamp;
+    event->duration = duration;
+    record(event);
+}
+
+void
+awn_startup_trace_mark(const gchar* name)
+{
+    if (awn_startup_trace_enabled()) {
+        awn_startup_trace_add(NULL, getpid(), name, awn_startup_trace_now(), -1);
+    }
+}
+
+void
+awn_startup_trace_span(const gchar* name, gint64 start)
+{
+    if (awn_startup_trace_enabled()) {
+        awn_startup_trace_add(NULL, getpid(), name, start,
+                              awn_startup_trace_now() - start);
+    }
+}
+
+void
+awn_startup_trace_set_sink(AwnStartupTraceSink sink, gpointer user_data)
+{
+    trace_sink = sink;
+    trace_sink_data = user_data;
+
+    if (sink && events) {
+        AwnStartupTraceEvent* event;
+
+        while ((event = (AwnStartupTraceEvent*)g_queue_pop_head(events))) {
+            sink(event, user_data);
+            event_free(event);
+        }
+    }
+}
+
+void
+awn_startup_trace_clear(void)
+{
+    if (events) {
+        g_queue_foreach(events, (GFunc)event_free, NULL);
+        g_queue_free(events);
+        events = NULL;
+    }
+}
+
+static void
+append_json_string(GString* json, const gchar* str)
+{
+    g_string_append_c(json, '"');
+    for (const gchar* c = str; *c; c++) {
+        switch (*c) {
+        case '"':
+        case '\\':
+            g_string_append_c(json, '\\');
+            g_string_append_c(json, *c);
+            break;
+        default:
+            if ((guchar)*c < 0x20) {
+                g_string_append_printf(json, "\\u%04x", *c);
+            } else {
+                g_string_append_c(json, *c);
+            }
+            break;
+        }
+    }
+    g_string_append_c(json, '"');
+}
+
+void
+awn_startup_trace_write_later(guint delay)
+{
+    write_delay = delay;
+    if (write_delay && !write_id && events && !g_queue_is_empty(events)) {
+        write_id = g_timeout_add(write_delay, on_write_timeout, NULL);
+    }
+}
+
+/*
+ Chrome trace-event format: complete ("X") events for spans, process-scoped
+ instant ("i") events for marks, plus a process_name metadata ("M") event
+ for every process seen.
+ */
+gboolean
+awn_startup_trace_write(GError** error)
+{
+    const gchar* filename = g_getenv("AWN_STARTUP_TRACE");
+    GHashTable* processes;
+    GHashTableIter iter;
+    gpointer pid, name;
+    GString* json;
+    gboolean result;
+
+    if (!awn_startup_trace_enabled()) {
+        return TRUE;
+    }
+
+    processes = g_hash_table_new(g_direct_hash, g_direct_equal);
+    json = g_string_new("{\"traceEvents\":[\n");
+
+    for (GList* l = events ? events->head : NULL; l; l = l->next) {
+        AwnStartupTraceEvent* event = (AwnStartupTraceEvent*)l->data;
+        const gchar* process = event->process ?
+                               event->process : awn_startup_trace_get_process_name();
+
+        g_hash_table_insert(processes, GINT_TO_POINTER(event->pid),
+                            (gpointer)process);
+
+        g_string_append(json, "{\"name\":");
+        append_json_string(json, event->name);
+        if (event->duration >= 0) {
+            g_string_append_printf(json, ",\"ph\":\"X\",\"dur\":%" G_GINT64_FORMAT,
+                                   event->duration);
+        } else {
+            g_string_append(json, ",\"ph\":\"i\",\"s\":\"p\"");
+        }
+        g_string_append_printf(json, ",\"ts\":%" G_GINT64_FORMAT
+                               ",\"pid\":%d,\"tid\":%d},\n",
+                               event->timestamp, event->pid, event->pid);
+    }
+
+    g_hash_table_iter_init(&iter, processes);
+    while (g_hash_table_iter_next(&iter, &pid, &name)) {
+        g_string_append_printf(json, "{\"name\":\"process_name\",\"ph\":\"M\","
+                               "\"pid\":%d,\"args\":{\"name\":",
+                               GPOINTER_TO_INT(pid));
+        append_json_string(json, (const gchar*)name);
+        g_string_append(json, "}},\n");
+    }
+
+    /* no trailing comma */
+    if (json->str[json->len - 2] == ',') {
+        g_string_truncate(json, json->len - 2);
+    }
+    g_string_append(json, "\n]}\n");
+
+    result = g_file_set_contents(filename, json->str, json->len, error);
+
+    g_string_free(json, TRUE);
+    g_hash_table_destroy(processes);
+    return result;
+}
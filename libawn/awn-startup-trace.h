@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2026 Awn-core team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* awn-startup-trace.h */
+
+#ifndef _AWN_STARTUP_TRACE_H
+#define _AWN_STARTUP_TRACE_H
+
+#include <glib.h>
+
+/*
+ Startup timeline, recorded only when AWN_STARTUP_TRACE names an output file
+ in awn's environment (the applets inherit it).
+
+ Timestamps are CLOCK_MONOTONIC microseconds, so they line up across
+ processes.  Applets hand their events to a sink (AwnApplet reports them to
+ the panel over D-Bus), awn collects them with its own and writes the lot
+ as Chrome trace-event JSON, rewriting the file as more events come in and
+ once more when it exits.
+ */
+
+typedef struct {
+    gchar* process;   /* NULL for this process */
+    gint pid;
+    gchar* name;
+    gint64 timestamp;
+    gint64 duration;  /* -1 for instant events */
+} AwnStartupTraceEvent;
+
+typedef void (*AwnStartupTraceSink)(const AwnStartupTraceEvent* event,
+                                    gpointer user_data);
+
+gboolean awn_startup_trace_enabled(void);
+
+gint64   awn_startup_trace_now(void);
+
+/* Names this process in the trace, defaults to g_get_prgname() */
+void     awn_startup_trace_set_process_name(const gchar* name);
+
+const gchar* awn_startup_trace_get_process_name(void);
+
+void     awn_startup_trace_mark(const gchar* name);
+
+/* Records the time from start (an awn_startup_trace_now() value) until now */
+void     awn_startup_trace_span(const gchar* name, gint64 start);
+
+/* Adds an event recorded by another process */
+void     awn_startup_trace_add(const gchar* process, gint pid,
+                               const gchar* name,
+                               gint64 timestamp, gint64 duration);
+
+/* Passes the events recorded so far and all later ones to sink instead of
+ * keeping them, NULL goes back to keeping them */
+void     awn_startup_trace_set_sink(AwnStartupTraceSink sink,
+                                    gpointer user_data);
+
+/* Forgets the events recorded so far (e.g. in a freshly forked child) */
+void     awn_startup_trace_clear(void);
+
+/* Writes the recorded events to the AWN_STARTUP_TRACE file */
+gboolean awn_startup_trace_write(GError** error);
+
+/* From now on rewrites the file delay ms after an event is recorded, so a
+ * burst of events is written once.  Call awn_startup_trace_write() before
+ * exiting for the events of the last delay ms. */
+void     awn_startup_trace_write_later(guint delay);
+
+#endif
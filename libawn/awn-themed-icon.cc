@@ -40,6 +40,9 @@
 #include "awn-themed-icon.h"
 #include "libawn.h"
 
+#include "awn-icon-private.h"
+#include "awn-pixbuf-scale.h"
+#include "awn-startup-trace.h"
 #include "gseal-transition.h"
 
 #if !GTK_CHECK_VERSION(2,14,0)
@@ -117,11 +120,35 @@ struct _GtkIconThemePrivate {
 };
 
 
+enum {
+    SCOPE_UID = 0,
+    SCOPE_APPLET,
+    SCOPE_AWN_THEME,
+    SCOPE_OVERRIDE_THEME,
+    SCOPE_GTK_THEME,
+    SCOPE_FILENAME,
+    SCOPE_FALLBACK_STOP,
+    SCOPE_FALLBACK_FILL,
+
+    N_SCOPES
+};
+
 typedef struct {
     gchar* name;
     gchar* state;
     gchar* original_name;   /*do we need this ? */
     gboolean  sticky;
+
+    /*
+     Memo of the scope walk in get_pixbuf_at_size(), valid while
+     memo_generation matches the icon's scope_generation: the scope that won
+     last, a bit per scope that came up empty and the awn-theme icon names
+     of the custom icon scopes.
+     */
+    guint   memo_generation;
+    gint    won_scope;
+    guint   empty_scopes;
+    gchar*  scope_names[SCOPE_OVERRIDE_THEME];
 } AwnThemedIconItem;
 
 struct _AwnThemedIconPrivate {
@@ -154,6 +181,11 @@ struct _AwnThemedIconPrivate {
     GtkWidget* remove_custom_icon_item;
 
     GList* preload_list;
+    /*AwnThemedIconPreloadLoads decoding on the pixbuf cache's workers*/
+    GList* preload_loads;
+
+    /*bumped whenever something the scopes resolve against changes*/
+    guint  scope_generation;
 };
 
 typedef struct {
@@ -163,18 +195,20 @@ typedef struct {
     guint         id;
 } AwnThemedIconPreloadItem;
 
-enum {
-    SCOPE_UID = 0,
-    SCOPE_APPLET,
-    SCOPE_AWN_THEME,
-    SCOPE_OVERRIDE_THEME,
-    SCOPE_GTK_THEME,
-    SCOPE_FILENAME,
-    SCOPE_FALLBACK_STOP,
-    SCOPE_FALLBACK_FILL,
-
-    N_SCOPES
-};
+/*
+ A preloaded icon file being decoded off the main loop, and the cache entry
+ it is for.
+ */
+typedef struct {
+    AwnThemedIcon* icon;
+    const gchar*    scope;
+    gchar*          theme_name;
+    gchar*          icon_name;
+    gint            size;
+    /* decoded at its own size, scaled as gtk_icon_info_load_icon() would */
+    gboolean        theme_scale;
+    gboolean        unthemed;
+} AwnThemedIconPreloadLoad;
 
 static const GtkTargetEntry drop_types[] = {
     { (gchar*)"STRING", GTK_TARGET_OTHER_APP, 0 },
@@ -195,8 +229,12 @@ static void on_icon_theme_changed(GtkIconTheme*  theme,
 
 static gboolean on_idle_preload(gpointer item);
 
+static void awn_themed_icon_cancel_preloads(AwnThemedIcon* icon);
+
 static void ensure_icon(AwnThemedIcon* icon);
 
+static void on_large_source_needed(AwnEffects* fx, AwnThemedIcon* icon);
+
 static void awn_themed_icon_preload_all(AwnThemedIcon* icon);
 
 static GtkIconTheme* get_awn_theme(void);
@@ -337,6 +375,9 @@ static void
 awn_themed_icon_invalidate_pixbuf_cache(AwnThemedIcon* icon)
 {
     AwnThemedIconPrivate* priv = AWN_THEMED_ICON_GET_PRIVATE(icon);
+
+    /* whatever is being decoded is for the old size or theme */
+    awn_themed_icon_cancel_preloads(icon);
     if (priv->cache_sentinel) {
         return;
     }
@@ -345,6 +386,47 @@ awn_themed_icon_invalidate_pixbuf_cache(AwnThemedIcon* icon)
     }
 }
 
+/*
+ Starts the memo of item over if the icon's scope_generation moved on since
+ it was made.  The custom icon names only change with the applet name and
+ uid, building them once saves get_pixbuf_at_size() the work at every size.
+ */
+static void
+awn_themed_icon_item_update_memo(AwnThemedIcon* icon, AwnThemedIconItem* item)
+{
+    AwnThemedIconPrivate* priv = icon->priv;
+    gchar* base;
+
+    if (item->memo_generation == priv->scope_generation) {
+        return;
+    }
+    for (gint i = 0; i < SCOPE_OVERRIDE_THEME; i++) {
+        g_free(item->scope_names[i]);
+    }
+    base = g_path_get_basename(item->name);
+    item->scope_names[SCOPE_UID] = g_strdup_printf("%s-%s-%s", base,
+                                   priv->applet_name, priv->uid);
+    item->scope_names[SCOPE_APPLET] = g_strdup_printf("%s-%s", base,
+                                      priv->applet_name);
+    item->scope_names[SCOPE_AWN_THEME] = base;
+
+    item->won_scope = SCOPE_UID;
+    item->empty_scopes = 0;
+    item->memo_generation = priv->scope_generation;
+}
+
+static void
+awn_themed_icon_item_free(AwnThemedIconItem* item)
+{
+    g_free(item->name);
+    g_free(item->original_name);
+    g_free(item->state);
+    for (gint i = 0; i < SCOPE_OVERRIDE_THEME; i++) {
+        g_free(item->scope_names[i]);
+    }
+    g_free(item);
+}
+
 
 /*End of pixbuf caching functions */
 
@@ -433,13 +515,7 @@ awn_themed_icon_finalize(GObject* object)
     g_return_if_fail(AWN_IS_THEMED_ICON(object));
     priv = AWN_THEMED_ICON(object)->priv;
 
-    for (iter = priv->list; iter; iter = g_list_next(iter)) {
-        AwnThemedIconItem* item = iter->data;
-        g_free(item->name);
-        g_free(item->state);
-        g_free(item->original_name);
-    }
-    g_list_foreach(priv->list, (GFunc) g_free, NULL);
+    g_list_foreach(priv->list, (GFunc) awn_themed_icon_item_free, NULL);
     g_list_free(priv->list);
 
     g_free(priv->applet_name);
@@ -461,6 +537,7 @@ awn_themed_icon_finalize(GObject* object)
     if (priv->preload_list) {
         g_list_free(priv->preload_list);
     }
+    awn_themed_icon_cancel_preloads(AWN_THEMED_ICON(object));
     G_OBJECT_CLASS(awn_themed_icon_parent_class)->finalize(object);
 }
 
@@ -603,6 +680,8 @@ awn_themed_icon_init(AwnThemedIcon* icon)
     priv->current_size = -1;
     priv->custom_icon_name = NULL;
     priv->preload_list = NULL;
+    priv->preload_loads = NULL;
+    priv->scope_generation = 1; /*items start out with an invalid memo*/
     priv->pixbufs = awn_pixbuf_cache_get_default();
     priv->cache_sentinel = 0;
 
@@ -650,6 +729,10 @@ awn_themed_icon_init(AwnThemedIcon* icon)
     priv->sig_id_for_awn_theme = g_signal_connect(priv->awn_theme, "changed",
                                  G_CALLBACK(on_icon_theme_changed), icon);
 
+    g_signal_connect(awn_overlayable_get_effects(AWN_OVERLAYABLE(icon)),
+                     "large-source-needed",
+                     G_CALLBACK(on_large_source_needed), icon);
+
     g_free(scalable_dir);
     g_free(theme_dir);
 //  g_free (hicolor_dir);
@@ -768,24 +851,22 @@ get_pixbuf_at_size(AwnThemedIcon* icon, gint size, const gchar* state)
         AwnThemedIconItem* item = iter->data;
         /*Conditional Operator */
         if (g_strcmp0(item->state, state ? state : priv->current_item->state) == 0) {
-            const gchar* applet_name;
             const gchar* icon_name;
-            const gchar* uid;
-            gchar* base = NULL;
             gint         i;
 
-            applet_name = priv->applet_name;
             icon_name = item->name;
-            uid = priv->uid;
-            priv->awn_theme_hit = TRUE;
-            /* Go through all the possible outcomes until we get a pixbuf */
-            for (i = 0; i < N_SCOPES; i++) {
-                gchar* name = NULL;
+            awn_themed_icon_item_update_memo(icon, item);
+            /* Go through the possible outcomes until we get a pixbuf, starting
+             with the one that won last time and skipping those known empty */
+            for (i = item->won_scope; i < N_SCOPES; i++) {
+                const gchar* name = NULL;
+
+                if (item->empty_scopes & (1 << i)) {
+                    continue;
+                }
                 switch (i) {
                 case SCOPE_UID:
-                    base = g_path_get_basename(icon_name);
-                    name = g_strdup_printf("%s-%s-%s", base, applet_name, uid);
-                    g_free(base);
+                    name = item->scope_names[SCOPE_UID];
                     pixbuf = awn_themed_icon_lookup_pixbuf(icon,
                                                            "scope_uid",
                                                            priv->awn_theme,
@@ -794,9 +875,7 @@ get_pixbuf_at_size(AwnThemedIcon* icon, gint size, const gchar* state)
                     break;
 
                 case SCOPE_APPLET:
-                    base = g_path_get_basename(icon_name);
-                    name = g_strdup_printf("%s-%s", base, applet_name);
-                    g_free(base);
+                    name = item->scope_names[SCOPE_APPLET];
                     pixbuf = awn_themed_icon_lookup_pixbuf(icon,
                                                            "scope_applet",
                                                            priv->awn_theme,
@@ -805,7 +884,7 @@ get_pixbuf_at_size(AwnThemedIcon* icon, gint size, const gchar* state)
                     break;
 
                 case SCOPE_AWN_THEME:
-                    name = g_path_get_basename(icon_name);
+                    name = item->scope_names[SCOPE_AWN_THEME];
                     pixbuf = awn_themed_icon_lookup_pixbuf(icon,
                                                            "scope_awn_theme",
                                                            priv->awn_theme,
@@ -814,7 +893,6 @@ get_pixbuf_at_size(AwnThemedIcon* icon, gint size, const gchar* state)
                     break;
 
                 case SCOPE_OVERRIDE_THEME:
-                    priv->awn_theme_hit = FALSE;
                     pixbuf = NULL;
                     if (priv->override_theme) {
                         pixbuf = awn_themed_icon_lookup_pixbuf(icon,
@@ -858,41 +936,38 @@ get_pixbuf_at_size(AwnThemedIcon* icon, gint size, const gchar* state)
                     break;
                 }
 
-                if (pixbuf && priv->awn_theme_hit && name) {
-                    if (priv->custom_icon_name) {
-                        g_free(priv->custom_icon_name);
+                /* Check if we got a valid pixbuf on this run */
+                if (!pixbuf) {
+                    /* the file is the current item's, which can change */
+                    if (i != SCOPE_FILENAME) {
+                        item->empty_scopes |= 1 << i;
                     }
-                    priv->custom_icon_name = name;
-                } else {
-                    g_free(name);
+                    continue;
                 }
+                item->won_scope = i;
 
-                /* Check if we got a valid pixbuf on this run */
-                if (pixbuf) {
-                    /* FIXME: Should we make this position-aware? */
-                    if (priv->awn_theme_hit && priv->remove_custom_icon_item) {
-                        gtk_widget_show(priv->remove_custom_icon_item);
-                    } else if (priv->remove_custom_icon_item) {
-                        gtk_widget_hide(priv->remove_custom_icon_item);
-                    }
+                priv->awn_theme_hit = i < SCOPE_OVERRIDE_THEME;
+                g_free(priv->custom_icon_name);
+                priv->custom_icon_name = priv->awn_theme_hit ? g_strdup(name) : NULL;
 
-                    if (gdk_pixbuf_get_height(pixbuf) > size) {
-                        GdkPixbuf* temp = pixbuf;
-                        gint       width, height;
+                /* FIXME: Should we make this position-aware? */
+                if (priv->awn_theme_hit && priv->remove_custom_icon_item) {
+                    gtk_widget_show(priv->remove_custom_icon_item);
+                } else if (priv->remove_custom_icon_item) {
+                    gtk_widget_hide(priv->remove_custom_icon_item);
+                }
 
-                        width = gdk_pixbuf_get_width(temp);
-                        height = gdk_pixbuf_get_height(temp);
+                if (gdk_pixbuf_get_height(pixbuf) > size) {
+                    GdkPixbuf* temp = pixbuf;
+                    gint       width, height;
 
-                        pixbuf = gdk_pixbuf_scale_simple(temp, width * size / height, size,
-                                                         GDK_INTERP_HYPER);
-                        g_object_unref(temp);
-                    }
-                    if (!name) {
-                        g_free(priv->custom_icon_name);
-                        priv->custom_icon_name = NULL;
-                    }
-                    return pixbuf;
+                    width = gdk_pixbuf_get_width(temp);
+                    height = gdk_pixbuf_get_height(temp);
+
+                    pixbuf = awn_pixbuf_scale(temp, width * size / height, size);
+                    g_object_unref(temp);
                 }
+                return pixbuf;
             }
         }
     }
@@ -906,11 +981,30 @@ get_pixbuf_at_size(AwnThemedIcon* icon, gint size, const gchar* state)
 /*
  * Main function to ensure the icon
  */
+static GdkPixbuf*
+get_rotated_pixbuf_at_size(AwnThemedIcon* icon, gint size)
+{
+    AwnThemedIconPrivate* priv = icon->priv;
+    GdkPixbuf*            pixbuf;
+
+    pixbuf = get_pixbuf_at_size(icon, size, priv->current_item->state);
+
+    if (priv->rotate) {
+        GdkPixbuf* rotated;
+        rotated = gdk_pixbuf_rotate_simple(pixbuf, priv->rotate);
+        g_object_unref(pixbuf);
+        pixbuf = rotated;
+    }
+    return pixbuf;
+}
+
 static void
 ensure_icon(AwnThemedIcon* icon)
 {
     AwnThemedIconPrivate* priv;
     GdkPixbuf*            pixbuf;
+    static gboolean       first_load = TRUE;
+    gint64                start = 0;
 
     priv = icon->priv;
 
@@ -918,17 +1012,49 @@ ensure_icon(AwnThemedIcon* icon)
         /* We're not ready yet */
         return;
     }
+    if (first_load) {
+        start = awn_startup_trace_now();
+    }
     /* Get the icon first */
-    pixbuf = get_pixbuf_at_size(icon, priv->current_size, priv->current_item->state);
+    pixbuf = get_rotated_pixbuf_at_size(icon, priv->current_size);
+    awn_icon_set_from_pixbuf(AWN_ICON(icon), pixbuf);
+    g_object_unref(pixbuf);
 
-    if (priv->rotate) {
-        GdkPixbuf* rotated;
-        rotated = gdk_pixbuf_rotate_simple(pixbuf, priv->rotate);
-        g_object_unref(pixbuf);
-        pixbuf = rotated;
+    if (first_load) {
+        awn_startup_trace_span("first icon load", start);
+        first_load = FALSE;
     }
-    awn_icon_set_from_pixbuf(AWN_ICON(icon), pixbuf);
+}
 
+/*
+ * Hover zoom draws the icon up to the size AwnIcon requests, give the effects
+ * the theme's rendering at that size instead of an upscale.  Only done for
+ * icons that actually get zoomed, once per icon set by ensure_icon().
+ */
+static void
+on_large_source_needed(AwnEffects* fx, AwnThemedIcon* icon)
+{
+    AwnThemedIconPrivate* priv = icon->priv;
+    GdkPixbuf*            pixbuf;
+    cairo_surface_t*      large;
+    cairo_t*              cr;
+
+    if (!priv->list || !priv->current_item || (priv->current_size <= 0)) {
+        return;
+    }
+    pixbuf = get_rotated_pixbuf_at_size(icon,
+                                        APPLY_SIZE_MULTIPLIER(priv->current_size));
+    large = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+                                       gdk_pixbuf_get_width(pixbuf),
+                                       gdk_pixbuf_get_height(pixbuf));
+    cr = cairo_create(large);
+    gdk_cairo_set_source_pixbuf(cr, pixbuf, 0, 0);
+    cairo_paint(cr);
+    cairo_destroy(cr);
+
+    awn_effects_set_icon_source_large(fx, large);
+
+    cairo_surface_destroy(large);
     g_object_unref(pixbuf);
 }
 
@@ -1101,10 +1227,7 @@ awn_themed_icon_set_info(AwnThemedIcon*  icon,
                 state = g_strdup(priv->current_item->state);
                 priv->current_item = NULL;
             }
-            g_free(item->name);
-            g_free(item->original_name);
-            g_free(item->state);
-            g_free(item);
+            awn_themed_icon_item_free(item);
             priv->list = g_list_delete_link(priv->list, iter);
             iter = priv->list;  /* FIXME*/
         }
@@ -1121,7 +1244,7 @@ awn_themed_icon_set_info(AwnThemedIcon*  icon,
 
     /* Copy states & icon_names into list */
     for (i = 0; i < n_states; i++) {
-        AwnThemedIconItem* item = g_malloc(sizeof(AwnThemedIconItem));
+        AwnThemedIconItem* item = g_new0(AwnThemedIconItem, 1);
         item->original_name = g_strdup(icon_names[i]);
         item->state = g_strdup(states[i]);
         item->sticky = FALSE;
@@ -1132,6 +1255,7 @@ awn_themed_icon_set_info(AwnThemedIcon*  icon,
     /* Now add the rest of the entries */
     g_free(priv->uid);
     priv->uid = g_strdup(uid);
+    priv->scope_generation++;
 
     /* Finally set-up the applet name & theme information */
     if (priv->applet_name && strcmp(priv->applet_name, applet_name) == 0) {
@@ -1259,13 +1383,15 @@ awn_themed_icon_set_info_append(AwnThemedIcon*  icon,
     /*FIXME once we get a applet name into AwnApplet*/
     if (!priv->applet_name) {
         priv->applet_name = g_strdup("__unknown__");
+        priv->scope_generation++;
     }
 
     if (!priv->uid) {
         priv->uid = g_strdup("__invisible__");
+        priv->scope_generation++;
     }
 
-    item = g_malloc(sizeof(AwnThemedIconItem));
+    item = g_new0(AwnThemedIconItem, 1);
 
     item->original_name = g_strdup(icon_name);
     item->name = normalise_name(icon_name);
@@ -1298,6 +1424,7 @@ awn_themed_icon_set_applet_info(AwnThemedIcon*  icon,
     } else {
         priv->uid = NULL;
     }
+    priv->scope_generation++;
 
     /* Finally set-up the applet name & theme information */
     if (priv->applet_name && strcmp(priv->applet_name, applet_name) == 0) {
@@ -1338,6 +1465,7 @@ awn_themed_icon_override_gtk_theme(AwnThemedIcon* icon,
     g_return_if_fail(AWN_IS_THEMED_ICON(icon));
 
     priv = icon->priv;
+    priv->scope_generation++;
     /* Remove old theme, if it exists */
     if (priv->override_theme) {
         g_object_unref(priv->override_theme);
@@ -1520,14 +1648,12 @@ awn_themed_icon_clear_info(AwnThemedIcon* icon)
 
     /* Free the old states & icon_names */
     priv->current_item = NULL;
+    awn_themed_icon_cancel_preloads(icon);
 
     for (iter = priv->list; iter; iter = g_list_next(iter)) {
         AwnThemedIconItem* item = iter->data;
 
-        g_free(item->name);
-        g_free(item->original_name);
-        g_free(item->state);
-        g_free(item);
+        awn_themed_icon_item_free(item);
         priv->list = g_list_delete_link(priv->list, iter);
     }
     if (priv->drag_and_drop) {
@@ -1590,6 +1716,11 @@ on_icon_theme_changed(GtkIconTheme* theme, AwnThemedIcon* icon)
     g_return_if_fail(AWN_IS_THEMED_ICON(icon));
 
     priv = icon->priv;
+    /*
+     Icons may have come or gone in either theme, this is also how changes to
+     the awn-theme directory arrive (see awn_theme_dir_changed()).
+     */
+    priv->scope_generation++;
     /*
      Don't invalidate if the theme name hasn't really changed.  The most
      annoying instance of this occuring is when an new AwnThemedIcon is created.
@@ -1602,11 +1733,234 @@ on_icon_theme_changed(GtkIconTheme* theme, AwnThemedIcon* icon)
     ensure_icon(icon);
 }
 
+static void
+awn_themed_icon_preload_load_free(AwnThemedIconPreloadLoad* load)
+{
+    g_free(load->theme_name);
+    g_free(load->icon_name);
+    g_free(load);
+}
+
+/*
+ What gtk_icon_info_load_icon() does with GTK_ICON_LOOKUP_FORCE_SIZE to an
+ icon file it decoded at its own size: scale the larger side to size, but
+ never up for icons outside of a theme.
+ */
+static GdkPixbuf*
+scale_like_icon_theme(GdkPixbuf* pixbuf, gint size, gboolean unthemed)
+{
+    gint width = gdk_pixbuf_get_width(pixbuf);
+    gint height = gdk_pixbuf_get_height(pixbuf);
+    gdouble scale = (gdouble) size / MAX(width, height);
+
+    if (unthemed) {
+        scale = MIN(scale, 1.0);
+    }
+    if (scale == 1.0) {
+        return GDK_PIXBUF(g_object_ref(pixbuf));
+    }
+    return gdk_pixbuf_scale_simple(pixbuf, 0.5 + width * scale,
+                                   0.5 + height * scale, GDK_INTERP_BILINEAR);
+}
+
+/*
+ A preloaded file got decoded.  Cached under the key get_pixbuf_at_size()
+ will look it up with, the same as awn_themed_icon_lookup_pixbuf() does.
+ Failures aren't cached, the synchronous load still gets its fallbacks.
+ */
+static void
+on_preload_file_loaded(GdkPixbuf* pixbuf, AwnThemedIconPreloadLoad* load)
+{
+    AwnThemedIconPrivate* priv = load->icon->priv;
+
+    priv->preload_loads = g_list_remove(priv->preload_loads, load);
+    if (pixbuf) {
+        GdkPixbuf* scaled = load->theme_scale ?
+                            scale_like_icon_theme(pixbuf, load->size, load->unthemed) :
+                            GDK_PIXBUF(g_object_ref(pixbuf));
+
+        awn_pixbuf_cache_insert_pixbuf(priv->pixbufs, scaled, load->scope,
+                                       load->theme_name, load->icon_name);
+        g_object_unref(scaled);
+    }
+    awn_themed_icon_preload_load_free(load);
+}
+
+static void
+awn_themed_icon_cancel_preloads(AwnThemedIcon* icon)
+{
+    AwnThemedIconPrivate* priv = AWN_THEMED_ICON_GET_PRIVATE(icon);
+
+    for (GList* iter = priv->preload_loads; iter; iter = iter->next) {
+        awn_pixbuf_cache_cancel_load_file(priv->pixbufs,
+                                          (AwnPixbufCacheFileFunc)on_preload_file_loaded,
+                                          iter->data);
+        awn_themed_icon_preload_load_free(iter->data);
+    }
+    g_list_free(priv->preload_loads);
+    priv->preload_loads = NULL;
+}
+
+/*
+ Decodes filename for the cache entry of scope, theme_name and icon_name.
+ Files found by an icon theme (theme isn't NULL) are decoded the way
+ theme_load_icon() gets them, others the way try_and_load_image_from_disk()
+ decodes them first.
+ */
+static void
+awn_themed_icon_preload_file(AwnThemedIcon* icon, const gchar* scope,
+                             GtkIconTheme* theme,
+                             const gchar* theme_name, const gchar* icon_name,
+                             const gchar* filename, gint size)
+{
+    AwnThemedIconPrivate* priv = icon->priv;
+    AwnThemedIconPreloadLoad* load;
+    GdkPixbuf* pixbuf;
+    gint decode_size = size;
+
+    load = g_new0(AwnThemedIconPreloadLoad, 1);
+    load->icon = icon;
+    load->scope = scope;
+    load->theme_name = g_strdup(theme_name);
+    load->icon_name = g_strdup(icon_name);
+    load->size = size;
+    /* GtkIconTheme renders SVGs at the size, other files at their own */
+    if (theme && !g_str_has_suffix(filename, ".svg")) {
+        gchar* dir = g_path_get_dirname(filename);
+        gchar** path = NULL;
+        gint n_path = 0;
+
+        /* unthemed icons lie right in a directory of the search path */
+        gtk_icon_theme_get_search_path(theme, &path, &n_path);
+        for (gint i = 0; i < n_path && !load->unthemed; i++) {
+            load->unthemed = g_strcmp0(dir, path[i]) == 0;
+        }
+        g_strfreev(path);
+        g_free(dir);
+
+        load->theme_scale = TRUE;
+        decode_size = -1;
+    }
+    priv->preload_loads = g_list_prepend(priv->preload_loads, load);
+
+    pixbuf = awn_pixbuf_cache_load_file(priv->pixbufs, filename,
+                                        decode_size, decode_size, TRUE,
+                                        (AwnPixbufCacheFileFunc)on_preload_file_loaded,
+                                        load);
+    if (pixbuf) {
+        /* decoded before, only the scope entry is missing */
+        on_preload_file_loaded(pixbuf, load);
+        g_object_unref(pixbuf);
+    }
+}
+
+/*
+ Walks the scopes like get_pixbuf_at_size() but leaves the decoding of the
+ icon file that wins to the pixbuf cache's worker threads, the result is
+ what get_pixbuf_at_size() would have cached.  Only the icon theme lookups,
+ which GtkIconTheme doesn't allow off the main loop, happen here.  Icons
+ without a file (builtins) and the fallbacks are left to get_pixbuf_at_size().
+ */
+static void
+awn_themed_icon_preload_at_size(AwnThemedIcon* icon, gint size, const gchar* state)
+{
+    AwnThemedIconPrivate* priv = icon->priv;
+    AwnThemedIconItem* item = NULL;
+
+    for (GList* iter = priv->list; iter; iter = g_list_next(iter)) {
+        if (g_strcmp0(((AwnThemedIconItem*)iter->data)->state, state) == 0) {
+            item = iter->data;
+            break;
+        }
+    }
+    if (!item || size <= 0) {
+        return;
+    }
+
+    awn_themed_icon_item_update_memo(icon, item);
+    for (gint i = item->won_scope; i < SCOPE_FALLBACK_STOP; i++) {
+        const gchar* scope = NULL;
+        GtkIconTheme* theme = NULL;
+        const gchar* theme_name;
+        const gchar* name = item->name;
+        GdkPixbuf* pixbuf;
+        gboolean null_result = FALSE;
+
+        if (item->empty_scopes & (1 << i)) {
+            continue;
+        }
+        switch (i) {
+        case SCOPE_UID:
+            name = item->scope_names[SCOPE_UID];
+            scope = "scope_uid";
+            theme = priv->awn_theme;
+            break;
+        case SCOPE_APPLET:
+            name = item->scope_names[SCOPE_APPLET];
+            scope = "scope_applet";
+            theme = priv->awn_theme;
+            break;
+        case SCOPE_AWN_THEME:
+            name = item->scope_names[SCOPE_AWN_THEME];
+            scope = "scope_awn_theme";
+            theme = priv->awn_theme;
+            break;
+        case SCOPE_OVERRIDE_THEME:
+            if (!priv->override_theme) {
+                item->empty_scopes |= 1 << i;
+                continue;
+            }
+            scope = "scope_override_theme";
+            theme = priv->override_theme;
+            break;
+        case SCOPE_GTK_THEME:
+            theme = priv->gtk_theme;
+            break;
+        case SCOPE_FILENAME:
+            if (!priv->current_item || !priv->current_item->original_name) {
+                continue;
+            }
+            break;
+        }
+        theme_name = theme ? theme->priv->current_theme : "__NONE__";
+
+        pixbuf = awn_pixbuf_cache_lookup(priv->pixbufs, scope, theme_name, name,
+                                         -1, size, &null_result);
+        if (pixbuf) {
+            g_object_unref(pixbuf);
+            return;
+        }
+        if (null_result) {
+            continue;
+        }
+
+        if (theme) {
+            const gchar* names[2] = {name, NULL};
+            GtkIconInfo* info = gtk_icon_theme_choose_icon(theme, names, size, LOAD_FLAGS);
+
+            if (!info) {
+                awn_pixbuf_cache_insert_null_result(priv->pixbufs, scope, theme_name,
+                                                    name, -1, size);
+                item->empty_scopes |= 1 << i;
+                continue;
+            }
+            if (gtk_icon_info_get_filename(info)) {
+                awn_themed_icon_preload_file(icon, scope, theme, theme_name, name,
+                                             gtk_icon_info_get_filename(info), size);
+            }
+            gtk_icon_info_free(info);
+        } else {
+            awn_themed_icon_preload_file(icon, scope, NULL, theme_name, name,
+                                         priv->current_item->original_name, size);
+        }
+        return;
+    }
+}
+
 static gboolean
 on_idle_preload(gpointer data)
 {
     AwnThemedIconPreloadItem* item = data;
-    GdkPixbuf* pixbuf;
     AwnThemedIconPrivate* priv;
     g_return_val_if_fail(item, FALSE);
     priv = item->icon->priv;
@@ -1617,11 +1971,10 @@ on_idle_preload(gpointer data)
     }
 
     /*CONDITIONAL operator*/
-    pixbuf = get_pixbuf_at_size(item->icon,
-                                item->size > 0 ? item->size : priv->current_size,
-                                item->state);
+    awn_themed_icon_preload_at_size(item->icon,
+                                    item->size > 0 ? item->size : priv->current_size,
+                                    item->state);
 
-    g_object_unref(pixbuf);
     priv->preload_list = g_list_remove(priv->preload_list, item);
     g_free(item->state);
     g_free(item);
@@ -21,6 +21,8 @@
 
 #include "config.h"
 
+#include <string.h>
+#include <glib/gstdio.h>
 #include <libawn/libawn.h>
 #include <libawn/awn-utils.h>
 #include "libawn/gseal-transition.h"
@@ -32,9 +34,27 @@
 #include "awn-throbber.h"
 #include "awn-separator.h"
 #include "xutils.h"
+#include "awn-marshal.h"
 
 #define MAX_UA_LIST_ENTRIES 50
 
+/* seconds to wait for an applet to embed before starting the next one */
+#define STARTUP_TIMEOUT 10
+
+#define APPLET_SIZES_GROUP "sizes"
+
+/* seconds between the readings of the applets' resource usage */
+#define USAGE_INTERVAL 5
+
+/* seconds the readings go on after a GetAppletUsage call */
+#define USAGE_REQUEST_TIMEOUT 60
+
+typedef enum {
+    USAGE_OVER_CPU     = 1 << 0,
+    USAGE_OVER_RSS     = 1 << 1,
+    USAGE_OVER_WAKEUPS = 1 << 2
+} UsageLimit;
+
 G_DEFINE_TYPE(AwnAppletManager, awn_applet_manager, AWN_TYPE_BOX)
 
 #define AWN_APPLET_MANAGER_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE (obj, \
@@ -66,6 +86,26 @@ struct _AwnAppletManagerPrivate {
     GQuark           touch_quark;
     GQuark           visibility_quark;
     GQuark           shape_mask_quark;
+
+    /* applets waiting to be started (by priority) and started applets that
+     * didn't embed yet (-> timeout id) */
+    GQueue*          startup_queue;
+    GHashTable*      startup_running;
+    GQuark           startup_priority_quark;
+    guint            startup_idle_id;
+    gint             startup_parallelism;
+    gboolean         startup_placeholders;
+    gchar*           placeholders_dir;
+
+    /* resource usage of the applets, limits of 0 are off */
+    guint            usage_timer_id;
+    guint            usage_request_id;
+    gboolean         usage_redraws;
+    GQuark           usage_over_quark;
+    gdouble          applet_cpu_limit;
+    gint             applet_rss_limit;
+    gint             applet_wakeup_limit;
+    gboolean         usage_overlay;
 };
 
 enum {
@@ -78,7 +118,13 @@ enum {
     PROP_APPLET_LIST,
     PROP_UA_LIST,
     PROP_UA_ACTIVE_LIST,
-    PROP_EXPANDS
+    PROP_EXPANDS,
+    PROP_STARTUP_PARALLELISM,
+    PROP_STARTUP_PLACEHOLDERS,
+    PROP_APPLET_CPU_LIMIT,
+    PROP_APPLET_RSS_LIMIT,
+    PROP_APPLET_WAKEUP_LIMIT,
+    PROP_APPLET_USAGE_OVERLAY
 };
 
 enum {
@@ -86,6 +132,7 @@ enum {
     APPLET_REMOVED,
     SHAPE_MASK_CHANGED,
     APPLETS_REFRESHED,
+    APPLET_OVERLOADED,
 
     LAST_SIGNAL
 };
@@ -104,6 +151,12 @@ static void on_icon_size_alloc(GtkWidget* widget,
                                GtkAllocation* alloc,
                                AwnAppletManager* manager);
 static void free_list(GSList** list);
+static void release_startup_slot(AwnAppletManager* manager,
+                                 AwnAppletProxy*   proxy);
+static void awn_applet_manager_set_usage_overlay(AwnAppletManager* manager,
+        gboolean          show);
+static void awn_applet_manager_update_usage_tracking(AwnAppletManager* manager);
+static gboolean update_usage(gpointer data);
 
 /*
  * GOBJECT CODE
@@ -134,6 +187,11 @@ awn_applet_manager_constructed(GObject* object)
                                         object, "offset", TRUE,
                                         DESKTOP_AGNOSTIC_CONFIG_BIND_METHOD_FALLBACK,
                                         NULL);
+    desktop_agnostic_config_client_bind(priv->client,
+                                        AWN_GROUP_PANELS, AWN_PANELS_STARTUP_PLACEHOLDERS,
+                                        object, "startup-placeholders", TRUE,
+                                        DESKTOP_AGNOSTIC_CONFIG_BIND_METHOD_FALLBACK,
+                                        NULL);
     desktop_agnostic_config_client_bind(priv->client,
                                         AWN_GROUP_PANEL, AWN_PANEL_APPLET_LIST,
                                         object, "applet_list", TRUE,
@@ -149,6 +207,31 @@ awn_applet_manager_constructed(GObject* object)
                                         object, "ua_active_list", TRUE,
                                         DESKTOP_AGNOSTIC_CONFIG_BIND_METHOD_FALLBACK,
                                         NULL);
+    desktop_agnostic_config_client_bind(priv->client,
+                                        AWN_GROUP_PANELS, AWN_PANELS_STARTUP_PARALLELISM,
+                                        object, "startup-parallelism", TRUE,
+                                        DESKTOP_AGNOSTIC_CONFIG_BIND_METHOD_FALLBACK,
+                                        NULL);
+    desktop_agnostic_config_client_bind(priv->client,
+                                        AWN_GROUP_PANELS, AWN_PANELS_APPLET_CPU_LIMIT,
+                                        object, "applet-cpu-limit", TRUE,
+                                        DESKTOP_AGNOSTIC_CONFIG_BIND_METHOD_FALLBACK,
+                                        NULL);
+    desktop_agnostic_config_client_bind(priv->client,
+                                        AWN_GROUP_PANELS, AWN_PANELS_APPLET_RSS_LIMIT,
+                                        object, "applet-rss-limit", TRUE,
+                                        DESKTOP_AGNOSTIC_CONFIG_BIND_METHOD_FALLBACK,
+                                        NULL);
+    desktop_agnostic_config_client_bind(priv->client,
+                                        AWN_GROUP_PANELS, AWN_PANELS_APPLET_WAKEUP_LIMIT,
+                                        object, "applet-wakeup-limit", TRUE,
+                                        DESKTOP_AGNOSTIC_CONFIG_BIND_METHOD_FALLBACK,
+                                        NULL);
+    desktop_agnostic_config_client_bind(priv->client,
+                                        AWN_GROUP_PANELS, AWN_PANELS_APPLET_USAGE_OVERLAY,
+                                        object, "applet-usage-overlay", TRUE,
+                                        DESKTOP_AGNOSTIC_CONFIG_BIND_METHOD_FALLBACK,
+                                        NULL);
     /*
     ua_active_list should be empty when awn starts...
      */
@@ -157,6 +240,8 @@ awn_applet_manager_constructed(GObject* object)
                                             AWN_GROUP_PANEL, AWN_PANEL_UA_ACTIVE_LIST,
                                             empty_array, NULL);
     g_value_array_free(empty_array);
+
+    awn_applet_manager_update_usage_tracking(AWN_APPLET_MANAGER(object));
 }
 
 static void
@@ -195,6 +280,24 @@ awn_applet_manager_get_property(GObject*    object,
     case PROP_EXPANDS:
         g_value_set_boolean(value, awn_applet_manager_get_expands(AWN_APPLET_MANAGER(object)));
         break;
+    case PROP_STARTUP_PARALLELISM:
+        g_value_set_int(value, priv->startup_parallelism);
+        break;
+    case PROP_STARTUP_PLACEHOLDERS:
+        g_value_set_boolean(value, priv->startup_placeholders);
+        break;
+    case PROP_APPLET_CPU_LIMIT:
+        g_value_set_double(value, priv->applet_cpu_limit);
+        break;
+    case PROP_APPLET_RSS_LIMIT:
+        g_value_set_int(value, priv->applet_rss_limit);
+        break;
+    case PROP_APPLET_WAKEUP_LIMIT:
+        g_value_set_int(value, priv->applet_wakeup_limit);
+        break;
+    case PROP_APPLET_USAGE_OVERLAY:
+        g_value_set_boolean(value, priv->usage_overlay);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
     }
@@ -256,6 +359,28 @@ awn_applet_manager_set_property(GObject*      object,
         set_list_property(value, &priv->ua_active_list);
         awn_applet_manager_refresh_applets(manager);
         break;
+    case PROP_STARTUP_PARALLELISM:
+        priv->startup_parallelism = g_value_get_int(value);
+        break;
+    case PROP_STARTUP_PLACEHOLDERS:
+        priv->startup_placeholders = g_value_get_boolean(value);
+        break;
+    case PROP_APPLET_CPU_LIMIT:
+        priv->applet_cpu_limit = g_value_get_double(value);
+        awn_applet_manager_update_usage_tracking(AWN_APPLET_MANAGER(object));
+        break;
+    case PROP_APPLET_RSS_LIMIT:
+        priv->applet_rss_limit = g_value_get_int(value);
+        awn_applet_manager_update_usage_tracking(AWN_APPLET_MANAGER(object));
+        break;
+    case PROP_APPLET_WAKEUP_LIMIT:
+        priv->applet_wakeup_limit = g_value_get_int(value);
+        awn_applet_manager_update_usage_tracking(AWN_APPLET_MANAGER(object));
+        break;
+    case PROP_APPLET_USAGE_OVERLAY:
+        awn_applet_manager_set_usage_overlay(AWN_APPLET_MANAGER(object),
+                                             g_value_get_boolean(value));
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
     }
@@ -277,6 +402,42 @@ awn_applet_manager_dispose(GObject* object)
         priv->extra_widgets = NULL;
     }
 
+    if (priv->startup_idle_id) {
+        g_source_remove(priv->startup_idle_id);
+        priv->startup_idle_id = 0;
+    }
+
+    if (priv->usage_timer_id) {
+        g_source_remove(priv->usage_timer_id);
+        priv->usage_timer_id = 0;
+    }
+
+    if (priv->usage_request_id) {
+        g_source_remove(priv->usage_request_id);
+        priv->usage_request_id = 0;
+    }
+
+    if (priv->startup_queue) {
+        g_queue_foreach(priv->startup_queue, (GFunc)g_object_unref, NULL);
+        g_queue_free(priv->startup_queue);
+        priv->startup_queue = NULL;
+    }
+
+    if (priv->startup_running) {
+        GHashTableIter iter;
+        gpointer timeout_id;
+
+        g_hash_table_iter_init(&iter, priv->startup_running);
+        while (g_hash_table_iter_next(&iter, NULL, &timeout_id)) {
+            g_source_remove(GPOINTER_TO_UINT(timeout_id));
+        }
+        g_hash_table_destroy(priv->startup_running);
+        priv->startup_running = NULL;
+    }
+
+    g_free(priv->placeholders_dir);
+    priv->placeholders_dir = NULL;
+
     desktop_agnostic_config_client_unbind_all_for_object(priv->client,
             object, NULL);
 
@@ -365,6 +526,60 @@ awn_applet_manager_class_init(AwnAppletManagerClass* klass)
                                             FALSE,
                                             G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 
+    g_object_class_install_property(obj_class,
+                                    PROP_STARTUP_PARALLELISM,
+                                    g_param_spec_int("startup-parallelism",
+                                            "Startup parallelism",
+                                            "How many applets can be starting at once",
+                                            1, G_MAXINT, 4,
+                                            G_PARAM_READWRITE | G_PARAM_CONSTRUCT |
+                                            G_PARAM_STATIC_STRINGS));
+
+    g_object_class_install_property(obj_class,
+                                    PROP_STARTUP_PLACEHOLDERS,
+                                    g_param_spec_boolean("startup-placeholders",
+                                            "Startup placeholders",
+                                            "Show the last image of each applet while it starts",
+                                            FALSE,
+                                            G_PARAM_READWRITE | G_PARAM_CONSTRUCT |
+                                            G_PARAM_STATIC_STRINGS));
+
+    g_object_class_install_property(obj_class,
+                                    PROP_APPLET_CPU_LIMIT,
+                                    g_param_spec_double("applet-cpu-limit",
+                                            "Applet CPU limit",
+                                            "Percentage of a CPU an applet can use without a warning",
+                                            0.0, G_MAXDOUBLE, 25.0,
+                                            G_PARAM_READWRITE | G_PARAM_CONSTRUCT |
+                                            G_PARAM_STATIC_STRINGS));
+
+    g_object_class_install_property(obj_class,
+                                    PROP_APPLET_RSS_LIMIT,
+                                    g_param_spec_int("applet-rss-limit",
+                                            "Applet memory limit",
+                                            "Megabytes of memory an applet can use without a warning",
+                                            0, G_MAXINT, 200,
+                                            G_PARAM_READWRITE | G_PARAM_CONSTRUCT |
+                                            G_PARAM_STATIC_STRINGS));
+
+    g_object_class_install_property(obj_class,
+                                    PROP_APPLET_WAKEUP_LIMIT,
+                                    g_param_spec_int("applet-wakeup-limit",
+                                            "Applet wakeup limit",
+                                            "Wakeups per second an applet can do without a warning",
+                                            0, G_MAXINT, 100,
+                                            G_PARAM_READWRITE | G_PARAM_CONSTRUCT |
+                                            G_PARAM_STATIC_STRINGS));
+
+    g_object_class_install_property(obj_class,
+                                    PROP_APPLET_USAGE_OVERLAY,
+                                    g_param_spec_boolean("applet-usage-overlay",
+                                            "Applet usage overlay",
+                                            "Show the resource usage of every applet",
+                                            FALSE,
+                                            G_PARAM_READWRITE | G_PARAM_CONSTRUCT |
+                                            G_PARAM_STATIC_STRINGS));
+
     /* Class signals */
     _applet_manager_signals[APPLET_EMBEDDED] =
         g_signal_new("applet-embedded",
@@ -402,6 +617,15 @@ awn_applet_manager_class_init(AwnAppletManagerClass* klass)
                      g_cclosure_marshal_VOID__VOID,
                      G_TYPE_NONE, 0);
 
+    _applet_manager_signals[APPLET_OVERLOADED] =
+        g_signal_new("applet-overloaded",
+                     G_OBJECT_CLASS_TYPE(obj_class),
+                     G_SIGNAL_RUN_FIRST,
+                     G_STRUCT_OFFSET(AwnAppletManagerClass, applet_overloaded),
+                     NULL, NULL,
+                     awn_marshal_VOID__STRING_STRING,
+                     G_TYPE_NONE, 2, G_TYPE_STRING, G_TYPE_STRING);
+
     g_type_class_add_private(obj_class, sizeof(AwnAppletManagerPrivate));
 }
 
@@ -415,9 +639,14 @@ awn_applet_manager_init(AwnAppletManager* manager)
     priv->touch_quark = g_quark_from_string("applets-touch-quark");
     priv->visibility_quark = g_quark_from_string("visibility-quark");
     priv->shape_mask_quark = g_quark_from_string("shape-mask-quark");
+    priv->startup_priority_quark = g_quark_from_string("startup-priority-quark");
+    priv->usage_over_quark = g_quark_from_string("usage-over-quark");
     priv->applets = g_hash_table_new_full(g_str_hash, g_str_equal,
                                           g_free, NULL);
     priv->extra_widgets = g_hash_table_new(g_direct_hash, g_direct_equal);
+    priv->startup_queue = g_queue_new();
+    priv->startup_running = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+                            g_object_unref, NULL);
 
     gtk_widget_show_all(GTK_WIDGET(manager));
 }
@@ -653,6 +882,7 @@ _applet_plug_added(AwnAppletManager* manager, GtkWidget* applet)
             gtk_widget_show(applet);
         }
         gtk_widget_hide(awn_applet_proxy_get_throbber(proxy));
+        release_startup_slot(manager, proxy);
     }
 
     g_signal_emit(manager, _applet_manager_signals[APPLET_EMBEDDED], 0, applet);
@@ -667,6 +897,619 @@ _applet_crashed(AwnAppletManager* manager, AwnAppletProxy* proxy)
     if (manager->priv->docklet_mode == FALSE) {
         gtk_widget_show(awn_applet_proxy_get_throbber(proxy));
     }
+    release_startup_slot(manager, proxy);
+}
+
+/*
+ * Last known sizes (along the panel) of the applets by uid, kept across runs
+ * so their space can be reserved while they start.
+ */
+static GKeyFile* applet_sizes = NULL;
+static guint     applet_sizes_save_id = 0;
+
+static gchar*
+get_applet_sizes_filename(void)
+{
+    return g_build_filename(g_get_user_cache_dir(), "awn", "applet-sizes", NULL);
+}
+
+static GKeyFile*
+get_applet_sizes(void)
+{
+    if (!applet_sizes) {
+        gchar* filename = get_applet_sizes_filename();
+
+        applet_sizes = g_key_file_new();
+        g_key_file_load_from_file(applet_sizes, filename, G_KEY_FILE_NONE, NULL);
+        g_free(filename);
+    }
+    return applet_sizes;
+}
+
+static gboolean
+save_applet_sizes(gpointer data)
+{
+    GError* error = NULL;
+    gchar* filename = get_applet_sizes_filename();
+    gchar* dir = g_path_get_dirname(filename);
+    gchar* contents;
+    gsize length;
+
+    contents = g_key_file_to_data(get_applet_sizes(), &length, NULL);
+    g_mkdir_with_parents(dir, 0755);
+    if (!g_file_set_contents(filename, contents, length, &error)) {
+        g_warning("Unable to save applet sizes: %s", error->message);
+        g_error_free(error);
+    }
+
+    g_free(contents);
+    g_free(dir);
+    g_free(filename);
+
+    applet_sizes_save_id = 0;
+    return FALSE;
+}
+
+static void
+set_applet_size(const gchar* uid, gint size)
+{
+    GKeyFile* sizes = get_applet_sizes();
+
+    if (size > 0 && g_key_file_get_integer(sizes, APPLET_SIZES_GROUP, uid, NULL) == size) {
+        return;
+    }
+    if (size > 0) {
+        g_key_file_set_integer(sizes, APPLET_SIZES_GROUP, uid, size);
+    } else {
+        g_key_file_remove_key(sizes, APPLET_SIZES_GROUP, uid, NULL);
+    }
+    if (!applet_sizes_save_id) {
+        applet_sizes_save_id = g_timeout_add_seconds(5, save_applet_sizes, NULL);
+    }
+}
+
+/*
+ * Images of the embedded applets as the panel last showed them, drawn in
+ * place of their throbbers while they start.  The file names include the
+ * panel position and size they were taken at.
+ */
+static gchar*
+get_placeholder_filename(AwnAppletManager* manager, const gchar* uid)
+{
+    AwnAppletManagerPrivate* priv = manager->priv;
+    gchar* name = g_strdup_printf("%s-%d-%d.png", uid, priv->position, priv->size);
+    gchar* filename = g_build_filename(priv->placeholders_dir, name, NULL);
+
+    g_free(name);
+    return filename;
+}
+
+static cairo_surface_t*
+load_placeholder(AwnAppletManager* manager, const gchar* uid)
+{
+    gchar* filename;
+    cairo_surface_t* surface = NULL;
+
+    if (!manager->priv->placeholders_dir) {
+        return NULL;
+    }
+
+    filename = get_placeholder_filename(manager, uid);
+    if (g_file_test(filename, G_FILE_TEST_EXISTS)) {
+        surface = cairo_image_surface_create_from_png(filename);
+        if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
+            cairo_surface_destroy(surface);
+            surface = NULL;
+        }
+    }
+    g_free(filename);
+    return surface;
+}
+
+static void
+show_placeholder(AwnAppletManager* manager, AwnAppletProxy* proxy,
+                 const gchar* uid)
+{
+    cairo_surface_t* placeholder;
+
+    if (!manager->priv->startup_placeholders) {
+        return;
+    }
+    placeholder = load_placeholder(manager, uid);
+    if (placeholder) {
+        awn_applet_proxy_set_placeholder(proxy, placeholder);
+        cairo_surface_destroy(placeholder);
+    }
+}
+
+/*
+ * The directory is the panel's own, saving removes the files it doesn't
+ * need any more.  Applets that haven't embedded yet get their placeholders
+ * right away.
+ */
+void
+awn_applet_manager_set_placeholders_dir(AwnAppletManager* manager,
+                                        const gchar*      dir)
+{
+    AwnAppletManagerPrivate* priv;
+    GHashTableIter iter;
+    gpointer uid, applet;
+
+    g_return_if_fail(AWN_IS_APPLET_MANAGER(manager));
+    priv = manager->priv;
+
+    g_free(priv->placeholders_dir);
+    priv->placeholders_dir = g_strdup(dir);
+
+    g_hash_table_iter_init(&iter, priv->applets);
+    while (g_hash_table_iter_next(&iter, &uid, &applet)) {
+        if (AWN_IS_APPLET_PROXY(applet) &&
+                !gtk_socket_get_plug_window(GTK_SOCKET(applet))) {
+            show_placeholder(manager, AWN_APPLET_PROXY(applet),
+                             (const gchar*)uid);
+        }
+    }
+}
+
+/*
+ * Removes the placeholders of applets no longer on the panel and the ones
+ * taken at another panel position or size, or all of them if the
+ * placeholders are disabled.
+ */
+static void
+remove_stale_placeholders(AwnAppletManager* manager)
+{
+    AwnAppletManagerPrivate* priv = manager->priv;
+    gchar* suffix;
+    GDir* dir;
+    const gchar* name;
+
+    dir = g_dir_open(priv->placeholders_dir, 0, NULL);
+    if (!dir) {
+        return;
+    }
+
+    suffix = g_strdup_printf("-%d-%d.png", priv->position, priv->size);
+    while ((name = g_dir_read_name(dir))) {
+        gboolean stale = !priv->startup_placeholders ||
+                         !g_str_has_suffix(name, suffix);
+
+        if (!stale) {
+            gchar* uid = g_strndup(name, strlen(name) - strlen(suffix));
+            stale = !g_hash_table_lookup(priv->applets, uid);
+            g_free(uid);
+        }
+        if (stale) {
+            gchar* filename = g_build_filename(priv->placeholders_dir, name, NULL);
+            g_unlink(filename);
+            g_free(filename);
+        }
+    }
+    g_free(suffix);
+    g_dir_close(dir);
+}
+
+/*
+ * Cuts the embedded applets out of image (the content of the panel's
+ * toplevel window) and replaces their saved placeholders.  Applets that
+ * haven't embedded (yet) keep the ones they have.
+ */
+void
+awn_applet_manager_save_placeholders(AwnAppletManager* manager,
+                                     cairo_surface_t*  image)
+{
+    AwnAppletManagerPrivate* priv;
+    GHashTableIter iter;
+    gpointer uid, applet;
+
+    g_return_if_fail(AWN_IS_APPLET_MANAGER(manager));
+    priv = manager->priv;
+
+    if (!priv->placeholders_dir) {
+        return;
+    }
+
+    g_mkdir_with_parents(priv->placeholders_dir, 0755);
+    remove_stale_placeholders(manager);
+
+    if (!priv->startup_placeholders) {
+        return;
+    }
+
+    g_hash_table_iter_init(&iter, priv->applets);
+    while (g_hash_table_iter_next(&iter, &uid, &applet)) {
+        GtkWidget* widget = GTK_WIDGET(applet);
+        GtkAllocation alloc;
+        cairo_surface_t* surface;
+        cairo_t* cr;
+        gchar* filename;
+        gint x, y;
+
+        if (!AWN_IS_APPLET_PROXY(widget) || !gtk_widget_get_mapped(widget) ||
+                !gtk_socket_get_plug_window(GTK_SOCKET(widget)) ||
+                !gtk_widget_translate_coordinates(widget,
+                        gtk_widget_get_toplevel(widget), 0, 0, &x, &y)) {
+            continue;
+        }
+        gtk_widget_get_allocation(widget, &alloc);
+        if (alloc.width <= 1 || alloc.height <= 1) {
+            continue;
+        }
+
+        surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+                                             alloc.width, alloc.height);
+        cr = cairo_create(surface);
+        cairo_set_source_surface(cr, image, -x, -y);
+        cairo_paint(cr);
+        cairo_destroy(cr);
+
+        filename = get_placeholder_filename(manager, (const gchar*)uid);
+        if (cairo_surface_write_to_png(surface, filename) != CAIRO_STATUS_SUCCESS) {
+            g_warning("Unable to save the placeholder image %s", filename);
+        }
+        g_free(filename);
+        cairo_surface_destroy(surface);
+    }
+}
+
+static void
+on_proxy_size_alloc(GtkWidget* widget, GtkAllocation* alloc,
+                    AwnAppletManager* manager)
+{
+    gchar* uid = NULL;
+    gint size;
+
+    /* only what the applet itself asked for */
+    if (!gtk_socket_get_plug_window(GTK_SOCKET(widget))) {
+        return;
+    }
+
+    switch (manager->priv->position) {
+    case GTK_POS_LEFT:
+    case GTK_POS_RIGHT:
+        size = alloc->height;
+        break;
+    default:
+        size = alloc->width;
+        break;
+    }
+    if (size <= 1) {
+        return;
+    }
+
+    g_object_get(widget, "uid", &uid, NULL);
+    set_applet_size(uid, size);
+    g_free(uid);
+}
+
+/*
+ * STARTUP SCHEDULING
+ *
+ * Up to startup-parallelism applets are started at once, the next one when
+ * one of them embeds, crashes or takes longer than STARTUP_TIMEOUT.
+ */
+/*
+ * Resource usage
+ */
+static void
+awn_applet_manager_set_usage_overlay(AwnAppletManager* manager,
+                                     gboolean          show)
+{
+    AwnAppletManagerPrivate* priv = manager->priv;
+    GHashTableIter iter;
+    gpointer applet;
+
+    priv->usage_overlay = show;
+    if (!priv->applets) {
+        return;
+    }
+
+    g_hash_table_iter_init(&iter, priv->applets);
+    while (g_hash_table_iter_next(&iter, NULL, &applet)) {
+        if (AWN_IS_APPLET_PROXY(applet)) {
+            awn_applet_proxy_set_usage_overlay(AWN_APPLET_PROXY(applet), show);
+        }
+    }
+    awn_applet_manager_update_usage_tracking(manager);
+}
+
+/*
+ * /proc is only read while a limit, the overlay or a recent GetAppletUsage
+ * call needs it.  The redraws, which cost an event per applet redraw, are
+ * only counted for the last two.
+ */
+static void
+awn_applet_manager_update_usage_tracking(AwnAppletManager* manager)
+{
+    AwnAppletManagerPrivate* priv = manager->priv;
+    gboolean redraws = priv->usage_overlay || priv->usage_request_id;
+    gboolean readings = redraws || priv->applet_cpu_limit > 0.0 ||
+                        priv->applet_rss_limit > 0 ||
+                        priv->applet_wakeup_limit > 0;
+    GHashTableIter iter;
+    gpointer applet;
+
+    if (!priv->applets) {
+        return;
+    }
+
+    if (readings && !priv->usage_timer_id) {
+        priv->usage_timer_id = g_timeout_add_seconds(USAGE_INTERVAL,
+                               update_usage, manager);
+    } else if (!readings && priv->usage_timer_id) {
+        g_source_remove(priv->usage_timer_id);
+        priv->usage_timer_id = 0;
+
+        g_hash_table_iter_init(&iter, priv->applets);
+        while (g_hash_table_iter_next(&iter, NULL, &applet)) {
+            if (AWN_IS_APPLET_PROXY(applet)) {
+                awn_applet_proxy_reset_usage(AWN_APPLET_PROXY(applet));
+            }
+        }
+    }
+
+    if (redraws != priv->usage_redraws) {
+        priv->usage_redraws = redraws;
+        g_hash_table_iter_init(&iter, priv->applets);
+        while (g_hash_table_iter_next(&iter, NULL, &applet)) {
+            if (AWN_IS_APPLET_PROXY(applet)) {
+                awn_applet_proxy_set_count_redraws(AWN_APPLET_PROXY(applet),
+                                                   redraws);
+            }
+        }
+    }
+}
+
+static gboolean
+on_usage_request_timeout(AwnAppletManager* manager)
+{
+    manager->priv->usage_request_id = 0;
+    awn_applet_manager_update_usage_tracking(manager);
+
+    return FALSE;
+}
+
+/* Returns the limits usage is over */
+static guint
+get_usage_over(AwnAppletManager* manager, const AwnAppletUsage* usage)
+{
+    AwnAppletManagerPrivate* priv = manager->priv;
+    guint over = 0;
+
+    if (priv->applet_cpu_limit > 0.0 && usage->cpu > priv->applet_cpu_limit) {
+        over |= USAGE_OVER_CPU;
+    }
+    if (priv->applet_rss_limit > 0 && usage->rss > priv->applet_rss_limit * 1024) {
+        over |= USAGE_OVER_RSS;
+    }
+    if (priv->applet_wakeup_limit > 0 &&
+            usage->wakeups > priv->applet_wakeup_limit) {
+        over |= USAGE_OVER_WAKEUPS;
+    }
+    return over;
+}
+
+static gboolean
+update_usage(gpointer data)
+{
+    AwnAppletManager* manager = AWN_APPLET_MANAGER(data);
+    AwnAppletManagerPrivate* priv = manager->priv;
+    GPtrArray* overloaded = g_ptr_array_new();
+    GHashTableIter iter;
+    gpointer uid, applet;
+
+    g_hash_table_iter_init(&iter, priv->applets);
+    while (g_hash_table_iter_next(&iter, &uid, &applet)) {
+        const AwnAppletUsage* usage;
+        GPid pid;
+        guint over, was_over, crossed;
+
+        if (!AWN_IS_APPLET_PROXY(applet) ||
+                !awn_applet_proxy_update_usage(AWN_APPLET_PROXY(applet))) {
+            continue;
+        }
+        usage = awn_applet_proxy_get_usage(AWN_APPLET_PROXY(applet));
+        pid = awn_applet_proxy_get_pid(AWN_APPLET_PROXY(applet));
+
+        /* warn only when a limit is crossed, not all the time it's over */
+        over = get_usage_over(manager, usage);
+        was_over = GPOINTER_TO_UINT(g_object_get_qdata(G_OBJECT(applet),
+                                    priv->usage_over_quark));
+        g_object_set_qdata(G_OBJECT(applet), priv->usage_over_quark,
+                           GUINT_TO_POINTER(over));
+        crossed = over & ~was_over;
+
+        if (crossed & USAGE_OVER_CPU) {
+            g_warning("Applet %s[%d] uses %.1f%% of a CPU",
+                      (gchar*)uid, pid, usage->cpu);
+            g_ptr_array_add(overloaded, g_strdup((gchar*)uid));
+            g_ptr_array_add(overloaded, (gpointer)"cpu");
+        }
+        if (crossed & USAGE_OVER_RSS) {
+            g_warning("Applet %s[%d] uses %ld MB of memory",
+                      (gchar*)uid, pid, usage->rss / 1024);
+            g_ptr_array_add(overloaded, g_strdup((gchar*)uid));
+            g_ptr_array_add(overloaded, (gpointer)"memory");
+        }
+        if (crossed & USAGE_OVER_WAKEUPS) {
+            g_warning("Applet %s[%d] wakes up %.1f times per second",
+                      (gchar*)uid, pid, usage->wakeups);
+            g_ptr_array_add(overloaded, g_strdup((gchar*)uid));
+            g_ptr_array_add(overloaded, (gpointer)"wakeups");
+        }
+    }
+
+    /* the handlers may restart or remove the applets */
+    for (guint i = 0; i + 1 < overloaded->len; i += 2) {
+        g_signal_emit(manager, _applet_manager_signals[APPLET_OVERLOADED], 0,
+                      g_ptr_array_index(overloaded, i),
+                      g_ptr_array_index(overloaded, i + 1));
+        g_free(g_ptr_array_index(overloaded, i));
+    }
+    g_ptr_array_free(overloaded, TRUE);
+
+    return TRUE;
+}
+
+/*
+ * Calls func with the resource usage of every running applet (that has been
+ * running for at least one reading).  The readings, with the redraw counts,
+ * go on for USAGE_REQUEST_TIMEOUT seconds after each call, so a caller
+ * polling this gets the usage once two readings followed its first call.
+ */
+void
+awn_applet_manager_foreach_usage(AwnAppletManager*  manager,
+                                 AwnAppletUsageFunc func,
+                                 gpointer           user_data)
+{
+    AwnAppletManagerPrivate* priv;
+    GHashTableIter iter;
+    gpointer uid, applet;
+
+    g_return_if_fail(AWN_IS_APPLET_MANAGER(manager));
+    priv = manager->priv;
+
+    if (priv->usage_request_id) {
+        g_source_remove(priv->usage_request_id);
+    }
+    priv->usage_request_id = g_timeout_add_seconds(USAGE_REQUEST_TIMEOUT,
+                             (GSourceFunc)on_usage_request_timeout, manager);
+    awn_applet_manager_update_usage_tracking(manager);
+
+    g_hash_table_iter_init(&iter, priv->applets);
+    while (g_hash_table_iter_next(&iter, &uid, &applet)) {
+        const AwnAppletUsage* usage;
+
+        if (!AWN_IS_APPLET_PROXY(applet)) {
+            continue;
+        }
+        usage = awn_applet_proxy_get_usage(AWN_APPLET_PROXY(applet));
+        if (usage) {
+            func((const gchar*)uid, awn_applet_proxy_get_pid(AWN_APPLET_PROXY(applet)),
+                 usage, user_data);
+        }
+    }
+}
+
+static gint
+get_startup_priority(const gchar* path)
+{
+    /* these take most of the panel, so start them first */
+    static const gchar* visible_first[] = {
+        "/taskmanager.desktop",
+        "/simple-launcher.desktop",
+        NULL
+    };
+
+    for (const gchar** suffix = visible_first; *suffix; suffix++) {
+        if (g_str_has_suffix(path, *suffix)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static gboolean start_queued_applets(gpointer data);
+
+static void
+schedule_startup(AwnAppletManager* manager)
+{
+    AwnAppletManagerPrivate* priv = manager->priv;
+
+    if (!priv->startup_idle_id) {
+        priv->startup_idle_id = g_idle_add(start_queued_applets, manager);
+    }
+}
+
+static gboolean
+on_startup_timeout(gpointer data)
+{
+    AwnAppletProxy* proxy = AWN_APPLET_PROXY(data);
+    GtkWidget* manager = gtk_widget_get_parent(GTK_WIDGET(proxy));
+    gchar* path = NULL;
+
+    g_return_val_if_fail(AWN_IS_APPLET_MANAGER(manager), FALSE);
+
+    g_object_get(proxy, "path", &path, NULL);
+    g_debug("Applet %s is slow to start, not waiting for it", path);
+    g_free(path);
+
+    g_hash_table_remove(AWN_APPLET_MANAGER(manager)->priv->startup_running, proxy);
+    schedule_startup(AWN_APPLET_MANAGER(manager));
+
+    return FALSE;
+}
+
+static gboolean
+start_queued_applets(gpointer data)
+{
+    AwnAppletManager* manager = AWN_APPLET_MANAGER(data);
+    AwnAppletManagerPrivate* priv = manager->priv;
+
+    priv->startup_idle_id = 0;
+
+    while (g_hash_table_size(priv->startup_running) < (guint)priv->startup_parallelism &&
+            !g_queue_is_empty(priv->startup_queue)) {
+        AwnAppletProxy* proxy = g_queue_pop_head(priv->startup_queue);
+        guint timeout_id;
+
+        timeout_id = g_timeout_add_seconds(STARTUP_TIMEOUT, on_startup_timeout, proxy);
+        g_hash_table_insert(priv->startup_running, proxy,
+                            GUINT_TO_POINTER(timeout_id));
+
+        awn_applet_proxy_execute(proxy);
+    }
+
+    return FALSE;
+}
+
+static void
+queue_startup(AwnAppletManager* manager, AwnAppletProxy* proxy,
+              const gchar* path)
+{
+    AwnAppletManagerPrivate* priv = manager->priv;
+    gint priority = get_startup_priority(path);
+    GList* iter;
+
+    g_object_set_qdata(G_OBJECT(proxy), priv->startup_priority_quark,
+                       GINT_TO_POINTER(priority));
+
+    /* after the applets with the same priority */
+    for (iter = priv->startup_queue->head; iter; iter = iter->next) {
+        gint other = GPOINTER_TO_INT(g_object_get_qdata(G_OBJECT(iter->data),
+                                     priv->startup_priority_quark));
+        if (other > priority) {
+            break;
+        }
+    }
+    if (iter) {
+        g_queue_insert_before(priv->startup_queue, iter, g_object_ref(proxy));
+    } else {
+        g_queue_push_tail(priv->startup_queue, g_object_ref(proxy));
+    }
+
+    /* the whole applet list gets queued before anything starts */
+    schedule_startup(manager);
+}
+
+static void
+release_startup_slot(AwnAppletManager* manager, AwnAppletProxy* proxy)
+{
+    AwnAppletManagerPrivate* priv = manager->priv;
+    gpointer timeout_id;
+
+    if (g_queue_remove(priv->startup_queue, proxy)) {
+        g_object_unref(proxy);
+    }
+
+    if (!g_hash_table_lookup_extended(priv->startup_running, proxy,
+                                      NULL, &timeout_id)) {
+        return;
+    }
+    g_source_remove(GPOINTER_TO_UINT(timeout_id));
+    g_hash_table_remove(priv->startup_running, proxy);
+
+    schedule_startup(manager);
 }
 
 static GtkWidget*
@@ -705,10 +1548,20 @@ create_applet(AwnAppletManager* manager,
         widget = awn_applet_proxy_get_throbber(AWN_APPLET_PROXY(applet));
         g_signal_connect(widget, "size-allocate",
                          G_CALLBACK(on_icon_size_alloc), manager);
+        g_signal_connect(applet, "size-allocate",
+                         G_CALLBACK(on_proxy_size_alloc), manager);
 
         gtk_box_pack_start(GTK_BOX(manager), applet, FALSE, FALSE, 0);
 
-        awn_applet_proxy_schedule_execute(AWN_APPLET_PROXY(applet));
+        awn_applet_proxy_set_reserved_size(AWN_APPLET_PROXY(applet),
+                                           g_key_file_get_integer(get_applet_sizes(),
+                                                   APPLET_SIZES_GROUP, uid, NULL));
+        show_placeholder(manager, AWN_APPLET_PROXY(applet), uid);
+        awn_applet_proxy_set_usage_overlay(AWN_APPLET_PROXY(applet),
+                                           priv->usage_overlay);
+        awn_applet_proxy_set_count_redraws(AWN_APPLET_PROXY(applet),
+                                           priv->usage_redraws);
+        queue_startup(manager, AWN_APPLET_PROXY(applet), path);
     }
 
     gtk_box_pack_start(GTK_BOX(manager), widget, expand, fill, 0);
@@ -754,6 +1607,8 @@ delete_applets(gpointer key, GtkWidget* applet, AwnAppletManager* manager)
     if (!touched) {
         if (AWN_IS_APPLET_PROXY(applet)) {
             g_object_get(applet, "uid", &uid, NULL);
+            release_startup_slot(manager, AWN_APPLET_PROXY(applet));
+            set_applet_size((const gchar*)key, 0);
             g_signal_emit(manager, _applet_manager_signals[APPLET_REMOVED],
                           0, applet);
         } else if (GTK_IS_IMAGE(applet) && !AWN_IS_SEPARATOR(applet)) { // expander
@@ -27,6 +27,8 @@
 #include <libdesktop-agnostic/desktop-agnostic.h>
 #include <libawn/libawn.h>
 
+#include "awn-applet-usage.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -67,6 +69,8 @@ struct _AwnAppletManagerClass {
     void (*applet_removed)(AwnAppletManager* manager, GtkWidget* applet);
     void (*shape_mask_changed)(AwnAppletManager* manager);
     void (*applets_refreshed)(AwnAppletManager* manager);
+    void (*applet_overloaded)(AwnAppletManager* manager, const gchar* uid,
+                              const gchar* reason);
 };
 
 GType       awn_applet_manager_get_type(void) G_GNUC_CONST;
@@ -97,6 +101,16 @@ void        awn_applet_manager_add_docklet(AwnAppletManager* manager,
 
 void        awn_applet_manager_redraw_throbbers(AwnAppletManager* manager);
 
+void        awn_applet_manager_set_placeholders_dir(AwnAppletManager* manager,
+        const gchar*      dir);
+
+void        awn_applet_manager_save_placeholders(AwnAppletManager* manager,
+        cairo_surface_t*  image);
+
+void        awn_applet_manager_foreach_usage(AwnAppletManager* manager,
+        AwnAppletUsageFunc func,
+        gpointer          user_data);
+
 GdkRegion*  awn_applet_manager_get_mask(AwnAppletManager* manager,
                                         AwnPathType path_type,
                                         gfloat offset_modifier);
@@ -22,11 +22,17 @@
 #include "config.h"
 #include <glib/gi18n.h>
 #include <gdk/gdkx.h>
+#ifdef HAVE_XDAMAGE
+#include <X11/extensions/Xdamage.h>
+#endif
 #include <libawn/libawn.h>
 #include <libawn/awn-utils.h>
 
 #include "awn-applet-proxy.h"
+#include "awn-applet-usage.h"
+#include "awn-applet-zygote.h"
 #include "awn-throbber.h"
+#include "libawn/awn-startup-trace.h"
 #include "libawn/gseal-transition.h"
 
 extern "C" {
@@ -48,6 +54,8 @@ struct _AwnAppletProxyPrivate {
     gint   position;
     gint   offset;
     gint   size;
+    gint   reserved_size;
+    cairo_surface_t* placeholder;
 
     gboolean running;
     gboolean crashed;
@@ -56,6 +64,22 @@ struct _AwnAppletProxyPrivate {
 
     gint old_x, old_y, old_w, old_h;
     guint idle_id;
+
+    /* spawn (or zygote request) to embed latency */
+    GTimer* embed_timer;
+    gboolean forked;
+
+    GPid pid;
+    AwnAppletCounters counters;
+    AwnAppletUsage usage;
+    gboolean has_usage;
+    GtkWidget* usage_overlay;
+
+    /* redraws of the plug window, counted while count_redraws is set */
+    gboolean count_redraws;
+    GdkWindow* plug_window;
+    gulong damage;
+    guint64 damage_count;
 };
 
 enum {
@@ -78,8 +102,13 @@ static guint _proxy_signals[LAST_SIGNAL] = { 0 };
  * FORWARDS
  */
 static gboolean on_plug_removed(AwnAppletProxy* proxy, gpointer user_data);
+static void     on_plug_added(AwnAppletProxy* proxy, gpointer user_data);
 static void     on_size_alloc(AwnAppletProxy* proxy, GtkAllocation* a);
 static void     on_child_exit(GPid pid, gint status, gpointer user_data);
+static void     awn_applet_proxy_apply_reserved_size(AwnAppletProxy* proxy);
+static void     awn_applet_proxy_set_pid(AwnAppletProxy* proxy, GPid pid);
+static void     awn_applet_proxy_watch_damage(AwnAppletProxy* proxy,
+        GdkWindow*      plug_window);
 
 /*
  * GOBJECT CODE
@@ -137,6 +166,7 @@ awn_applet_proxy_set_property(GObject*      object,
     case PROP_POSITION:
         priv->position = g_value_get_int(value);
         awn_icon_set_pos_type(AWN_ICON(priv->throbber), priv->position);
+        awn_applet_proxy_apply_reserved_size(AWN_APPLET_PROXY(object));
         break;
     case PROP_OFFSET:
         priv->offset = g_value_get_int(value);
@@ -162,15 +192,17 @@ awn_applet_proxy_size_request(GtkWidget* widget, GtkRequisition* req)
     if (!priv->size_req_initialized && req->width == 1 && req->height == 1) {
         // to prevent flicker we set the size request to the same value
         //   as AwnThrobber uses
+        gint size = priv->reserved_size > 0 ?
+                    priv->reserved_size : APPLY_SIZE_MULTIPLIER(priv->size);
         switch (priv->position) {
         case GTK_POS_LEFT:
         case GTK_POS_RIGHT:
-            req->height = APPLY_SIZE_MULTIPLIER(priv->size);
+            req->height = size;
             break;
         case GTK_POS_BOTTOM:
         case GTK_POS_TOP:
         default:
-            req->width = APPLY_SIZE_MULTIPLIER(priv->size);
+            req->width = size;
             break;
         }
     } else if (!priv->size_req_initialized) {
@@ -194,11 +226,28 @@ awn_applet_proxy_dispose(GObject* object)
         priv->throbber = NULL;
     }
 
+    if (priv->placeholder) {
+        cairo_surface_destroy(priv->placeholder);
+        priv->placeholder = NULL;
+    }
+
     if (priv->idle_id) {
         g_source_remove(priv->idle_id);
         priv->idle_id = 0;
     }
 
+    if (priv->embed_timer) {
+        g_timer_destroy(priv->embed_timer);
+        priv->embed_timer = NULL;
+    }
+
+    awn_applet_proxy_watch_damage(AWN_APPLET_PROXY(object), NULL);
+
+    if (priv->usage_overlay) {
+        gtk_widget_destroy(priv->usage_overlay);
+        priv->usage_overlay = NULL;
+    }
+
     G_OBJECT_CLASS(awn_applet_proxy_parent_class)->dispose(object);
 }
 
@@ -286,6 +335,33 @@ throbber_click(GtkWidget* widget, GdkEventButton* event, gpointer user_data)
     return FALSE;
 }
 
+/* Draws the placeholder instead of the throbber */
+static gboolean
+on_throbber_expose(GtkWidget* widget, GdkEventExpose* event,
+                   AwnAppletProxy* proxy)
+{
+    cairo_surface_t* placeholder = proxy->priv->placeholder;
+    GtkAllocation alloc;
+    cairo_t* cr;
+
+    if (!placeholder) {
+        return FALSE;
+    }
+
+    gtk_widget_get_allocation(widget, &alloc);
+    cr = gdk_cairo_create(event->window);
+    gdk_cairo_region(cr, event->region);
+    cairo_clip(cr);
+    if (gtk_widget_get_has_window(widget)) {
+        alloc.x = alloc.y = 0;
+    }
+    cairo_set_source_surface(cr, placeholder, alloc.x, alloc.y);
+    cairo_paint(cr);
+    cairo_destroy(cr);
+
+    return TRUE;
+}
+
 static void
 awn_applet_proxy_init(AwnAppletProxy* proxy)
 {
@@ -295,6 +371,7 @@ awn_applet_proxy_init(AwnAppletProxy* proxy)
 
     /* Connect to the socket signals */
     g_signal_connect(proxy, "plug-removed", G_CALLBACK(on_plug_removed), NULL);
+    g_signal_connect(proxy, "plug-added", G_CALLBACK(on_plug_added), NULL);
     g_signal_connect(proxy, "size-allocate", G_CALLBACK(on_size_alloc), NULL);
     awn_utils_ensure_transparent_bg(GTK_WIDGET(proxy));
     /* Rest is for the crash notification window */
@@ -309,6 +386,78 @@ awn_applet_proxy_init(AwnAppletProxy* proxy)
 
     g_signal_connect(priv->throbber, "button-release-event",
                      G_CALLBACK(throbber_click), proxy);
+    g_signal_connect(priv->throbber, "expose-event",
+                     G_CALLBACK(on_throbber_expose), proxy);
+}
+
+static void
+awn_applet_proxy_apply_reserved_size(AwnAppletProxy* proxy)
+{
+    AwnAppletProxyPrivate* priv = proxy->priv;
+    gint size = priv->reserved_size > 0 ? priv->reserved_size : -1;
+
+    if (!priv->throbber) {
+        return;
+    }
+
+    switch (priv->position) {
+    case GTK_POS_LEFT:
+    case GTK_POS_RIGHT:
+        gtk_widget_set_size_request(priv->throbber, -1, size);
+        break;
+    case GTK_POS_BOTTOM:
+    case GTK_POS_TOP:
+    default:
+        gtk_widget_set_size_request(priv->throbber, size, -1);
+        break;
+    }
+}
+
+/*
+ * Makes the proxy and its throbber take size pixels along the panel until
+ * the applet is embedded, so the panel doesn't resize when it is.
+ */
+void
+awn_applet_proxy_set_reserved_size(AwnAppletProxy* proxy, gint size)
+{
+    g_return_if_fail(AWN_IS_APPLET_PROXY(proxy));
+
+    proxy->priv->reserved_size = size;
+    awn_applet_proxy_apply_reserved_size(proxy);
+    gtk_widget_queue_resize(GTK_WIDGET(proxy));
+}
+
+/*
+ * Shows an image of the applet as it was last seen instead of the throbber
+ * until the applet embeds (or crashes).  NULL goes back to the throbber.
+ */
+void
+awn_applet_proxy_set_placeholder(AwnAppletProxy*  proxy,
+                                 cairo_surface_t* placeholder)
+{
+    AwnAppletProxyPrivate* priv;
+
+    g_return_if_fail(AWN_IS_APPLET_PROXY(proxy));
+    priv = proxy->priv;
+
+    if (priv->placeholder == placeholder) {
+        return;
+    }
+    if (priv->placeholder) {
+        cairo_surface_destroy(priv->placeholder);
+    }
+    priv->placeholder = placeholder ? cairo_surface_reference(placeholder) : NULL;
+
+    if (placeholder && priv->reserved_size <= 0) {
+        gboolean vertical = priv->position == GTK_POS_LEFT ||
+                            priv->position == GTK_POS_RIGHT;
+        awn_applet_proxy_set_reserved_size(proxy, vertical ?
+                                           cairo_image_surface_get_height(placeholder) :
+                                           cairo_image_surface_get_width(placeholder));
+    }
+    if (priv->throbber) {
+        gtk_widget_queue_draw(priv->throbber);
+    }
 }
 
 GtkWidget*
@@ -355,9 +504,19 @@ on_plug_removed(AwnAppletProxy* proxy, gpointer user_data)
     priv->old_w = 0;
     priv->old_h = 0;
 
+    awn_applet_proxy_watch_damage(proxy, NULL);
+
+    /* forked applets are only watched by the zygote, which can be gone, so
+     * don't rely on hearing about the exit to stop reading /proc */
+    if (priv->pid) {
+        awn_applet_usage_forget(priv->pid);
+        awn_applet_proxy_set_pid(proxy, 0);
+    }
+
     /* indicate that the applet crashed and allow restart */
     priv->running = FALSE;
     priv->crashed = TRUE;
+    awn_applet_proxy_set_placeholder(proxy, NULL);
     awn_icon_set_tooltip_text(AWN_ICON(priv->throbber),
                               _("Whoops! The applet crashed. Click to restart it."));
     awn_throbber_set_type(AWN_THROBBER(priv->throbber),
@@ -369,6 +528,133 @@ on_plug_removed(AwnAppletProxy* proxy, gpointer user_data)
     return TRUE;
 }
 
+static void
+awn_applet_proxy_trace_mark(AwnAppletProxy* proxy, const gchar* what)
+{
+    if (awn_startup_trace_enabled()) {
+        gchar* desktop = g_path_get_basename(proxy->priv->path);
+        gchar* name = g_strdup_printf("%s %s", what, desktop);
+
+        awn_startup_trace_mark(name);
+        g_free(name);
+        g_free(desktop);
+    }
+}
+
+#ifdef HAVE_XDAMAGE
+static gboolean damage_checked = FALSE;
+static gint     damage_event_base = 0;
+
+static GdkFilterReturn
+on_plug_damage(GdkXEvent* xevent, GdkEvent* event, AwnAppletProxy* proxy)
+{
+    XEvent* xev = (XEvent*) xevent;
+    XDamageNotifyEvent* damage_event = (XDamageNotifyEvent*) xevent;
+
+    if (xev->type != damage_event_base + XDamageNotify ||
+            damage_event->damage != proxy->priv->damage) {
+        return GDK_FILTER_CONTINUE;
+    }
+
+    /* we only want to know that it redrew, not what */
+    proxy->priv->damage_count++;
+    XDamageSubtract(damage_event->display, damage_event->damage, None, None);
+
+    return GDK_FILTER_REMOVE;
+}
+#endif
+
+/*
+ * Counts the redraws of plug_window, or stops counting if it's NULL.  The
+ * count needs the XDamage extension.
+ */
+static void
+awn_applet_proxy_watch_damage(AwnAppletProxy* proxy, GdkWindow* plug_window)
+{
+#ifdef HAVE_XDAMAGE
+    AwnAppletProxyPrivate* priv = proxy->priv;
+    Display* dpy;
+
+    if (priv->plug_window) {
+        dpy = GDK_WINDOW_XDISPLAY(priv->plug_window);
+        gdk_window_remove_filter(priv->plug_window,
+                                 (GdkFilterFunc) on_plug_damage, proxy);
+        /* the damage is gone already if the plug window was destroyed */
+        gdk_error_trap_push();
+        XDamageDestroy(dpy, priv->damage);
+        gdk_flush();
+        gdk_error_trap_pop();
+
+        g_object_unref(priv->plug_window);
+        priv->plug_window = NULL;
+        priv->damage = 0;
+    }
+
+    if (!plug_window) {
+        return;
+    }
+
+    dpy = GDK_WINDOW_XDISPLAY(plug_window);
+    if (!damage_checked) {
+        gint error_base;
+
+        if (!XDamageQueryExtension(dpy, &damage_event_base, &error_base)) {
+            damage_event_base = -1;
+        }
+        damage_checked = TRUE;
+    }
+    if (damage_event_base < 0) {
+        return;
+    }
+
+    gdk_error_trap_push();
+    priv->damage = XDamageCreate(dpy, GDK_WINDOW_XID(plug_window),
+                                 XDamageReportNonEmpty);
+    gdk_flush();
+    if (gdk_error_trap_pop()) {
+        priv->damage = 0;
+        return;
+    }
+
+    priv->plug_window = GDK_WINDOW(g_object_ref(plug_window));
+    gdk_window_add_filter(plug_window, (GdkFilterFunc) on_plug_damage, proxy);
+#endif
+}
+
+static void
+on_plug_added(AwnAppletProxy* proxy, gpointer user_data)
+{
+    AwnAppletProxyPrivate* priv;
+
+    g_return_if_fail(AWN_IS_APPLET_PROXY(proxy));
+    priv = proxy->priv;
+
+    awn_applet_proxy_trace_mark(proxy, "embedded");
+
+    if (priv->embed_timer) {
+        gchar* desktop = g_path_get_basename(priv->path);
+        g_debug("Applet \"%s\" embedded %.1f ms after %s", desktop,
+                g_timer_elapsed(priv->embed_timer, NULL) * 1000.0,
+                priv->forked ? "requesting it from the zygote" : "spawning it");
+        g_free(desktop);
+
+        g_timer_destroy(priv->embed_timer);
+        priv->embed_timer = NULL;
+    }
+
+    awn_applet_proxy_set_placeholder(proxy, NULL);
+    if (priv->count_redraws) {
+        awn_applet_proxy_watch_damage(proxy,
+                                      gtk_socket_get_plug_window(GTK_SOCKET(proxy)));
+    }
+
+    /* the applet asks for its own size now */
+    if (priv->reserved_size > 0) {
+        priv->reserved_size = 0;
+        awn_applet_proxy_apply_reserved_size(proxy);
+    }
+}
+
 /* FIXME: should we schedule the event or not?
 static gboolean
 schedule_send_client_event (gpointer data)
@@ -456,6 +742,11 @@ on_child_exit(GPid pid, gint status, gpointer user_data)
 
         priv->running = FALSE;
         priv->crashed = TRUE;
+        awn_applet_proxy_set_placeholder(AWN_APPLET_PROXY(user_data), NULL);
+
+        if (priv->pid == pid) {
+            awn_applet_proxy_set_pid(AWN_APPLET_PROXY(user_data), 0);
+        }
 
         awn_throbber_set_type(AWN_THROBBER(priv->throbber),
                               AWN_THROBBER_TYPE_SAD_FACE);
@@ -469,36 +760,25 @@ on_child_exit(GPid pid, gint status, gpointer user_data)
          */
     }
 
+    awn_applet_usage_forget(pid);
     g_spawn_close_pid(pid); /* doesn't do anything on UNIX, but let's have it */
 }
 
-void
-awn_applet_proxy_execute(AwnAppletProxy* proxy)
+static gchar**
+awn_applet_proxy_get_argv(AwnAppletProxy* proxy, gboolean debug)
 {
-    AwnAppletProxyPrivate* priv;
-    GdkScreen*             screen;
+    AwnAppletProxyPrivate* priv = proxy->priv;
     GError*                error = NULL;
     gint                   panel_id = AWN_PANEL_ID_DEFAULT;
     gchar*                 exec;
     gchar**                argv = NULL;
-    GPid                   pid;
-    GSpawnFlags            flags = G_SPAWN_SEARCH_PATH | G_SPAWN_DO_NOT_REAP_CHILD;
-
-    priv = AWN_APPLET_PROXY_GET_PRIVATE(proxy);
-
-    priv->size_req_initialized = FALSE;
-    gtk_widget_realize(GTK_WIDGET(proxy));
 
-    /* FIXME: update tooltip with name of the applet?! */
-
-    /* Load the applet */
-    screen = gtk_widget_get_screen(GTK_WIDGET(proxy));
     gint64 socket_id = (gint64) gtk_socket_get_id(GTK_SOCKET(proxy));
 
     g_object_get(G_OBJECT(gtk_widget_get_toplevel(GTK_WIDGET(proxy))),
                  "panel-id", &panel_id, NULL);
 
-    if (g_getenv("AWN_APPLET_GDB")) {
+    if (debug) {
         exec = g_strdup_printf(DEBUG_APPLET_EXEC, priv->path, priv->uid,
                                socket_id, panel_id);
     } else {
@@ -509,14 +789,34 @@ awn_applet_proxy_execute(AwnAppletProxy* proxy)
     g_shell_parse_argv(exec, NULL, &argv, &error);
     g_warn_if_fail(error == NULL);
 
+    g_free(exec);
+    return argv;
+}
+
+static void
+awn_applet_proxy_spawn(AwnAppletProxy* proxy, gboolean debug)
+{
+    AwnAppletProxyPrivate* priv = proxy->priv;
+    GdkScreen*             screen;
+    GError*                error = NULL;
+    gchar**                argv;
+    GPid                   pid;
+    GSpawnFlags            flags = G_SPAWN_SEARCH_PATH | G_SPAWN_DO_NOT_REAP_CHILD;
+
+    screen = gtk_widget_get_screen(GTK_WIDGET(proxy));
+    argv = awn_applet_proxy_get_argv(proxy, debug);
+
     if (gdk_spawn_on_screen(
                 screen, NULL, argv, NULL, flags, NULL, NULL, &pid, &error)) {
         priv->running = TRUE;
+        priv->forked = FALSE;
+        awn_applet_proxy_set_pid(proxy, pid);
         g_child_watch_add(pid, on_child_exit, proxy);
 
         gchar* desktop = g_path_get_basename(priv->path);
         g_debug("Spawned awn-applet[%d] for \"%s\", UID: %s, XID: %" G_GINT64_FORMAT,
-                pid, desktop, priv->uid, socket_id);
+                pid, desktop, priv->uid,
+                (gint64) gtk_socket_get_id(GTK_SOCKET(proxy)));
         g_free(desktop);
     } else {
         g_warning("Unable to load applet %s: %s", priv->path, error->message);
@@ -525,7 +825,62 @@ awn_applet_proxy_execute(AwnAppletProxy* proxy)
     }
 
     g_strfreev(argv);
-    g_free(exec);
+}
+
+static void
+on_zygote_spawned(GPid pid, GError* error, gpointer user_data)
+{
+    AwnAppletProxy* proxy = AWN_APPLET_PROXY(user_data);
+    AwnAppletProxyPrivate* priv = proxy->priv;
+
+    if (error) {
+        g_debug("%s", error->message);
+        awn_applet_proxy_spawn(proxy, FALSE);
+        return;
+    }
+
+    priv->running = TRUE;
+    priv->forked = TRUE;
+    awn_applet_proxy_set_pid(proxy, pid);
+
+    gchar* desktop = g_path_get_basename(priv->path);
+    g_debug("Forked awn-applet[%d] for \"%s\", UID: %s, XID: %" G_GINT64_FORMAT,
+            pid, desktop, priv->uid,
+            (gint64) gtk_socket_get_id(GTK_SOCKET(proxy)));
+    g_free(desktop);
+}
+
+void
+awn_applet_proxy_execute(AwnAppletProxy* proxy)
+{
+    AwnAppletProxyPrivate* priv;
+
+    priv = AWN_APPLET_PROXY_GET_PRIVATE(proxy);
+
+    priv->size_req_initialized = FALSE;
+    gtk_widget_realize(GTK_WIDGET(proxy));
+
+    if (priv->embed_timer) {
+        g_timer_start(priv->embed_timer);
+    } else {
+        priv->embed_timer = g_timer_new();
+    }
+
+    /* FIXME: update tooltip with name of the applet?! */
+
+    awn_applet_proxy_trace_mark(proxy, "spawn");
+
+    /* Load the applet */
+    if (g_getenv("AWN_APPLET_GDB")) {
+        awn_applet_proxy_spawn(proxy, TRUE);
+    } else {
+        gchar** argv = awn_applet_proxy_get_argv(proxy, FALSE);
+
+        awn_applet_zygote_spawn(gtk_widget_get_screen(GTK_WIDGET(proxy)), argv,
+                                on_zygote_spawned, on_child_exit,
+                                G_OBJECT(proxy));
+        g_strfreev(argv);
+    }
 }
 
 static gboolean
@@ -550,3 +905,164 @@ awn_applet_proxy_schedule_execute(AwnAppletProxy* proxy)
         priv->idle_id = g_idle_add(awn_applet_proxy_idle_cb, proxy);
     }
 }
+
+static void
+awn_applet_proxy_set_pid(AwnAppletProxy* proxy, GPid pid)
+{
+    AwnAppletProxyPrivate* priv = proxy->priv;
+
+    priv->pid = pid;
+    if (pid > 0) {
+        awn_applet_usage_watch(pid);
+    }
+    priv->has_usage = FALSE;
+    priv->counters.time = 0.0;
+}
+
+/*
+ * The pid of the applet's process, 0 if it isn't running.
+ */
+GPid
+awn_applet_proxy_get_pid(AwnAppletProxy* proxy)
+{
+    g_return_val_if_fail(AWN_IS_APPLET_PROXY(proxy), 0);
+
+    return proxy->priv->pid;
+}
+
+static void
+awn_applet_proxy_update_usage_overlay(AwnAppletProxy* proxy)
+{
+    AwnAppletProxyPrivate* priv = proxy->priv;
+    gchar* text;
+
+    if (!priv->usage_overlay) {
+        return;
+    }
+    if (!priv->has_usage || !gtk_widget_get_mapped(GTK_WIDGET(proxy))) {
+        gtk_widget_hide(priv->usage_overlay);
+        return;
+    }
+
+    text = awn_applet_usage_to_string(&priv->usage);
+    awn_tooltip_set_position_hint(AWN_TOOLTIP(priv->usage_overlay),
+                                  (GtkPositionType) priv->position,
+                                  priv->size + priv->offset);
+    awn_tooltip_set_text(AWN_TOOLTIP(priv->usage_overlay), text);
+    awn_tooltip_update_position(AWN_TOOLTIP(priv->usage_overlay));
+    gtk_widget_show(priv->usage_overlay);
+    g_free(text);
+}
+
+/*
+ * Takes a new reading of the applet's resource usage.  Returns FALSE if
+ * there isn't a usage since the last reading (the applet isn't running or
+ * just started).
+ */
+gboolean
+awn_applet_proxy_update_usage(AwnAppletProxy* proxy)
+{
+    AwnAppletProxyPrivate* priv;
+    AwnAppletCounters counters;
+    glong rss = 0;
+
+    g_return_val_if_fail(AWN_IS_APPLET_PROXY(proxy), FALSE);
+    priv = proxy->priv;
+
+    if (!awn_applet_usage_read(priv->pid, &counters, &rss)) {
+        priv->has_usage = FALSE;
+        awn_applet_proxy_update_usage_overlay(proxy);
+        return FALSE;
+    }
+    counters.damage = priv->damage_count;
+
+    if (priv->counters.time > 0.0) {
+        awn_applet_usage_compute(&priv->counters, &counters, &priv->usage);
+        priv->usage.rss = rss;
+        if (!priv->plug_window) {
+            priv->usage.damage = -1.0;
+        }
+        priv->has_usage = TRUE;
+    }
+    priv->counters = counters;
+
+    awn_applet_proxy_update_usage_overlay(proxy);
+    return priv->has_usage;
+}
+
+/*
+ * The usage from the last two readings, NULL if there isn't one.
+ */
+const AwnAppletUsage*
+awn_applet_proxy_get_usage(AwnAppletProxy* proxy)
+{
+    g_return_val_if_fail(AWN_IS_APPLET_PROXY(proxy), NULL);
+
+    return proxy->priv->has_usage ? &proxy->priv->usage : NULL;
+}
+
+/*
+ * Drops the readings taken so far, for when they stop for a while.
+ */
+void
+awn_applet_proxy_reset_usage(AwnAppletProxy* proxy)
+{
+    g_return_if_fail(AWN_IS_APPLET_PROXY(proxy));
+
+    proxy->priv->has_usage = FALSE;
+    proxy->priv->counters.time = 0.0;
+    awn_applet_proxy_update_usage_overlay(proxy);
+}
+
+/*
+ * Starts or stops counting the redraws of the applet.  Readings taken with
+ * the count off report no redraw rate.
+ */
+void
+awn_applet_proxy_set_count_redraws(AwnAppletProxy* proxy, gboolean count)
+{
+    AwnAppletProxyPrivate* priv;
+
+    g_return_if_fail(AWN_IS_APPLET_PROXY(proxy));
+    priv = proxy->priv;
+
+    if (priv->count_redraws == count) {
+        return;
+    }
+    priv->count_redraws = count;
+
+    /* without a plug, on_plug_added starts counting */
+    awn_applet_proxy_watch_damage(proxy, count ?
+                                  gtk_socket_get_plug_window(GTK_SOCKET(proxy)) : NULL);
+    /* the next reading starts a new interval */
+    awn_applet_proxy_reset_usage(proxy);
+}
+
+/*
+ * Shows the usage in a popup next to the applet, updated with every reading.
+ */
+void
+awn_applet_proxy_set_usage_overlay(AwnAppletProxy* proxy, gboolean show)
+{
+    AwnAppletProxyPrivate* priv;
+
+    g_return_if_fail(AWN_IS_APPLET_PROXY(proxy));
+    priv = proxy->priv;
+
+    if (!show) {
+        if (priv->usage_overlay) {
+            gtk_widget_destroy(priv->usage_overlay);
+            priv->usage_overlay = NULL;
+        }
+        return;
+    }
+
+    if (!priv->usage_overlay) {
+        priv->usage_overlay = awn_tooltip_new_for_widget(GTK_WIDGET(proxy));
+        g_object_set(priv->usage_overlay,
+                     "smart-behavior", FALSE,
+                     "toggle-on-click", FALSE,
+                     NULL);
+    }
+    awn_applet_proxy_update_usage_overlay(proxy);
+}
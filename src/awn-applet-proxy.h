@@ -25,6 +25,7 @@
 #include <gtk/gtk.h>
 
 #include "awn-panel.h"
+#include "awn-applet-usage.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -77,6 +78,26 @@ void        awn_applet_proxy_schedule_execute(AwnAppletProxy* proxy);
 
 GtkWidget* awn_applet_proxy_get_throbber(AwnAppletProxy* proxy);
 
+void        awn_applet_proxy_set_reserved_size(AwnAppletProxy* proxy,
+                                               gint            size);
+
+void        awn_applet_proxy_set_placeholder(AwnAppletProxy*  proxy,
+        cairo_surface_t* placeholder);
+
+GPid        awn_applet_proxy_get_pid(AwnAppletProxy* proxy);
+
+gboolean    awn_applet_proxy_update_usage(AwnAppletProxy* proxy);
+
+const AwnAppletUsage* awn_applet_proxy_get_usage(AwnAppletProxy* proxy);
+
+void        awn_applet_proxy_set_usage_overlay(AwnAppletProxy* proxy,
+        gboolean        show);
+
+void        awn_applet_proxy_set_count_redraws(AwnAppletProxy* proxy,
+        gboolean        count);
+
+void        awn_applet_proxy_reset_usage(AwnAppletProxy* proxy);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
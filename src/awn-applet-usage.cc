@@ -0,0 +1,359 @@
+/*
+ *  Copyright (C) 2026 Awn-core team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <glib/gi18n.h>
+
+#include "awn-applet-usage.h"
+
+typedef struct {
+    GPid pid;          /* 0 until the bus tells, or if it couldn't */
+    gboolean resolving;
+    guint unattributed; /* messages that came while resolving */
+} Sender;
+
+/* unique bus name -> Sender*, removed when the name goes away */
+static GHashTable* senders = NULL;
+/* applet pid -> number of messages, only the watched pids are counted */
+static GHashTable* pid_messages = NULL;
+
+static gboolean
+read_cpu_ticks(GPid pid, guint64* ticks)
+{
+    gchar* filename = g_strdup_printf("/proc/%d/stat", pid);
+    gchar* contents = NULL;
+    gchar** fields;
+    gchar* end;
+    gboolean result = FALSE;
+
+    if (!g_file_get_contents(filename, &contents, NULL, NULL)) {
+        g_free(filename);
+        return FALSE;
+    }
+    g_free(filename);
+
+    /* the command name can contain anything, skip past it */
+    end = strrchr(contents, ')');
+    if (end) {
+        fields = g_strsplit(end + 2, " ", 0);
+        /* utime and stime are fields 14 and 15, we start at the 3rd */
+        if (g_strv_length(fields) > 12) {
+            *ticks = g_ascii_strtoull(fields[11], NULL, 10) +
+                     g_ascii_strtoull(fields[12], NULL, 10);
+            result = TRUE;
+        }
+        g_strfreev(fields);
+    }
+
+    g_free(contents);
+    return result;
+}
+
+/* Returns the value of a "Key:\t value" line of a /proc status file */
+static guint64
+read_status_value(const gchar* contents, const gchar* key)
+{
+    const gchar* line = contents;
+
+    while (line) {
+        if (g_str_has_prefix(line, key) && line[strlen(key)] == ':') {
+            return g_ascii_strtoull(line + strlen(key) + 1, NULL, 10);
+        }
+        line = strchr(line, '\n');
+        if (line) {
+            line++;
+        }
+    }
+    return 0;
+}
+
+static guint64
+read_switches(GPid pid)
+{
+    gchar* dirname = g_strdup_printf("/proc/%d/task", pid);
+    GDir* dir = g_dir_open(dirname, 0, NULL);
+    const gchar* task;
+    guint64 switches = 0;
+
+    while (dir && (task = g_dir_read_name(dir))) {
+        gchar* filename = g_build_filename(dirname, task, "status", NULL);
+        gchar* contents;
+
+        if (g_file_get_contents(filename, &contents, NULL, NULL)) {
+            switches += read_status_value(contents, "voluntary_ctxt_switches");
+            g_free(contents);
+        }
+        g_free(filename);
+    }
+
+    if (dir) {
+        g_dir_close(dir);
+    }
+    g_free(dirname);
+    return switches;
+}
+
+/*
+ * Reads the counters of process pid (except the damage), and its resident
+ * memory in kB into rss.  Returns FALSE if the process doesn't exist.
+ */
+gboolean
+awn_applet_usage_read(GPid pid, AwnAppletCounters* counters, glong* rss)
+{
+    GTimeVal now;
+    gchar* filename;
+    gchar* contents;
+
+    g_return_val_if_fail(counters != NULL, FALSE);
+
+    if (pid <= 0 || !read_cpu_ticks(pid, &counters->cpu_ticks)) {
+        return FALSE;
+    }
+
+    filename = g_strdup_printf("/proc/%d/status", pid);
+    if (rss && g_file_get_contents(filename, &contents, NULL, NULL)) {
+        *rss = read_status_value(contents, "VmRSS");
+        g_free(contents);
+    }
+    g_free(filename);
+
+    g_get_current_time(&now);
+    counters->time = now.tv_sec + now.tv_usec / 1000000.0;
+    counters->switches = read_switches(pid);
+    counters->messages = awn_applet_usage_get_messages(pid);
+
+    return TRUE;
+}
+
+void
+awn_applet_usage_compute(const AwnAppletCounters* before,
+                         const AwnAppletCounters* after,
+                         AwnAppletUsage* usage)
+{
+    gdouble elapsed = after->time - before->time;
+
+    g_return_if_fail(usage != NULL);
+
+    if (elapsed <= 0.0) {
+        return;
+    }
+
+    usage->cpu = (after->cpu_ticks - before->cpu_ticks) * 100.0 /
+                 sysconf(_SC_CLK_TCK) / elapsed;
+    usage->wakeups = (after->switches - before->switches) / elapsed;
+    usage->damage = (after->damage - before->damage) / elapsed;
+    usage->messages = (after->messages - before->messages) / elapsed;
+}
+
+gchar*
+awn_applet_usage_to_string(const AwnAppletUsage* usage)
+{
+    GString* str;
+
+    g_return_val_if_fail(usage != NULL, NULL);
+
+    str = g_string_new(NULL);
+    g_string_append_printf(str, _("CPU: %.1f%%\nMemory: %.1f MB\n"
+                                  "Wakeups: %.1f/s\n"),
+                           usage->cpu, usage->rss / 1024.0, usage->wakeups);
+    if (usage->damage >= 0.0) {
+        g_string_append_printf(str, _("Redraws: %.1f/s\n"), usage->damage);
+    }
+    g_string_append_printf(str, _("D-Bus messages: %.1f/s"), usage->messages);
+
+    return g_string_free(str, FALSE);
+}
+
+static void
+ensure_tables(void)
+{
+    if (!senders) {
+        senders = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                        g_free, g_free);
+        pid_messages = g_hash_table_new(g_direct_hash, g_direct_equal);
+    }
+}
+
+static void
+count_messages(GPid pid, guint count)
+{
+    gpointer messages;
+
+    if (pid > 0 && count &&
+            g_hash_table_lookup_extended(pid_messages, GINT_TO_POINTER(pid),
+                                         NULL, &messages)) {
+        g_hash_table_insert(pid_messages, GINT_TO_POINTER(pid),
+                            GUINT_TO_POINTER(GPOINTER_TO_UINT(messages) + count));
+    }
+}
+
+static void
+on_sender_pid_reply(DBusPendingCall* call, gpointer name)
+{
+    DBusMessage* reply = dbus_pending_call_steal_reply(call);
+    Sender* sender = (Sender*)g_hash_table_lookup(senders, name);
+    dbus_uint32_t pid = 0;
+
+    if (reply) {
+        if (dbus_message_get_type(reply) == DBUS_MESSAGE_TYPE_METHOD_RETURN) {
+            dbus_message_get_args(reply, NULL, DBUS_TYPE_UINT32, &pid,
+                                  DBUS_TYPE_INVALID);
+        }
+        dbus_message_unref(reply);
+    }
+
+    /* the name could be gone already */
+    if (sender) {
+        sender->pid = pid;
+        sender->resolving = FALSE;
+        count_messages(sender->pid, sender->unattributed);
+        sender->unattributed = 0;
+    }
+}
+
+/* Asks the bus for the pid, once per connection as unique names aren't
+ * reused */
+static void
+resolve_sender_pid(DBusConnection* connection, const gchar* name)
+{
+    DBusMessage* msg;
+    DBusPendingCall* call = NULL;
+
+    msg = dbus_message_new_method_call(DBUS_SERVICE_DBUS, DBUS_PATH_DBUS,
+                                       DBUS_INTERFACE_DBUS,
+                                       "GetConnectionUnixProcessID");
+    dbus_message_append_args(msg, DBUS_TYPE_STRING, &name, DBUS_TYPE_INVALID);
+    if (dbus_connection_send_with_reply(connection, msg, &call, -1) && call) {
+        dbus_pending_call_set_notify(call, on_sender_pid_reply, g_strdup(name),
+                                     g_free);
+        dbus_pending_call_unref(call);
+    }
+    dbus_message_unref(msg);
+}
+
+static DBusHandlerResult
+on_name_owner_changed(DBusConnection* connection, DBusMessage* message,
+                      void* user_data)
+{
+    const gchar* name, *old_owner, *new_owner;
+
+    if (dbus_message_is_signal(message, DBUS_INTERFACE_DBUS,
+                               "NameOwnerChanged") &&
+            dbus_message_get_args(message, NULL,
+                                  DBUS_TYPE_STRING, &name,
+                                  DBUS_TYPE_STRING, &old_owner,
+                                  DBUS_TYPE_STRING, &new_owner,
+                                  DBUS_TYPE_INVALID) &&
+            !new_owner[0]) {
+        g_hash_table_remove(senders, name);
+    }
+    return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+}
+
+static void
+watch_name_owners(DBusConnection* connection)
+{
+    static DBusConnection* watched = NULL;
+
+    if (watched == connection) {
+        return;
+    }
+    watched = connection;
+    dbus_bus_add_match(connection,
+                       "type='signal',sender='" DBUS_SERVICE_DBUS "',"
+                       "interface='" DBUS_INTERFACE_DBUS "',"
+                       "member='NameOwnerChanged'", NULL);
+    dbus_connection_add_filter(connection, on_name_owner_changed, NULL, NULL);
+}
+
+/*
+ * The pid of a new sender is looked up asynchronously, the messages it
+ * sends meanwhile are counted once it's known.
+ */
+void
+awn_applet_usage_count_message(DBusConnection* connection,
+                               DBusMessage* message)
+{
+    const gchar* name = dbus_message_get_sender(message);
+    Sender* sender;
+
+    if (!name) {
+        return;
+    }
+
+    ensure_tables();
+    watch_name_owners(connection);
+
+    sender = (Sender*)g_hash_table_lookup(senders, name);
+    if (!sender) {
+        sender = g_new0(Sender, 1);
+        sender->resolving = TRUE;
+        g_hash_table_insert(senders, g_strdup(name), sender);
+        resolve_sender_pid(connection, name);
+    }
+
+    if (sender->resolving) {
+        sender->unattributed++;
+    } else {
+        count_messages(sender->pid, 1);
+    }
+}
+
+void
+awn_applet_usage_watch(GPid pid)
+{
+    g_return_if_fail(pid > 0);
+
+    ensure_tables();
+    if (!g_hash_table_lookup_extended(pid_messages, GINT_TO_POINTER(pid),
+                                      NULL, NULL)) {
+        g_hash_table_insert(pid_messages, GINT_TO_POINTER(pid),
+                            GUINT_TO_POINTER(0));
+    }
+}
+
+guint64
+awn_applet_usage_get_messages(GPid pid)
+{
+    if (!pid_messages) {
+        return 0;
+    }
+    return GPOINTER_TO_UINT(g_hash_table_lookup(pid_messages,
+                                                GINT_TO_POINTER(pid)));
+}
+
+static gboolean
+is_sender_of(gpointer name, gpointer sender, gpointer exited)
+{
+    return ((Sender*)sender)->pid == GPOINTER_TO_INT(exited);
+}
+
+void
+awn_applet_usage_forget(GPid pid)
+{
+    if (!senders) {
+        return;
+    }
+    g_hash_table_foreach_remove(senders, is_sender_of, GINT_TO_POINTER(pid));
+    g_hash_table_remove(pid_messages, GINT_TO_POINTER(pid));
+}
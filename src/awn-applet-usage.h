@@ -0,0 +1,83 @@
+/*
+ *  Copyright (C) 2026 Awn-core team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA.
+ */
+
+#ifndef _AWN_APPLET_USAGE_H
+#define _AWN_APPLET_USAGE_H
+
+#include <glib.h>
+#include <dbus/dbus.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ Resource accounting of the applet processes.  The counters are read from
+ /proc/<pid> (so this only works on Linux), the usage is the difference of
+ two readings divided by the time between them.
+
+ Wakeups are the voluntary context switches of all the threads of the
+ applet, ie. how many times it went to sleep and was woken up again.
+ */
+
+typedef struct {
+    gdouble time;      /* seconds */
+    guint64 cpu_ticks; /* user + system time in clock ticks */
+    guint64 switches;
+    guint64 damage;    /* filled in by AwnAppletProxy */
+    guint64 messages;
+} AwnAppletCounters;
+
+typedef struct {
+    gdouble cpu;       /* percent of one CPU */
+    glong   rss;       /* kB */
+    gdouble wakeups;   /* per second */
+    gdouble damage;    /* redraws of the plug per second, < 0 if unknown */
+    gdouble messages;  /* D-Bus messages to the panel per second */
+} AwnAppletUsage;
+
+typedef void (*AwnAppletUsageFunc)(const gchar* uid, GPid pid,
+                                   const AwnAppletUsage* usage,
+                                   gpointer user_data);
+
+gboolean awn_applet_usage_read(GPid pid, AwnAppletCounters* counters,
+                               glong* rss);
+
+void     awn_applet_usage_compute(const AwnAppletCounters* before,
+                                  const AwnAppletCounters* after,
+                                  AwnAppletUsage* usage);
+
+gchar*   awn_applet_usage_to_string(const AwnAppletUsage* usage);
+
+/* Called for every message the panel gets, counted by the sender's pid */
+void     awn_applet_usage_count_message(DBusConnection* connection,
+                                        DBusMessage* message);
+
+/* Starts counting the messages of an applet process */
+void     awn_applet_usage_watch(GPid pid);
+
+guint64  awn_applet_usage_get_messages(GPid pid);
+
+/* Drops what's known about an exited process */
+void     awn_applet_usage_forget(GPid pid);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* _AWN_APPLET_USAGE_H */
@@ -0,0 +1,390 @@
+/*
+ *  Copyright (C) 2026 Awn-core team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <glib/gstdio.h>
+
+#include "awn-applet-zygote.h"
+
+typedef enum {
+    ZYGOTE_STOPPED,
+    ZYGOTE_STARTING,
+    ZYGOTE_READY,
+    ZYGOTE_FAILED
+} ZygoteState;
+
+typedef struct {
+    gchar** argv;
+    AwnAppletZygoteSpawnedFunc spawned;
+    GChildWatchFunc exited;
+    GObject* object;
+} SpawnRequest;
+
+typedef struct {
+    GPid pid; /* 0 until the zygote replied */
+    AwnAppletZygoteSpawnedFunc spawned;
+    GChildWatchFunc exited;
+    GObject* object;
+} ZygoteChild;
+
+static ZygoteState zygote_state = ZYGOTE_STOPPED;
+static gchar* zygote_socket = NULL;
+static gint zygote_stdin = -1; /* never written, the zygote exits when it's closed */
+static GQueue* zygote_pending = NULL;
+
+static void zygote_spawn_now(SpawnRequest* request);
+
+static void
+spawn_request_free(SpawnRequest* request)
+{
+    if (request->object) {
+        g_object_remove_weak_pointer(request->object, (gpointer*)&request->object);
+    }
+    g_strfreev(request->argv);
+    g_free(request);
+}
+
+static void
+zygote_flush_pending(void)
+{
+    SpawnRequest* request;
+
+    if (!zygote_pending) {
+        return;
+    }
+    while ((request = g_queue_pop_head(zygote_pending))) {
+        zygote_spawn_now(request);
+        spawn_request_free(request);
+    }
+}
+
+static void
+zygote_cleanup(void)
+{
+    gchar* dir;
+
+    if (zygote_stdin >= 0) {
+        close(zygote_stdin);
+        zygote_stdin = -1;
+    }
+    if (zygote_socket) {
+        dir = g_path_get_dirname(zygote_socket);
+        g_unlink(zygote_socket);
+        g_rmdir(dir);
+        g_free(dir);
+    }
+}
+
+static void
+on_zygote_exit(GPid pid, gint status, gpointer user_data)
+{
+    g_warning("awn-applet zygote[%d] exited, spawning applets directly", pid);
+
+    /* not restarting it, it could just crash again */
+    zygote_state = ZYGOTE_FAILED;
+    zygote_cleanup();
+    zygote_flush_pending();
+
+    g_spawn_close_pid(pid);
+}
+
+static gboolean
+on_zygote_ready(GIOChannel* channel, GIOCondition condition, gpointer user_data)
+{
+    gchar* line = NULL;
+
+    g_io_channel_read_line(channel, &line, NULL, NULL, NULL);
+
+    if (g_strcmp0(line, "ready\n") == 0) {
+        zygote_state = ZYGOTE_READY;
+    } else {
+        g_warning("awn-applet zygote didn't start, spawning applets directly");
+        zygote_state = ZYGOTE_FAILED;
+        zygote_cleanup();
+    }
+    g_free(line);
+
+    zygote_flush_pending();
+
+    return FALSE;
+}
+
+static void
+zygote_start(void)
+{
+    GError* error = NULL;
+    gchar* dir;
+    gchar* argv[3] = { (gchar*)"awn-applet", NULL, NULL };
+    GPid pid;
+    gint stdout_fd;
+    GIOChannel* channel;
+
+    dir = g_build_filename(g_get_tmp_dir(), "awn-applet-zygote-XXXXXX", NULL);
+    if (!mkdtemp(dir)) {
+        g_warning("Unable to create directory for the zygote socket: %s",
+                  g_strerror(errno));
+        g_free(dir);
+        zygote_state = ZYGOTE_FAILED;
+        return;
+    }
+    zygote_socket = g_build_filename(dir, "socket", NULL);
+    g_free(dir);
+
+    argv[1] = g_strdup_printf("--zygote=%s", zygote_socket);
+    if (!g_spawn_async_with_pipes(NULL, argv, NULL,
+                                  (GSpawnFlags)(G_SPAWN_SEARCH_PATH | G_SPAWN_DO_NOT_REAP_CHILD),
+                                  NULL, NULL, &pid,
+                                  &zygote_stdin, &stdout_fd, NULL, &error)) {
+        g_warning("Unable to start the awn-applet zygote: %s", error->message);
+        g_error_free(error);
+        g_free(argv[1]);
+        zygote_state = ZYGOTE_FAILED;
+        zygote_cleanup();
+        return;
+    }
+    g_free(argv[1]);
+
+    g_child_watch_add(pid, on_zygote_exit, NULL);
+
+    channel = g_io_channel_unix_new(stdout_fd);
+    g_io_channel_set_close_on_unref(channel, TRUE);
+    g_io_add_watch(channel, (GIOCondition)(G_IO_IN | G_IO_HUP | G_IO_ERR),
+                   on_zygote_ready, NULL);
+    g_io_channel_unref(channel);
+
+    zygote_state = ZYGOTE_STARTING;
+}
+
+static void
+zygote_child_free(ZygoteChild* child)
+{
+    if (child->object) {
+        g_object_remove_weak_pointer(child->object, (gpointer*)&child->object);
+    }
+    g_free(child);
+}
+
+/*
+ The zygote answers with the pid of the forked applet, then with its wait
+ status when it exits.  Both are read from the main loop, forking doesn't
+ block awn.
+ */
+static gboolean
+on_child_status(GIOChannel* channel, GIOCondition condition, gpointer user_data)
+{
+    ZygoteChild* child = (ZygoteChild*)user_data;
+    GIOStatus status;
+    gchar* line = NULL;
+
+    while ((status = g_io_channel_read_line(channel, &line, NULL, NULL, NULL)) ==
+            G_IO_STATUS_NORMAL) {
+        gint value = atoi(line);
+
+        g_free(line);
+        line = NULL;
+        if (child->pid) {
+            if (child->object) {
+                child->exited(child->pid, value, child->object);
+            }
+            zygote_child_free(child);
+            return FALSE;
+        }
+        if (value <= 0) {
+            break;
+        }
+        child->pid = value;
+        if (child->object) {
+            child->spawned(child->pid, NULL, child->object);
+        }
+    }
+    if (status == G_IO_STATUS_AGAIN) {
+        return TRUE;
+    }
+
+    /* no pid means the applet wasn't forked, no status means the zygote is
+     * gone and we won't hear about the applet (the proxy forgets its pid
+     * when the plug goes away) */
+    if (!child->pid && child->object) {
+        GError* error = g_error_new(G_SPAWN_ERROR, G_SPAWN_ERROR_FORK,
+                                    "The zygote didn't fork the applet");
+        child->spawned(0, error, child->object);
+        g_error_free(error);
+    }
+    g_free(line);
+    zygote_child_free(child);
+
+    return FALSE;
+}
+
+/*
+ Sends the request for argv, returns the connection the zygote answers on.
+ The request is small and the socket local, only the answer is waited for
+ (see on_child_status()).
+ */
+static gboolean
+zygote_fork(gchar** argv, gint* status_fd, GError** error)
+{
+    struct sockaddr_un addr;
+    GString* request;
+    gint fd;
+    gsize sent = 0;
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    g_strlcpy(addr.sun_path, zygote_socket, sizeof(addr.sun_path));
+
+    if (fd < 0 || connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        g_set_error(error, G_SPAWN_ERROR, G_SPAWN_ERROR_FAILED,
+                    "Unable to connect to the zygote: %s", g_strerror(errno));
+        if (fd >= 0) {
+            close(fd);
+        }
+        return FALSE;
+    }
+
+    request = g_string_new(NULL);
+    for (gchar** arg = argv; *arg; arg++) {
+        gchar* quoted = g_shell_quote(*arg);
+        g_string_append_printf(request, "%s%s", arg == argv ? "" : " ", quoted);
+        g_free(quoted);
+    }
+    g_string_append_c(request, '\n');
+
+    while (sent < request->len) {
+        ssize_t written = write(fd, request->str + sent, request->len - sent);
+
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            break;
+        }
+        sent += written;
+    }
+
+    if (sent < request->len) {
+        g_set_error(error, G_SPAWN_ERROR, G_SPAWN_ERROR_FAILED,
+                    "Unable to send the request to the zygote: %s",
+                    g_strerror(errno));
+        g_string_free(request, TRUE);
+        close(fd);
+        return FALSE;
+    }
+    g_string_free(request, TRUE);
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    *status_fd = fd;
+    return TRUE;
+}
+
+static void
+zygote_spawn_now(SpawnRequest* request)
+{
+    GError* error = NULL;
+    gint status_fd;
+
+    if (!request->object) {
+        return;
+    }
+
+    if (zygote_state != ZYGOTE_READY) {
+        g_set_error(&error, G_SPAWN_ERROR, G_SPAWN_ERROR_FAILED,
+                    "The zygote isn't running");
+    } else if (zygote_fork(request->argv, &status_fd, &error)) {
+        ZygoteChild* child = g_new0(ZygoteChild, 1);
+        GIOChannel* channel;
+
+        child->spawned = request->spawned;
+        child->exited = request->exited;
+        child->object = request->object;
+        g_object_add_weak_pointer(child->object, (gpointer*)&child->object);
+
+        channel = g_io_channel_unix_new(status_fd);
+        g_io_channel_set_close_on_unref(channel, TRUE);
+        g_io_channel_set_encoding(channel, NULL, NULL);
+        g_io_add_watch(channel, (GIOCondition)(G_IO_IN | G_IO_HUP | G_IO_ERR),
+                       on_child_status, child);
+        g_io_channel_unref(channel);
+        return;
+    }
+
+    request->spawned(0, error, request->object);
+    g_error_free(error);
+}
+
+void
+awn_applet_zygote_spawn(GdkScreen*                 screen,
+                        gchar**                    argv,
+                        AwnAppletZygoteSpawnedFunc spawned,
+                        GChildWatchFunc            exited,
+                        GObject*                   object)
+{
+    SpawnRequest* request;
+    gchar* display;
+    guint argc;
+
+    g_return_if_fail(GDK_IS_SCREEN(screen));
+    g_return_if_fail(argv && spawned && exited);
+    g_return_if_fail(G_IS_OBJECT(object));
+
+    if (zygote_state == ZYGOTE_STOPPED) {
+        if (g_getenv("AWN_APPLET_NO_ZYGOTE")) {
+            zygote_state = ZYGOTE_FAILED;
+        } else {
+            zygote_start();
+        }
+    }
+
+    request = g_new0(SpawnRequest, 1);
+    /* like gdk_spawn_on_screen() does */
+    display = gdk_screen_make_display_name(screen);
+    argc = g_strv_length(argv);
+    request->argv = g_new0(gchar*, argc + 2);
+    request->argv[0] = g_strdup_printf("DISPLAY=%s", display);
+    for (guint i = 0; i < argc; i++) {
+        request->argv[i + 1] = g_strdup(argv[i]);
+    }
+    g_free(display);
+
+    request->spawned = spawned;
+    request->exited = exited;
+    request->object = object;
+    g_object_add_weak_pointer(object, (gpointer*)&request->object);
+
+    if (zygote_state == ZYGOTE_STARTING) {
+        if (!zygote_pending) {
+            zygote_pending = g_queue_new();
+        }
+        g_queue_push_tail(zygote_pending, request);
+        return;
+    }
+
+    zygote_spawn_now(request);
+    spawn_request_free(request);
+}
@@ -0,0 +1,59 @@
+/*
+ *  Copyright (C) 2026 Awn-core team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA.
+ */
+
+#ifndef _AWN_APPLET_ZYGOTE_H
+#define _AWN_APPLET_ZYGOTE_H
+
+#include <glib.h>
+#include <glib-object.h>
+#include <gdk/gdk.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ Client side of awn-applet's zygote mode (see applet-activation/main.cc):
+ a single pre-initialized awn-applet process that forks the applets, started
+ with the first request.  Requests made while it starts up are queued.
+
+ Set AWN_APPLET_NO_ZYGOTE in the environment to spawn every applet on its
+ own.
+ */
+
+/* error is set if the zygote couldn't fork the applet, spawn it yourself */
+typedef void (*AwnAppletZygoteSpawnedFunc)(GPid pid, GError* error,
+                                           gpointer user_data);
+
+/*
+ Forks argv (an awn-applet command line) on screen.  Doesn't wait for the
+ zygote: spawned is called from the main loop once it answered, exited (with
+ the wait status) when the applet process exits.  The callbacks are called
+ only while object is alive.
+ */
+void awn_applet_zygote_spawn(GdkScreen*                 screen,
+                             gchar**                    argv,
+                             AwnAppletZygoteSpawnedFunc spawned,
+                             GChildWatchFunc            exited,
+                             GObject*                   object);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* _AWN_APPLET_ZYGOTE_H */
@@ -40,6 +40,12 @@
 #define AWN_PANELS_HIDE_DELAY      "hide_delay"
 #define AWN_PANELS_POLL_DELAY      "mouse_poll_delay"
 #define AWN_PANELS_IDS             "panel_list"
+#define AWN_PANELS_STARTUP_PARALLELISM "applet_startup_parallelism"
+#define AWN_PANELS_STARTUP_PLACEHOLDERS "applet_startup_placeholders"
+#define AWN_PANELS_APPLET_CPU_LIMIT "applet_cpu_limit"
+#define AWN_PANELS_APPLET_RSS_LIMIT "applet_rss_limit"
+#define AWN_PANELS_APPLET_WAKEUP_LIMIT "applet_wakeup_limit"
+#define AWN_PANELS_APPLET_USAGE_OVERLAY "applet_usage_overlay"
 
 #define AWN_GROUP_PANEL            "panel"
 #define AWN_PANEL_PANEL_MODE       "panel_mode"
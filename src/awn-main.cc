@@ -33,6 +33,8 @@
 
 #include <libdesktop-agnostic/vfs.h>
 
+#include "libawn/awn-startup-trace.h"
+
 #include "awn-app.h"
 #include "awn-defines.h"
 
@@ -83,6 +85,10 @@ main(gint argc, gchar* argv[])
     DBusGProxy*      proxy;
     GError*          error = NULL;
     guint32          ret;
+    gint64           start;
+
+    awn_startup_trace_set_process_name("awn");
+    awn_startup_trace_mark("main");
 
     context = g_option_context_new("- Avant Window Navigator " VERSION);
     g_option_context_add_main_entries(context, entries, GETTEXT_PACKAGE);
@@ -100,9 +106,11 @@ main(gint argc, gchar* argv[])
         g_thread_init(NULL);
     }
 
+    start = awn_startup_trace_now();
     dbus_g_thread_init();
     g_type_init();
     gtk_init(&argc, &argv);
+    awn_startup_trace_span("gtk_init", start);
 
     desktop_agnostic_vfs_init(&error);
     if (error) {
@@ -169,11 +177,20 @@ main(gint argc, gchar* argv[])
     }
 
     /* Launch Awn */
+    start = awn_startup_trace_now();
     app = awn_application_get_default();
+    awn_startup_trace_span("application", start);
+    /* awn owns the trace file, the applets report to it */
+    awn_startup_trace_write_later(2000);
 
     g_unsetenv("DESKTOP_AUTOSTART_ID");
     gtk_main();
 
+    if (!awn_startup_trace_write(&error)) {
+        g_warning("Unable to write the startup trace: %s", error->message);
+        g_clear_error(&error);
+    }
+
     g_object_unref(app);
     g_object_unref(proxy);
     dbus_g_connection_unref(connection);
@@ -33,6 +33,8 @@
 #include <dbus/dbus.h>
 #include "awn-panel.h"
 #include "awn-panel-dispatcher.h"
+#include "awn-applet-usage.h"
+#include <libawn/awn-startup-trace.h>
 #include <libawn/vala-utils.h>
 #include <string>
 
@@ -75,10 +77,12 @@ static DBusHandlerResult _dbus_awn_panel_dbus_interface_delete_applet(AwnPanelDB
 static DBusHandlerResult _dbus_awn_panel_dbus_interface_docklet_request(AwnPanelDBusInterface* self, DBusConnection* connection, DBusMessage* message);
 static DBusHandlerResult _dbus_awn_panel_dbus_interface_get_inhibitors(AwnPanelDBusInterface* self, DBusConnection* connection, DBusMessage* message);
 static DBusHandlerResult _dbus_awn_panel_dbus_interface_get_snapshot(AwnPanelDBusInterface* self, DBusConnection* connection, DBusMessage* message);
+static DBusHandlerResult _dbus_awn_panel_dbus_interface_get_applet_usage(AwnPanelDBusInterface* self, DBusConnection* connection, DBusMessage* message);
 static DBusHandlerResult _dbus_awn_panel_dbus_interface_inhibit_autohide(AwnPanelDBusInterface* self, DBusConnection* connection, DBusMessage* message);
 static DBusHandlerResult _dbus_awn_panel_dbus_interface_uninhibit_autohide(AwnPanelDBusInterface* self, DBusConnection* connection, DBusMessage* message);
 static DBusHandlerResult _dbus_awn_panel_dbus_interface_set_applet_flags(AwnPanelDBusInterface* self, DBusConnection* connection, DBusMessage* message);
 static DBusHandlerResult _dbus_awn_panel_dbus_interface_set_glow(AwnPanelDBusInterface* self, DBusConnection* connection, DBusMessage* message);
+static DBusHandlerResult _dbus_awn_panel_dbus_interface_report_startup_phase(AwnPanelDBusInterface* self, DBusConnection* connection, DBusMessage* message);
 static void _dbus_awn_panel_dbus_interface_destroy_applet(GObject* _sender, const gchar* uid, DBusConnection* _connection);
 static void _dbus_awn_panel_dbus_interface_destroy_notify(GObject* _sender, DBusConnection* _connection);
 static void _dbus_awn_panel_dbus_interface_property_changed(GObject* _sender, const gchar* prop_name, GValue* value, DBusConnection* _connection);
@@ -95,10 +99,12 @@ static void awn_panel_dbus_interface_dbus_proxy_delete_applet(AwnPanelDBusInterf
 static gint64 awn_panel_dbus_interface_dbus_proxy_docklet_request(AwnPanelDBusInterface* self, gint min_size, gboolean shrink, gboolean expand, GError** error);
 static gchar** awn_panel_dbus_interface_dbus_proxy_get_inhibitors(AwnPanelDBusInterface* self, int* result_length1, GError** error);
 static void awn_panel_dbus_interface_dbus_proxy_get_snapshot(AwnPanelDBusInterface* self, AwnImageStruct* result, GError** error);
+static void awn_panel_dbus_interface_dbus_proxy_get_applet_usage(AwnPanelDBusInterface* self, std::vector<AwnAppletUsageStruct>* result, GError** error);
 static guint awn_panel_dbus_interface_dbus_proxy_inhibit_autohide(AwnPanelDBusInterface* self, const char* sender, const gchar* app_name, const gchar* reason, GError** error);
 static void awn_panel_dbus_interface_dbus_proxy_uninhibit_autohide(AwnPanelDBusInterface* self, guint cookie, GError** error);
 static void awn_panel_dbus_interface_dbus_proxy_set_applet_flags(AwnPanelDBusInterface* self, const gchar* uid, gint flags, GError** error);
 static void awn_panel_dbus_interface_dbus_proxy_set_glow(AwnPanelDBusInterface* self, const char* sender, gboolean activate, GError** error);
+static void awn_panel_dbus_interface_dbus_proxy_report_startup_phase(AwnPanelDBusInterface* self, const gchar* process, gint pid, const gchar* name, gint64 timestamp, gint64 duration, GError** error);
 static gdouble awn_panel_dbus_interface_dbus_proxy_get_offset_modifier(AwnPanelDBusInterface* self);
 static gint awn_panel_dbus_interface_dbus_proxy_get_max_size(AwnPanelDBusInterface* self);
 static gint awn_panel_dbus_interface_dbus_proxy_get_offset(AwnPanelDBusInterface* self);
@@ -131,10 +137,12 @@ static void awn_panel_dispatcher_real_delete_applet(AwnPanelDBusInterface* base,
 static gint64 awn_panel_dispatcher_real_docklet_request(AwnPanelDBusInterface* base, gint min_size, gboolean shrink, gboolean expand, GError** error);
 static gchar** awn_panel_dispatcher_real_get_inhibitors(AwnPanelDBusInterface* base, int* result_length1, GError** error);
 static void awn_panel_dispatcher_real_get_snapshot(AwnPanelDBusInterface* base, AwnImageStruct* result, GError** error);
+static void awn_panel_dispatcher_real_get_applet_usage(AwnPanelDBusInterface* base, std::vector<AwnAppletUsageStruct>* result, GError** error);
 static guint awn_panel_dispatcher_real_inhibit_autohide(AwnPanelDBusInterface* base, const char* sender, const gchar* app_name, const gchar* reason, GError** error);
 static void awn_panel_dispatcher_real_uninhibit_autohide(AwnPanelDBusInterface* base, guint cookie, GError** error);
 static void awn_panel_dispatcher_real_set_applet_flags(AwnPanelDBusInterface* base, const gchar* uid, gint flags, GError** error);
 static void awn_panel_dispatcher_real_set_glow(AwnPanelDBusInterface* base, const char* sender, gboolean activate, GError** error);
+static void awn_panel_dispatcher_real_report_startup_phase(AwnPanelDBusInterface* base, const gchar* process, gint pid, const gchar* name, gint64 timestamp, gint64 duration, GError** error);
 static void awn_panel_dispatcher_set_panel(AwnPanelDispatcher* self, AwnPanel* value);
 static void awn_panel_dispatcher_finalize(GObject* obj);
 void awn_panel_dispatcher_dbus_register_object(DBusConnection* connection, const char* path, void* object);
@@ -186,6 +194,12 @@ void awn_panel_dbus_interface_get_snapshot(AwnPanelDBusInterface* self, AwnImage
 }
 
 
+void awn_panel_dbus_interface_get_applet_usage(AwnPanelDBusInterface* self, std::vector<AwnAppletUsageStruct>* result, GError** error)
+{
+    AWN_PANEL_DBUS_INTERFACE_GET_INTERFACE(self)->get_applet_usage(self, result, error);
+}
+
+
 guint awn_panel_dbus_interface_inhibit_autohide(AwnPanelDBusInterface* self, const char* sender, const gchar* app_name, const gchar* reason, GError** error)
 {
     return AWN_PANEL_DBUS_INTERFACE_GET_INTERFACE(self)->inhibit_autohide(self, sender, app_name, reason, error);
@@ -210,6 +224,12 @@ void awn_panel_dbus_interface_set_glow(AwnPanelDBusInterface* self, const char*
 }
 
 
+void awn_panel_dbus_interface_report_startup_phase(AwnPanelDBusInterface* self, const gchar* process, gint pid, const gchar* name, gint64 timestamp, gint64 duration, GError** error)
+{
+    AWN_PANEL_DBUS_INTERFACE_GET_INTERFACE(self)->report_startup_phase(self, process, pid, name, timestamp, duration, error);
+}
+
+
 gdouble awn_panel_dbus_interface_get_offset_modifier(AwnPanelDBusInterface* self)
 {
     return AWN_PANEL_DBUS_INTERFACE_GET_INTERFACE(self)->get_offset_modifier(self);
@@ -338,7 +358,7 @@ static DBusHandlerResult _dbus_awn_panel_dbus_interface_introspect(AwnPanelDBusI
     dbus_message_iter_init_append(reply, &iter);
 
     std::string xml_data{"<!DOCTYPE node PUBLIC \"-//freedesktop//DTD D-BUS Object Introspection 1.0//EN\" \"http://www.freedesktop.org/standards/dbus/1.0/introspect.dtd\">\n"};
-    xml_data += "<node>\n<interface name=\"org.freedesktop.DBus.Introspectable\">\n  <method name=\"Introspect\">\n    <arg name=\"data\" direction=\"out\" type=\"s\"/>\n  </method>\n</interface>\n<interface name=\"org.freedesktop.DBus.Properties\">\n  <method name=\"Get\">\n    <arg name=\"interface\" direction=\"in\" type=\"s\"/>\n    <arg name=\"propname\" direction=\"in\" type=\"s\"/>\n    <arg name=\"value\" direction=\"out\" type=\"v\"/>\n  </method>\n  <method name=\"Set\">\n    <arg name=\"interface\" direction=\"in\" type=\"s\"/>\n    <arg name=\"propname\" direction=\"in\" type=\"s\"/>\n    <arg name=\"value\" direction=\"in\" type=\"v\"/>\n  </method>\n  <method name=\"GetAll\">\n    <arg name=\"interface\" direction=\"in\" type=\"s\"/>\n    <arg name=\"props\" direction=\"out\" type=\"a{sv}\"/>\n  </method>\n</interface>\n<interface name=\"org.awnproject.Awn.Panel\">\n  <method name=\"AddApplet\">\n    <arg name=\"desktop_file\" type=\"s\" direction=\"in\"/>\n  </method>\n  <method name=\"DeleteApplet\">\n    <arg name=\"uid\" type=\"s\" direction=\"in\"/>\n  </method>\n  <method name=\"DockletRequest\">\n    <arg name=\"min_size\" type=\"i\" direction=\"in\"/>\n    <arg name=\"shrink\" type=\"b\" direction=\"in\"/>\n    <arg name=\"expand\" type=\"b\" direction=\"in\"/>\n    <arg name=\"result\" type=\"x\" direction=\"out\"/>\n  </method>\n  <method name=\"GetInhibitors\">\n    <arg name=\"result\" type=\"as\" direction=\"out\"/>\n  </method>\n  <method name=\"GetSnapshot\">\n    <arg name=\"result\" type=\"(iiibiiay)\" direction=\"out\"/>\n  </method>\n  <method name=\"InhibitAutohide\">\n    <arg name=\"app_name\" type=\"s\" direction=\"in\"/>\n    <arg name=\"reason\" type=\"s\" direction=\"in\"/>\n    <arg name=\"result\" type=\"u\" direction=\"out\"/>\n  </method>\n  <method name=\"UninhibitAutohide\">\n    <arg name=\"cookie\" type=\"u\" direction=\"in\"/>\n  </method>\n  <method name=\"SetAppletFlags\">\n    <arg name=\"uid\" type=\"s\" direction=\"in\"/>\n    <arg name=\"flags\" type=\"i\" direction=\"in\"/>\n  </method>\n  <method name=\"SetGlow\">\n    <arg name=\"activate\" type=\"b\" direction=\"in\"/>\n  </method>\n  <property name=\"OffsetModifier\" type=\"d\" access=\"read\"/>\n  <property name=\"MaxSize\" type=\"i\" access=\"read\"/>\n  <property name=\"Offset\" type=\"i\" access=\"readwrite\"/>\n  <property name=\"PathType\" type=\"i\" access=\"read\"/>\n  <property name=\"Position\" type=\"i\" access=\"readwrite\"/>\n  <property name=\"Size\" type=\"i\" access=\"readwrite\"/>\n  <property name=\"PanelXid\" type=\"x\" access=\"read\"/>\n  <signal name=\"DestroyApplet\">\n    <arg name=\"uid\" type=\"s\"/>\n  </signal>\n  <signal name=\"DestroyNotify\">\n  </signal>\n  <signal name=\"PropertyChanged\">\n    <arg name=\"prop_name\" type=\"s\"/>\n    <arg name=\"value\" type=\"v\"/>\n  </signal>\n</interface>\n";
+    xml_data += "<node>\n<interface name=\"org.freedesktop.DBus.Introspectable\">\n  <method name=\"Introspect\">\n    <arg name=\"data\" direction=\"out\" type=\"s\"/>\n  </method>\n</interface>\n<interface name=\"org.freedesktop.DBus.Properties\">\n  <method name=\"Get\">\n    <arg name=\"interface\" direction=\"in\" type=\"s\"/>\n    <arg name=\"propname\" direction=\"in\" type=\"s\"/>\n    <arg name=\"value\" direction=\"out\" type=\"v\"/>\n  </method>\n  <method name=\"Set\">\n    <arg name=\"interface\" direction=\"in\" type=\"s\"/>\n    <arg name=\"propname\" direction=\"in\" type=\"s\"/>\n    <arg name=\"value\" direction=\"in\" type=\"v\"/>\n  </method>\n  <method name=\"GetAll\">\n    <arg name=\"interface\" direction=\"in\" type=\"s\"/>\n    <arg name=\"props\" direction=\"out\" type=\"a{sv}\"/>\n  </method>\n</interface>\n<interface name=\"org.awnproject.Awn.Panel\">\n  <method name=\"AddApplet\">\n    <arg name=\"desktop_file\" type=\"s\" direction=\"in\"/>\n  </method>\n  <method name=\"DeleteApplet\">\n    <arg name=\"uid\" type=\"s\" direction=\"in\"/>\n  </method>\n  <method name=\"DockletRequest\">\n    <arg name=\"min_size\" type=\"i\" direction=\"in\"/>\n    <arg name=\"shrink\" type=\"b\" direction=\"in\"/>\n    <arg name=\"expand\" type=\"b\" direction=\"in\"/>\n    <arg name=\"result\" type=\"x\" direction=\"out\"/>\n  </method>\n  <method name=\"GetInhibitors\">\n    <arg name=\"result\" type=\"as\" direction=\"out\"/>\n  </method>\n  <method name=\"GetSnapshot\">\n    <arg name=\"result\" type=\"(iiibiiay)\" direction=\"out\"/>\n  </method>\n  <method name=\"GetAppletUsage\">\n    <arg name=\"result\" type=\"a(sididdd)\" direction=\"out\"/>\n  </method>\n  <method name=\"InhibitAutohide\">\n    <arg name=\"app_name\" type=\"s\" direction=\"in\"/>\n    <arg name=\"reason\" type=\"s\" direction=\"in\"/>\n    <arg name=\"result\" type=\"u\" direction=\"out\"/>\n  </method>\n  <method name=\"UninhibitAutohide\">\n    <arg name=\"cookie\" type=\"u\" direction=\"in\"/>\n  </method>\n  <method name=\"SetAppletFlags\">\n    <arg name=\"uid\" type=\"s\" direction=\"in\"/>\n    <arg name=\"flags\" type=\"i\" direction=\"in\"/>\n  </method>\n  <method name=\"SetGlow\">\n    <arg name=\"activate\" type=\"b\" direction=\"in\"/>\n  </method>\n  <method name=\"ReportStartupPhase\">\n    <arg name=\"process\" type=\"s\" direction=\"in\"/>\n    <arg name=\"pid\" type=\"i\" direction=\"in\"/>\n    <arg name=\"name\" type=\"s\" direction=\"in\"/>\n    <arg name=\"timestamp\" type=\"x\" direction=\"in\"/>\n    <arg name=\"duration\" type=\"x\" direction=\"in\"/>\n  </method>\n  <property name=\"OffsetModifier\" type=\"d\" access=\"read\"/>\n  <property name=\"MaxSize\" type=\"i\" access=\"read\"/>\n  <property name=\"Offset\" type=\"i\" access=\"readwrite\"/>\n  <property name=\"PathType\" type=\"i\" access=\"read\"/>\n  <property name=\"Position\" type=\"i\" access=\"readwrite\"/>\n  <property name=\"Size\" type=\"i\" access=\"readwrite\"/>\n  <property name=\"PanelXid\" type=\"x\" access=\"read\"/>\n  <signal name=\"DestroyApplet\">\n    <arg name=\"uid\" type=\"s\"/>\n  </signal>\n  <signal name=\"DestroyNotify\">\n  </signal>\n  <signal name=\"PropertyChanged\">\n    <arg name=\"prop_name\" type=\"s\"/>\n    <arg name=\"value\" type=\"v\"/>\n  </signal>\n</interface>\n";
     dbus_connection_list_registered(connection, g_object_get_data((GObject*) self, "dbus_object_path"), &children);
     for (int i = 0; children[i]; i++) {
         xml_data = xml_data + "<node name=\"" + children[i] + "\"/>\n";
@@ -768,6 +788,47 @@ static DBusHandlerResult _dbus_awn_panel_dbus_interface_get_snapshot(AwnPanelDBu
 }
 
 
+static DBusHandlerResult _dbus_awn_panel_dbus_interface_get_applet_usage(AwnPanelDBusInterface* self, DBusConnection* connection, DBusMessage* message)
+{
+    DBusMessageIter iter;
+    GError* error = nullptr;
+    std::vector<AwnAppletUsageStruct> result;
+    DBusMessageIter _tmp_array_;
+    if (strcmp(dbus_message_get_signature(message), "")) {
+        return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+    }
+    dbus_message_iter_init(message, &iter);
+    awn_panel_dbus_interface_get_applet_usage(self, &result, &error);
+    if (error) {
+        awn::vala_send_dbus_error_message(connection, message, error);
+        return DBUS_HANDLER_RESULT_HANDLED;
+    }
+    DBusMessage* reply = dbus_message_new_method_return(message);
+    dbus_message_iter_init_append(reply, &iter);
+    dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "(sididdd)", &_tmp_array_);
+    for (const auto& usage : result) {
+        DBusMessageIter _tmp_struct_;
+        dbus_message_iter_open_container(&_tmp_array_, DBUS_TYPE_STRUCT, NULL, &_tmp_struct_);
+        awn::vala_dbus_iter_append_string(&_tmp_struct_, usage.uid.c_str());
+        awn::vala_dbus_iter_append_int32(&_tmp_struct_, usage.pid);
+        awn::vala_dbus_iter_append_double(&_tmp_struct_, usage.cpu);
+        awn::vala_dbus_iter_append_int32(&_tmp_struct_, usage.rss);
+        awn::vala_dbus_iter_append_double(&_tmp_struct_, usage.wakeups);
+        awn::vala_dbus_iter_append_double(&_tmp_struct_, usage.damage);
+        awn::vala_dbus_iter_append_double(&_tmp_struct_, usage.messages);
+        dbus_message_iter_close_container(&_tmp_array_, &_tmp_struct_);
+    }
+    dbus_message_iter_close_container(&iter, &_tmp_array_);
+    if (reply) {
+        dbus_connection_send(connection, reply, NULL);
+        dbus_message_unref(reply);
+        return DBUS_HANDLER_RESULT_HANDLED;
+    } else {
+        return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+    }
+}
+
+
 static DBusHandlerResult _dbus_awn_panel_dbus_interface_inhibit_autohide(AwnPanelDBusInterface* self, DBusConnection* connection, DBusMessage* message)
 {
     DBusMessageIter iter;
@@ -896,6 +957,53 @@ static DBusHandlerResult _dbus_awn_panel_dbus_interface_set_glow(AwnPanelDBusInt
 }
 
 
+static DBusHandlerResult _dbus_awn_panel_dbus_interface_report_startup_phase(AwnPanelDBusInterface* self, DBusConnection* connection, DBusMessage* message)
+{
+    if (strcmp(dbus_message_get_signature(message), "sisxx")) {
+        return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+    }
+
+    DBusMessageIter iter;
+    dbus_message_iter_init(message, &iter);
+
+    const char* process;
+    dbus_message_iter_get_basic(&iter, &process);
+    dbus_message_iter_next(&iter);
+
+    dbus_int32_t pid;
+    dbus_message_iter_get_basic(&iter, &pid);
+    dbus_message_iter_next(&iter);
+
+    const char* name;
+    dbus_message_iter_get_basic(&iter, &name);
+    dbus_message_iter_next(&iter);
+
+    dbus_int64_t timestamp;
+    dbus_message_iter_get_basic(&iter, &timestamp);
+    dbus_message_iter_next(&iter);
+
+    dbus_int64_t duration;
+    dbus_message_iter_get_basic(&iter, &duration);
+    dbus_message_iter_next(&iter);
+
+    GError* error = nullptr;
+    awn_panel_dbus_interface_report_startup_phase(self, process, pid, name, timestamp, duration, &error);
+    if (error) {
+        awn::vala_send_dbus_error_message(connection, message, error);
+        return DBUS_HANDLER_RESULT_HANDLED;
+    }
+    DBusMessage* reply = dbus_message_new_method_return(message);
+    dbus_message_iter_init_append(reply, &iter);
+    if (reply) {
+        dbus_connection_send(connection, reply, NULL);
+        dbus_message_unref(reply);
+        return DBUS_HANDLER_RESULT_HANDLED;
+    } else {
+        return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+    }
+}
+
+
 DBusHandlerResult awn_panel_dbus_interface_dbus_message(DBusConnection* connection, DBusMessage* message, void* object)
 {
     DBusHandlerResult result = DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
@@ -917,6 +1025,8 @@ DBusHandlerResult awn_panel_dbus_interface_dbus_message(DBusConnection* connecti
         result = _dbus_awn_panel_dbus_interface_get_inhibitors(object, connection, message);
     } else if (dbus_message_is_method_call(message, "org.awnproject.Awn.Panel", "GetSnapshot")) {
         result = _dbus_awn_panel_dbus_interface_get_snapshot(object, connection, message);
+    } else if (dbus_message_is_method_call(message, "org.awnproject.Awn.Panel", "GetAppletUsage")) {
+        result = _dbus_awn_panel_dbus_interface_get_applet_usage(object, connection, message);
     } else if (dbus_message_is_method_call(message, "org.awnproject.Awn.Panel", "InhibitAutohide")) {
         result = _dbus_awn_panel_dbus_interface_inhibit_autohide(object, connection, message);
     } else if (dbus_message_is_method_call(message, "org.awnproject.Awn.Panel", "UninhibitAutohide")) {
@@ -925,6 +1035,8 @@ DBusHandlerResult awn_panel_dbus_interface_dbus_message(DBusConnection* connecti
         result = _dbus_awn_panel_dbus_interface_set_applet_flags(object, connection, message);
     } else if (dbus_message_is_method_call(message, "org.awnproject.Awn.Panel", "SetGlow")) {
         result = _dbus_awn_panel_dbus_interface_set_glow(object, connection, message);
+    } else if (dbus_message_is_method_call(message, "org.awnproject.Awn.Panel", "ReportStartupPhase")) {
+        result = _dbus_awn_panel_dbus_interface_report_startup_phase(object, connection, message);
     }
     if (result == DBUS_HANDLER_RESULT_HANDLED) {
         return result;
@@ -1369,6 +1481,71 @@ static void awn_panel_dbus_interface_dbus_proxy_get_snapshot(AwnPanelDBusInterfa
 }
 
 
+static void awn_panel_dbus_interface_dbus_proxy_get_applet_usage(AwnPanelDBusInterface* self, std::vector<AwnAppletUsageStruct>* result, GError** error)
+{
+    DBusError _dbus_error;
+    DBusGConnection* _connection;
+    DBusMessage* msg, *reply;
+    DBusMessageIter iter;
+    DBusMessageIter _tmp_array_;
+    if (((AwnPanelDBusInterfaceDBusProxy*) self)->disposed) {
+        g_set_error(error, DBUS_GERROR, DBUS_GERROR_DISCONNECTED, "%s", "Connection is closed");
+        return;
+    }
+    msg = dbus_message_new_method_call(dbus_g_proxy_get_bus_name((DBusGProxy*) self), dbus_g_proxy_get_path((DBusGProxy*) self), "org.awnproject.Awn.Panel", "GetAppletUsage");
+    dbus_message_iter_init_append(msg, &iter);
+    g_object_get(self, "connection", &_connection, NULL);
+    dbus_error_init(&_dbus_error);
+    reply = dbus_connection_send_with_reply_and_block(dbus_g_connection_get_connection(_connection), msg, -1, &_dbus_error);
+    dbus_g_connection_unref(_connection);
+    dbus_message_unref(msg);
+    if (dbus_error_is_set(&_dbus_error)) {
+        awn::vala_set_dbus_error(_dbus_error, error);
+        dbus_error_free(&_dbus_error);
+        return;
+    }
+    if (strcmp(dbus_message_get_signature(reply), "a(sididdd)")) {
+        g_set_error(error, DBUS_GERROR, DBUS_GERROR_INVALID_SIGNATURE, "Invalid signature, expected \"%s\", got \"%s\"", "a(sididdd)", dbus_message_get_signature(reply));
+        dbus_message_unref(reply);
+        return;
+    }
+    dbus_message_iter_init(reply, &iter);
+    result->clear();
+    dbus_message_iter_recurse(&iter, &_tmp_array_);
+    for (; dbus_message_iter_get_arg_type(&_tmp_array_); dbus_message_iter_next(&_tmp_array_)) {
+        AwnAppletUsageStruct usage;
+        DBusMessageIter subiter;
+        const char* uid;
+        dbus_int32_t pid, rss;
+        double cpu, wakeups, damage, messages;
+        dbus_message_iter_recurse(&_tmp_array_, &subiter);
+        dbus_message_iter_get_basic(&subiter, &uid);
+        dbus_message_iter_next(&subiter);
+        dbus_message_iter_get_basic(&subiter, &pid);
+        dbus_message_iter_next(&subiter);
+        dbus_message_iter_get_basic(&subiter, &cpu);
+        dbus_message_iter_next(&subiter);
+        dbus_message_iter_get_basic(&subiter, &rss);
+        dbus_message_iter_next(&subiter);
+        dbus_message_iter_get_basic(&subiter, &wakeups);
+        dbus_message_iter_next(&subiter);
+        dbus_message_iter_get_basic(&subiter, &damage);
+        dbus_message_iter_next(&subiter);
+        dbus_message_iter_get_basic(&subiter, &messages);
+        usage.uid = uid;
+        usage.pid = pid;
+        usage.cpu = cpu;
+        usage.rss = rss;
+        usage.wakeups = wakeups;
+        usage.damage = damage;
+        usage.messages = messages;
+        result->push_back(usage);
+    }
+    dbus_message_iter_next(&iter);
+    dbus_message_unref(reply);
+}
+
+
 static guint awn_panel_dbus_interface_dbus_proxy_inhibit_autohide(AwnPanelDBusInterface* self, const char* sender, const gchar* app_name, const gchar* reason, GError** error)
 {
     DBusError _dbus_error;
@@ -1513,6 +1690,43 @@ static void awn_panel_dbus_interface_dbus_proxy_set_glow(AwnPanelDBusInterface*
 }
 
 
+static void awn_panel_dbus_interface_dbus_proxy_report_startup_phase(AwnPanelDBusInterface* self, const gchar* process, gint pid, const gchar* name, gint64 timestamp, gint64 duration, GError** error)
+{
+    DBusError _dbus_error;
+    DBusGConnection* _connection;
+    DBusMessage* msg, *reply;
+    DBusMessageIter iter;
+    if (((AwnPanelDBusInterfaceDBusProxy*) self)->disposed) {
+        g_set_error(error, DBUS_GERROR, DBUS_GERROR_DISCONNECTED, "%s", "Connection is closed");
+        return;
+    }
+    msg = dbus_message_new_method_call(dbus_g_proxy_get_bus_name((DBusGProxy*) self), dbus_g_proxy_get_path((DBusGProxy*) self), "org.awnproject.Awn.Panel", "ReportStartupPhase");
+    dbus_message_iter_init_append(msg, &iter);
+    awn::vala_dbus_iter_append_string(&iter, process);
+    awn::vala_dbus_iter_append_int32(&iter, pid);
+    awn::vala_dbus_iter_append_string(&iter, name);
+    awn::vala_dbus_iter_append_int64(&iter, timestamp);
+    awn::vala_dbus_iter_append_int64(&iter, duration);
+    g_object_get(self, "connection", &_connection, NULL);
+    dbus_error_init(&_dbus_error);
+    reply = dbus_connection_send_with_reply_and_block(dbus_g_connection_get_connection(_connection), msg, -1, &_dbus_error);
+    dbus_g_connection_unref(_connection);
+    dbus_message_unref(msg);
+    if (dbus_error_is_set(&_dbus_error)) {
+        awn::vala_set_dbus_error(_dbus_error, error);
+        dbus_error_free(&_dbus_error);
+        return;
+    }
+    if (strcmp(dbus_message_get_signature(reply), "")) {
+        g_set_error(error, DBUS_GERROR, DBUS_GERROR_INVALID_SIGNATURE, "Invalid signature, expected \"%s\", got \"%s\"", "", dbus_message_get_signature(reply));
+        dbus_message_unref(reply);
+        return;
+    }
+    dbus_message_iter_init(reply, &iter);
+    dbus_message_unref(reply);
+}
+
+
 static gdouble awn_panel_dbus_interface_dbus_proxy_get_offset_modifier(AwnPanelDBusInterface* self)
 {
     DBusError _dbus_error;
@@ -1942,10 +2156,12 @@ static void awn_panel_dbus_interface_dbus_proxy_awn_panel_dbus_interface__interf
     iface->docklet_request = awn_panel_dbus_interface_dbus_proxy_docklet_request;
     iface->get_inhibitors = awn_panel_dbus_interface_dbus_proxy_get_inhibitors;
     iface->get_snapshot = awn_panel_dbus_interface_dbus_proxy_get_snapshot;
+    iface->get_applet_usage = awn_panel_dbus_interface_dbus_proxy_get_applet_usage;
     iface->inhibit_autohide = awn_panel_dbus_interface_dbus_proxy_inhibit_autohide;
     iface->uninhibit_autohide = awn_panel_dbus_interface_dbus_proxy_uninhibit_autohide;
     iface->set_applet_flags = awn_panel_dbus_interface_dbus_proxy_set_applet_flags;
     iface->set_glow = awn_panel_dbus_interface_dbus_proxy_set_glow;
+    iface->report_startup_phase = awn_panel_dbus_interface_dbus_proxy_report_startup_phase;
     iface->get_offset_modifier = awn_panel_dbus_interface_dbus_proxy_get_offset_modifier;
     iface->get_max_size = awn_panel_dbus_interface_dbus_proxy_get_max_size;
     iface->get_offset = awn_panel_dbus_interface_dbus_proxy_get_offset;
@@ -2161,6 +2377,29 @@ static void awn_panel_dispatcher_real_get_snapshot(AwnPanelDBusInterface* base,
 }
 
 
+static void _awn_panel_dispatcher_add_applet_usage(const gchar* uid, GPid pid, const AwnAppletUsage* usage, gpointer user_data)
+{
+    std::vector<AwnAppletUsageStruct>* result = (std::vector<AwnAppletUsageStruct>*) user_data;
+    AwnAppletUsageStruct item;
+    item.uid = uid;
+    item.pid = pid;
+    item.cpu = usage->cpu;
+    item.rss = usage->rss;
+    item.wakeups = usage->wakeups;
+    item.damage = usage->damage;
+    item.messages = usage->messages;
+    result->push_back(item);
+}
+
+
+static void awn_panel_dispatcher_real_get_applet_usage(AwnPanelDBusInterface* base, std::vector<AwnAppletUsageStruct>* result, GError** error)
+{
+    AwnPanelDispatcher* self = (AwnPanelDispatcher*) base;
+    result->clear();
+    awn_panel_get_applet_usage(self->priv->_panel, _awn_panel_dispatcher_add_applet_usage, result);
+}
+
+
 static guint awn_panel_dispatcher_real_inhibit_autohide(AwnPanelDBusInterface* base, const char* sender, const gchar* app_name, const gchar* reason, GError** error)
 {
     AwnPanelDispatcher* self = (AwnPanelDispatcher*) base;
@@ -2206,6 +2445,14 @@ static void awn_panel_dispatcher_real_set_glow(AwnPanelDBusInterface* base, cons
 }
 
 
+static void awn_panel_dispatcher_real_report_startup_phase(AwnPanelDBusInterface* base, const gchar* process, gint pid, const gchar* name, gint64 timestamp, gint64 duration, GError** error)
+{
+    g_return_if_fail(process != NULL);
+    g_return_if_fail(name != NULL);
+    awn_startup_trace_add(process, pid, name, timestamp, duration);
+}
+
+
 AwnPanel* awn_panel_dispatcher_get_panel(AwnPanelDispatcher* self)
 {
     g_return_val_if_fail(self != NULL, NULL);
@@ -2324,10 +2571,12 @@ static void awn_panel_dispatcher_awn_panel_dbus_interface_interface_init(AwnPane
     iface->docklet_request = (gint64(*)(AwnPanelDBusInterface* , gint , gboolean , gboolean , GError**)) awn_panel_dispatcher_real_docklet_request;
     iface->get_inhibitors = (gchar** (*)(AwnPanelDBusInterface* , int* , GError**)) awn_panel_dispatcher_real_get_inhibitors;
     iface->get_snapshot = (AwnImageStruct(*)(AwnPanelDBusInterface* , AwnImageStruct* , GError**)) awn_panel_dispatcher_real_get_snapshot;
+    iface->get_applet_usage = (void (*)(AwnPanelDBusInterface* , std::vector<AwnAppletUsageStruct>* , GError**)) awn_panel_dispatcher_real_get_applet_usage;
     iface->inhibit_autohide = (guint(*)(AwnPanelDBusInterface* , const char* , const gchar* , const gchar* , GError**)) awn_panel_dispatcher_real_inhibit_autohide;
     iface->uninhibit_autohide = (void (*)(AwnPanelDBusInterface* , guint , GError**)) awn_panel_dispatcher_real_uninhibit_autohide;
     iface->set_applet_flags = (void (*)(AwnPanelDBusInterface* , const gchar* , gint , GError**)) awn_panel_dispatcher_real_set_applet_flags;
     iface->set_glow = (void (*)(AwnPanelDBusInterface* , const char* , gboolean , GError**)) awn_panel_dispatcher_real_set_glow;
+    iface->report_startup_phase = (void (*)(AwnPanelDBusInterface* , const gchar* , gint , const gchar* , gint64 , gint64 , GError**)) awn_panel_dispatcher_real_report_startup_phase;
     iface->get_offset_modifier = awn_panel_dispatcher_real_get_offset_modifier;
     iface->get_max_size = awn_panel_dispatcher_real_get_max_size;
     iface->get_offset = awn_panel_dispatcher_real_get_offset;
@@ -2367,7 +2616,7 @@ static DBusHandlerResult _dbus_awn_panel_dispatcher_introspect(AwnPanelDispatche
     dbus_message_iter_init_append(reply, &iter);
 
     std::string xml_data{"<!DOCTYPE node PUBLIC \"-//freedesktop//DTD D-BUS Object Introspection 1.0//EN\" \"http://www.freedesktop.org/standards/dbus/1.0/introspect.dtd\">\n"};
-    xml_data += "<node>\n<interface name=\"org.freedesktop.DBus.Introspectable\">\n  <method name=\"Introspect\">\n    <arg name=\"data\" direction=\"out\" type=\"s\"/>\n  </method>\n</interface>\n<interface name=\"org.freedesktop.DBus.Properties\">\n  <method name=\"Get\">\n    <arg name=\"interface\" direction=\"in\" type=\"s\"/>\n    <arg name=\"propname\" direction=\"in\" type=\"s\"/>\n    <arg name=\"value\" direction=\"out\" type=\"v\"/>\n  </method>\n  <method name=\"Set\">\n    <arg name=\"interface\" direction=\"in\" type=\"s\"/>\n    <arg name=\"propname\" direction=\"in\" type=\"s\"/>\n    <arg name=\"value\" direction=\"in\" type=\"v\"/>\n  </method>\n  <method name=\"GetAll\">\n    <arg name=\"interface\" direction=\"in\" type=\"s\"/>\n    <arg name=\"props\" direction=\"out\" type=\"a{sv}\"/>\n  </method>\n</interface>\n<interface name=\"org.awnproject.Awn.Panel\">\n  <method name=\"AddApplet\">\n    <arg name=\"desktop_file\" type=\"s\" direction=\"in\"/>\n  </method>\n  <method name=\"DeleteApplet\">\n    <arg name=\"uid\" type=\"s\" direction=\"in\"/>\n  </method>\n  <method name=\"DockletRequest\">\n    <arg name=\"min_size\" type=\"i\" direction=\"in\"/>\n    <arg name=\"shrink\" type=\"b\" direction=\"in\"/>\n    <arg name=\"expand\" type=\"b\" direction=\"in\"/>\n    <arg name=\"result\" type=\"x\" direction=\"out\"/>\n  </method>\n  <method name=\"GetInhibitors\">\n    <arg name=\"result\" type=\"as\" direction=\"out\"/>\n  </method>\n  <method name=\"GetSnapshot\">\n    <arg name=\"result\" type=\"(iiibiiay)\" direction=\"out\"/>\n  </method>\n  <method name=\"InhibitAutohide\">\n    <arg name=\"app_name\" type=\"s\" direction=\"in\"/>\n    <arg name=\"reason\" type=\"s\" direction=\"in\"/>\n    <arg name=\"result\" type=\"u\" direction=\"out\"/>\n  </method>\n  <method name=\"UninhibitAutohide\">\n    <arg name=\"cookie\" type=\"u\" direction=\"in\"/>\n  </method>\n  <method name=\"SetAppletFlags\">\n    <arg name=\"uid\" type=\"s\" direction=\"in\"/>\n    <arg name=\"flags\" type=\"i\" direction=\"in\"/>\n  </method>\n  <method name=\"SetGlow\">\n    <arg name=\"activate\" type=\"b\" direction=\"in\"/>\n  </method>\n  <property name=\"OffsetModifier\" type=\"d\" access=\"read\"/>\n  <property name=\"MaxSize\" type=\"i\" access=\"read\"/>\n  <property name=\"Offset\" type=\"i\" access=\"readwrite\"/>\n  <property name=\"PathType\" type=\"i\" access=\"read\"/>\n  <property name=\"Position\" type=\"i\" access=\"readwrite\"/>\n  <property name=\"Size\" type=\"i\" access=\"readwrite\"/>\n  <property name=\"PanelXid\" type=\"x\" access=\"read\"/>\n  <signal name=\"DestroyApplet\">\n    <arg name=\"uid\" type=\"s\"/>\n  </signal>\n  <signal name=\"DestroyNotify\">\n  </signal>\n  <signal name=\"PropertyChanged\">\n    <arg name=\"prop_name\" type=\"s\"/>\n    <arg name=\"value\" type=\"v\"/>\n  </signal>\n</interface>\n";
+    xml_data += "<node>\n<interface name=\"org.freedesktop.DBus.Introspectable\">\n  <method name=\"Introspect\">\n    <arg name=\"data\" direction=\"out\" type=\"s\"/>\n  </method>\n</interface>\n<interface name=\"org.freedesktop.DBus.Properties\">\n  <method name=\"Get\">\n    <arg name=\"interface\" direction=\"in\" type=\"s\"/>\n    <arg name=\"propname\" direction=\"in\" type=\"s\"/>\n    <arg name=\"value\" direction=\"out\" type=\"v\"/>\n  </method>\n  <method name=\"Set\">\n    <arg name=\"interface\" direction=\"in\" type=\"s\"/>\n    <arg name=\"propname\" direction=\"in\" type=\"s\"/>\n    <arg name=\"value\" direction=\"in\" type=\"v\"/>\n  </method>\n  <method name=\"GetAll\">\n    <arg name=\"interface\" direction=\"in\" type=\"s\"/>\n    <arg name=\"props\" direction=\"out\" type=\"a{sv}\"/>\n  </method>\n</interface>\n<interface name=\"org.awnproject.Awn.Panel\">\n  <method name=\"AddApplet\">\n    <arg name=\"desktop_file\" type=\"s\" direction=\"in\"/>\n  </method>\n  <method name=\"DeleteApplet\">\n    <arg name=\"uid\" type=\"s\" direction=\"in\"/>\n  </method>\n  <method name=\"DockletRequest\">\n    <arg name=\"min_size\" type=\"i\" direction=\"in\"/>\n    <arg name=\"shrink\" type=\"b\" direction=\"in\"/>\n    <arg name=\"expand\" type=\"b\" direction=\"in\"/>\n    <arg name=\"result\" type=\"x\" direction=\"out\"/>\n  </method>\n  <method name=\"GetInhibitors\">\n    <arg name=\"result\" type=\"as\" direction=\"out\"/>\n  </method>\n  <method name=\"GetSnapshot\">\n    <arg name=\"result\" type=\"(iiibiiay)\" direction=\"out\"/>\n  </method>\n  <method name=\"GetAppletUsage\">\n    <arg name=\"result\" type=\"a(sididdd)\" direction=\"out\"/>\n  </method>\n  <method name=\"InhibitAutohide\">\n    <arg name=\"app_name\" type=\"s\" direction=\"in\"/>\n    <arg name=\"reason\" type=\"s\" direction=\"in\"/>\n    <arg name=\"result\" type=\"u\" direction=\"out\"/>\n  </method>\n  <method name=\"UninhibitAutohide\">\n    <arg name=\"cookie\" type=\"u\" direction=\"in\"/>\n  </method>\n  <method name=\"SetAppletFlags\">\n    <arg name=\"uid\" type=\"s\" direction=\"in\"/>\n    <arg name=\"flags\" type=\"i\" direction=\"in\"/>\n  </method>\n  <method name=\"SetGlow\">\n    <arg name=\"activate\" type=\"b\" direction=\"in\"/>\n  </method>\n  <method name=\"ReportStartupPhase\">\n    <arg name=\"process\" type=\"s\" direction=\"in\"/>\n    <arg name=\"pid\" type=\"i\" direction=\"in\"/>\n    <arg name=\"name\" type=\"s\" direction=\"in\"/>\n    <arg name=\"timestamp\" type=\"x\" direction=\"in\"/>\n    <arg name=\"duration\" type=\"x\" direction=\"in\"/>\n  </method>\n  <property name=\"OffsetModifier\" type=\"d\" access=\"read\"/>\n  <property name=\"MaxSize\" type=\"i\" access=\"read\"/>\n  <property name=\"Offset\" type=\"i\" access=\"readwrite\"/>\n  <property name=\"PathType\" type=\"i\" access=\"read\"/>\n  <property name=\"Position\" type=\"i\" access=\"readwrite\"/>\n  <property name=\"Size\" type=\"i\" access=\"readwrite\"/>\n  <property name=\"PanelXid\" type=\"x\" access=\"read\"/>\n  <signal name=\"DestroyApplet\">\n    <arg name=\"uid\" type=\"s\"/>\n  </signal>\n  <signal name=\"DestroyNotify\">\n  </signal>\n  <signal name=\"PropertyChanged\">\n    <arg name=\"prop_name\" type=\"s\"/>\n    <arg name=\"value\" type=\"v\"/>\n  </signal>\n</interface>\n";
     dbus_connection_list_registered(connection, g_object_get_data((GObject*) self, "dbus_object_path"), &children);
     for (int i = 0; children[i]; i++) {
         xml_data = xml_data + "<node name=\"" + children[i] + "\"/>\n";
@@ -2388,6 +2637,7 @@ static DBusHandlerResult _dbus_awn_panel_dispatcher_introspect(AwnPanelDispatche
 DBusHandlerResult awn_panel_dispatcher_dbus_message(DBusConnection* connection, DBusMessage* message, void* object)
 {
     DBusHandlerResult result = DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+    awn_applet_usage_count_message(connection, message);
     if (dbus_message_is_method_call(message, "org.freedesktop.DBus.Introspectable", "Introspect")) {
         result = _dbus_awn_panel_dispatcher_introspect(object, connection, message);
     }
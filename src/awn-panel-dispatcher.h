@@ -13,6 +13,7 @@
 #include <float.h>
 #include <math.h>
 #include "awn-panel.h"
+#include <string>
 #include <vector>
 
 #ifdef __cplusplus
@@ -44,6 +45,16 @@ struct AwnImageStruct {
     std::vector<char> pixel_data;
 };
 
+struct AwnAppletUsageStruct {
+    std::string uid;
+    int32_t pid;
+    double cpu;
+    int32_t rss;
+    double wakeups;
+    double damage;
+    double messages;
+};
+
 struct _AwnPanelDBusInterfaceIface {
     GTypeInterface parent_iface;
     void (*add_applet)(AwnPanelDBusInterface* self, const gchar* desktop_file, GError** error);
@@ -51,10 +62,12 @@ struct _AwnPanelDBusInterfaceIface {
     gint64(*docklet_request)(AwnPanelDBusInterface* self, gint min_size, gboolean shrink, gboolean expand, GError** error);
     gchar** (*get_inhibitors)(AwnPanelDBusInterface* self, int* result_length1, GError** error);
     void (*get_snapshot)(AwnPanelDBusInterface* self, AwnImageStruct* result, GError** error);
+    void (*get_applet_usage)(AwnPanelDBusInterface* self, std::vector<AwnAppletUsageStruct>* result, GError** error);
     guint(*inhibit_autohide)(AwnPanelDBusInterface* self, const char* sender, const gchar* app_name, const gchar* reason, GError** error);
     void (*uninhibit_autohide)(AwnPanelDBusInterface* self, guint cookie, GError** error);
     void (*set_applet_flags)(AwnPanelDBusInterface* self, const gchar* uid, gint flags, GError** error);
     void (*set_glow)(AwnPanelDBusInterface* self, const char* sender, gboolean activate, GError** error);
+    void (*report_startup_phase)(AwnPanelDBusInterface* self, const gchar* process, gint pid, const gchar* name, gint64 timestamp, gint64 duration, GError** error);
     gdouble(*get_offset_modifier)(AwnPanelDBusInterface* self);
     gint(*get_max_size)(AwnPanelDBusInterface* self);
     gint(*get_offset)(AwnPanelDBusInterface* self);
@@ -85,10 +98,12 @@ void awn_panel_dbus_interface_delete_applet(AwnPanelDBusInterface* self, const g
 gint64 awn_panel_dbus_interface_docklet_request(AwnPanelDBusInterface* self, gint min_size, gboolean shrink, gboolean expand, GError** error);
 gchar** awn_panel_dbus_interface_get_inhibitors(AwnPanelDBusInterface* self, int* result_length1, GError** error);
 void awn_panel_dbus_interface_get_snapshot(AwnPanelDBusInterface* self, AwnImageStruct* result, GError** error);
+void awn_panel_dbus_interface_get_applet_usage(AwnPanelDBusInterface* self, std::vector<AwnAppletUsageStruct>* result, GError** error);
 guint awn_panel_dbus_interface_inhibit_autohide(AwnPanelDBusInterface* self, const char* sender, const gchar* app_name, const gchar* reason, GError** error);
 void awn_panel_dbus_interface_uninhibit_autohide(AwnPanelDBusInterface* self, guint cookie, GError** error);
 void awn_panel_dbus_interface_set_applet_flags(AwnPanelDBusInterface* self, const gchar* uid, gint flags, GError** error);
 void awn_panel_dbus_interface_set_glow(AwnPanelDBusInterface* self, const char* sender, gboolean activate, GError** error);
+void awn_panel_dbus_interface_report_startup_phase(AwnPanelDBusInterface* self, const gchar* process, gint pid, const gchar* name, gint64 timestamp, gint64 duration, GError** error);
 gdouble awn_panel_dbus_interface_get_offset_modifier(AwnPanelDBusInterface* self);
 gint awn_panel_dbus_interface_get_max_size(AwnPanelDBusInterface* self);
 gint awn_panel_dbus_interface_get_offset(AwnPanelDBusInterface* self);
@@ -53,6 +53,7 @@
 #include "awn-throbber.h"
 #include "awn-x.h"
 
+#include "libawn/awn-startup-trace.h"
 #include "libawn/gseal-transition.h"
 #include "xutils.h"
 
@@ -70,6 +71,11 @@ struct _AwnPanelPrivate {
 
     GHashTable* inhibits;
     guint startup_inhibit_cookie;
+    gboolean exposed;
+    gboolean startup_complete;
+
+    guint placeholders_timer_id;
+    guint placeholders_quit_id;
 
     AwnPanelDispatcher* dbus_proxy;
     AwnBackground* bg;
@@ -144,6 +150,7 @@ struct _AwnPanelPrivate {
 
     guint autohide_start_timer_id;
     gboolean autohide_started;
+    gboolean autohide_hidden; /* fully hidden, animations paused */
     gboolean autohide_always_visible;
     gboolean autohide_inhibited;
 
@@ -510,6 +517,48 @@ awn_panel_drag_motion(GtkWidget* widget, GdkDragContext* context,
 }
 #endif
 
+/*
+ * Saves what the applets look like now, so that they can be shown right
+ * away on the next start.
+ */
+static gboolean
+awn_panel_save_placeholders(AwnPanel* panel)
+{
+    AwnPanelPrivate* priv = panel->priv;
+    GdkWindow* window = gtk_widget_get_window(GTK_WIDGET(panel));
+    cairo_surface_t* surface;
+    cairo_t* cr;
+    gint width, height;
+
+    if (!priv->startup_complete || !priv->composited || priv->autohide_started ||
+            !window || !gtk_widget_get_mapped(GTK_WIDGET(panel))) {
+        return TRUE;
+    }
+
+    gdk_drawable_get_size(window, &width, &height);
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+    cr = cairo_create(surface);
+    gdk_cairo_set_source_pixmap(cr, window, 0, 0);
+    cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+    cairo_paint(cr);
+    cairo_destroy(cr);
+    cairo_surface_flush(surface);
+
+    awn_applet_manager_save_placeholders(AWN_APPLET_MANAGER(priv->manager),
+                                         surface);
+    cairo_surface_destroy(surface);
+
+    return TRUE;
+}
+
+static gboolean
+on_quit_save_placeholders(AwnPanel* panel)
+{
+    panel->priv->placeholders_quit_id = 0;
+    awn_panel_save_placeholders(panel);
+    return FALSE;
+}
+
 static gboolean
 on_startup_complete(AwnPanel* panel)
 {
@@ -517,6 +566,15 @@ on_startup_complete(AwnPanel* panel)
 
     awn_panel_uninhibit_autohide(panel, panel->priv->startup_inhibit_cookie);
 
+    panel->priv->startup_complete = TRUE;
+    awn_panel_save_placeholders(panel);
+    panel->priv->placeholders_timer_id =
+        g_timeout_add_seconds_full(G_PRIORITY_LOW, 300,
+                                   (GSourceFunc)awn_panel_save_placeholders,
+                                   panel, NULL);
+
+    awn_startup_trace_mark("startup complete");
+
     return FALSE;
 }
 
@@ -571,6 +629,7 @@ awn_panel_constructed(GObject* object)
     AwnPanelPrivate* priv;
     GtkWidget*       panel;
     GdkScreen*       screen;
+    gint64           start = awn_startup_trace_now();
 
     priv = AWN_PANEL_GET_PRIVATE(object);
     panel = GTK_WIDGET(object);
@@ -609,6 +668,15 @@ awn_panel_constructed(GObject* object)
 
     /* Contents */
     priv->manager = awn_applet_manager_new_from_config(priv->client);
+    gchar* panel_name = g_strdup_printf("panel-%d", priv->panel_id);
+    gchar* placeholders_dir = g_build_filename(g_get_user_cache_dir(), "awn",
+                              "placeholders", panel_name, NULL);
+    awn_applet_manager_set_placeholders_dir(AWN_APPLET_MANAGER(priv->manager),
+                                            placeholders_dir);
+    g_free(placeholders_dir);
+    g_free(panel_name);
+    priv->placeholders_quit_id =
+        gtk_quit_add(1, (GtkFunction)on_quit_save_placeholders, panel);
     g_signal_connect_swapped(priv->manager, "applet-embedded",
                              G_CALLBACK(on_applet_embedded), panel);
     g_signal_connect_swapped(priv->manager, "applet-removed",
@@ -712,6 +780,8 @@ awn_panel_constructed(GObject* object)
     awn_utils_show_menu_images(GTK_MENU(priv->menu));
 
     gtk_widget_show_all(priv->menu);
+
+    awn_startup_trace_span("panel constructed", start);
 }
 
 static void
@@ -1464,6 +1534,32 @@ static gboolean awn_panel_check_mouse_pos(AwnPanel* panel,
     return FALSE;
 }
 
+/*
+ * Pauses the animations while the panel is hidden, both the panel's own
+ * and the applets' (which get told through the panel-hidden property).
+ * Only fading out takes the window off the screen, keep-below and
+ * transparentize leave the panel visible.
+ */
+static void
+awn_panel_set_autohide_hidden(AwnPanel* panel, gboolean hidden)
+{
+    AwnPanelPrivate* priv = panel->priv;
+    GValue value = {0};
+
+    if (priv->autohide_hidden == hidden) {
+        return;
+    }
+    priv->autohide_hidden = hidden;
+
+    awn_effects_set_paused_for_toplevel(GTK_WIDGET(panel), hidden);
+
+    g_value_init(&value, G_TYPE_BOOLEAN);
+    g_value_set_boolean(&value, hidden);
+    g_signal_emit(panel, _panel_signals[PROPERTY_CHANGED], 0,
+                  "panel-hidden", &value);
+    g_value_unset(&value);
+}
+
 /* Auto-hide fade out method */
 static gboolean
 alpha_blend_hide(gpointer data)
@@ -1486,6 +1582,7 @@ alpha_blend_hide(gpointer data)
         priv->autohide_always_visible = FALSE; /* see the note in start function */
         gdk_window_set_opacity(win, 1.0);
         gtk_widget_hide(GTK_WIDGET(panel));
+        awn_panel_set_autohide_hidden(panel, TRUE);
         return FALSE;
     }
 
@@ -1606,6 +1703,7 @@ poll_mouse_position(gpointer data)
             if (priv->autohide_started) {
                 priv->autohide_started = FALSE;
                 g_signal_emit(panel, _panel_signals[AUTOHIDE_END], 0);
+                awn_panel_set_autohide_hidden(panel, FALSE);
             }
         } else if (gtk_widget_get_mapped(GTK_WIDGET(widget))) {
             /* mouse is away, panel should start hiding */
@@ -1744,6 +1842,16 @@ awn_panel_dispose(GObject* object)
         priv->resize_timer_id = 0;
     }
 
+    if (priv->placeholders_timer_id) {
+        g_source_remove(priv->placeholders_timer_id);
+        priv->placeholders_timer_id = 0;
+    }
+
+    if (priv->placeholders_quit_id) {
+        gtk_quit_remove(priv->placeholders_quit_id);
+        priv->placeholders_quit_id = 0;
+    }
+
     if (priv->dbus_proxy) {
         g_object_unref(priv->dbus_proxy);
         priv->dbus_proxy = NULL;
@@ -2710,6 +2818,11 @@ awn_panel_expose(GtkWidget* widget, GdkEventExpose* event)
     g_return_val_if_fail(AWN_IS_PANEL(widget), FALSE);
     priv = AWN_PANEL(widget)->priv;
 
+    if (!priv->exposed) {
+        priv->exposed = TRUE;
+        awn_startup_trace_mark("first expose");
+    }
+
     if (priv->composited == FALSE) {
         /* we dont need to paint anything, it will be overlayed by the eventbox */
         child = gtk_bin_get_child(GTK_BIN(widget));
@@ -3071,6 +3184,7 @@ on_mouse_over(GtkWidget* widget, GdkEventCrossing* event)
     if (priv->autohide_started) {
         priv->autohide_started = FALSE;
         g_signal_emit(panel, _panel_signals[AUTOHIDE_END], 0);
+        awn_panel_set_autohide_hidden(panel, FALSE);
     }
 
     if (priv->mouse_poll_timer_id == 0 && poll_mouse_position(panel)) {
@@ -3106,6 +3220,7 @@ awn_panel_reset_autohide(AwnPanel* panel)
     if (priv->autohide_started) {
         priv->autohide_started = FALSE;
         g_signal_emit(panel, _panel_signals[AUTOHIDE_END], 0);
+        awn_panel_set_autohide_hidden(panel, FALSE);
     }
 }
 
@@ -3191,6 +3306,7 @@ awn_panel_set_style(AwnPanel* panel, gint style)
     AwnPathType path = AWN_PATH_LINEAR;
     gfloat offset_mod = 1.0;
     GType bg_type;
+    gint64 start;
 
     /* if the style hasn't changed and the background exist everything is done. */
     if (priv->style == style && priv->bg) {
@@ -3226,9 +3342,11 @@ awn_panel_set_style(AwnPanel* panel, gint style)
         g_assert_not_reached();
     }
 
+    start = awn_startup_trace_now();
     priv->bg = g_object_new(bg_type,
                             "client", priv->client,
                             "panel", panel, NULL);
+    awn_startup_trace_span("background", start);
 
     if (old_bg) {
         awn_background_set_glow(priv->bg, awn_background_get_glow(old_bg));
@@ -4062,6 +4180,17 @@ awn_panel_docklet_request(AwnPanel* panel,
     return window_id;
 }
 
+void
+awn_panel_get_applet_usage(AwnPanel* panel,
+                           AwnAppletUsageFunc func,
+                           gpointer user_data)
+{
+    g_return_if_fail(AWN_IS_PANEL(panel));
+
+    awn_applet_manager_foreach_usage(AWN_APPLET_MANAGER(panel->priv->manager),
+                                     func, user_data);
+}
+
 gboolean
 awn_panel_get_snapshot(AwnPanel* panel,
                        AwnImageStruct* image,
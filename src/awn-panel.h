@@ -30,6 +30,8 @@
 #include <libdesktop-agnostic/config.h>
 #include <libawn/libawn.h>
 
+#include "awn-applet-usage.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -132,6 +134,10 @@ gboolean    awn_panel_get_snapshot(AwnPanel* panel,
                                    AwnImageStruct* image,
                                    GError** error);
 
+void        awn_panel_get_applet_usage(AwnPanel* panel,
+                                       AwnAppletUsageFunc func,
+                                       gpointer user_data);
+
 gboolean    awn_panel_get_all_server_flags(AwnPanel* panel,
         GHashTable** hash,
         gchar*     name,
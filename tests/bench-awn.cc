@@ -0,0 +1,607 @@
+/*
+ * Copyright (C) 2026 Awn-core team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA.
+ */
+
+/*
+ Rendering benchmark: a row of task icons in a panel-like window is driven
+ through scripted scenarios.  Per scenario it reports frame time percentiles
+ (a frame being one expose of the window, or one icon rendered with
+ awn_effects_render_to_surface() for offscreen-render), CPU time and
+ X requests per frame, how many times the icon box was allocated and the RSS
+ at its end, as JSON when --output is given.
+
+ Window frames end once the X server has drawn them, the client time is
+ the part spent in the expose handlers queueing the requests.
+
+ theme-switch goes back and forth between the current icon theme and the
+ one given with --theme, it is reported as skipped without one.
+
+ This measures libawn's icons and effects in its own window, it doesn't
+ start avant-window-navigator or its applets: the per frame figures come
+ from this process' expose handlers and X connection.
+
+ Meant to be run on a private X server, see run-bench.sh (make bench).
+
+ Usage: bench-awn [--icons=N] [--size=N] [--effects=N] [--theme=NAME]
+                  [--scenario=NAME...] [--output=FILE] [icon-name...]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#include <gtk/gtk.h>
+#include <gdk/gdkx.h>
+#include <libawn/libawn.h>
+
+typedef struct {
+    const gchar* name;
+    void (*run)(void);
+    /* why the scenario can't run, NULL if it can */
+    const gchar* (*unavailable)(void);
+} Scenario;
+
+typedef struct {
+    GArray* frame_times; /* ms */
+    GArray* client_times; /* ms */
+    gdouble duration;    /* ms */
+    gdouble cpu_time;    /* ms */
+    gulong x_requests;
+    guint allocations;   /* of the icon box */
+    glong rss;           /* kB */
+} Result;
+
+static gint n_icons = 12;
+static gint icon_size = 48;
+static gint effects = -1;
+static gchar* other_theme = NULL;
+static gchar** scenario_names = NULL;
+static gchar* output = NULL;
+static gchar** icon_names = NULL;
+
+static GOptionEntry entries[] = {
+    { "icons", 'n', 0, G_OPTION_ARG_INT, &n_icons, "Number of task icons", "N" },
+    { "size", 's', 0, G_OPTION_ARG_INT, &icon_size, "Icon size", "N" },
+    { "effects", 'e', 0, G_OPTION_ARG_INT, &effects, "AwnEffects effects value", "N" },
+    { "theme", 't', 0, G_OPTION_ARG_STRING, &other_theme,
+      "Icon theme theme-switch switches to", "NAME" },
+    { "scenario", 0, 0, G_OPTION_ARG_STRING_ARRAY, &scenario_names,
+      "Run only this scenario (repeatable)", "NAME" },
+    { "output", 'o', 0, G_OPTION_ARG_FILENAME, &output, "Write JSON results to FILE", "FILE" },
+    { G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_STRING_ARRAY, &icon_names, NULL, NULL },
+    { NULL }
+};
+
+static const gchar* default_icon_names[] = {
+    "utilities-terminal",
+    "system-file-manager",
+    "web-browser",
+    "accessories-text-editor",
+    "help-browser",
+    "preferences-desktop",
+    NULL
+};
+
+static GtkWidget* window = NULL;
+static GPtrArray* icons = NULL;
+static GArray* frame_times = NULL;
+static GArray* client_times = NULL;
+static gdouble frame_start = 0.0;
+static gdouble frame_client_time = 0.0;
+static guint frame_end_id = 0;
+static guint box_allocations = 0;
+
+static gdouble
+now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static gdouble
+cpu_time_ms(void)
+{
+    struct rusage usage;
+
+    getrusage(RUSAGE_SELF, &usage);
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000.0 +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000.0;
+}
+
+static gulong
+x_request_serial(void)
+{
+    return NextRequest(GDK_DISPLAY_XDISPLAY(gdk_display_get_default()));
+}
+
+static glong
+rss_kb(void)
+{
+    gchar* contents = NULL;
+    glong size = 0, resident = 0;
+
+    if (g_file_get_contents("/proc/self/statm", &contents, NULL, NULL)) {
+        sscanf(contents, "%ld %ld", &size, &resident);
+        g_free(contents);
+    }
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+/* The icons don't have windows, so all their drawing happens in here */
+static gboolean
+on_expose_start(GtkWidget* widget, GdkEventExpose* event)
+{
+    frame_start = now_ms();
+    return FALSE;
+}
+
+/* Runs right after the expose, once GTK has copied the double buffer to
+ * the window, and waits for the server to draw it */
+static gboolean
+on_frame_end(gpointer data)
+{
+    gdouble frame_time;
+
+    XSync(GDK_DISPLAY_XDISPLAY(gdk_display_get_default()), False);
+    frame_time = now_ms() - frame_start;
+    frame_end_id = 0;
+
+    if (frame_times) {
+        g_array_append_val(frame_times, frame_time);
+        g_array_append_val(client_times, frame_client_time);
+    }
+    return FALSE;
+}
+
+static gboolean
+on_expose_end(GtkWidget* widget, GdkEventExpose* event)
+{
+    frame_client_time = now_ms() - frame_start;
+    if (!frame_end_id) {
+        frame_end_id = g_idle_add_full(G_PRIORITY_HIGH, on_frame_end, NULL, NULL);
+    }
+    return FALSE;
+}
+
+/* Once per size negotiation that reached the box, however many icons were
+ * shown or hidden before it */
+static void
+on_box_size_allocate(GtkWidget* box, GtkAllocation* alloc)
+{
+    box_allocations++;
+}
+
+static gboolean
+set_done(gboolean* done)
+{
+    *done = TRUE;
+    return FALSE;
+}
+
+static void
+run_for(guint ms)
+{
+    gboolean done = FALSE;
+
+    g_timeout_add(ms, (GSourceFunc)set_done, &done);
+    while (!done) {
+        gtk_main_iteration();
+    }
+}
+
+static AwnEffects*
+get_effects(guint i)
+{
+    return awn_overlayable_get_effects(AWN_OVERLAYABLE(g_ptr_array_index(icons, i)));
+}
+
+static void
+hover_sweep(void)
+{
+    for (guint i = 0; i < icons->len; i++) {
+        awn_effects_start(get_effects(i), AWN_EFFECT_HOVER);
+        run_for(150);
+        awn_effects_stop(get_effects(i), AWN_EFFECT_HOVER);
+    }
+    run_for(500);
+}
+
+static void
+attention_storm(void)
+{
+    for (guint i = 0; i < icons->len; i++) {
+        awn_effects_start(get_effects(i), AWN_EFFECT_ATTENTION);
+    }
+    run_for(3000);
+    for (guint i = 0; i < icons->len; i++) {
+        awn_effects_stop(get_effects(i), AWN_EFFECT_ATTENTION);
+    }
+    run_for(500);
+}
+
+static void
+set_icon_size(gint size)
+{
+    for (guint i = 0; i < icons->len; i++) {
+        awn_themed_icon_set_size(AWN_THEMED_ICON(g_ptr_array_index(icons, i)),
+                                 size);
+    }
+}
+
+static void
+resize(void)
+{
+    for (gint size = icon_size; size >= icon_size / 2; size -= 2) {
+        set_icon_size(size);
+        run_for(40);
+    }
+    for (gint size = icon_size / 2; size <= icon_size * 2; size += 2) {
+        set_icon_size(size);
+        run_for(40);
+    }
+    set_icon_size(icon_size);
+    run_for(500);
+}
+
+static gchar*
+get_icon_theme_name(void)
+{
+    gchar* theme = NULL;
+
+    g_object_get(gtk_settings_get_default(), "gtk-icon-theme-name", &theme, NULL);
+    return theme;
+}
+
+static gboolean
+icon_theme_installed(const gchar* name)
+{
+    gchar** path = NULL;
+    gint n_elements = 0;
+    gboolean found = FALSE;
+
+    gtk_icon_theme_get_search_path(gtk_icon_theme_get_default(), &path,
+                                   &n_elements);
+    for (gint i = 0; i < n_elements && !found; i++) {
+        gchar* index = g_build_filename(path[i], name, "index.theme", NULL);
+
+        found = g_file_test(index, G_FILE_TEST_IS_REGULAR);
+        g_free(index);
+    }
+    g_strfreev(path);
+    return found;
+}
+
+static const gchar*
+theme_switch_unavailable(void)
+{
+    gchar* theme;
+    gboolean same;
+
+    if (!other_theme) {
+        return "no --theme given";
+    }
+    if (!icon_theme_installed(other_theme)) {
+        return "the --theme isn't installed";
+    }
+    theme = get_icon_theme_name();
+    same = g_strcmp0(theme, other_theme) == 0;
+    g_free(theme);
+    return same ? "the --theme is the current theme" : NULL;
+}
+
+static void
+theme_switch(void)
+{
+    GtkSettings* settings = gtk_settings_get_default();
+    gchar* theme = get_icon_theme_name();
+
+    for (gint i = 0; i < 4; i++) {
+        gtk_settings_set_string_property(settings, "gtk-icon-theme-name",
+                                         i % 2 ? theme : other_theme, "bench-awn");
+        run_for(500);
+    }
+    g_free(theme);
+}
+
+/* Like the task manager does: the icons of the windows on the other
+ * workspace go away, those on the new one come back and a new one is active */
+static void
+workspace_switch(void)
+{
+    for (gint ws = 1; ws <= 8; ws++) {
+        for (guint i = 0; i < icons->len; i++) {
+            GtkWidget* icon = GTK_WIDGET(g_ptr_array_index(icons, i));
+
+            if (i % 2 == 0 || (gint)(i % 2) == ws % 2) {
+                gtk_widget_show(icon);
+            } else {
+                gtk_widget_hide(icon);
+            }
+            awn_icon_set_is_active(AWN_ICON(icon), i == (guint)ws % icons->len);
+        }
+        run_for(250);
+    }
+}
+
+/* Effects cost without X: every frame is one icon rendered to an image */
+static void
+offscreen_render(void)
+{
+    GtkAllocation alloc;
+    cairo_surface_t* surface;
+    /* the window's own exposes don't count */
+    GArray* times = frame_times;
+    GArray* window_client_times = client_times;
+
+    frame_times = NULL;
+    client_times = NULL;
+    gtk_widget_get_allocation(GTK_WIDGET(g_ptr_array_index(icons, 0)), &alloc);
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+                                         alloc.width, alloc.height);
+    for (guint i = 0; i < icons->len; i++) {
+        awn_effects_start(get_effects(i), AWN_EFFECT_HOVER);
+    }
+    for (gint frame = 0; frame < 100; frame++) {
+        for (guint i = 0; i < icons->len; i++) {
+            gdouble start = now_ms();
+            gdouble frame_time;
+
+            awn_effects_render_to_surface(get_effects(i), surface, 0, 0,
+                                          alloc.width, alloc.height, NULL, NULL);
+            cairo_surface_flush(surface);
+            frame_time = now_ms() - start;
+            g_array_append_val(times, frame_time);
+            g_array_append_val(window_client_times, frame_time);
+        }
+        /* advance the animations */
+        while (gtk_events_pending()) {
+            gtk_main_iteration();
+        }
+    }
+    for (guint i = 0; i < icons->len; i++) {
+        awn_effects_stop(get_effects(i), AWN_EFFECT_HOVER);
+    }
+    cairo_surface_destroy(surface);
+    run_for(500);
+    frame_times = times;
+    client_times = window_client_times;
+}
+
+static Scenario scenarios[] = {
+    { "hover-sweep", hover_sweep, NULL },
+    { "attention-storm", attention_storm, NULL },
+    { "resize", resize, NULL },
+    { "theme-switch", theme_switch, theme_switch_unavailable },
+    { "workspace-switch", workspace_switch, NULL },
+    { "offscreen-render", offscreen_render, NULL },
+    { NULL, NULL, NULL }
+};
+
+static gboolean
+scenario_selected(const gchar* name)
+{
+    if (!scenario_names) {
+        return TRUE;
+    }
+    for (gchar** s = scenario_names; *s; s++) {
+        if (strcmp(*s, name) == 0) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static gint
+compare_doubles(gconstpointer a, gconstpointer b)
+{
+    gdouble d = *(const gdouble*)a - *(const gdouble*)b;
+    return d < 0 ? -1 : d > 0 ? 1 : 0;
+}
+
+/* nearest-rank percentile of sorted times */
+static gdouble
+percentile(GArray* times, gdouble p)
+{
+    gint rank;
+
+    if (!times->len) {
+        return 0.0;
+    }
+    rank = (gint)ceil(p / 100.0 * times->len) - 1;
+    return g_array_index(times, gdouble, CLAMP(rank, 0, (gint)times->len - 1));
+}
+
+static void
+run_scenario(Scenario* scenario, Result* result)
+{
+    gdouble start, cpu_start;
+    gulong serial_start;
+
+    frame_times = g_array_new(FALSE, FALSE, sizeof(gdouble));
+    client_times = g_array_new(FALSE, FALSE, sizeof(gdouble));
+    start = now_ms();
+    cpu_start = cpu_time_ms();
+    serial_start = x_request_serial();
+    box_allocations = 0;
+
+    scenario->run();
+    gdk_display_sync(gdk_display_get_default());
+
+    result->duration = now_ms() - start;
+    result->cpu_time = cpu_time_ms() - cpu_start;
+    result->x_requests = x_request_serial() - serial_start;
+    result->allocations = box_allocations;
+    result->rss = rss_kb();
+    result->frame_times = frame_times;
+    result->client_times = client_times;
+    frame_times = NULL;
+    client_times = NULL;
+
+    g_array_sort(result->frame_times, compare_doubles);
+    g_array_sort(result->client_times, compare_doubles);
+}
+
+static void
+append_result(GString* json, const gchar* name, Result* result)
+{
+    guint frames = MAX(result->frame_times->len, 1);
+
+    g_string_append_printf(json,
+                           "    {\n"
+                           "      \"name\": \"%s\",\n"
+                           "      \"frames\": %u,\n"
+                           "      \"duration_ms\": %.3f,\n"
+                           "      \"frame_time_ms\": {\"p50\": %.3f, \"p90\": %.3f, "
+                           "\"p99\": %.3f, \"max\": %.3f},\n"
+                           "      \"client_time_ms\": {\"p50\": %.3f, \"p90\": %.3f, "
+                           "\"p99\": %.3f, \"max\": %.3f},\n"
+                           "      \"cpu_ms_per_frame\": %.3f,\n"
+                           "      \"x_requests_per_frame\": %.1f,\n"
+                           "      \"box_allocations\": %u,\n"
+                           "      \"rss_kb\": %ld\n"
+                           "    }",
+                           name, result->frame_times->len, result->duration,
+                           percentile(result->frame_times, 50),
+                           percentile(result->frame_times, 90),
+                           percentile(result->frame_times, 99),
+                           percentile(result->frame_times, 100),
+                           percentile(result->client_times, 50),
+                           percentile(result->client_times, 90),
+                           percentile(result->client_times, 99),
+                           percentile(result->client_times, 100),
+                           result->cpu_time / frames,
+                           (gdouble)result->x_requests / frames,
+                           result->allocations,
+                           result->rss);
+}
+
+static void
+create_icons(GtkWidget* box)
+{
+    gchar** names = icon_names ? icon_names : (gchar**)default_icon_names;
+    guint n_names = g_strv_length(names);
+
+    icons = g_ptr_array_new();
+    for (gint i = 0; i < n_icons; i++) {
+        GtkWidget* icon = awn_themed_icon_new();
+        gchar* uid = g_strdup_printf("bench-%d", i);
+
+        awn_themed_icon_set_info_simple(AWN_THEMED_ICON(icon), "bench-awn", uid,
+                                        names[i % n_names]);
+        awn_themed_icon_set_size(AWN_THEMED_ICON(icon), icon_size);
+        if (effects >= 0) {
+            g_object_set(awn_overlayable_get_effects(AWN_OVERLAYABLE(icon)),
+                         "effects", effects, NULL);
+        }
+        awn_icon_set_indicator_count(AWN_ICON(icon), i % 3);
+        gtk_container_add(GTK_CONTAINER(box), icon);
+        g_ptr_array_add(icons, icon);
+        g_free(uid);
+    }
+}
+
+gint
+main(gint argc, gchar** argv)
+{
+    GError* error = NULL;
+    GtkWidget* box;
+    GString* json;
+    gboolean first = TRUE;
+
+    if (!gtk_init_with_args(&argc, &argv, "[icon-name...]", entries, NULL,
+                            &error)) {
+        g_printerr("%s\n", error ? error->message : "Cannot open display");
+        return 1;
+    }
+
+    window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+    gtk_window_set_decorated(GTK_WINDOW(window), FALSE);
+    g_signal_connect(window, "expose-event", G_CALLBACK(on_expose_start), NULL);
+    g_signal_connect_after(window, "expose-event", G_CALLBACK(on_expose_end), NULL);
+
+    box = awn_icon_box_new();
+    awn_icon_box_set_pos_type(AWN_ICON_BOX(box), GTK_POS_BOTTOM);
+    gtk_container_add(GTK_CONTAINER(window), box);
+    g_signal_connect(box, "size-allocate", G_CALLBACK(on_box_size_allocate), NULL);
+    create_icons(box);
+    gtk_widget_show_all(window);
+
+    /* let the icons load and the window settle */
+    run_for(1000);
+
+    json = g_string_new(NULL);
+    g_string_append_printf(json, "{\n  \"icons\": %d,\n  \"size\": %d,\n"
+                           "  \"scenarios\": [\n", n_icons, icon_size);
+
+    for (Scenario* scenario = scenarios; scenario->name; scenario++) {
+        const gchar* unavailable;
+        Result result;
+
+        if (!scenario_selected(scenario->name)) {
+            continue;
+        }
+        if (!first) {
+            g_string_append(json, ",\n");
+        }
+        first = FALSE;
+
+        unavailable = scenario->unavailable ? scenario->unavailable() : NULL;
+        if (unavailable) {
+            g_print("%-18s skipped, %s\n", scenario->name, unavailable);
+            g_string_append_printf(json,
+                                   "    {\n"
+                                   "      \"name\": \"%s\",\n"
+                                   "      \"skipped\": \"%s\"\n"
+                                   "    }",
+                                   scenario->name, unavailable);
+            continue;
+        }
+        run_scenario(scenario, &result);
+
+        g_print("%-18s %5u frames  p50 %7.3f ms  p99 %7.3f ms  "
+                "client p50 %7.3f ms  "
+                "cpu %7.3f ms/frame  %6.1f X req/frame  %4u allocs  rss %ld kB\n",
+                scenario->name, result.frame_times->len,
+                percentile(result.frame_times, 50),
+                percentile(result.frame_times, 99),
+                percentile(result.client_times, 50),
+                result.cpu_time / MAX(result.frame_times->len, 1),
+                (gdouble)result.x_requests / MAX(result.frame_times->len, 1),
+                result.allocations, result.rss);
+
+        append_result(json, scenario->name, &result);
+        g_array_free(result.frame_times, TRUE);
+        g_array_free(result.client_times, TRUE);
+    }
+    g_string_append(json, "\n  ]\n}\n");
+
+    if (output && !g_file_set_contents(output, json->str, json->len, &error)) {
+        g_printerr("%s\n", error->message);
+        g_error_free(error);
+        return 1;
+    }
+
+    g_string_free(json, TRUE);
+    g_ptr_array_free(icons, TRUE);
+    gtk_widget_destroy(window);
+    return 0;
+}
@@ -0,0 +1,37 @@
+#!/bin/sh
+#
+# Runs a program (bench-awn by default) on a private Xvfb display, so that
+# nothing else draws or competes for the CPU while it measures.  The panel
+# itself isn't started, bench-awn draws libawn's icons in its own window.
+#
+# Usage: run-bench.sh [program] [args...]
+
+if [ $# -gt 0 ] && [ -x "$1" ]; then
+	BENCH="$1"
+	shift
+else
+	BENCH=./bench-awn
+fi
+
+SCREEN="1280x1024x24"
+
+if which xvfb-run > /dev/null 2>&1; then
+	exec xvfb-run -a -s "-screen 0 $SCREEN" "$BENCH" "$@"
+fi
+
+if ! which Xvfb > /dev/null 2>&1; then
+	echo "Xvfb not found" >&2
+	exit 1
+fi
+
+DISPLAY_NUM=99
+while [ -e "/tmp/.X$DISPLAY_NUM-lock" ]; do
+	DISPLAY_NUM=`expr $DISPLAY_NUM + 1`
+done
+
+Xvfb ":$DISPLAY_NUM" -screen 0 "$SCREEN" -nolisten tcp > /dev/null 2>&1 &
+XVFB_PID=$!
+trap 'kill $XVFB_PID 2> /dev/null' EXIT INT TERM
+sleep 1
+
+DISPLAY=":$DISPLAY_NUM" "$BENCH" "$@"
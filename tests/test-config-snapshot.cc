@@ -0,0 +1,280 @@
+/*
+ * Copyright (C) 2026 Awn-core team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA.
+ */
+
+/*
+ Binds objects to a key of a config snapshot and checks that:
+  - a burst of changes reaches every bound object as one property update
+    carrying the last value,
+  - unbound and finalized objects aren't updated any more,
+  - a property handler unbinding another object during an update is safe,
+  - dropping the client removes the snapshot's notifies.
+
+ The key lives in a throwaway schema, its instance is reset at the end.
+ Exits with 77 (skipped) when the configuration backend isn't usable.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <glib-object.h>
+
+#include "libawn/awn-config.h"
+
+#define GROUP "DEFAULT"
+#define KEY "value"
+
+/* an object counting the updates of its "value" property */
+
+typedef struct {
+    GObject parent;
+
+    gint value;
+    guint updates;
+    AwnConfigSnapshot* snapshot;
+    GObject* unbind_on_update; /* unbound from the snapshot on update */
+} TestTarget;
+
+typedef struct {
+    GObjectClass parent_class;
+} TestTargetClass;
+
+G_DEFINE_TYPE(TestTarget, test_target, G_TYPE_OBJECT)
+
+#define TEST_TYPE_TARGET (test_target_get_type())
+#define TEST_TARGET(obj) (G_TYPE_CHECK_INSTANCE_CAST((obj), TEST_TYPE_TARGET, TestTarget))
+
+enum {
+    PROP_0,
+    PROP_VALUE
+};
+
+static void
+test_target_set_property(GObject* object, guint prop_id,
+                         const GValue* value, GParamSpec* pspec)
+{
+    TestTarget* target = TEST_TARGET(object);
+
+    switch (prop_id) {
+    case PROP_VALUE:
+        target->value = g_value_get_int(value);
+        target->updates++;
+        if (target->unbind_on_update) {
+            awn_config_snapshot_unbind_all_for_object(target->snapshot,
+                    target->unbind_on_update);
+            target->unbind_on_update = NULL;
+        }
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+    }
+}
+
+static void
+test_target_get_property(GObject* object, guint prop_id,
+                         GValue* value, GParamSpec* pspec)
+{
+    switch (prop_id) {
+    case PROP_VALUE:
+        g_value_set_int(value, TEST_TARGET(object)->value);
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+    }
+}
+
+static void
+test_target_class_init(TestTargetClass* klass)
+{
+    GObjectClass* obj_class = G_OBJECT_CLASS(klass);
+
+    obj_class->set_property = test_target_set_property;
+    obj_class->get_property = test_target_get_property;
+
+    g_object_class_install_property(obj_class, PROP_VALUE,
+                                    g_param_spec_int("value", "Value", "Value",
+                                            G_MININT, G_MAXINT, 0,
+                                            G_PARAM_READWRITE));
+}
+
+static void
+test_target_init(TestTarget* target)
+{
+}
+
+static TestTarget*
+target_new(AwnConfigSnapshot* snapshot)
+{
+    TestTarget* target = TEST_TARGET(g_object_new(TEST_TYPE_TARGET, NULL));
+    GError* error = NULL;
+
+    target->snapshot = snapshot;
+    if (!awn_config_snapshot_bind(snapshot, KEY, G_OBJECT(target), "value",
+                                  &error)) {
+        g_printerr("Cannot bind to the snapshot: %s\n", error->message);
+        exit(1);
+    }
+    return target;
+}
+
+static gboolean
+quit_loop(GMainLoop* loop)
+{
+    g_main_loop_quit(loop);
+    return FALSE;
+}
+
+/* Long enough for the backend to notify and the snapshot to flush */
+static void
+settle(void)
+{
+    GMainLoop* loop = g_main_loop_new(NULL, FALSE);
+
+    g_timeout_add(500, (GSourceFunc)quit_loop, loop);
+    g_main_loop_run(loop);
+    g_main_loop_unref(loop);
+}
+
+static void
+set_value(DesktopAgnosticConfigClient* client, gint value)
+{
+    GError* error = NULL;
+
+    desktop_agnostic_config_client_set_int(client, GROUP, KEY, value, &error);
+    if (error) {
+        g_printerr("Cannot set the value: %s\n", error->message);
+        exit(1);
+    }
+}
+
+static guint failures = 0;
+
+static void
+check(const gchar* what, TestTarget* target, guint updates, gint value)
+{
+    if (target->updates != updates || target->value != value) {
+        g_warning("%s: %u updates to %d, expected %u to %d", what,
+                  target->updates, target->value, updates, value);
+        failures++;
+    }
+}
+
+static gchar*
+write_schema(const gchar* dir)
+{
+    gchar* path = g_build_filename(dir, "awn-test-config-snapshot.schema-ini",
+                                   NULL);
+    const gchar* contents =
+        "[DEFAULT]\n"
+        "single_instance = false\n"
+        "\n"
+        "[" GROUP "/" KEY "]\n"
+        "type = integer\n"
+        "default = 0\n"
+        "description=Value bound by test-config-snapshot.\n";
+
+    g_file_set_contents(path, contents, -1, NULL);
+    return path;
+}
+
+gint
+main(gint argc, gchar** argv)
+{
+    gchar dir[] = "/tmp/test-config-snapshot-XXXXXX";
+    gchar* schema_path;
+    DesktopAgnosticConfigSchema* schema;
+    DesktopAgnosticConfigClient* client;
+    AwnConfigSnapshot* snapshot;
+    TestTarget* first, *second, *unbinder, *unbound;
+    GError* error = NULL;
+
+    g_type_init();
+
+    if (!mkdtemp(dir)) {
+        g_printerr("Cannot create a temporary directory\n");
+        return 1;
+    }
+    schema_path = write_schema(dir);
+    schema = desktop_agnostic_config_schema_new(schema_path, &error);
+    g_unlink(schema_path);
+    g_rmdir(dir);
+    g_free(schema_path);
+    client = error ? NULL :
+             desktop_agnostic_config_client_new_for_schema(schema, "test", &error);
+    if (error) {
+        g_printerr("SKIPPED: no usable configuration backend: %s\n",
+                   error->message);
+        g_error_free(error);
+        return 77;
+    }
+
+    set_value(client, 0);
+    settle();
+
+    snapshot = awn_config_snapshot_get(client, GROUP);
+    first = target_new(snapshot);
+    second = target_new(snapshot);
+    check("bind", first, 1, 0);
+    check("bind", second, 1, 0);
+
+    /* a burst is applied once, with its last value */
+    for (gint i = 1; i <= 50; i++) {
+        set_value(client, i);
+    }
+    settle();
+    check("burst", first, 2, 50);
+    check("burst", second, 2, 50);
+
+    /* and a later change once more */
+    set_value(client, 51);
+    settle();
+    check("second flush", first, 3, 51);
+
+    awn_config_snapshot_unbind_all_for_object(snapshot, G_OBJECT(second));
+    g_object_unref(second);
+    set_value(client, 52);
+    settle();
+    check("after unbinding", first, 4, 52);
+
+    /* unbinding an object bound after the updated one, from its handler */
+    unbinder = target_new(snapshot);
+    unbound = target_new(snapshot);
+    unbinder->unbind_on_update = G_OBJECT(unbound);
+    set_value(client, 53);
+    settle();
+    check("unbinder", unbinder, 2, 53);
+    check("unbound from a handler", unbound, 1, 52);
+
+    /* finalizing unbinds too */
+    g_object_unref(first);
+    set_value(client, 54);
+    settle();
+    check("after finalizing", unbinder, 3, 54);
+
+    /* the snapshot goes with the client, leaving the objects alone */
+    desktop_agnostic_config_client_reset(client, FALSE, NULL);
+    g_object_unref(client);
+    g_object_unref(schema);
+    settle();
+    check("after the client", unbinder, 3, 54);
+    g_object_unref(unbinder);
+    g_object_unref(unbound);
+
+    g_print("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,223 @@
+/*
+ * Copyright (C) 2026 Awn-core team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA.
+ */
+
+/*
+ Runs the taskmanager's desktop file lookup over a synthetic applications
+ dir.  Every query is built from one desktop file and has to find exactly
+ that file through the substring fallbacks (the ones going through the
+ trigram index); queries for nothing have to find nothing.  A second lookup
+ made with AWN_DESKTOP_LOOKUP_NO_INDEX, which scans desktop_list as the
+ lookup did before the index, has to give the same results.
+
+ Usage: test-desktop-lookup-index [entries] [rounds]
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <libdesktop-agnostic/vfs.h>
+
+#include "applets/taskmanager/awn-desktop-lookup-cached.h"
+
+typedef enum {
+    QUERY_EXEC_PREFIX,  /* full command line starting with the Exec */
+    QUERY_EXEC_SUB,     /* part of the Exec */
+    QUERY_EXEC_TITLE,   /* shared part of the Exec, the Name in the title */
+    QUERY_PATH,         /* command matching the desktop file name */
+    QUERY_MISSING,
+
+    QUERY_LAST
+} QueryType;
+
+static const gchar* query_names[] = {
+    "exec prefix", "exec substring", "exec and title", "path", "missing"
+};
+
+static gchar*
+desktop_path(const gchar* dir, guint i)
+{
+    gchar* name = g_strdup_printf("app-%05u-tool.desktop", i);
+    gchar* path = g_build_filename(dir, name, NULL);
+
+    g_free(name);
+    return path;
+}
+
+static void
+write_corpus(const gchar* dir, guint count)
+{
+    for (guint i = 0; i < count; i++) {
+        gchar* path = desktop_path(dir, i);
+        gchar* contents = g_strdup_printf("[Desktop Entry]\n"
+                                          "Type=Application\n"
+                                          "Name=App %05u\n"
+                                          "Exec=/usr/bin/app-%05u-tool --opt %%U\n",
+                                          i, i);
+
+        g_file_set_contents(path, contents, -1, NULL);
+        g_free(contents);
+        g_free(path);
+    }
+}
+
+static void
+remove_corpus(const gchar* root, const gchar* dir, guint count)
+{
+    for (guint i = 0; i < count; i++) {
+        gchar* path = desktop_path(dir, i);
+        g_unlink(path);
+        g_free(path);
+    }
+    g_rmdir(dir);
+    g_rmdir(root);
+}
+
+/* Returns what the lookup found for query type of entry i */
+static gchar*
+lookup(AwnDesktopLookupCached* lookup, QueryType type, guint i)
+{
+    gchar* full_cmd = NULL;
+    gchar* cmd = NULL;
+    gchar* title = NULL;
+    gchar* result;
+
+    switch (type) {
+    case QUERY_EXEC_PREFIX:
+        full_cmd = g_strdup_printf("/usr/bin/app-%05u-tool --opt /tmp/file", i);
+        break;
+    case QUERY_EXEC_SUB:
+        full_cmd = g_strdup_printf("app-%05u-tool --opt", i);
+        break;
+    case QUERY_EXEC_TITLE:
+        full_cmd = g_strdup("-tool --opt");
+        title = g_strdup_printf("Document - App %05u", i);
+        break;
+    case QUERY_PATH:
+        cmd = g_strdup_printf("app-%05u-tool", i);
+        break;
+    default:
+        full_cmd = g_strdup_printf("/usr/bin/missing-%05u", i);
+        cmd = g_strdup_printf("missing-%05u", i);
+        break;
+    }
+
+    result = awn_desktop_lookup_search_by_window_data(lookup, NULL, NULL, cmd,
+             full_cmd, title ? title : "");
+    g_free(full_cmd);
+    g_free(cmd);
+    g_free(title);
+    return result;
+}
+
+gint
+main(gint argc, gchar** argv)
+{
+    guint count = argc > 1 ? atoi(argv[1]) : 5000;
+    guint rounds = argc > 2 ? atoi(argv[2]) : 100;
+    gchar root[] = "/tmp/test-desktop-lookup-XXXXXX";
+    gchar* data_dir;
+    gchar* apps_dir;
+    AwnDesktopLookupCached* desktop_lookup;
+    AwnDesktopLookupCached* linear_lookup;
+    GTimer* timer;
+    GError* error = NULL;
+    gdouble build_time;
+    gdouble query_time[QUERY_LAST] = { 0.0 };
+    gdouble linear_time[QUERY_LAST] = { 0.0 };
+    guint failures = 0;
+
+    if (!mkdtemp(root)) {
+        g_printerr("Cannot create a temporary directory\n");
+        return 1;
+    }
+    data_dir = g_build_filename(root, "share", NULL);
+    apps_dir = g_build_filename(data_dir, "applications", NULL);
+    g_mkdir_with_parents(apps_dir, 0700);
+    write_corpus(apps_dir, count);
+
+    /* only the corpus, GLib reads these once, before anything else does */
+    g_setenv("XDG_DATA_DIRS", data_dir, TRUE);
+    g_setenv("XDG_DATA_HOME", root, TRUE);
+
+    g_type_init();
+    desktop_agnostic_vfs_init(&error);
+    if (error) {
+        g_printerr("Cannot initialize VFS: %s\n", error->message);
+        g_error_free(error);
+        remove_corpus(root, apps_dir, count);
+        return 1;
+    }
+
+    timer = g_timer_new();
+    desktop_lookup = awn_desktop_lookup_cached_new();
+    build_time = g_timer_elapsed(timer, NULL);
+
+    g_setenv("AWN_DESKTOP_LOOKUP_NO_INDEX", "1", TRUE);
+    linear_lookup = awn_desktop_lookup_cached_new();
+    g_unsetenv("AWN_DESKTOP_LOOKUP_NO_INDEX");
+
+    for (guint round = 0; round < rounds; round++) {
+        guint i = (round * 7919) % count;
+
+        for (gint type = 0; type < QUERY_LAST; type++) {
+            gchar* expected = type == QUERY_MISSING ? NULL : desktop_path(apps_dir, i);
+            gchar* result;
+            gchar* linear_result;
+
+            g_timer_start(timer);
+            result = lookup(desktop_lookup, (QueryType)type, i);
+            query_time[type] += g_timer_elapsed(timer, NULL);
+
+            g_timer_start(timer);
+            linear_result = lookup(linear_lookup, (QueryType)type, i);
+            linear_time[type] += g_timer_elapsed(timer, NULL);
+
+            if (g_strcmp0(result, expected) != 0) {
+                g_warning("%s query for entry %u found %s instead of %s",
+                          query_names[type], i, result, expected);
+                failures++;
+            }
+            if (g_strcmp0(result, linear_result) != 0) {
+                g_warning("%s query for entry %u found %s, the linear scan %s",
+                          query_names[type], i, result, linear_result);
+                failures++;
+            }
+            g_free(linear_result);
+            g_free(result);
+            g_free(expected);
+        }
+    }
+
+    g_print("entries: %u, queries: %u\n", count, rounds * QUERY_LAST);
+    g_print("lookup build: %.3f ms\n", build_time * 1000.0);
+    for (gint type = 0; type < QUERY_LAST; type++) {
+        g_print("%s: %.2f us/query, linear scan %.2f us/query\n", query_names[type],
+                query_time[type] * 1e6 / rounds, linear_time[type] * 1e6 / rounds);
+    }
+    g_print("%s\n", failures ? "FAILED" : "OK");
+
+    g_object_unref(linear_lookup);
+    g_object_unref(desktop_lookup);
+    g_timer_destroy(timer);
+    remove_corpus(root, apps_dir, count);
+    g_free(apps_dir);
+    g_free(data_dir);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,143 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+#  Copyright © 2026 Awn-core team
+#
+#  This program is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation; either version 2 of the License, or
+#  (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software
+#  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA.
+
+# Floods a taskmanager item with UpdateDockItem calls and checks the dock
+# coalesced them: a burst of changes inside one frame has to be applied by
+# exactly one flush carrying the last value, and a change made after that
+# frame by a second flush.
+#
+# Usage: test-dock-manager-flood.py [--private] [updates]
+#
+# With --private a private session bus is started and the dock is run on it
+# (needs a running X server), otherwise the dock on the current session bus
+# is used.  Exits with 77 (skipped) if the burst couldn't be sent within a
+# frame.
+
+import os
+import subprocess
+import sys
+import time
+
+import dbus
+
+DOCK_MANAGER = 'net.launchpad.DockManager'
+DOCK_MANAGER_PATH = '/net/launchpad/DockManager'
+DOCK_ITEM_IFACE = 'net.launchpad.DockItem'
+FRAME = 0.040
+
+updates = 50
+private = False
+for arg in sys.argv[1:]:
+    if arg == '--private':
+        private = True
+    else:
+        updates = int(arg)
+
+
+def stats(props):
+    return [int(v) for v in props.Get(DOCK_ITEM_IFACE, 'AwnUpdateStats')]
+
+
+def last_flush(props):
+    return dict(props.Get(DOCK_ITEM_IFACE, 'AwnLastFlush'))
+
+
+def check(what, flush, progress, message):
+    if flush.get('progress') != progress or flush.get('message') != message:
+        print 'FAILED: %s flush applied %r, expected progress %d, message %r' \
+            % (what, flush, progress, message)
+        sys.exit(1)
+
+
+children = []
+if private:
+    daemon = subprocess.Popen(['dbus-daemon', '--session', '--nofork',
+                               '--print-address=1'],
+                              stdout=subprocess.PIPE)
+    children.append(daemon)
+    os.environ['DBUS_SESSION_BUS_ADDRESS'] = daemon.stdout.readline().strip()
+    children.append(subprocess.Popen(['avant-window-navigator']))
+
+try:
+    bus = dbus.SessionBus()
+    for i in range(100):
+        if bus.name_has_owner(DOCK_MANAGER):
+            break
+        time.sleep(0.1)
+    else:
+        print 'No %s on the bus' % DOCK_MANAGER
+        sys.exit(1)
+
+    manager = bus.get_object(DOCK_MANAGER, DOCK_MANAGER_PATH)
+    paths = manager.GetItems(dbus_interface=DOCK_MANAGER)
+    if not paths:
+        print 'The dock has no items'
+        sys.exit(1)
+
+    item = bus.get_object(DOCK_MANAGER, paths[0])
+    props = dbus.Interface(item, 'org.freedesktop.DBus.Properties')
+
+    # let anything still pending flush first
+    time.sleep(FRAME * 3)
+    before = stats(props)
+
+    # the burst, only the last call waits for its reply so that all of them
+    # reach the dock before the first frame is over
+    start = time.time()
+    for i in range(updates):
+        item.UpdateDockItem({'progress': dbus.Int32(i % 100),
+                             'message': 'burst %d' % i},
+                            dbus_interface=DOCK_ITEM_IFACE,
+                            ignore_reply=(i < updates - 1))
+    elapsed = time.time() - start
+    time.sleep(FRAME * 3)
+
+    burst = stats(props)
+    received, coalesced, dropped, flushes = \
+        [a - b for a, b in zip(burst, before)]
+
+    print 'updates: %d in %.3f ms' % (updates, elapsed * 1000)
+    print 'hints received: %d, coalesced: %d, unchanged: %d' % \
+        (received, coalesced, dropped)
+
+    if elapsed >= FRAME:
+        print 'SKIPPED: the burst took longer than a frame'
+        sys.exit(77)
+    if flushes != 1:
+        print 'FAILED: the burst was applied by %d flushes, expected 1' % \
+            flushes
+        sys.exit(1)
+    check('burst', last_flush(props), (updates - 1) % 100,
+          'burst %d' % (updates - 1))
+
+    # a change after the frame is over gets a flush of its own
+    item.UpdateDockItem({'progress': dbus.Int32(-1), 'message': ''},
+                        dbus_interface=DOCK_ITEM_IFACE)
+    time.sleep(FRAME * 3)
+
+    flushes = stats(props)[3] - before[3]
+    if flushes != 2:
+        print 'FAILED: %d flushes after the second change, expected 2' % \
+            flushes
+        sys.exit(1)
+    check('second', last_flush(props), -1, '')
+    print 'OK'
+finally:
+    for child in reversed(children):
+        child.terminate()
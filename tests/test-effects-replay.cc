@@ -0,0 +1,320 @@
+/*
+ * Copyright (C) 2026 Awn-core team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA.
+ */
+
+/*
+ Records every effect style playing all its animations on real timers, and
+ replays recordings on the virtual clock, rendering each frame offscreen.
+
+ The replay prints the render time and a checksum of the pixels for every
+ frame.  Given the output of an earlier replay as reference it fails when
+ any checksum differs; it also fails when the animation state differs from
+ the recorded one.  Neither mode needs a display.
+
+ Without arguments, as run by make check, it replays effects-simple.recording
+ from $srcdir and only checks the animation state.
+
+ Usage: test-effects-replay record FILE
+        test-effects-replay replay FILE [REFERENCE]
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <gtk/gtk.h>
+#include <libawn/libawn.h>
+
+#include "libawn/awn-effects-replay.h"
+
+#define ICON_SIZE 48
+#define N_STYLES 9
+#define CHECK_RECORDING "effects-simple.recording"
+
+static gboolean animation_ended = FALSE;
+
+static cairo_surface_t*
+create_icon_source(void)
+{
+    cairo_surface_t* surface;
+    cairo_pattern_t* pattern;
+    cairo_t* cr;
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+                                         ICON_SIZE, ICON_SIZE);
+    cr = cairo_create(surface);
+    pattern = cairo_pattern_create_linear(0, 0, ICON_SIZE, ICON_SIZE);
+    cairo_pattern_add_color_stop_rgba(pattern, 0.0, 0.2, 0.4, 0.9, 1.0);
+    cairo_pattern_add_color_stop_rgba(pattern, 1.0, 0.9, 0.5, 0.1, 0.8);
+    cairo_set_source(cr, pattern);
+    awn_cairo_rounded_rect(cr, 2, 2, ICON_SIZE - 4, ICON_SIZE - 4, 8, ROUND_ALL);
+    cairo_fill(cr);
+    cairo_pattern_destroy(pattern);
+    cairo_destroy(cr);
+
+    return surface;
+}
+
+static AwnEffects*
+create_effects(void)
+{
+    GtkWidget* widget = gtk_drawing_area_new();
+    AwnEffects* fx;
+    cairo_surface_t* source;
+
+    g_object_ref_sink(widget);
+    fx = awn_effects_new_for_widget(widget);
+    awn_effects_set_icon_size(fx, ICON_SIZE, ICON_SIZE, FALSE);
+
+    source = create_icon_source();
+    awn_effects_set_icon_source(fx, source);
+    cairo_surface_destroy(source);
+
+    return fx;
+}
+
+static void
+on_animation_end(AwnEffects* fx, AwnEffect effect)
+{
+    animation_ended = TRUE;
+}
+
+static gboolean
+set_done(gboolean* done)
+{
+    *done = TRUE;
+    return FALSE;
+}
+
+static void
+run_for(guint ms)
+{
+    gboolean done = FALSE;
+
+    g_timeout_add(ms, (GSourceFunc)set_done, &done);
+    while (!done) {
+        g_main_context_iteration(NULL, TRUE);
+    }
+}
+
+static void
+play(AwnEffects* fx, AwnEffect effect, gint loops, guint stop_after)
+{
+    gboolean timed_out = FALSE;
+    guint timeout;
+
+    animation_ended = FALSE;
+    awn_effects_start_ex(fx, effect, loops, FALSE, TRUE);
+    if (stop_after) {
+        run_for(stop_after);
+        awn_effects_stop(fx, effect);
+    }
+
+    timeout = g_timeout_add(10000, (GSourceFunc)set_done, &timed_out);
+    while (!animation_ended && !timed_out) {
+        g_main_context_iteration(NULL, TRUE);
+    }
+    if (timed_out) {
+        g_warning("Effect %d with effects %x didn't end", effect,
+                  (guint)fx->set_effects);
+        awn_effects_stop(fx, effect);
+    } else {
+        g_source_remove(timeout);
+    }
+}
+
+static gint
+record(const gchar* filename)
+{
+    AwnEffects* fx = create_effects();
+    AwnEffectsRecording* recording = awn_effects_recording_new();
+    GError* error = NULL;
+    gint result = 0;
+
+    g_signal_connect(fx, "animation-end", G_CALLBACK(on_animation_end), NULL);
+    awn_effects_record(fx, recording);
+
+    for (gint style = 0; style < N_STYLES; style++) {
+        g_object_set(fx, "effects", style * 0x11111, NULL);
+
+        play(fx, AWN_EFFECT_OPENING, 1, 0);
+        play(fx, AWN_EFFECT_HOVER, 0, 600);
+        play(fx, AWN_EFFECT_LAUNCHING, 1, 0);
+        play(fx, AWN_EFFECT_ATTENTION, 2, 0);
+        play(fx, AWN_EFFECT_CLOSING, 1, 0);
+    }
+    awn_effects_record(fx, NULL);
+
+    g_print("%u frames recorded\n", awn_effects_recording_get_n_frames(recording));
+    if (!awn_effects_recording_save(recording, filename, &error)) {
+        g_printerr("%s\n", error->message);
+        g_error_free(error);
+        result = 1;
+    }
+
+    awn_effects_recording_free(recording);
+    return result;
+}
+
+typedef struct {
+    cairo_surface_t* target;
+    GArray* checksums;
+    gdouble render_time;
+} Replay;
+
+/* FNV-1a over the visible pixels */
+static guint32
+checksum(cairo_surface_t* surface)
+{
+    const guchar* data = cairo_image_surface_get_data(surface);
+    gint stride = cairo_image_surface_get_stride(surface);
+    gint row = cairo_image_surface_get_width(surface) * 4;
+    guint32 hash = 2166136261u;
+
+    for (gint y = 0; y < cairo_image_surface_get_height(surface); y++) {
+        for (gint i = 0; i < row; i++) {
+            hash = (hash ^ data[y * stride + i]) * 16777619u;
+        }
+    }
+    return hash;
+}
+
+static void
+on_frame(AwnEffects* fx, guint frame, gint64 time, Replay* replay)
+{
+    struct timespec start, end;
+    gdouble render_time;
+    guint32 sum;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    awn_effects_render_to_surface(fx, replay->target, 0, 0,
+                                  cairo_image_surface_get_width(replay->target),
+                                  cairo_image_surface_get_height(replay->target),
+                                  NULL, NULL);
+    cairo_surface_flush(replay->target);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    render_time = (end.tv_sec - start.tv_sec) * 1000.0 +
+                  (end.tv_nsec - start.tv_nsec) / 1000000.0;
+    replay->render_time += render_time;
+
+    sum = checksum(replay->target);
+    g_array_append_val(replay->checksums, sum);
+
+    g_print("frame %u %" G_GINT64_FORMAT " ms render %.3f ms checksum %08x\n",
+            frame, time, render_time, sum);
+}
+
+static GArray*
+load_reference(const gchar* filename)
+{
+    GArray* checksums = g_array_new(FALSE, FALSE, sizeof(guint32));
+    gchar* contents;
+    gchar** lines;
+
+    if (!g_file_get_contents(filename, &contents, NULL, NULL)) {
+        g_printerr("Cannot read %s\n", filename);
+        return checksums;
+    }
+    lines = g_strsplit(contents, "\n", -1);
+    for (gchar** line = lines; *line; line++) {
+        guint32 sum;
+        const gchar* s = strstr(*line, "checksum ");
+
+        if (g_str_has_prefix(*line, "frame ") && s &&
+                sscanf(s, "checksum %x", &sum) == 1) {
+            g_array_append_val(checksums, sum);
+        }
+    }
+    g_strfreev(lines);
+    g_free(contents);
+    return checksums;
+}
+
+static gint
+replay(const gchar* filename, const gchar* reference)
+{
+    AwnEffectsRecording* recording;
+    AwnEffects* fx;
+    GError* error = NULL;
+    Replay data;
+    guint mismatches, different = 0;
+
+    recording = awn_effects_recording_load(filename, &error);
+    if (!recording) {
+        g_printerr("%s\n", error->message);
+        g_error_free(error);
+        return 1;
+    }
+
+    fx = create_effects();
+    data.target = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+                  ICON_SIZE * 2, ICON_SIZE * 2);
+    data.checksums = g_array_new(FALSE, FALSE, sizeof(guint32));
+    data.render_time = 0.0;
+
+    mismatches = awn_effects_replay(fx, recording, (AwnEffectsReplayFunc)on_frame,
+                                    &data);
+
+    g_print("%u frames, %.3f ms rendering, %u not in the recorded state\n",
+            data.checksums->len, data.render_time, mismatches);
+
+    if (reference) {
+        GArray* expected = load_reference(reference);
+
+        for (guint i = 0; i < MAX(expected->len, data.checksums->len); i++) {
+            if (i >= expected->len || i >= data.checksums->len ||
+                    g_array_index(expected, guint32, i) !=
+                    g_array_index(data.checksums, guint32, i)) {
+                different++;
+            }
+        }
+        g_print("%u frames differ from %s\n", different, reference);
+        g_array_free(expected, TRUE);
+    }
+
+    g_array_free(data.checksums, TRUE);
+    cairo_surface_destroy(data.target);
+    awn_effects_recording_free(recording);
+    return mismatches || different ? 1 : 0;
+}
+
+gint
+main(gint argc, gchar** argv)
+{
+    /* nothing is shown, carry on without a display */
+    gtk_init_check(&argc, &argv);
+
+    if (argc == 1) {
+        const gchar* srcdir = g_getenv("srcdir");
+        gchar* filename = g_build_filename(srcdir ? srcdir : ".",
+                                           CHECK_RECORDING, NULL);
+        gint result = replay(filename, NULL);
+
+        g_free(filename);
+        return result;
+    }
+    if (argc >= 3 && strcmp(argv[1], "record") == 0) {
+        return record(argv[2]);
+    }
+    if (argc >= 3 && strcmp(argv[1], "replay") == 0) {
+        return replay(argv[2], argc > 3 ? argv[3] : NULL);
+    }
+
+    g_printerr("Usage: %s record FILE\n"
+               "       %s replay FILE [REFERENCE]\n", argv[0], argv[0]);
+    return 2;
+}
@@ -0,0 +1,376 @@
+/*
+ * Copyright (C) 2026 Awn-core team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA.
+ */
+
+/*
+ Checks libawn's icon scaler on generated icons, so nothing depends on the
+ icons installed:
+  - the results have the requested size, as pixbuf and as surface,
+  - flat and fully transparent icons stay flat and transparent,
+  - colour under transparent pixels doesn't bleed into the visible ones,
+  - scaling to the source size keeps the icon,
+  - the results are within MIN_PSNR of GDK_INTERP_HYPER's.
+
+ With --bench it instead times the scaler against GDK_INTERP_HYPER and
+ GDK_INTERP_BILINEAR on the large icons found in the given directories (or
+ the generated ones if there are none) and prints the PSNR against HYPER,
+ on premultiplied pixels so invisible colour doesn't count.  make bench
+ runs it that way.
+
+ Usage: test-icon-scaling [--bench [size] [dir...]]
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+#include "libawn/awn-pixbuf-scale.h"
+
+/* below this awn_pixbuf_scale() visibly differs from HYPER */
+#define MIN_PSNR 30.0
+
+static const gchar* default_dirs[] = {
+    "/usr/share/icons/hicolor/256x256/apps",
+    "/usr/share/icons/hicolor/512x512/apps",
+    NULL
+};
+
+typedef enum {
+    ICON_DISC,          /* shaded disc with a soft edge */
+    ICON_GLYPH,         /* hard edged bars on a rounded square */
+    ICON_FLAT,          /* one opaque colour */
+    ICON_TRANSPARENT,   /* nothing visible, colour in the invisible pixels */
+    ICON_HALF_VISIBLE,  /* opaque red left, invisible green right */
+    N_ICONS
+} IconKind;
+
+static const gchar* icon_names[] = {
+    "disc", "glyph", "flat", "transparent", "half visible"
+};
+
+static void
+set_pixel(GdkPixbuf* pixbuf, gint x, gint y,
+          guchar r, guchar g, guchar b, guchar a)
+{
+    guchar* p = gdk_pixbuf_get_pixels(pixbuf) +
+                y * gdk_pixbuf_get_rowstride(pixbuf) + x * 4;
+
+    p[0] = r;
+    p[1] = g;
+    p[2] = b;
+    p[3] = a;
+}
+
+static GdkPixbuf*
+make_icon(IconKind kind, gint width, gint height)
+{
+    GdkPixbuf* pixbuf = gdk_pixbuf_new(GDK_COLORSPACE_RGB, TRUE, 8, width, height);
+    gdouble radius = MIN(width, height) / 2.0;
+
+    for (gint y = 0; y < height; y++) {
+        for (gint x = 0; x < width; x++) {
+            gdouble dx = x + 0.5 - width / 2.0;
+            gdouble dy = y + 0.5 - height / 2.0;
+            gdouble d = sqrt(dx * dx + dy * dy);
+            gdouble edge = CLAMP(radius - 1.0 - d, 0.0, 1.0);
+
+            switch (kind) {
+            case ICON_DISC:
+                set_pixel(pixbuf, x, y, 40 + 200 * x / width, 180 - 140 * y / height,
+                          90, edge * 255);
+                break;
+            case ICON_GLYPH: {
+                gboolean inside = MAX(fabs(dx), fabs(dy)) < radius * 0.9;
+                gboolean bar = ((x * 8 / width) % 2) && fabs(dy) < radius * 0.6;
+
+                set_pixel(pixbuf, x, y, bar ? 250 : 30, bar ? 250 : 60, bar ? 250 : 120,
+                          inside ? 255 : 0);
+                break;
+            }
+            case ICON_FLAT:
+                set_pixel(pixbuf, x, y, 200, 100, 50, 255);
+                break;
+            case ICON_TRANSPARENT:
+                set_pixel(pixbuf, x, y, 255, 255, 255, 0);
+                break;
+            case ICON_HALF_VISIBLE:
+                if (x < width / 2) {
+                    set_pixel(pixbuf, x, y, 255, 0, 0, 255);
+                } else {
+                    set_pixel(pixbuf, x, y, 0, 255, 0, 0);
+                }
+                break;
+            default:
+                g_assert_not_reached();
+            }
+        }
+    }
+    return pixbuf;
+}
+
+static void
+load_dir(GPtrArray* icons, const gchar* path, gint min_size)
+{
+    GDir* dir = g_dir_open(path, 0, NULL);
+    const gchar* name;
+
+    if (!dir) {
+        g_warning("Could not open %s", path);
+        return;
+    }
+    while ((name = g_dir_read_name(dir))) {
+        gchar* filename = g_build_filename(path, name, NULL);
+        GdkPixbuf* pixbuf = gdk_pixbuf_new_from_file(filename, NULL);
+
+        if (pixbuf && gdk_pixbuf_get_width(pixbuf) >= min_size &&
+                gdk_pixbuf_get_height(pixbuf) >= min_size) {
+            /* compare RGBA to RGBA */
+            g_ptr_array_add(icons, gdk_pixbuf_add_alpha(pixbuf, FALSE, 0, 0, 0));
+        }
+        if (pixbuf) {
+            g_object_unref(pixbuf);
+        }
+        g_free(filename);
+    }
+    g_dir_close(dir);
+}
+
+static gdouble
+premultiplied_mse(GdkPixbuf* i1, GdkPixbuf* i2)
+{
+    gint width = gdk_pixbuf_get_width(i1);
+    gint height = gdk_pixbuf_get_height(i1);
+    gdouble result = 0.0;
+
+    for (gint y = 0; y < height; y++) {
+        const guchar* p1 = gdk_pixbuf_get_pixels(i1) + y * gdk_pixbuf_get_rowstride(i1);
+        const guchar* p2 = gdk_pixbuf_get_pixels(i2) + y * gdk_pixbuf_get_rowstride(i2);
+
+        for (gint x = 0; x < width; x++, p1 += 4, p2 += 4) {
+            for (gint c = 0; c < 3; c++) {
+                gdouble d = (p1[c] * p1[3] - p2[c] * p2[3]) / 255.0;
+                result += d * d;
+            }
+            result += (p1[3] - p2[3]) * (p1[3] - p2[3]);
+        }
+    }
+    return result / width / height / 4;
+}
+
+static gdouble
+psnr(gdouble mse)
+{
+    return mse < 0.0001 ? 99.0 : 10 * log10(255 * 255 / mse);
+}
+
+static guint failures = 0;
+
+static void
+fail(const gchar* icon, gint size, const gchar* what)
+{
+    g_warning("%s icon scaled to %d: %s", icon, size, what);
+    failures++;
+}
+
+/* TRUE if every pixel of pixbuf is within 1 of r, g, b, a */
+static gboolean
+is_flat(GdkPixbuf* pixbuf, gint r, gint g, gint b, gint a)
+{
+    for (gint y = 0; y < gdk_pixbuf_get_height(pixbuf); y++) {
+        const guchar* p = gdk_pixbuf_get_pixels(pixbuf) + y * gdk_pixbuf_get_rowstride(pixbuf);
+
+        for (gint x = 0; x < gdk_pixbuf_get_width(pixbuf); x++, p += 4) {
+            if (abs(p[3] - a) > 1 ||
+                    (a && (abs(p[0] - r) > 1 || abs(p[1] - g) > 1 || abs(p[2] - b) > 1))) {
+                return FALSE;
+            }
+        }
+    }
+    return TRUE;
+}
+
+/* TRUE if no visible pixel has any green in it */
+static gboolean
+has_no_green(GdkPixbuf* pixbuf)
+{
+    for (gint y = 0; y < gdk_pixbuf_get_height(pixbuf); y++) {
+        const guchar* p = gdk_pixbuf_get_pixels(pixbuf) + y * gdk_pixbuf_get_rowstride(pixbuf);
+
+        for (gint x = 0; x < gdk_pixbuf_get_width(pixbuf); x++, p += 4) {
+            if (p[3] && p[1] > 1) {
+                return FALSE;
+            }
+        }
+    }
+    return TRUE;
+}
+
+static void
+check_icon(IconKind kind, gint source_width, gint source_height, gint size)
+{
+    const gchar* name = icon_names[kind];
+    GdkPixbuf* icon = make_icon(kind, source_width, source_height);
+    gint width = source_width * size / source_height;
+    GdkPixbuf* scaled = awn_pixbuf_scale(icon, width, size);
+    cairo_surface_t* surface = awn_pixbuf_scale_to_surface(icon, width, size);
+    GdkPixbuf* hyper;
+
+    if (gdk_pixbuf_get_width(scaled) != width ||
+            gdk_pixbuf_get_height(scaled) != size ||
+            !gdk_pixbuf_get_has_alpha(scaled)) {
+        fail(name, size, "wrong pixbuf size or no alpha");
+        goto out;
+    }
+    if (cairo_image_surface_get_width(surface) != width ||
+            cairo_image_surface_get_height(surface) != size ||
+            cairo_image_surface_get_format(surface) != CAIRO_FORMAT_ARGB32) {
+        fail(name, size, "wrong surface size or format");
+    }
+
+    switch (kind) {
+    case ICON_FLAT:
+        if (!is_flat(scaled, 200, 100, 50, 255)) {
+            fail(name, size, "isn't flat any more");
+        }
+        break;
+    case ICON_TRANSPARENT:
+        if (!is_flat(scaled, 0, 0, 0, 0)) {
+            fail(name, size, "isn't transparent any more");
+        }
+        break;
+    case ICON_HALF_VISIBLE:
+        if (!has_no_green(scaled)) {
+            fail(name, size, "invisible colour bled into visible pixels");
+        }
+        break;
+    default:
+        break;
+    }
+
+    if (width == source_width && size == source_height) {
+        if (psnr(premultiplied_mse(icon, scaled)) < 50.0) {
+            fail(name, size, "changed when scaled to its own size");
+        }
+    } else {
+        hyper = gdk_pixbuf_scale_simple(icon, width, size, GDK_INTERP_HYPER);
+        if (psnr(premultiplied_mse(hyper, scaled)) < MIN_PSNR) {
+            fail(name, size, "too far from GDK_INTERP_HYPER");
+        }
+        g_object_unref(hyper);
+    }
+
+out:
+    cairo_surface_destroy(surface);
+    g_object_unref(scaled);
+    g_object_unref(icon);
+}
+
+static gint
+run_checks(void)
+{
+    static const gint sizes[] = { 256, 64, 48, 22 };
+
+    for (gint kind = 0; kind < N_ICONS; kind++) {
+        for (guint i = 0; i < G_N_ELEMENTS(sizes); i++) {
+            check_icon((IconKind) kind, 256, 256, sizes[i]);
+        }
+        /* a non square one, reduced a lot */
+        check_icon((IconKind) kind, 384, 512, 48);
+    }
+    g_print("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
+
+static gint
+run_bench(gint argc, gchar** argv)
+{
+    gint size = argc > 0 ? atoi(argv[0]) : 48;
+    GPtrArray* icons = g_ptr_array_new();
+    GTimer* timer = g_timer_new();
+    gdouble hyper_time = 0.0, bilinear_time = 0.0, awn_time = 0.0;
+    gdouble bilinear_mse = 0.0, awn_mse = 0.0;
+
+    if (argc > 1) {
+        for (gint i = 1; i < argc; i++) {
+            load_dir(icons, argv[i], size * 2);
+        }
+    } else {
+        for (const gchar** dir = default_dirs; *dir; dir++) {
+            load_dir(icons, *dir, size * 2);
+        }
+    }
+    if (!icons->len) {
+        g_print("no icons of at least %dx%d found, using generated ones\n",
+                size * 2, size * 2);
+        for (gint kind = 0; kind < N_ICONS; kind++) {
+            g_ptr_array_add(icons, make_icon((IconKind) kind, 512, 512));
+        }
+    }
+
+    for (guint i = 0; i < icons->len; i++) {
+        GdkPixbuf* icon = g_ptr_array_index(icons, i);
+        GdkPixbuf* hyper;
+        GdkPixbuf* bilinear;
+        GdkPixbuf* scaled;
+        cairo_surface_t* surface;
+
+        g_timer_start(timer);
+        hyper = gdk_pixbuf_scale_simple(icon, size, size, GDK_INTERP_HYPER);
+        hyper_time += g_timer_elapsed(timer, NULL);
+
+        g_timer_start(timer);
+        bilinear = gdk_pixbuf_scale_simple(icon, size, size, GDK_INTERP_BILINEAR);
+        bilinear_time += g_timer_elapsed(timer, NULL);
+
+        g_timer_start(timer);
+        surface = awn_pixbuf_scale_to_surface(icon, size, size);
+        awn_time += g_timer_elapsed(timer, NULL);
+        cairo_surface_destroy(surface);
+
+        scaled = awn_pixbuf_scale(icon, size, size);
+
+        bilinear_mse += premultiplied_mse(hyper, bilinear);
+        awn_mse += premultiplied_mse(hyper, scaled);
+
+        g_object_unref(scaled);
+        g_object_unref(bilinear);
+        g_object_unref(hyper);
+    }
+
+    g_print("icons: %u, scaled to %dx%d\n", icons->len, size, size);
+    g_print("hyper: %.3f ms, bilinear: %.3f ms, awn: %.3f ms (to surface)\n",
+            hyper_time * 1000.0, bilinear_time * 1000.0, awn_time * 1000.0);
+    g_print("PSNR against hyper: bilinear %.2f dB, awn %.2f dB\n",
+            psnr(bilinear_mse / icons->len), psnr(awn_mse / icons->len));
+
+    g_ptr_array_foreach(icons, (GFunc)g_object_unref, NULL);
+    g_ptr_array_free(icons, TRUE);
+    g_timer_destroy(timer);
+    return 0;
+}
+
+gint
+main(gint argc, gchar** argv)
+{
+    g_type_init();
+
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        return run_bench(argc - 2, argv + 2);
+    }
+    return run_checks();
+}
@@ -0,0 +1,351 @@
+/*
+ * Copyright (C) 2026 Awn-core team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA.
+ */
+
+/*
+ Checks the taskmanager's icon similarity against the plain MSE comparison
+ it replaced, over every pair of a generated set of icons (flat, low
+ contrast, mostly transparent, ...) and of the icons found in the given
+ directories, or in the default ones when they exist.  For each pair the
+ verdicts must match and the signatures' MSE bound must not exceed the MSE.
+
+ Usage: test-icon-similarity [size] [dir...]
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+#include "applets/taskmanager/pixbuf-similarity.h"
+
+static const gchar* default_dirs[] = {
+    "/usr/share/icons/hicolor/48x48/apps",
+    "/usr/share/pixmaps",
+    NULL
+};
+
+/* compute_mse() as it was in applets/taskmanager/util.cc */
+static gdouble
+reference_mse(GdkPixbuf* i1, GdkPixbuf* i2)
+{
+    int i, j;
+    int width, height, row_stride, has_alpha;
+    guchar* i1_pixels, *i2_pixels;
+    gdouble result = 0.0;
+
+    has_alpha = gdk_pixbuf_get_has_alpha(i1);
+    width = gdk_pixbuf_get_width(i1);
+    height = gdk_pixbuf_get_height(i1);
+    row_stride = gdk_pixbuf_get_rowstride(i1);
+
+    i1_pixels = gdk_pixbuf_get_pixels(i1);
+    i2_pixels = gdk_pixbuf_get_pixels(i2);
+
+    for (i = 0; i < height; i++) {
+        guchar* it1, *it2;
+        it1 = i1_pixels + i * row_stride;
+        it2 = i2_pixels + i * row_stride;
+        for (j = 0; j < width; j++) {
+            gdouble inc = 0.0;
+            gint delta_r = *(it1++);
+            delta_r -= *(it2++);
+            gint delta_g = *(it1++);
+            delta_g -= *(it2++);
+            gint delta_b = *(it1++);
+            delta_b -= *(it2++);
+            inc += delta_r * delta_r + delta_g * delta_g + delta_b * delta_b;
+
+            if (has_alpha) {
+                gint delta_alpha = *it1 - *it2;
+                inc += delta_alpha * delta_alpha;
+                if (abs(delta_alpha) <= 10 && *it1 <= 10) {
+                    it1++;
+                    it2++;
+                    continue;
+                }
+                it1++;
+                it2++;
+            }
+            result += inc;
+        }
+    }
+
+    return result / width / height / (has_alpha ? 4 : 3);
+}
+
+static gboolean
+reference_similar_to(GdkPixbuf* i1, GdkPixbuf* i2)
+{
+    gdouble MSE = reference_mse(i1, i2);
+
+    if (MSE < 0.01) {
+        return TRUE;
+    }
+    return 10 * log10(255 * 255 / MSE) >= 11;
+}
+
+static void
+load_dir(GPtrArray* icons, const gchar* path, gint size)
+{
+    GDir* dir = g_dir_open(path, 0, NULL);
+    const gchar* name;
+
+    if (!dir) {
+        g_print("Could not open %s\n", path);
+        return;
+    }
+    while ((name = g_dir_read_name(dir))) {
+        gchar* filename = g_build_filename(path, name, NULL);
+        GdkPixbuf* pixbuf = gdk_pixbuf_new_from_file_at_scale(filename, size, size,
+                            FALSE, NULL);
+        if (pixbuf) {
+            if (!gdk_pixbuf_get_has_alpha(pixbuf)) {
+                GdkPixbuf* tmp = gdk_pixbuf_add_alpha(pixbuf, FALSE, 0, 0, 0);
+                g_object_unref(pixbuf);
+                pixbuf = tmp;
+            }
+            g_ptr_array_add(icons, pixbuf);
+        }
+        g_free(filename);
+    }
+    g_dir_close(dir);
+}
+
+/* generated icons */
+
+static GdkPixbuf*
+new_icon(gint size)
+{
+    return gdk_pixbuf_new(GDK_COLORSPACE_RGB, TRUE, 8, size, size);
+}
+
+static void
+set_pixel(GdkPixbuf* pixbuf, gint x, gint y,
+          guchar r, guchar g, guchar b, guchar a)
+{
+    guchar* p = gdk_pixbuf_get_pixels(pixbuf) +
+                y * gdk_pixbuf_get_rowstride(pixbuf) + x * 4;
+
+    p[0] = r;
+    p[1] = g;
+    p[2] = b;
+    p[3] = a;
+}
+
+static GdkPixbuf*
+flat_icon(gint size, guchar r, guchar g, guchar b, guchar a)
+{
+    GdkPixbuf* pixbuf = new_icon(size);
+
+    gdk_pixbuf_fill(pixbuf, ((guint32)r << 24) | (g << 16) | (b << 8) | a);
+    return pixbuf;
+}
+
+/* grey around level, each pixel off by up to amplitude */
+static GdkPixbuf*
+noise_icon(gint size, gint level, gint amplitude, guchar a, guint32 seed)
+{
+    GdkPixbuf* pixbuf = new_icon(size);
+    GRand* rand = g_rand_new_with_seed(seed);
+
+    for (gint y = 0; y < size; y++) {
+        for (gint x = 0; x < size; x++) {
+            gint v = CLAMP(level + g_rand_int_range(rand, -amplitude,
+                           amplitude + 1), 0, 255);
+            set_pixel(pixbuf, x, y, v, v, v, a);
+        }
+    }
+    g_rand_free(rand);
+    return pixbuf;
+}
+
+static GdkPixbuf*
+gradient_icon(gint size, gint from, gint to)
+{
+    GdkPixbuf* pixbuf = new_icon(size);
+
+    for (gint y = 0; y < size; y++) {
+        for (gint x = 0; x < size; x++) {
+            gint v = from + (to - from) * x / (size - 1);
+            set_pixel(pixbuf, x, y, v, v, v, 255);
+        }
+    }
+    return pixbuf;
+}
+
+/* alpha <= 10 everywhere but for an opaque dot of radius size / 8 */
+static GdkPixbuf*
+mostly_transparent_icon(gint size, gint dot_x, gint dot_y, guint32 seed)
+{
+    GdkPixbuf* pixbuf = new_icon(size);
+    GRand* rand = g_rand_new_with_seed(seed);
+    gint radius = MAX(size / 8, 1);
+
+    for (gint y = 0; y < size; y++) {
+        for (gint x = 0; x < size; x++) {
+            gint dx = x - dot_x, dy = y - dot_y;
+            if (dx * dx + dy * dy <= radius * radius) {
+                set_pixel(pixbuf, x, y, 255, 255, 255, 255);
+            } else {
+                set_pixel(pixbuf, x, y, g_rand_int_range(rand, 0, 256),
+                          g_rand_int_range(rand, 0, 256),
+                          g_rand_int_range(rand, 0, 256),
+                          g_rand_int_range(rand, 0, 11));
+            }
+        }
+    }
+    g_rand_free(rand);
+    return pixbuf;
+}
+
+static GdkPixbuf*
+disc_icon(gint size, guchar r, guchar g, guchar b)
+{
+    GdkPixbuf* pixbuf = new_icon(size);
+    gdouble c = (size - 1) / 2.0;
+
+    for (gint y = 0; y < size; y++) {
+        for (gint x = 0; x < size; x++) {
+            gboolean inside = (x - c) * (x - c) + (y - c) * (y - c) <= c * c;
+            set_pixel(pixbuf, x, y, r, g, b, inside ? 255 : 0);
+        }
+    }
+    return pixbuf;
+}
+
+static GdkPixbuf*
+checker_icon(gint size, gint cell)
+{
+    GdkPixbuf* pixbuf = new_icon(size);
+
+    for (gint y = 0; y < size; y++) {
+        for (gint x = 0; x < size; x++) {
+            guchar v = ((x / cell + y / cell) % 2) ? 255 : 0;
+            set_pixel(pixbuf, x, y, v, v, v, 255);
+        }
+    }
+    return pixbuf;
+}
+
+static void
+generate_icons(GPtrArray* icons, gint size)
+{
+    g_ptr_array_add(icons, flat_icon(size, 0, 0, 0, 255));
+    g_ptr_array_add(icons, flat_icon(size, 255, 255, 255, 255));
+    g_ptr_array_add(icons, flat_icon(size, 128, 128, 128, 255));
+    g_ptr_array_add(icons, flat_icon(size, 129, 129, 129, 255));
+    g_ptr_array_add(icons, flat_icon(size, 200, 30, 30, 255));
+    g_ptr_array_add(icons, flat_icon(size, 0, 0, 0, 0));
+    g_ptr_array_add(icons, flat_icon(size, 255, 255, 255, 10));
+    g_ptr_array_add(icons, noise_icon(size, 128, 2, 255, 1));
+    g_ptr_array_add(icons, noise_icon(size, 128, 2, 255, 2));
+    g_ptr_array_add(icons, noise_icon(size, 40, 3, 255, 3));
+    g_ptr_array_add(icons, noise_icon(size, 128, 60, 255, 4));
+    g_ptr_array_add(icons, noise_icon(size, 128, 2, 8, 5));
+    g_ptr_array_add(icons, gradient_icon(size, 120, 136));
+    g_ptr_array_add(icons, gradient_icon(size, 136, 120));
+    g_ptr_array_add(icons, gradient_icon(size, 0, 255));
+    g_ptr_array_add(icons, mostly_transparent_icon(size, size / 2, size / 2, 6));
+    g_ptr_array_add(icons, mostly_transparent_icon(size, size / 2, size / 2, 7));
+    g_ptr_array_add(icons, mostly_transparent_icon(size, size / 8, size / 8, 8));
+    g_ptr_array_add(icons, disc_icon(size, 255, 255, 255));
+    g_ptr_array_add(icons, disc_icon(size, 200, 30, 30));
+    g_ptr_array_add(icons, checker_icon(size, MAX(size / 8, 1)));
+    g_ptr_array_add(icons, checker_icon(size, 1));
+}
+
+gint
+main(gint argc, gchar** argv)
+{
+    gint size = argc > 1 ? atoi(argv[1]) : 48;
+    GPtrArray* icons = g_ptr_array_new();
+    GTimer* timer = g_timer_new();
+    guint generated, pairs = 0, mismatches = 0, similar = 0, rejected = 0;
+    gdouble reference_time = 0.0, similarity_time = 0.0;
+
+    g_type_init();
+
+    if (size <= 0) {
+        g_printerr("Usage: %s [size] [dir...]\n", argv[0]);
+        return 1;
+    }
+
+    generate_icons(icons, size);
+    generated = icons->len;
+    if (argc > 2) {
+        for (gint i = 2; i < argc; i++) {
+            load_dir(icons, argv[i], size);
+        }
+    } else {
+        for (const gchar** dir = default_dirs; *dir; dir++) {
+            if (g_file_test(*dir, G_FILE_TEST_IS_DIR)) {
+                load_dir(icons, *dir, size);
+            }
+        }
+    }
+
+    for (guint i = 0; i < icons->len; i++) {
+        for (guint j = i; j < icons->len; j++) {
+            GdkPixbuf* i1 = g_ptr_array_index(icons, i);
+            GdkPixbuf* i2 = g_ptr_array_index(icons, j);
+            gboolean expected, result;
+            gdouble mse, bound;
+
+            if (gdk_pixbuf_get_rowstride(i1) != gdk_pixbuf_get_rowstride(i2)) {
+                continue;
+            }
+            g_timer_start(timer);
+            expected = reference_similar_to(i1, i2);
+            reference_time += g_timer_elapsed(timer, NULL);
+
+            g_timer_start(timer);
+            result = pixbuf_similarity_similar_to(i1, i2);
+            similarity_time += g_timer_elapsed(timer, NULL);
+
+            pairs++;
+            similar += expected;
+            if (expected != result) {
+                g_print("icons %u and %u: similar %d, expected %d\n",
+                        i, j, result, expected);
+                mismatches++;
+            }
+
+            /* the early rejection must never be above the real MSE */
+            mse = reference_mse(i1, i2);
+            bound = pixbuf_similarity_mse_lower_bound(i1, i2);
+            if (bound > mse) {
+                g_print("icons %u and %u: MSE %g below its bound %g\n",
+                        i, j, mse, bound);
+                mismatches++;
+            }
+            if (bound > 0.0 && 10 * log10(255 * 255 / bound) < 11) {
+                rejected++;
+            }
+        }
+    }
+
+    g_print("icons: %u (%u generated), pairs: %u, similar: %u, "
+            "rejected on the bound: %u, mismatches: %u\n",
+            icons->len, generated, pairs, similar, rejected, mismatches);
+    g_print("mse: %.3f ms, bound rejection + mse: %.3f ms\n",
+            reference_time * 1000.0, similarity_time * 1000.0);
+
+    g_timer_destroy(timer);
+    return mismatches ? 1 : 0;
+}